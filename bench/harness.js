@@ -0,0 +1,128 @@
+/**
+ * Benchmark harness
+ *
+ * This file is concatenated in front of the workload files by `run.js` and
+ * executed as a single program, so it only relies on the globals provided
+ * by the runtime (`micros`, `setTimeout`, `process`, `console`).
+ *
+ * A workload is registered with `bench(name, options, fn)`:
+ *
+ * - sync (default): `fn(ctx, i)` is called `options.iterations` times, and
+ *   each call is timed individually. `options.setup()` may return a context
+ *   which is passed as `ctx`.
+ * - async (`options.async: true`): `fn(b)` is called once and must report
+ *   callback latencies with `b.sample(us)` and finish with `b.done(ops)`.
+ *
+ * Results are printed as a single line prefixed with `BENCH_JSON ` when all
+ * workloads have finished.
+ */
+
+var __bench = {
+  list: [],
+  results: [],
+  filter: null,
+};
+
+function bench(name, options, fn) {
+  if (typeof options === 'function') {
+    fn = options;
+    options = {};
+  }
+  __bench.list.push({ name: name, options: options, fn: fn });
+}
+
+function __benchPercentile(sorted, p) {
+  if (sorted.length === 0) return 0;
+  var idx = Math.ceil((p / 100) * sorted.length) - 1;
+  if (idx < 0) idx = 0;
+  return sorted[idx];
+}
+
+function __benchMemory() {
+  var mem = process.memoryUsage();
+  return mem ? mem : { heapUsed: 0, heapPeak: 0 };
+}
+
+function __benchReport() {
+  var report = {
+    arch: process.arch,
+    platform: process.platform,
+    version: process.version,
+    heapTotal: __benchMemory().heapTotal,
+    results: __bench.results,
+  };
+  console.log('BENCH_JSON ' + JSON.stringify(report));
+}
+
+function __benchRun(index) {
+  if (index >= __bench.list.length) {
+    __benchReport();
+    return;
+  }
+  var b = __bench.list[index];
+  if (__bench.filter && b.name.indexOf(__bench.filter) < 0) {
+    __benchRun(index + 1);
+    return;
+  }
+  var samples = [];
+  var start = 0;
+  var finished = false;
+  var heapBefore = __benchMemory().heapUsed;
+  var finish = function (err, ops) {
+    if (finished) return;
+    finished = true;
+    var elapsed = micros() - start;
+    var result = { name: b.name };
+    if (err) {
+      result.skipped = true;
+      result.error = String(err && err.message ? err.message : err);
+    } else {
+      var mem = __benchMemory();
+      samples.sort(function (x, y) {
+        return x - y;
+      });
+      result.ops = ops;
+      result.elapsedUs = elapsed;
+      result.opsPerSec = elapsed > 0 ? Math.round((ops * 1e6) / elapsed) : 0;
+      result.p50Us = __benchPercentile(samples, 50);
+      result.p99Us = __benchPercentile(samples, 99);
+      result.heapUsedDelta = mem.heapUsed - heapBefore;
+      result.heapPeak = mem.heapPeak;
+    }
+    __bench.results.push(result);
+    samples = null;
+    // let pending handles of the workload drain before the next one
+    setTimeout(function () {
+      __benchRun(index + 1);
+    }, 0);
+  };
+  try {
+    if (b.options.async) {
+      start = micros();
+      b.fn({
+        sample: function (us) {
+          samples.push(us);
+        },
+        done: function (ops) {
+          finish(null, ops);
+        },
+        fail: function (err) {
+          finish(err);
+        },
+      });
+    } else {
+      var n = b.options.iterations || 1000;
+      var ctx = b.options.setup ? b.options.setup() : undefined;
+      start = micros();
+      for (var i = 0; i < n; i++) {
+        var t = micros();
+        b.fn(ctx, i);
+        samples.push(micros() - t);
+      }
+      if (b.options.teardown) b.options.teardown(ctx);
+      finish(null, n);
+    }
+  } catch (err) {
+    finish(err);
+  }
+}
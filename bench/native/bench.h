@@ -0,0 +1,67 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_BENCH_H
+#define __PWJS_BENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A benchmark case. run() is called repeatedly and is timed; each call
+ * performs `ops` operations of the kernel. setup() and teardown() are
+ * called once around all repetitions and are not timed.
+ */
+typedef struct {
+  const char *name;
+  uint32_t ops;
+  void (*setup)();
+  void (*run)();
+  void (*teardown)();
+} pwjs_bench_t;
+
+typedef struct {
+  const pwjs_bench_t *cases;
+  size_t count;
+} pwjs_bench_group_t;
+
+/**
+ * Store a result so the compiler cannot optimize the kernel away.
+ */
+extern volatile uint32_t pwjs_bench_sink;
+
+/**
+ * Fill a buffer with deterministic pseudo-random bytes.
+ */
+void pwjs_bench_fill(uint8_t *buf, size_t len, uint32_t seed);
+
+#define PWJS_BENCH_GROUP(group) \
+  const pwjs_bench_group_t group = {group##_cases, \
+                                    sizeof(group##_cases) / sizeof(pwjs_bench_t)}
+
+extern const pwjs_bench_group_t bench_core;
+extern const pwjs_bench_group_t bench_graphics;
+extern const pwjs_bench_group_t bench_url;
+extern const pwjs_bench_group_t bench_storage;
+extern const pwjs_bench_group_t bench_flash;
+extern const pwjs_bench_group_t bench_fat;
+
+#endif /* __PWJS_BENCH_H */
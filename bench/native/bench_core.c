@@ -0,0 +1,141 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "base64.h"
+#include "bench.h"
+#include "mem.h"
+#include "ringbuffer.h"
+#include "tty.h"
+#include "ymodem.h"
+
+#define RB_SIZE 2048
+#define RB_CHUNK 64
+#define DATA_SIZE 1024
+
+static uint8_t rb_buffer[RB_SIZE];
+static ringbuffer_t rb;
+static uint8_t data[DATA_SIZE];
+static unsigned char *encoded = NULL;
+static size_t encoded_len = 0;
+
+/* ymodem.c is linked for its CRC, it never receives anything here */
+
+uint32_t pwjs_tty_read_sync(uint8_t *buf, size_t len, uint32_t timeout) {
+  return 0;
+}
+
+void pwjs_tty_putc(char ch) {}
+
+static void data_setup() { pwjs_bench_fill(data, DATA_SIZE, 1); }
+
+static void rb_setup() {
+  data_setup();
+  ringbuffer_init(&rb, rb_buffer, RB_SIZE);
+}
+
+static void rb_half_setup() {
+  rb_setup();
+  ringbuffer_write(&rb, data, RB_SIZE / 2);
+}
+
+/* write then read one chunk, wrapping around the buffer over time */
+static void rb_write_read_run() {
+  uint8_t chunk[RB_CHUNK];
+  ringbuffer_write(&rb, data, RB_CHUNK);
+  ringbuffer_read(&rb, chunk, RB_CHUNK);
+  pwjs_bench_sink += chunk[0];
+}
+
+/* byte-by-byte, as done by tty/uart receive paths */
+static void rb_byte_run() {
+  uint8_t ch;
+  for (int i = 0; i < RB_CHUNK; i++) {
+    ringbuffer_write(&rb, &data[i], 1);
+  }
+  for (int i = 0; i < RB_CHUNK; i++) {
+    ringbuffer_read(&rb, &ch, 1);
+    pwjs_bench_sink += ch;
+  }
+}
+
+static void rb_look_at_run() {
+  uint32_t sum = 0;
+  uint32_t len = ringbuffer_length(&rb);
+  for (uint32_t i = 0; i < len; i++) {
+    sum += ringbuffer_look_at(&rb, i);
+  }
+  pwjs_bench_sink += sum;
+}
+
+/* search for a byte which is not in the buffer (worst case) */
+static void rb_find_run() {
+  pwjs_bench_sink += (uint32_t)ringbuffer_find(&rb, '\n');
+}
+
+static void rb_find_setup() {
+  rb_setup();
+  for (int i = 0; i < DATA_SIZE; i++) {
+    if (data[i] == '\n') data[i] = ' ';
+  }
+  ringbuffer_write(&rb, data, DATA_SIZE);
+}
+
+static void base64_encode_run() {
+  size_t len;
+  unsigned char *out = pwjs_base64_encode(data, DATA_SIZE, &len);
+  pwjs_bench_sink += out[0];
+  pwjs_free(out);
+}
+
+static void base64_decode_setup() {
+  data_setup();
+  encoded = pwjs_base64_encode(data, DATA_SIZE, &encoded_len);
+}
+
+static void base64_decode_run() {
+  size_t len;
+  unsigned char *out = pwjs_base64_decode(encoded, encoded_len, &len);
+  pwjs_bench_sink += out[0];
+  pwjs_free(out);
+}
+
+static void base64_decode_teardown() {
+  pwjs_free(encoded);
+  encoded = NULL;
+}
+
+static void crc16_run() { pwjs_bench_sink += pwjs_ymodem_crc16(data, DATA_SIZE); }
+
+static const pwjs_bench_t bench_core_cases[] = {
+    {"ringbuffer.write-read", RB_CHUNK, rb_setup, rb_write_read_run, NULL},
+    {"ringbuffer.byte", RB_CHUNK, rb_setup, rb_byte_run, NULL},
+    {"ringbuffer.look_at", RB_SIZE / 2, rb_half_setup, rb_look_at_run, NULL},
+    {"ringbuffer.find", DATA_SIZE, rb_find_setup, rb_find_run, NULL},
+    {"base64.encode", DATA_SIZE, data_setup, base64_encode_run, NULL},
+    {"base64.decode", DATA_SIZE, base64_decode_setup, base64_decode_run,
+     base64_decode_teardown},
+    {"ymodem.crc16", DATA_SIZE, data_setup, crc16_run, NULL},
+};
+
+PWJS_BENCH_GROUP(bench_core);
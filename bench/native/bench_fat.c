@@ -0,0 +1,163 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "diskio.h"
+#include "ff.h"
+#include "vfs_fat.h"
+
+/*
+ * A 8 MB FAT16 image in RAM with one-sector clusters, holding a 6 MB file
+ * whose clusters are interleaved with another file every 256 KB, as a log
+ * growing next to other files. Each seek of a plain open walks the FAT chain
+ * from the start of the file, across the FAT sectors.
+ */
+#define SECTOR_SIZE 512
+#define SECTOR_COUNT 16384
+#define FILE_CHUNK 4096
+#define FILE_CHUNKS 1536
+#define FILE_SIZE (FILE_CHUNK * FILE_CHUNKS)
+#define READ_SIZE 64
+#define READ_COUNT 64
+
+static uint8_t *image;
+static uint32_t sector_reads;
+static uint32_t reads;
+static FATFS fat_fs;
+static vfs_fat_handle_t vfs_handle;
+static void *file;
+static uint32_t seed;
+static uint8_t buffer[FILE_CHUNK];
+
+DRESULT disk_read(void *drv, BYTE *buff, DWORD sector, UINT count) {
+  sector_reads += count;
+  memcpy(buff, image + sector * SECTOR_SIZE, count * SECTOR_SIZE);
+  return RES_OK;
+}
+
+DRESULT disk_write(void *drv, const BYTE *buff, DWORD sector, UINT count) {
+  memcpy(image + sector * SECTOR_SIZE, buff, count * SECTOR_SIZE);
+  return RES_OK;
+}
+
+DRESULT disk_ioctl(void *drv, BYTE cmd, void *buff) {
+  switch (cmd) {
+    case GET_SECTOR_COUNT:
+      *((DWORD *)buff) = SECTOR_COUNT;
+      return RES_OK;
+    case GET_SECTOR_SIZE:
+      *((WORD *)buff) = SECTOR_SIZE;
+      return RES_OK;
+    case GET_BLOCK_SIZE:
+      *((DWORD *)buff) = 1;
+      return RES_OK;
+    case IOCTL_INIT:
+    case IOCTL_STATUS:
+      *((DSTATUS *)buff) = 0;
+      return RES_OK;
+    default:
+      return RES_OK;
+  }
+}
+
+DWORD get_fattime(void) { return 0; }
+
+/* vfs_fat_free() releases the JS block device, there is no engine here */
+void jerry_release_value(jerry_value_t value) {}
+
+static void fat_setup_image() {
+  image = calloc(SECTOR_COUNT, SECTOR_SIZE);
+  BYTE work[SECTOR_SIZE];
+  if (image == NULL ||
+      f_mkfs(&fat_fs, FM_FAT | FM_SFD, SECTOR_SIZE, work, sizeof(work)) !=
+          FR_OK ||
+      f_mount(&fat_fs) != FR_OK) {
+    fprintf(stderr, "fat: failed to format the image\n");
+    exit(1);
+  }
+  vfs_handle.fat_fs = &fat_fs;
+  pwjs_vfs_t *vfs = &vfs_handle.vfs;
+  void *data;
+  void *other;
+  int flags = PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE | PWJS_VFS_FLAG_TRUNC;
+  vfs_fat_ops.open(vfs, "/data.bin", flags, &data);
+  vfs_fat_ops.open(vfs, "/other.bin", flags, &other);
+  for (int i = 0; i < FILE_CHUNKS; i++) {
+    pwjs_bench_fill(buffer, FILE_CHUNK, i);
+    vfs_fat_ops.write(vfs, data, buffer, FILE_CHUNK);
+    if (i % 64 == 63) {
+      vfs_fat_ops.write(vfs, other, buffer, FILE_CHUNK);
+    }
+  }
+  vfs_fat_ops.close(vfs, data);
+  vfs_fat_ops.close(vfs, other);
+}
+
+static void fat_open(int flags) {
+  fat_setup_image();
+  if (vfs_fat_ops.open(&vfs_handle.vfs, "/data.bin", flags, &file) < 0) {
+    fprintf(stderr, "fat: failed to open the file\n");
+    exit(1);
+  }
+  seed = 1;
+  sector_reads = 0;
+  reads = 0;
+}
+
+static void fat_setup() { fat_open(PWJS_VFS_FLAG_READ); }
+
+static void fat_setup_random() {
+  fat_open(PWJS_VFS_FLAG_READ | PWJS_VFS_FLAG_RANDOM);
+}
+
+static void fat_teardown() {
+  if (reads > 0) {
+    fprintf(stderr, "fat: %u sector reads for %u reads\n", sector_reads,
+            reads);
+  }
+  vfs_fat_ops.close(&vfs_handle.vfs, file);
+  free(image);
+  image = NULL;
+}
+
+/* reads at random positions, as a logger looking back into its file */
+static void seek_read_run() {
+  for (int i = 0; i < READ_COUNT; i++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t position = (seed >> 8) % (FILE_SIZE - READ_SIZE);
+    vfs_fat_ops.seek(&vfs_handle.vfs, file, position);
+    vfs_fat_ops.read(&vfs_handle.vfs, file, buffer, READ_SIZE);
+    pwjs_bench_sink += buffer[0];
+  }
+  reads += READ_COUNT;
+}
+
+static const pwjs_bench_t bench_fat_cases[] = {
+    {"fat.seek-read", READ_COUNT, fat_setup, seek_read_run, fat_teardown},
+    {"fat.seek-read-fastseek", READ_COUNT, fat_setup_random, seek_read_run,
+     fat_teardown},
+};
+
+PWJS_BENCH_GROUP(bench_fat);
@@ -0,0 +1,93 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "board.h"
+#include "flash.h"
+#include "flash_cache.h"
+
+// a sector past the program area, not used by the storage
+#define BENCH_SECTOR 200
+#define PAGE_COUNT (PICOWJS_FLASH_SECTOR_SIZE / PICOWJS_FLASH_PAGE_SIZE)
+
+static uint8_t page[PICOWJS_FLASH_PAGE_SIZE];
+
+static void flash_setup() {
+  // the linux flash port maps PICOWJS_FLASH, keep it away from the default
+  setenv("PICOWJS_FLASH", "/tmp/picowjs-bench-flash.bin", 0);
+  pwjs_flash_init();
+  pwjs_bench_fill(page, sizeof(page), 36);
+  pwjs_flash_cache_reset_stats();
+}
+
+static void flash_teardown() {
+  pwjs_flash_cache_stats_t stats;
+  pwjs_flash_cache_get_stats(&stats);
+  if (stats.requested > 0) {
+    fprintf(stderr, "flash cache: %u pages (%u merged) in %u programs\n",
+            stats.requested, stats.merged, stats.programs);
+  }
+  pwjs_flash_cache_cleanup();
+  pwjs_flash_erase(BENCH_SECTOR, 1);
+}
+
+/* fill a sector page by page, as a block device driver does */
+static void program_run() {
+  pwjs_flash_erase(BENCH_SECTOR, 1);
+  for (int i = 0; i < PAGE_COUNT; i++) {
+    pwjs_flash_program(BENCH_SECTOR, i * PICOWJS_FLASH_PAGE_SIZE, page,
+                       PICOWJS_FLASH_PAGE_SIZE);
+  }
+}
+
+/* the same through the cache, written back in one burst on sync */
+static void program_cached_run() {
+  pwjs_flash_cache_erase(BENCH_SECTOR, 1);
+  for (int i = 0; i < PAGE_COUNT; i++) {
+    pwjs_flash_cache_program(BENCH_SECTOR, i * PICOWJS_FLASH_PAGE_SIZE, page,
+                             PICOWJS_FLASH_PAGE_SIZE);
+  }
+  pwjs_flash_cache_sync();
+}
+
+/* each page programmed twice (e.g. a header updated after its data) */
+static void rewrite_cached_run() {
+  pwjs_flash_cache_erase(BENCH_SECTOR, 1);
+  for (int i = 0; i < PAGE_COUNT * 2; i++) {
+    pwjs_flash_cache_program(BENCH_SECTOR,
+                             (i / 2) * PICOWJS_FLASH_PAGE_SIZE, page,
+                             PICOWJS_FLASH_PAGE_SIZE);
+  }
+  pwjs_flash_cache_sync();
+}
+
+static const pwjs_bench_t bench_flash_cases[] = {
+    {"flash.program", PAGE_COUNT, flash_setup, program_run, flash_teardown},
+    {"flash.program-cached", PAGE_COUNT, flash_setup, program_cached_run,
+     flash_teardown},
+    {"flash.rewrite-cached", PAGE_COUNT * 2, flash_setup, rewrite_cached_run,
+     flash_teardown},
+};
+
+PWJS_BENCH_GROUP(bench_flash);
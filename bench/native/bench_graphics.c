@@ -0,0 +1,157 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gc.h"
+#include "gc_16bit_prims.h"
+#include "gc_1bit_prims.h"
+#include "gc_3bit_prims.h"
+
+#define WIDTH 128
+#define HEIGHT 64
+#define TEXT "Hello, World! 012345"
+
+static gc_handle_t gc;
+
+/**
+ * Initialize the handle the same way as BufferedGraphicsContext does.
+ */
+static void gc_setup(uint8_t bpp) {
+  memset(&gc, 0, sizeof(gc_handle_t));
+  gc.device_width = WIDTH;
+  gc.device_height = HEIGHT;
+  gc.bpp = bpp;
+  gc.color = 1;
+  gc.fill_color = 1;
+  gc.font_color = 1;
+  gc.font_scale_x = 1;
+  gc.font_scale_y = 1;
+  gc_set_rotation(&gc, 0);
+  size_t size = WIDTH * HEIGHT;
+  if (bpp == 1) {
+    gc.set_pixel_cb = gc_prim_1bit_set_pixel;
+    gc.get_pixel_cb = gc_prim_1bit_get_pixel;
+    gc.draw_hline_cb = gc_prim_1bit_draw_hline;
+    gc.draw_vline_cb = gc_prim_1bit_draw_vline;
+    gc.fill_rect_cb = gc_prim_1bit_fill_rect;
+    gc.fill_screen_cb = gc_prim_1bit_fill_screen;
+    size = size / 8;
+  } else if (bpp == 3) {
+    gc.set_pixel_cb = gc_prim_3bit_set_pixel;
+    gc.get_pixel_cb = gc_prim_3bit_get_pixel;
+    gc.draw_hline_cb = gc_prim_3bit_draw_hline;
+    gc.draw_vline_cb = gc_prim_3bit_draw_vline;
+    gc.fill_rect_cb = gc_prim_3bit_fill_rect;
+    gc.fill_screen_cb = gc_prim_3bit_fill_screen;
+    size = size / 2;
+  } else {
+    gc.set_pixel_cb = gc_prim_16bit_set_pixel;
+    gc.get_pixel_cb = gc_prim_16bit_get_pixel;
+    gc.draw_hline_cb = gc_prim_16bit_draw_hline;
+    gc.draw_vline_cb = gc_prim_16bit_draw_vline;
+    gc.fill_rect_cb = gc_prim_16bit_fill_rect;
+    gc.fill_screen_cb = gc_prim_16bit_fill_screen;
+    size = size * 2;
+  }
+  gc.buffer = calloc(size, 1);
+  gc.buffer_size = size;
+}
+
+static void gc_1bit_setup() { gc_setup(1); }
+
+static void gc_3bit_setup() { gc_setup(3); }
+
+static void gc_16bit_setup() { gc_setup(16); }
+
+static void gc_teardown() {
+  free(gc.buffer);
+  gc.buffer = NULL;
+}
+
+static void set_pixel_run() {
+  for (int16_t y = 0; y < HEIGHT; y++) {
+    for (int16_t x = 0; x < WIDTH; x++) {
+      gc.set_pixel_cb(&gc, x, y, (x ^ y) & 1);
+    }
+  }
+}
+
+static void get_pixel_run() {
+  uint16_t color;
+  uint32_t sum = 0;
+  for (int16_t y = 0; y < HEIGHT; y++) {
+    for (int16_t x = 0; x < WIDTH; x++) {
+      gc.get_pixel_cb(&gc, x, y, &color);
+      sum += color;
+    }
+  }
+  pwjs_bench_sink += sum;
+}
+
+static void hline_run() {
+  for (int16_t y = 0; y < HEIGHT; y++) {
+    gc.draw_hline_cb(&gc, 0, y, WIDTH, 1);
+  }
+}
+
+static void vline_run() {
+  for (int16_t x = 0; x < WIDTH; x++) {
+    gc.draw_vline_cb(&gc, x, 0, HEIGHT, 1);
+  }
+}
+
+static void fill_rect_run() { gc.fill_rect_cb(&gc, 8, 8, 100, 48, 1); }
+
+static void fill_screen_run() { gc.fill_screen_cb(&gc, 1); }
+
+/* diagonal lines through the whole screen (Bresenham in gc_draw_line) */
+static void line_run() {
+  for (int16_t i = 0; i < 16; i++) {
+    gc_draw_line(&gc, 0, i * 4, WIDTH - 1, HEIGHT - 1 - i * 4);
+  }
+}
+
+static void circle_run() { gc_fill_circle(&gc, WIDTH / 2, HEIGHT / 2, 30); }
+
+static void text_run() { gc_draw_text(&gc, 0, 28, TEXT); }
+
+#define GC_CASES(bpp, setup)                                                  \
+  {"gc." bpp ".set_pixel", WIDTH * HEIGHT, setup, set_pixel_run, gc_teardown}, \
+      {"gc." bpp ".get_pixel", WIDTH * HEIGHT, setup, get_pixel_run,          \
+       gc_teardown},                                                          \
+      {"gc." bpp ".hline", HEIGHT, setup, hline_run, gc_teardown},            \
+      {"gc." bpp ".vline", WIDTH, setup, vline_run, gc_teardown},             \
+      {"gc." bpp ".fill_rect", 1, setup, fill_rect_run, gc_teardown},         \
+      {"gc." bpp ".fill_screen", 1, setup, fill_screen_run, gc_teardown},     \
+      {"gc." bpp ".line", 16, setup, line_run, gc_teardown},                  \
+      {"gc." bpp ".fill_circle", 1, setup, circle_run, gc_teardown},          \
+      {"gc." bpp ".text", sizeof(TEXT) - 1, setup, text_run, gc_teardown}
+
+static const pwjs_bench_t bench_graphics_cases[] = {
+    GC_CASES("1bit", gc_1bit_setup),
+    GC_CASES("3bit", gc_3bit_setup),
+    GC_CASES("16bit", gc_16bit_setup),
+};
+
+PWJS_BENCH_GROUP(bench_graphics);
@@ -0,0 +1,131 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "flash.h"
+#include "storage.h"
+
+#define KEY_COUNT 256
+
+static char keys[KEY_COUNT][16];
+
+/**
+ * Fill the storage with KEY_COUNT items, removing every other one once so
+ * that lookups also have to skip over removed slots.
+ */
+static void storage_setup() {
+  // the linux flash port maps PICOWJS_FLASH, keep it away from the default
+  setenv("PICOWJS_FLASH", "/tmp/picowjs-bench-flash.bin", 0);
+  pwjs_flash_init();
+  storage_clear();
+  for (int i = 0; i < KEY_COUNT; i++) {
+    snprintf(keys[i], sizeof(keys[i]), "key-%d", i);
+    storage_set_item(keys[i], "value");
+  }
+  for (int i = 0; i < KEY_COUNT; i += 2) {
+    storage_set_item(keys[i], "value-updated");
+  }
+}
+
+static void storage_teardown() { storage_clear(); }
+
+/* lookup of every key */
+static void find_run() {
+  for (int i = 0; i < KEY_COUNT; i++) {
+    pwjs_bench_sink += storage_get_value_length(keys[i]);
+  }
+}
+
+/* lookup of a missing key */
+static void find_miss_run() {
+  pwjs_bench_sink += storage_get_value_length("missing-key");
+}
+
+/* key(i) for every index, as done when enumerating the storage */
+static void key_by_index_run() {
+  for (int i = 0; i < KEY_COUNT; i++) {
+    pwjs_bench_sink += storage_get_key_length(i);
+  }
+}
+
+static void count_run() { pwjs_bench_sink += storage_get_item_count(); }
+
+/* update keys round-robin, includes the incremental sector collection */
+static void set_run() {
+  static int i = 0;
+  pwjs_bench_sink += storage_set_item(keys[i], "value-set");
+  i = (i + 1) % KEY_COUNT;
+}
+
+/* update BATCH_COUNT keys in a single batch */
+#define BATCH_COUNT 16
+
+static void batch_run() {
+  static int i = 0;
+  storage_batch_op_t ops[BATCH_COUNT];
+  for (int j = 0; j < BATCH_COUNT; j++) {
+    ops[j].key = keys[(i + j) % KEY_COUNT];
+    ops[j].value = (const uint8_t *)"value-batch";
+    ops[j].length = 11;
+    ops[j].bytes = false;
+  }
+  pwjs_bench_sink += storage_write_batch(ops, BATCH_COUNT);
+  i = (i + BATCH_COUNT) % KEY_COUNT;
+}
+
+/**
+ * Fill the storage with one-slot items until it is full
+ */
+static void storage_full_setup() {
+  char value[200];
+  setenv("PICOWJS_FLASH", "/tmp/picowjs-bench-flash.bin", 0);
+  pwjs_flash_init();
+  storage_clear();
+  memset(value, 'v', sizeof(value) - 1);
+  value[sizeof(value) - 1] = '\0';
+  for (int i = 0;; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "key-%d", i);
+    if (storage_set_item(key, value) < 0) {
+      break;
+    }
+  }
+}
+
+/* recovery pass on boot: check every record and build the index */
+static void mount_run() { storage_mount(); }
+
+static const pwjs_bench_t bench_storage_cases[] = {
+    {"storage.find", KEY_COUNT, storage_setup, find_run, storage_teardown},
+    {"storage.find-miss", 1, storage_setup, find_miss_run, storage_teardown},
+    {"storage.key-by-index", KEY_COUNT, storage_setup, key_by_index_run,
+     storage_teardown},
+    {"storage.count", 1, storage_setup, count_run, storage_teardown},
+    {"storage.set", 1, storage_setup, set_run, storage_teardown},
+    {"storage.batch", 1, storage_setup, batch_run, storage_teardown},
+    {"storage.mount", 1, storage_full_setup, mount_run, storage_teardown},
+};
+
+PWJS_BENCH_GROUP(bench_storage);
@@ -0,0 +1,244 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define DEFAULT_WARMUP 3
+#define DEFAULT_REPS 15
+#define DEFAULT_MIN_TIME_US 2000
+#define MAX_REPS 1000
+
+volatile uint32_t pwjs_bench_sink = 0;
+
+static const pwjs_bench_group_t *groups[] = {
+    &bench_core,
+    &bench_graphics,
+    &bench_url,
+    &bench_storage,
+    &bench_flash,
+    &bench_fat,
+};
+
+#define GROUP_COUNT (sizeof(groups) / sizeof(groups[0]))
+
+typedef struct {
+  int warmup;
+  int reps;
+  uint64_t min_time_ns;
+  bool json;
+  bool list;
+  int filter_count;
+  char **filters;
+} bench_options_t;
+
+typedef struct {
+  uint32_t iters;  // run() calls per repetition
+  uint64_t min_ns;
+  uint64_t median_ns;
+} bench_result_t;
+
+void pwjs_bench_fill(uint8_t *buf, size_t len, uint32_t seed) {
+  uint32_t x = seed ? seed : 0x12345678;
+  for (size_t i = 0; i < len; i++) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    buf[i] = (uint8_t)x;
+  }
+}
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t time_iters(const pwjs_bench_t *bench, uint32_t iters) {
+  uint64_t start = now_ns();
+  for (uint32_t i = 0; i < iters; i++) {
+    bench->run();
+  }
+  return now_ns() - start;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Match a benchmark name against the filters: exact name, or a prefix
+ * ending at a '.' boundary (e.g. "gc" or "gc.1bit" matches "gc.1bit.line").
+ */
+static bool is_selected(const bench_options_t *opts, const char *name) {
+  if (opts->filter_count == 0) {
+    return true;
+  }
+  for (int i = 0; i < opts->filter_count; i++) {
+    size_t len = strlen(opts->filters[i]);
+    if (strncmp(name, opts->filters[i], len) == 0 &&
+        (name[len] == '\0' || name[len] == '.')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void run_bench(const bench_options_t *opts, const pwjs_bench_t *bench,
+                      bench_result_t *result) {
+  uint64_t samples[MAX_REPS];
+  if (bench->setup) bench->setup();
+  // calibrate: grow the iteration count until a repetition is long enough
+  // to be measured reliably, then warm up with that count.
+  uint32_t iters = 1;
+  while (time_iters(bench, iters) < opts->min_time_ns && iters < (1u << 30)) {
+    iters *= 2;
+  }
+  for (int i = 0; i < opts->warmup; i++) {
+    time_iters(bench, iters);
+  }
+  for (int i = 0; i < opts->reps; i++) {
+    samples[i] = time_iters(bench, iters);
+  }
+  if (bench->teardown) bench->teardown();
+  qsort(samples, opts->reps, sizeof(uint64_t), compare_u64);
+  result->iters = iters;
+  result->min_ns = samples[0];
+  result->median_ns = samples[opts->reps / 2];
+}
+
+static double per_op(const pwjs_bench_t *bench, const bench_result_t *result,
+                     uint64_t ns) {
+  return (double)ns / ((double)result->iters * bench->ops);
+}
+
+static void print_usage(const char *prog) {
+  printf("Usage: %s [options] [name ...]\n", prog);
+  printf("  --list          list benchmark names\n");
+  printf("  --json          print results as JSON\n");
+  printf("  --warmup <n>    warmup repetitions (default: %d)\n",
+         DEFAULT_WARMUP);
+  printf("  --reps <n>      measured repetitions (default: %d)\n",
+         DEFAULT_REPS);
+  printf("  --min-time <us> minimum time of a repetition (default: %d)\n",
+         DEFAULT_MIN_TIME_US);
+  printf("  name            run only the benchmark or group (e.g. gc.1bit)\n");
+}
+
+static int parse_options(int argc, char **argv, bench_options_t *opts) {
+  opts->warmup = DEFAULT_WARMUP;
+  opts->reps = DEFAULT_REPS;
+  opts->min_time_ns = DEFAULT_MIN_TIME_US * 1000ULL;
+  opts->json = false;
+  opts->list = false;
+  opts->filter_count = 0;
+  opts->filters = argv;
+  for (int i = 1; i < argc; i++) {
+    bool has_value = (i + 1 < argc);
+    if (strcmp(argv[i], "--list") == 0) {
+      opts->list = true;
+    } else if (strcmp(argv[i], "--json") == 0) {
+      opts->json = true;
+    } else if (strcmp(argv[i], "--warmup") == 0 && has_value) {
+      opts->warmup = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--reps") == 0 && has_value) {
+      opts->reps = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--min-time") == 0 && has_value) {
+      opts->min_time_ns = strtoull(argv[++i], NULL, 10) * 1000ULL;
+    } else if (argv[i][0] == '-') {
+      print_usage(argv[0]);
+      return -1;
+    } else {
+      opts->filters[opts->filter_count++] = argv[i];
+    }
+  }
+  if (opts->warmup < 0 || opts->reps < 1 || opts->reps > MAX_REPS) {
+    fprintf(stderr, "reps must be 1..%d and warmup >= 0\n", MAX_REPS);
+    return -1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  bench_options_t opts;
+  if (parse_options(argc, argv, &opts) < 0) {
+    return 1;
+  }
+  if (opts.list) {
+    for (size_t g = 0; g < GROUP_COUNT; g++) {
+      for (size_t i = 0; i < groups[g]->count; i++) {
+        printf("%s\n", groups[g]->cases[i].name);
+      }
+    }
+    return 0;
+  }
+  int matched = 0;
+  if (opts.json) {
+    printf("{\"warmup\":%d,\"reps\":%d,\"benchmarks\":[", opts.warmup,
+           opts.reps);
+  }
+  for (size_t g = 0; g < GROUP_COUNT; g++) {
+    for (size_t i = 0; i < groups[g]->count; i++) {
+      const pwjs_bench_t *bench = &groups[g]->cases[i];
+      if (!is_selected(&opts, bench->name)) {
+        continue;
+      }
+      bench_result_t result;
+      run_bench(&opts, bench, &result);
+      if (opts.json) {
+        printf("%s\n{\"name\":\"%s\",\"ops\":%u,\"iters\":%u,"
+               "\"min_ns\":%llu,\"median_ns\":%llu,"
+               "\"min_ns_per_op\":%.3f,\"median_ns_per_op\":%.3f}",
+               matched ? "," : "", bench->name, bench->ops, result.iters,
+               (unsigned long long)result.min_ns,
+               (unsigned long long)result.median_ns,
+               per_op(bench, &result, result.min_ns),
+               per_op(bench, &result, result.median_ns));
+      } else {
+        if (matched == 0) {
+          printf("%-28s %10s %12s %12s %14s\n", "name", "iters", "min(ns)",
+                 "median(ns)", "median/op(ns)");
+        }
+        printf("%-28s %10u %12llu %12llu %14.3f\n", bench->name, result.iters,
+               (unsigned long long)result.min_ns,
+               (unsigned long long)result.median_ns,
+               per_op(bench, &result, result.median_ns));
+      }
+      fflush(stdout);
+      matched++;
+    }
+  }
+  if (opts.json) {
+    printf("\n]}\n");
+  }
+  if (matched == 0) {
+    fprintf(stderr, "no benchmark matched, see --list\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Run the JS workload suite and collect machine-readable results
+
+const fs = require('node:fs');
+const os = require('node:os');
+const path = require('node:path');
+const minimist = require('minimist');
+const childProcess = require('node:child_process');
+
+// Parse options
+//   --bin <path>     picowjs executable (default: build/picowjs-linux-host-*)
+//   --filter <text>  run only workloads whose name contains <text>
+//   --out <file>     write the JSON result to <file> instead of stdout
+//   --emit <file>    only write the bundled program (e.g. to upload to a board)
+//   --timeout <ms>   kill the run after <ms> milliseconds (default: 120000)
+var argv = minimist(process.argv.slice(2));
+
+const rootPath = path.join(__dirname, '..');
+const workloadsPath = path.join(__dirname, 'workloads');
+
+main();
+
+function main() {
+  const program = bundle(argv.filter);
+  if (argv.emit) {
+    fs.writeFileSync(argv.emit, program);
+    return;
+  }
+  const bin = argv.bin ? argv.bin : findHostBinary();
+  if (!bin) {
+    console.error('picowjs host executable not found, build with:');
+    console.error('  node build.js --target=linux');
+    process.exit(1);
+  }
+  const tmpPath = fs.mkdtempSync(path.join(os.tmpdir(), 'picowjs-bench-'));
+  const programFile = path.join(tmpPath, 'bench.js');
+  fs.writeFileSync(programFile, program);
+  const ret = childProcess.spawnSync(bin, [programFile], {
+    encoding: 'utf8',
+    timeout: argv.timeout ? Number(argv.timeout) : 120000,
+    env: Object.assign({}, process.env, {
+      // run against a scratch flash image so storage workloads start clean
+      PICOWJS_FLASH: path.join(tmpPath, 'flash.bin'),
+    }),
+  });
+  fs.rmSync(tmpPath, { recursive: true, force: true });
+  const line = (ret.stdout || '')
+    .split(/\r?\n/)
+    .find((l) => l.startsWith('BENCH_JSON '));
+  if (!line) {
+    process.stderr.write(ret.stdout || '');
+    process.stderr.write(ret.stderr || '');
+    console.error('benchmark did not report results');
+    process.exit(1);
+  }
+  const report = JSON.parse(line.substr('BENCH_JSON '.length));
+  report.bin = path.basename(bin);
+  report.date = new Date().toISOString();
+  const json = JSON.stringify(report, null, 2);
+  if (argv.out) {
+    fs.writeFileSync(argv.out, json + '\n');
+  } else {
+    console.log(json);
+  }
+}
+
+function bundle(filter) {
+  let code = fs.readFileSync(path.join(__dirname, 'harness.js'), 'utf8');
+  const files = fs
+    .readdirSync(workloadsPath)
+    .filter((f) => f.endsWith('.js'))
+    .sort();
+  for (const file of files) {
+    code += `\n// ${file}\n`;
+    code += fs.readFileSync(path.join(workloadsPath, file), 'utf8');
+  }
+  code += `\n__bench.filter = ${JSON.stringify(filter ? String(filter) : null)};\n`;
+  code += '__benchRun(0);\n';
+  return code;
+}
+
+function findHostBinary() {
+  const buildPath = path.join(rootPath, 'build');
+  if (!fs.existsSync(buildPath)) return null;
+  const found = fs
+    .readdirSync(buildPath)
+    .filter((f) => f.startsWith('picowjs-linux-host-'));
+  return found.length > 0 ? path.join(buildPath, found[0]) : null;
+}
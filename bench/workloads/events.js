@@ -0,0 +1,39 @@
+/**
+ * EventEmitter fan-out: one emit delivered to several listeners.
+ */
+
+bench(
+  'events.emit-fanout',
+  {
+    iterations: 2000,
+    setup: function () {
+      var EventEmitter = require('events').EventEmitter;
+      var emitter = new EventEmitter();
+      var ctx = { emitter: emitter, sum: 0 };
+      for (var i = 0; i < 8; i++) {
+        emitter.on('data', function (v) {
+          ctx.sum += v;
+        });
+      }
+      return ctx;
+    },
+  },
+  function (ctx, i) {
+    ctx.emitter.emit('data', i);
+  }
+);
+
+bench(
+  'events.on-off',
+  {
+    iterations: 1000,
+    setup: function () {
+      var EventEmitter = require('events').EventEmitter;
+      return { emitter: new EventEmitter(), listener: function () {} };
+    },
+  },
+  function (ctx) {
+    ctx.emitter.on('tick', ctx.listener);
+    ctx.emitter.removeListener('tick', ctx.listener);
+  }
+);
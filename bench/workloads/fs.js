@@ -0,0 +1,88 @@
+/**
+ * File system overhead on a RAM block device, which has no device latency,
+ * so the time is spent in the VFS and littlefs only.
+ */
+
+function __fsRamdiskSetup() {
+  var fs = require('fs');
+  var RamBlockDev = require('ramblkdev').RamBlockDev;
+  fs.mount('/bench-ram', new RamBlockDev(128, 512), 'lfs', true);
+  var data = new Uint8Array(1024);
+  for (var i = 0; i < data.length; i++) data[i] = i & 0xff;
+  return { fs: fs, data: data, buffer: new Uint8Array(1024) };
+}
+
+function __fsRamdiskTeardown(ctx) {
+  ctx.fs.unmount('/bench-ram');
+}
+
+bench(
+  'fs.ramdisk-writeFile',
+  {
+    iterations: 200,
+    setup: __fsRamdiskSetup,
+    teardown: __fsRamdiskTeardown,
+  },
+  function (ctx, i) {
+    ctx.fs.writeFile('/bench-ram/file-' + (i % 8), ctx.data);
+  }
+);
+
+bench(
+  'fs.ramdisk-readFile',
+  {
+    iterations: 500,
+    setup: function () {
+      var ctx = __fsRamdiskSetup();
+      for (var i = 0; i < 8; i++) {
+        ctx.fs.writeFile('/bench-ram/file-' + i, ctx.data);
+      }
+      return ctx;
+    },
+    teardown: __fsRamdiskTeardown,
+  },
+  function (ctx, i) {
+    ctx.fs.readFile('/bench-ram/file-' + (i % 8), { buffer: ctx.buffer });
+  }
+);
+
+function __fsAssetsSetup() {
+  var fs = require('fs');
+  var RamBlockDev = require('ramblkdev').RamBlockDev;
+  fs.register('assets', require('vfs_assets').VFSAssets);
+  fs.mount('/bench-assets', new RamBlockDev(64, 512), 'assets', true);
+  var data = new Uint8Array(16384);
+  for (var i = 0; i < data.length; i++) data[i] = i & 0xff;
+  if (!fs.exists('/bench-assets/asset')) {
+    fs.writeFile('/bench-assets/asset', data);
+  }
+  return { fs: fs };
+}
+
+function __fsAssetsTeardown(ctx) {
+  ctx.fs.unmount('/bench-assets');
+}
+
+bench(
+  'fs.assets-readFile',
+  {
+    iterations: 200,
+    setup: __fsAssetsSetup,
+    teardown: __fsAssetsTeardown,
+  },
+  function (ctx) {
+    ctx.fs.readFile('/bench-assets/asset');
+  }
+);
+
+bench(
+  'fs.assets-mmap',
+  {
+    iterations: 200,
+    setup: __fsAssetsSetup,
+    teardown: __fsAssetsTeardown,
+  },
+  function (ctx) {
+    ctx.fs.mmap('/bench-assets/asset');
+  }
+);
@@ -0,0 +1,60 @@
+/**
+ * GraphicsContext draw calls, both on the native frame buffer and through
+ * JS pixel callbacks.
+ */
+
+function __graphicsScene(gc, i) {
+  gc.clearScreen();
+  gc.drawLine(0, 0, 127, 63);
+  gc.drawRect(4, 4, 40, 20);
+  gc.fillRect(60, 10, 30, 30);
+  gc.drawCircle(100, 32, 20);
+  gc.drawText(2, 50, 'Frame ' + i);
+}
+
+bench(
+  'graphics.buffered-1bit',
+  {
+    iterations: 200,
+    setup: function () {
+      var BufferedGraphicsContext = require('graphics').BufferedGraphicsContext;
+      return new BufferedGraphicsContext(128, 64, { bpp: 1 });
+    },
+  },
+  __graphicsScene
+);
+
+bench(
+  'graphics.buffered-16bit',
+  {
+    iterations: 100,
+    setup: function () {
+      var BufferedGraphicsContext = require('graphics').BufferedGraphicsContext;
+      return new BufferedGraphicsContext(128, 64, { bpp: 16 });
+    },
+  },
+  __graphicsScene
+);
+
+bench(
+  'graphics.callback',
+  {
+    iterations: 50,
+    setup: function () {
+      var GraphicsContext = require('graphics').GraphicsContext;
+      var fb = new Uint8Array(128 * 64);
+      return new GraphicsContext(128, 64, {
+        setPixel: function (x, y, c) {
+          fb[y * 128 + x] = c;
+        },
+        getPixel: function (x, y) {
+          return fb[y * 128 + x];
+        },
+        fillRect: function (x, y, w, h, c) {
+          for (var j = y; j < y + h; j++) fb.fill(c, j * 128 + x, j * 128 + x + w);
+        },
+      });
+    },
+  },
+  __graphicsScene
+);
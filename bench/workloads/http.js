@@ -0,0 +1,46 @@
+/**
+ * HTTP request parse and response serialize through `http.js`, using an
+ * in-memory socket so no network stack is involved.
+ */
+
+var __httpRequest =
+  'GET /api/sensors?id=42 HTTP/1.1\r\n' +
+  'Host: 192.168.0.10\r\n' +
+  'User-Agent: bench/1.0\r\n' +
+  'Accept: application/json\r\n' +
+  'Connection: close\r\n' +
+  '\r\n';
+
+bench(
+  'http.parse-serialize',
+  {
+    iterations: 300,
+    setup: function () {
+      var http = require('http');
+      var EventEmitter = require('events').EventEmitter;
+      var ctx = { bytes: 0 };
+      ctx.Socket = class extends EventEmitter {
+        write(data, cb) {
+          ctx.bytes += data.length;
+          if (cb) cb();
+        }
+        end(cb) {
+          if (cb) cb();
+        }
+        destroy(cb) {
+          if (cb) cb();
+        }
+      };
+      ctx.server = http.createServer(function (req, res) {
+        res.writeHead(200, 'OK', { 'Content-Type': 'application/json' });
+        res.end('{"id":42,"value":23.5}');
+      });
+      return ctx;
+    },
+  },
+  function (ctx) {
+    var socket = new ctx.Socket();
+    ctx.server.emit('connection', socket);
+    socket.emit('data', __httpRequest);
+  }
+);
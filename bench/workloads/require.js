@@ -0,0 +1,15 @@
+/**
+ * require cold-start: evaluate builtin modules from their snapshots without
+ * hitting the module cache, the same way `Module.prototype.loadBuiltin` does.
+ */
+
+var __requireModules = ['stream', 'http', 'graphics', 'storage', 'url'];
+
+bench('require.cold-start', { iterations: 20 }, function (ctx, i) {
+  for (var k = 0; k < __requireModules.length; k++) {
+    var id = __requireModules[k];
+    if (process.builtin_modules.indexOf(id) < 0) continue;
+    var mod = { id: id, exports: {} };
+    process.getBuiltinModule(id)(mod.exports, require, mod);
+  }
+});
@@ -0,0 +1,44 @@
+/**
+ * storage.setItem churn over a small working set of keys, which exercises
+ * the index lookup, appends to the log and the incremental collection of
+ * the sectors holding the superseded values.
+ */
+
+bench(
+  'storage.setItem-churn',
+  {
+    iterations: 500,
+    setup: function () {
+      var storage = require('storage');
+      storage.clear();
+      var value = '';
+      for (var i = 0; i < 32; i++) value += String.fromCharCode(0x61 + (i % 26));
+      return { storage: storage, value: value };
+    },
+    teardown: function (ctx) {
+      ctx.storage.clear();
+    },
+  },
+  function (ctx, i) {
+    ctx.storage.setItem('bench-' + (i % 32), ctx.value + i);
+  }
+);
+
+bench(
+  'storage.getItem',
+  {
+    iterations: 1000,
+    setup: function () {
+      var storage = require('storage');
+      storage.clear();
+      for (var i = 0; i < 32; i++) storage.setItem('bench-' + i, 'value-' + i);
+      return { storage: storage };
+    },
+    teardown: function (ctx) {
+      ctx.storage.clear();
+    },
+  },
+  function (ctx, i) {
+    ctx.storage.getItem('bench-' + (i % 32));
+  }
+);
@@ -0,0 +1,42 @@
+/**
+ * stream.Writable throughput: small chunks written into a sink that
+ * completes synchronously. Latency is the time from write() to the sink.
+ */
+
+bench('stream.writable-throughput', { async: true }, function (b) {
+  var Writable = require('stream').Writable;
+  var chunk = '';
+  for (var i = 0; i < 64; i++) chunk += String.fromCharCode(0x41 + (i % 26));
+  var count = 300;
+  var bytes = 0;
+  var written = 0;
+  var last = 0;
+
+  class Sink extends Writable {
+    _write(data, cb) {
+      b.sample(micros() - last);
+      bytes += data.length;
+      cb();
+    }
+    _final(cb) {
+      cb();
+    }
+  }
+
+  var sink = new Sink();
+  sink.on('error', b.fail);
+  sink.on('finish', function () {
+    b.done(count);
+  });
+  var pump = function () {
+    last = micros();
+    sink.write(chunk);
+    written++;
+    if (written < count) {
+      setTimeout(pump, 0);
+    } else {
+      sink.end();
+    }
+  };
+  pump();
+});
@@ -0,0 +1,31 @@
+/**
+ * TextEncoder / TextDecoder and base64 (btoa/atob) on short payloads.
+ */
+
+var __textPayload = 'temperature=23.5&humidity=41&pressure=1013.2&id=pico';
+
+bench(
+  'text.encode-decode',
+  {
+    iterations: 1000,
+    setup: function () {
+      return { encoder: new TextEncoder(), decoder: new TextDecoder() };
+    },
+  },
+  function (ctx) {
+    ctx.decoder.decode(ctx.encoder.encode(__textPayload));
+  }
+);
+
+bench(
+  'text.btoa-atob',
+  {
+    iterations: 1000,
+    setup: function () {
+      return { data: new TextEncoder().encode(__textPayload) };
+    },
+  },
+  function (ctx) {
+    atob(btoa(ctx.data));
+  }
+);
@@ -0,0 +1,34 @@
+/**
+ * Timer storms: many zero-delay timeouts scheduled at once, and a fast
+ * interval. Latency is the lateness of each callback against its due time.
+ */
+
+bench('timers.timeout-storm', { async: true }, function (b) {
+  var count = 500;
+  var fired = 0;
+  for (var i = 0; i < count; i++) {
+    (function (due) {
+      setTimeout(function () {
+        b.sample(micros() - due);
+        fired++;
+        if (fired === count) b.done(count);
+      }, 0);
+    })(micros());
+  }
+});
+
+bench('timers.interval', { async: true }, function (b) {
+  var ticks = 100;
+  var fired = 0;
+  var prev = micros();
+  var id = setInterval(function () {
+    var now = micros();
+    b.sample(now - prev);
+    prev = now;
+    fired++;
+    if (fired === ticks) {
+      clearInterval(id);
+      b.done(ticks);
+    }
+  }, 1);
+});
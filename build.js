@@ -10,8 +10,14 @@ const childProcess = require('node:child_process');
 var argv = minimist(process.argv.slice(2));
 
 
+// default board of each target
+const defaultBoards = {
+  rp2: "pico-w",
+  linux: "host",
+};
+
 argv.target = argv.target ? argv.target : "rp2"
-argv.board = argv.board ? argv.board : "pico-w"
+argv.board = argv.board ? argv.board : defaultBoards[argv.target]
 
 const buildPath = path.join(__dirname, "build");
 const srcGenPath = path.join(__dirname, "src/gen");
@@ -0,0 +1,117 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_BLKCACHE_H
+#define __PWJS_BLKCACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * LRU block cache shared by all mounted file systems. The devices are cached
+ * in lines of PWJS_BLKCACHE_LINE_SIZE bytes, so a device is only cached if
+ * its block size is a multiple of it. Requests of a quarter of the cache or
+ * more go to the device for the lines not in the cache, so that reading or
+ * writing a large file does not evict the metadata blocks.
+ */
+#define PWJS_BLKCACHE_LINE_SIZE 512
+#define PWJS_BLKCACHE_DEFAULT_SIZE 8192
+
+typedef enum {
+  PWJS_BLKCACHE_NONE = 0,
+  PWJS_BLKCACHE_WRITE_THROUGH,  // writes go to the device and the cache
+  PWJS_BLKCACHE_WRITE_BACK,     // writes stay in the cache until a flush
+} pwjs_blkcache_mode_t;
+
+typedef struct pwjs_blkcache_dev_s pwjs_blkcache_dev_t;
+
+/**
+ * A cached device, embedded in the handle of a mounted file system. read()
+ * and write() access the device and return 0 or a negative errno.
+ */
+struct pwjs_blkcache_dev_s {
+  int (*read)(pwjs_blkcache_dev_t *dev, uint32_t block, uint32_t offset,
+              uint8_t *buffer, size_t size);
+  int (*write)(pwjs_blkcache_dev_t *dev, uint32_t block, uint32_t offset,
+               const uint8_t *buffer, size_t size);
+  void *owner;  // for the callbacks
+  uint32_t block_size;
+  pwjs_blkcache_mode_t mode;
+};
+
+typedef struct {
+  uint32_t size;        // cache size in bytes
+  uint32_t used;        // lines holding a block
+  uint32_t dirty;       // lines not written back
+  uint32_t hits;        // lines found in the cache
+  uint32_t misses;      // lines read from the device into the cache
+  uint32_t evictions;   // lines reused for another block
+  uint32_t writebacks;  // dirty lines written to the device
+} pwjs_blkcache_stats_t;
+
+/**
+ * Get the mode named 'none', 'writethrough' or 'writeback', or EINVAL
+ */
+int pwjs_blkcache_parse_mode(const char *name);
+
+/**
+ * Set the cache size in bytes (0 to disable the cache). The dirty lines are
+ * written back and all the lines are dropped. The memory is allocated on
+ * the first access of a cached device.
+ */
+int pwjs_blkcache_configure(uint32_t size);
+
+/**
+ * Read or write a device through the cache. The arguments are the same as
+ * for the callbacks of the device.
+ */
+int pwjs_blkcache_read(pwjs_blkcache_dev_t *dev, uint32_t block,
+                       uint32_t offset, uint8_t *buffer, size_t size);
+int pwjs_blkcache_write(pwjs_blkcache_dev_t *dev, uint32_t block,
+                        uint32_t offset, const uint8_t *buffer, size_t size);
+
+/**
+ * Write back the dirty lines of a device, or of all devices if dev is NULL
+ */
+int pwjs_blkcache_flush(pwjs_blkcache_dev_t *dev);
+
+/**
+ * Drop the lines of a block, dirty or not (e.g. when the block is erased)
+ */
+void pwjs_blkcache_invalidate(pwjs_blkcache_dev_t *dev, uint32_t block);
+
+/**
+ * Drop all the lines of a device without writing them back. To be called
+ * before the device goes away, after a flush if the data must be kept.
+ */
+void pwjs_blkcache_release(pwjs_blkcache_dev_t *dev);
+
+/**
+ * Write back the dirty lines, release the cache memory and restore the
+ * default size
+ */
+void pwjs_blkcache_cleanup();
+
+void pwjs_blkcache_get_stats(pwjs_blkcache_stats_t *stats);
+void pwjs_blkcache_reset_stats();
+
+#endif /* __PWJS_BLKCACHE_H */
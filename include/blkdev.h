@@ -0,0 +1,73 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_BLKDEV_H
+#define __PWJS_BLKDEV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "jerryscript.h"
+
+/**
+ * Block device operations (same as the ioctl() of JS block devices)
+ */
+#define PWJS_BLKDEV_INIT 1
+#define PWJS_BLKDEV_SHUTDOWN 2
+#define PWJS_BLKDEV_SYNC 3
+#define PWJS_BLKDEV_BLOCK_COUNT 4
+#define PWJS_BLKDEV_BLOCK_SIZE 5
+#define PWJS_BLKDEV_ERASE 6
+#define PWJS_BLKDEV_BUFFER_SIZE 7
+
+typedef struct pwjs_blkdev_s pwjs_blkdev_t;
+
+/**
+ * Native side of a built-in block device (e.g. Flash, SDCard). The file
+ * systems call it directly instead of the read(), write() and ioctl()
+ * methods of the JS object. read() and write() may span several blocks.
+ * The functions return 0 (or the ioctl() result) or a negative errno.
+ * The struct is the first member of the device's own native handle.
+ */
+struct pwjs_blkdev_s {
+  int (*read)(pwjs_blkdev_t *blkdev, uint32_t block, uint32_t offset,
+              uint8_t *buffer, size_t size);
+  int (*write)(pwjs_blkdev_t *blkdev, uint32_t block, uint32_t offset,
+               const uint8_t *buffer, size_t size);
+  int (*ioctl)(pwjs_blkdev_t *blkdev, int op, int arg);
+  void (*free)(pwjs_blkdev_t *blkdev);  // NULL if not allocated
+  // address of the blocks when they are memory-mapped and contiguous, with
+  // the pending writes done, or NULL. NULL if the device is never mapped.
+  const uint8_t *(*map)(pwjs_blkdev_t *blkdev);
+};
+
+/**
+ * Bind a native block device to its JS object
+ */
+void pwjs_blkdev_bind(jerry_value_t obj, pwjs_blkdev_t *blkdev);
+
+/**
+ * Get the native block device of a JS object, or NULL for a block device
+ * implemented in JS
+ */
+pwjs_blkdev_t *pwjs_blkdev_get(jerry_value_t obj);
+
+#endif /* __PWJS_BLKDEV_H */
@@ -0,0 +1,68 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_FLASH_CACHE_H
+#define __PWJS_FLASH_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Write-back page cache over pwjs_flash_program(). The pages programmed in
+ * one sector are kept in RAM, a page programmed again is merged into its
+ * cached copy (ANDed, as programming only clears bits), and the dirty pages
+ * are written back in runs of contiguous pages: on sync, or when a program
+ * goes to another sector. Reads see the cached pages. Arguments are the
+ * same as for pwjs_flash_program() and pwjs_flash_erase().
+ */
+typedef struct {
+  uint32_t requested;  // pages programmed by the callers
+  uint32_t merged;     // pages merged into an already dirty page
+  uint32_t dropped;    // dirty pages discarded by an erase of their sector
+  uint32_t programs;   // pwjs_flash_program() calls issued
+  uint32_t pages;      // pages written by these calls
+  uint32_t syncs;      // write-backs of dirty pages
+} pwjs_flash_cache_stats_t;
+
+int pwjs_flash_cache_program(uint32_t sector, uint32_t offset,
+                             const uint8_t *buffer, size_t size);
+int pwjs_flash_cache_erase(uint32_t sector, size_t count);
+
+/**
+ * Read from flash at any offset, through the cached pages
+ */
+int pwjs_flash_cache_read(uint32_t sector, uint32_t offset, uint8_t *buffer,
+                          size_t size);
+
+/**
+ * Write back the dirty pages
+ */
+int pwjs_flash_cache_sync();
+
+/**
+ * Write back the dirty pages and release the cache
+ */
+void pwjs_flash_cache_cleanup();
+
+void pwjs_flash_cache_get_stats(pwjs_flash_cache_stats_t *stats);
+void pwjs_flash_cache_reset_stats();
+
+#endif /* __PWJS_FLASH_CACHE_H */
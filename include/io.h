@@ -37,6 +37,7 @@ typedef struct pwjs_io_watch_handle_s pwjs_io_watch_handle_t;
 typedef struct pwjs_io_uart_handle_s pwjs_io_uart_handle_t;
 typedef struct pwjs_io_idle_handle_s pwjs_io_idle_handle_t;
 typedef struct pwjs_io_stream_handle_s pwjs_io_stream_handle_t;
+typedef struct pwjs_io_file_handle_s pwjs_io_file_handle_t;
 
 /* handle flags */
 
@@ -55,7 +56,8 @@ typedef enum pwjs_io_type {
   PWJS_IO_WATCH,
   PWJS_IO_UART,
   PWJS_IO_IDLE,
-  PWJS_IO_STREAM
+  PWJS_IO_STREAM,
+  PWJS_IO_FILE
 } pwjs_io_type_t;
 
 typedef void (*pwjs_io_close_cb)(pwjs_io_handle_t *);
@@ -150,6 +152,21 @@ struct pwjs_io_stream_handle_s {
   pwjs_io_stream_read_cb read_cb;
 };
 
+/* file handle type */
+
+typedef void (*pwjs_io_file_cb)(pwjs_io_file_handle_t *);
+
+/**
+ * A file transfer driven by the loop. file_cb is called once per loop
+ * iteration while the handle is active and should move a single chunk, so
+ * that a long transfer does not starve the other handles.
+ */
+struct pwjs_io_file_handle_s {
+  pwjs_io_handle_t base;
+  int fd;
+  pwjs_io_file_cb file_cb;
+};
+
 /* loop type */
 
 struct pwjs_io_loop_s {
@@ -161,6 +178,7 @@ struct pwjs_io_loop_s {
   pwjs_list_t uart_handles;
   pwjs_list_t idle_handles;
   pwjs_list_t stream_handles;
+  pwjs_list_t file_handles;
   pwjs_list_t closing_handles;
 };
 
@@ -233,4 +251,15 @@ void pwjs_io_stream_cleanup();
 // void pwjs_io_stream_push(pwjs_io_stream_handle_t *stream, uint8_t *buffer, size_t
 // size); // push to read buffer
 
+/* file functions */
+
+void pwjs_io_file_init(pwjs_io_file_handle_t *file);
+void pwjs_io_file_start(pwjs_io_file_handle_t *file, int fd,
+                        pwjs_io_file_cb file_cb);
+void pwjs_io_file_pause(pwjs_io_file_handle_t *file);
+void pwjs_io_file_resume(pwjs_io_file_handle_t *file);
+void pwjs_io_file_stop(pwjs_io_file_handle_t *file);
+pwjs_io_file_handle_t *pwjs_io_file_get_by_id(uint32_t id);
+void pwjs_io_file_cleanup();
+
 #endif /* ___PWJS_IO_H */
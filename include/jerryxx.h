@@ -238,6 +238,36 @@
   jerry_release_value(name##_p);                                          \
   jerry_release_value(name##_n);
 
+/**
+ * Pre-interned property keys. Each entry maps a key ID to the magic string
+ * it is created from, so the value is built once per runtime instead of on
+ * every property access.
+ */
+#define JERRYXX_KEYS(X)            \
+  X(PROTOTYPE, MSTR_PROTOTYPE)     \
+  X(CONSTRUCTOR, MSTR_CONSTRUCTOR) \
+  X(REQUIRE, MSTR_REQUIRE)         \
+  X(OBJECT, MSTR_OBJECT)           \
+  X(CREATE, MSTR_CREATE)           \
+  X(PUSH, MSTR_PUSH)               \
+  X(STACK, MSTR_STACK)             \
+  X(READ, MSTR_READ)               \
+  X(WRITE, MSTR_WRITE)             \
+  X(IOCTL, MSTR_IOCTL)             \
+  X(BASE, MSTR_BASE)               \
+  X(COUNT, MSTR_COUNT)             \
+  X(SIZE, MSTR_SIZE)               \
+  X(READ_CB, MSTR_READ_CB)
+
+#define JERRYXX_KEY_ENUM(id, str) JERRYXX_KEY_##id,
+typedef enum { JERRYXX_KEYS(JERRYXX_KEY_ENUM) JERRYXX_KEY_MAX } jerryxx_key_t;
+#undef JERRYXX_KEY_ENUM
+
+// interned key table (valid between jerryxx_keys_init and _cleanup)
+void jerryxx_keys_init();
+void jerryxx_keys_cleanup();
+jerry_value_t jerryxx_key(jerryxx_key_t key);
+
 // functions for setting property
 void jerryxx_set_property(jerry_value_t object, const char *name,
                           jerry_value_t value);
@@ -248,6 +278,11 @@ void jerryxx_set_property_string(jerry_value_t object, const char *name,
 void jerryxx_set_property_function(jerry_value_t object, const char *name,
                                    jerry_external_handler_t fn);
 
+void jerryxx_set_property_by_key(jerry_value_t object, jerryxx_key_t key,
+                                 jerry_value_t value);
+void jerryxx_set_property_number_by_key(jerry_value_t object,
+                                        jerryxx_key_t key, double value);
+
 // function for define own property
 void jerryxx_define_own_property(jerry_value_t object, const char *name,
                                  jerry_external_handler_t getter,
@@ -259,6 +294,11 @@ double jerryxx_get_property_number(jerry_value_t object, const char *name,
                                    double default_value);
 bool jerryxx_get_property_boolean(jerry_value_t object, const char *name,
                                   bool default_value);
+jerry_value_t jerryxx_get_property_by_key(jerry_value_t object,
+                                          jerryxx_key_t key);
+double jerryxx_get_property_number_by_key(jerry_value_t object,
+                                          jerryxx_key_t key,
+                                          double default_value);
 
 // array functions
 uint8_t *jerryxx_get_typedarray_buffer(jerry_value_t object);
@@ -280,6 +320,8 @@ jerry_size_t jerryxx_string_to_ascii_char_buffer(const jerry_value_t value,
 jerry_value_t jerryxx_call_require(const char *name);
 jerry_value_t jerryxx_call_method(jerry_value_t obj, char *name,
                                   jerry_value_t *args, int args_count);
+jerry_value_t jerryxx_call_method_by_key(jerry_value_t obj, jerryxx_key_t key,
+                                         jerry_value_t *args, int args_count);
 
 // class inheritance
 void jerryxx_inherit(jerry_value_t super_ctor, jerry_value_t sub_ctor);
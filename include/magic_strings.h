@@ -27,6 +27,15 @@
 #define MSTR_REQUIRE "require"
 #define MSTR_CREATE "create"
 
+/* interned property keys (see jerryxx_key_t) */
+#define MSTR_READ "read"
+#define MSTR_IOCTL "ioctl"
+#define MSTR_BASE "base"
+#define MSTR_COUNT "count"
+#define MSTR_SIZE "size"
+#define MSTR_PUSH "push"
+#define MSTR_STACK "stack"
+
 /* global */
 #define MSTR_GLOBAL "global"
 #define MSTR_HIGH "HIGH"
@@ -172,5 +181,12 @@
 #define MSTR_HEAP_TOTAL "heapTotal"
 #define MSTR_HEAP_PEAK "heapPeak"
 #define MSTR_HEAP_USED "heapUsed"
+#define MSTR_MEM_DETAILED "detailed"
+#define MSTR_MEM_NATIVE "native"
+#define MSTR_MEM_MODULES "modules"
+#define MSTR_MEM_CURRENT "current"
+#define MSTR_MEM_PEAK "peak"
+#define MSTR_MEM_COUNT "count"
+#define MSTR_MEM_ALLOCS "allocs"
 
 #endif /* __MAGIC_STRINGS_H */
@@ -0,0 +1,91 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_MEM_H
+#define __PWJS_MEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Owner of native allocations. Keep in sync with the names in mem.c.
+ */
+typedef enum {
+  PWJS_MEM_CORE = 0,
+  PWJS_MEM_TIMER,
+  PWJS_MEM_WATCH,
+  PWJS_MEM_REPL,
+  PWJS_MEM_PROG,
+  PWJS_MEM_SPI,
+  PWJS_MEM_I2C,
+  PWJS_MEM_UART,
+  PWJS_MEM_GRAPHICS,
+  PWJS_MEM_STORAGE,
+  PWJS_MEM_VFS_LFS,
+  PWJS_MEM_VFS_FAT,
+  PWJS_MEM_NET,
+  PWJS_MEM_FLASH,
+  PWJS_MEM_VFS,
+  PWJS_MEM_RAMBLKDEV,
+  PWJS_MEM_VFS_ASSETS,
+  PWJS_MEM_ID_COUNT
+} pwjs_mem_id_t;
+
+typedef struct {
+  uint32_t current;  // bytes currently allocated
+  uint32_t peak;     // highest value of current
+  uint32_t count;    // number of live allocations
+  uint32_t allocs;   // number of allocations made so far
+} pwjs_mem_stats_t;
+
+/**
+ * Allocate memory owned by a module. Memory allocated by the functions below
+ * must be released with pwjs_free().
+ */
+void *pwjs_malloc(pwjs_mem_id_t id, size_t size);
+void *pwjs_calloc(pwjs_mem_id_t id, size_t nmemb, size_t size);
+
+/**
+ * Resize memory allocated by pwjs_malloc(). The owner is kept.
+ */
+void *pwjs_realloc(void *ptr, size_t size);
+
+/**
+ * Release memory allocated by pwjs_malloc(). NULL is ignored.
+ */
+void pwjs_free(void *ptr);
+
+/**
+ * Return the name of a module ID (e.g. "spi").
+ */
+const char *pwjs_mem_name(pwjs_mem_id_t id);
+
+/**
+ * Get the statistics of a module.
+ */
+void pwjs_mem_get_stats(pwjs_mem_id_t id, pwjs_mem_stats_t *stats);
+
+/**
+ * Get the statistics of all native allocations.
+ */
+void pwjs_mem_get_total(pwjs_mem_stats_t *stats);
+
+#endif /* __PWJS_MEM_H */
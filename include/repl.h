@@ -26,6 +26,9 @@
 #include "jerryscript.h"
 #include "jerryxx.h"
 #include "utils.h"
+#include "ymodem.h"
+
+#define PWJS_REPL_ARGS_MAX 5  // tokens of a command, with its name
 
 typedef enum { PWJS_REPL_MODE_NORMAL, PWJS_REPL_MODE_ESCAPE } pwjs_repl_mode_t;
 
@@ -55,6 +58,8 @@ struct pwjs_repl_state_s {
   unsigned int history_size;
   unsigned int history_position;
   uint8_t ymodem_state;  // 0=stopped, 1=transfering
+  char *argv[PWJS_REPL_ARGS_MAX];  // tokens of the running command
+  unsigned int argc;
   pwjs_list_t commands;
 };
 
@@ -82,6 +87,14 @@ void pwjs_repl_pretty_print(uint8_t indent, uint8_t depth, jerry_value_t value);
 void pwjs_repl_println();
 
 void pwjs_repl_register_command(char *name, char *desc, pwjs_repl_command_cb cb);
+
+/**
+ * Receive files via YMODEM, with the REPL input stopped during the transfer
+ */
+pwjs_ymodem_status_t pwjs_repl_ymodem_receive(pwjs_ymodem_header_cb header_cb,
+                                              pwjs_ymodem_packet_cb packet_cb,
+                                              pwjs_ymodem_footer_cb footer_cb,
+                                              pwjs_ymodem_flush_cb flush_cb);
 void pwjs_repl_unregister_command(char *name);
 void pwjs_repl_clear_commands();
 
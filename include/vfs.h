@@ -0,0 +1,173 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_VFS_H
+#define __PWJS_VFS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "jerryscript.h"
+
+#define PWJS_VFS_PATH_MAX 256  // including the null terminator
+#define PWJS_VFS_NAME_MAX 255
+#define PWJS_VFS_MOUNT_MAX 4
+#define PWJS_VFS_FD_MAX 16
+#define PWJS_VFS_FD_BASE 3  // first descriptor number, after stdio
+
+/**
+ * File open flags
+ */
+#define PWJS_VFS_FLAG_READ 1
+#define PWJS_VFS_FLAG_WRITE 2
+#define PWJS_VFS_FLAG_CREATE 4
+#define PWJS_VFS_FLAG_APPEND 8
+#define PWJS_VFS_FLAG_EXCL 16
+#define PWJS_VFS_FLAG_TRUNC 32
+#define PWJS_VFS_FLAG_RANDOM 64  // hint: frequent seeks, e.g. FatFs fast seek
+
+/**
+ * File types
+ */
+#define PWJS_VFS_TYPE_FILE 1
+#define PWJS_VFS_TYPE_DIR 2
+
+typedef struct pwjs_vfs_s pwjs_vfs_t;
+typedef struct pwjs_vfs_ops_s pwjs_vfs_ops_t;
+
+typedef struct {
+  uint8_t type;
+  uint32_t size;   // 0 for directories
+  uint32_t mtime;  // seconds since 1970, 0 if unknown
+} pwjs_vfs_stat_t;
+
+typedef struct {
+  uint8_t type;
+  uint32_t size;   // 0 for directories
+  uint32_t mtime;  // seconds since 1970, 0 if unknown
+  char name[PWJS_VFS_NAME_MAX + 1];
+} pwjs_vfs_dirent_t;
+
+/**
+ * File system operations, one table per file system type. Paths are
+ * absolute in the file system (the mount path is removed). The functions
+ * return 0 (or a byte count for read() and write()) or a negative errno.
+ * readdir() returns 1 for an entry, 0 at the end, and skips "." and "..".
+ * mmap() is NULL for file systems which do not store files contiguously.
+ */
+struct pwjs_vfs_ops_s {
+  int (*open)(pwjs_vfs_t *vfs, const char *path, int flags, void **file);
+  int (*close)(pwjs_vfs_t *vfs, void *file);
+  int (*read)(pwjs_vfs_t *vfs, void *file, uint8_t *buffer, size_t size);
+  int (*write)(pwjs_vfs_t *vfs, void *file, const uint8_t *buffer,
+               size_t size);
+  int (*seek)(pwjs_vfs_t *vfs, void *file, uint32_t position);
+  int (*stat)(pwjs_vfs_t *vfs, const char *path, pwjs_vfs_stat_t *stat);
+  int (*opendir)(pwjs_vfs_t *vfs, const char *path, void **dir);
+  int (*readdir)(pwjs_vfs_t *vfs, void *dir, pwjs_vfs_dirent_t *entry);
+  int (*closedir)(pwjs_vfs_t *vfs, void *dir);
+  int (*mkdir)(pwjs_vfs_t *vfs, const char *path);
+  int (*unlink)(pwjs_vfs_t *vfs, const char *path);
+  int (*rename)(pwjs_vfs_t *vfs, const char *old_path, const char *new_path);
+  int (*rmdir)(pwjs_vfs_t *vfs, const char *path);
+  int (*mmap)(pwjs_vfs_t *vfs, const char *path, const uint8_t **addr,
+              uint32_t *size);
+  void (*free)(pwjs_vfs_t *vfs);  // release the native handle
+};
+
+/**
+ * Native side of a file system object (e.g. VFSLittleFS). The struct is
+ * the first member of the file system's own native handle.
+ */
+struct pwjs_vfs_s {
+  const pwjs_vfs_ops_t *ops;
+};
+
+/**
+ * Bind a native file system to its JS object
+ */
+void pwjs_vfs_bind(jerry_value_t obj, pwjs_vfs_t *vfs);
+
+/**
+ * Get the native file system of a JS object, or NULL
+ */
+pwjs_vfs_t *pwjs_vfs_get(jerry_value_t obj);
+
+/**
+ * Close all files and release the mounted file systems
+ */
+void pwjs_vfs_cleanup();
+
+/**
+ * Resolve a path against the current directory into an absolute path
+ * without ".", ".." and empty components. The buffer holds
+ * PWJS_VFS_PATH_MAX bytes.
+ */
+int pwjs_vfs_resolve(const char *path, char *resolved);
+
+/**
+ * Current directory
+ */
+const char *pwjs_vfs_getcwd();
+int pwjs_vfs_chdir(const char *path);
+
+/**
+ * Mount a file system object on a path. The object is kept alive until
+ * it is unmounted. pwjs_vfs_unmount() returns the object in `obj`, the
+ * caller releases it.
+ */
+int pwjs_vfs_mount(const char *path, jerry_value_t obj);
+int pwjs_vfs_unmount(const char *path, jerry_value_t *obj);
+
+/**
+ * File descriptors. A negative position reads or writes at the current
+ * position. open() returns the descriptor, read() and write() the number
+ * of bytes.
+ */
+int pwjs_vfs_open(const char *path, int flags);
+int pwjs_vfs_close(int fd);
+int pwjs_vfs_read(int fd, uint8_t *buffer, size_t size, int64_t position);
+int pwjs_vfs_write(int fd, const uint8_t *buffer, size_t size,
+                   int64_t position);
+
+/**
+ * Directory descriptors, closed with pwjs_vfs_closedir()
+ */
+int pwjs_vfs_opendir(const char *path);
+int pwjs_vfs_readdir(int fd, pwjs_vfs_dirent_t *entry);
+int pwjs_vfs_closedir(int fd);
+
+int pwjs_vfs_stat(const char *path, pwjs_vfs_stat_t *stat);
+int pwjs_vfs_mkdir(const char *path);
+int pwjs_vfs_unlink(const char *path);
+int pwjs_vfs_rename(const char *old_path, const char *new_path);
+int pwjs_vfs_rmdir(const char *path);
+
+/**
+ * Get the address and size of a file stored contiguously in memory-mapped
+ * storage. The memory is valid while the file system object returned in
+ * `obj` is alive (not acquired) and the file is not removed. Returns
+ * ENODEV if the file system or its device can't map files.
+ */
+int pwjs_vfs_mmap(const char *path, const uint8_t **addr, uint32_t *size,
+                  jerry_value_t *obj);
+
+#endif /* __PWJS_VFS_H */
@@ -17,8 +17,16 @@ typedef enum {
 typedef int (*pwjs_ymodem_header_cb)(uint8_t *file_name, size_t file_size);
 typedef int (*pwjs_ymodem_packet_cb)(uint8_t *data, size_t len);
 typedef void (*pwjs_ymodem_footer_cb)();
+/**
+ * Called after a data packet is acknowledged, while the sender transmits
+ * the next one: slow work such as writing the received data goes there.
+ * A negative return aborts the transfer.
+ */
+typedef int (*pwjs_ymodem_flush_cb)();
+uint16_t pwjs_ymodem_crc16(const uint8_t *data, uint32_t size);
 pwjs_ymodem_status_t pwjs_ymodem_receive(pwjs_ymodem_header_cb header_cb,
                                      pwjs_ymodem_packet_cb packet_cb,
-                                     pwjs_ymodem_footer_cb footer_cb);
+                                     pwjs_ymodem_footer_cb footer_cb,
+                                     pwjs_ymodem_flush_cb flush_cb);
 
 #endif /* __PWJS_YMODEM_H_ */
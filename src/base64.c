@@ -10,6 +10,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "mem.h"
+
 static const unsigned char base64_table[65] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
@@ -36,7 +38,7 @@ unsigned char *pwjs_base64_encode(const unsigned char *src, size_t len,
   olen += olen / 72;           /* line feeds */
   olen++;                      /* nul termination */
   if (olen < len) return NULL; /* integer overflow */
-  out = malloc(olen);
+  out = pwjs_malloc(PWJS_MEM_CORE, olen);
   if (out == NULL) return NULL;
 
   end = src + len;
@@ -105,7 +107,7 @@ unsigned char *pwjs_base64_decode(const unsigned char *src, size_t len,
   if (count == 0 || count % 4) return NULL;
 
   olen = count / 4 * 3;
-  pos = out = malloc(olen);
+  pos = out = pwjs_malloc(PWJS_MEM_CORE, olen);
   if (out == NULL) return NULL;
 
   count = 0;
@@ -128,7 +130,7 @@ unsigned char *pwjs_base64_decode(const unsigned char *src, size_t len,
           pos -= 2;
         else {
           /* Invalid padding */
-          free(out);
+          pwjs_free(out);
           return NULL;
         }
         break;
@@ -0,0 +1,445 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "blkcache.h"
+
+#include <string.h>
+
+#include "err.h"
+#include "mem.h"
+
+#define LINE_SIZE PWJS_BLKCACHE_LINE_SIZE
+#define NIL -1
+
+/**
+ * - dev : device of the cached line, NULL if free
+ * - line : device address / LINE_SIZE
+ * - prev, next : LRU list, the most recently used line first and the free
+ *   lines last
+ * - hash_next : next line in the same hash bucket
+ */
+typedef struct {
+  pwjs_blkcache_dev_t *dev;
+  uint32_t line;
+  int16_t prev;
+  int16_t next;
+  int16_t hash_next;
+  bool dirty;
+} blkcache_line_t;
+
+/**
+ * The lines, hash buckets and data are allocated in one block on the first
+ * access of a cached device. count is 0 until then.
+ */
+static struct {
+  uint32_t size;
+  uint16_t count;
+  int16_t head;
+  int16_t tail;
+  blkcache_line_t *lines;
+  int16_t *buckets;
+  uint8_t *data;
+} cache = {PWJS_BLKCACHE_DEFAULT_SIZE, 0, NIL, NIL, NULL, NULL, NULL};
+
+static pwjs_blkcache_stats_t stats;
+
+static bool blkcache_enabled(pwjs_blkcache_dev_t *dev) {
+  return dev->mode != PWJS_BLKCACHE_NONE && cache.size >= LINE_SIZE &&
+         dev->block_size > 0 && dev->block_size % LINE_SIZE == 0;
+}
+
+static int blkcache_alloc() {
+  if (cache.count > 0) {
+    return 0;
+  }
+  uint32_t count = cache.size / LINE_SIZE;
+  uint8_t *mem = pwjs_malloc(
+      PWJS_MEM_VFS,
+      count * (LINE_SIZE + sizeof(blkcache_line_t) + sizeof(int16_t)));
+  if (mem == NULL) {
+    return ENOMEM;
+  }
+  cache.data = mem;
+  cache.lines = (blkcache_line_t *)(mem + count * LINE_SIZE);
+  cache.buckets = (int16_t *)(cache.lines + count);
+  for (uint32_t i = 0; i < count; i++) {
+    cache.lines[i].dev = NULL;
+    cache.lines[i].line = 0;
+    cache.lines[i].prev = (int16_t)i - 1;
+    cache.lines[i].next = (i + 1 < count) ? (int16_t)(i + 1) : NIL;
+    cache.lines[i].hash_next = NIL;
+    cache.lines[i].dirty = false;
+    cache.buckets[i] = NIL;
+  }
+  cache.head = 0;
+  cache.tail = (int16_t)(count - 1);
+  cache.count = (uint16_t)count;
+  return 0;
+}
+
+static void blkcache_free() {
+  pwjs_free(cache.data);
+  cache.data = NULL;
+  cache.lines = NULL;
+  cache.buckets = NULL;
+  cache.count = 0;
+  cache.head = NIL;
+  cache.tail = NIL;
+}
+
+static uint8_t *blkcache_data(int16_t i) {
+  return cache.data + (uint32_t)i * LINE_SIZE;
+}
+
+/* LRU list */
+
+static void blkcache_unlink(int16_t i) {
+  blkcache_line_t *l = &cache.lines[i];
+  if (l->prev != NIL) {
+    cache.lines[l->prev].next = l->next;
+  } else {
+    cache.head = l->next;
+  }
+  if (l->next != NIL) {
+    cache.lines[l->next].prev = l->prev;
+  } else {
+    cache.tail = l->prev;
+  }
+}
+
+static void blkcache_push_front(int16_t i) {
+  blkcache_line_t *l = &cache.lines[i];
+  l->prev = NIL;
+  l->next = cache.head;
+  if (cache.head != NIL) {
+    cache.lines[cache.head].prev = i;
+  } else {
+    cache.tail = i;
+  }
+  cache.head = i;
+}
+
+static void blkcache_push_back(int16_t i) {
+  blkcache_line_t *l = &cache.lines[i];
+  l->next = NIL;
+  l->prev = cache.tail;
+  if (cache.tail != NIL) {
+    cache.lines[cache.tail].next = i;
+  } else {
+    cache.head = i;
+  }
+  cache.tail = i;
+}
+
+static void blkcache_touch(int16_t i) {
+  if (cache.head != i) {
+    blkcache_unlink(i);
+    blkcache_push_front(i);
+  }
+}
+
+/* hash buckets */
+
+static int16_t *blkcache_bucket(pwjs_blkcache_dev_t *dev, uint32_t line) {
+  uint32_t hash = line ^ (uint32_t)((uintptr_t)dev >> 3);
+  return &cache.buckets[hash % cache.count];
+}
+
+static int16_t blkcache_lookup(pwjs_blkcache_dev_t *dev, uint32_t line) {
+  int16_t i = *blkcache_bucket(dev, line);
+  while (i != NIL) {
+    if (cache.lines[i].dev == dev && cache.lines[i].line == line) {
+      return i;
+    }
+    i = cache.lines[i].hash_next;
+  }
+  return NIL;
+}
+
+static void blkcache_unhash(int16_t i) {
+  blkcache_line_t *l = &cache.lines[i];
+  int16_t *p = blkcache_bucket(l->dev, l->line);
+  while (*p != i) {
+    p = &cache.lines[*p].hash_next;
+  }
+  *p = l->hash_next;
+  l->hash_next = NIL;
+}
+
+/* lines */
+
+/**
+ * Read or write count lines from a device
+ */
+static int blkcache_line_io(pwjs_blkcache_dev_t *dev, uint32_t line,
+                            uint8_t *buffer, uint32_t count, bool write) {
+  uint64_t addr = (uint64_t)line * LINE_SIZE;
+  uint32_t block = (uint32_t)(addr / dev->block_size);
+  uint32_t offset = (uint32_t)(addr % dev->block_size);
+  return write ? dev->write(dev, block, offset, buffer, count * LINE_SIZE)
+               : dev->read(dev, block, offset, buffer, count * LINE_SIZE);
+}
+
+static int blkcache_writeback(int16_t i) {
+  blkcache_line_t *l = &cache.lines[i];
+  if (!l->dirty) {
+    return 0;
+  }
+  int ret = blkcache_line_io(l->dev, l->line, blkcache_data(i), 1, true);
+  if (ret < 0) {
+    return ret;
+  }
+  l->dirty = false;
+  stats.writebacks++;
+  return 0;
+}
+
+/**
+ * Free a line and move it to the end of the LRU list
+ */
+static void blkcache_drop(int16_t i) {
+  blkcache_unhash(i);
+  cache.lines[i].dev = NULL;
+  cache.lines[i].dirty = false;
+  blkcache_unlink(i);
+  blkcache_push_back(i);
+}
+
+/**
+ * Assign the least recently used line to a device line. Fails if the dirty
+ * line to evict could not be written back.
+ */
+static int blkcache_take(pwjs_blkcache_dev_t *dev, uint32_t line,
+                         int16_t *index) {
+  int16_t i = cache.tail;
+  blkcache_line_t *l = &cache.lines[i];
+  if (l->dev != NULL) {
+    int ret = blkcache_writeback(i);
+    if (ret < 0) {
+      return ret;
+    }
+    blkcache_unhash(i);
+    stats.evictions++;
+  }
+  l->dev = dev;
+  l->line = line;
+  l->dirty = false;
+  int16_t *bucket = blkcache_bucket(dev, line);
+  l->hash_next = *bucket;
+  *bucket = i;
+  blkcache_touch(i);
+  *index = i;
+  return 0;
+}
+
+/**
+ * Assign a line and fill it from the device
+ */
+static int blkcache_fill(pwjs_blkcache_dev_t *dev, uint32_t line,
+                         int16_t *index) {
+  int ret = blkcache_take(dev, line, index);
+  if (ret < 0) {
+    return ret;
+  }
+  ret = blkcache_line_io(dev, line, blkcache_data(*index), 1, false);
+  if (ret < 0) {
+    blkcache_drop(*index);
+    return ret;
+  }
+  stats.misses++;
+  return 0;
+}
+
+/* API */
+
+int pwjs_blkcache_parse_mode(const char *name) {
+  if (strcmp(name, "none") == 0) {
+    return PWJS_BLKCACHE_NONE;
+  } else if (strcmp(name, "writethrough") == 0) {
+    return PWJS_BLKCACHE_WRITE_THROUGH;
+  } else if (strcmp(name, "writeback") == 0) {
+    return PWJS_BLKCACHE_WRITE_BACK;
+  }
+  return EINVAL;
+}
+
+int pwjs_blkcache_configure(uint32_t size) {
+  if (size / LINE_SIZE > INT16_MAX) {
+    return EINVAL;
+  }
+  int ret = pwjs_blkcache_flush(NULL);
+  if (ret < 0) {
+    return ret;
+  }
+  blkcache_free();
+  cache.size = size - size % LINE_SIZE;
+  return 0;
+}
+
+int pwjs_blkcache_read(pwjs_blkcache_dev_t *dev, uint32_t block,
+                       uint32_t offset, uint8_t *buffer, size_t size) {
+  if (!blkcache_enabled(dev) || blkcache_alloc() < 0) {
+    return dev->read(dev, block, offset, buffer, size);
+  }
+  uint64_t addr = (uint64_t)block * dev->block_size + offset;
+  bool bulk = size >= cache.size / 4;
+  while (size > 0) {
+    uint32_t line = (uint32_t)(addr / LINE_SIZE);
+    uint32_t skip = (uint32_t)(addr % LINE_SIZE);
+    size_t len = LINE_SIZE - skip;
+    if (len > size) {
+      len = size;
+    }
+    int16_t i = blkcache_lookup(dev, line);
+    if (i != NIL) {
+      stats.hits++;
+      blkcache_touch(i);
+      memcpy(buffer, blkcache_data(i) + skip, len);
+    } else if (bulk && len == LINE_SIZE) {
+      // read the run of missing full lines directly
+      uint32_t count = 1;
+      while ((count + 1) * LINE_SIZE <= size &&
+             blkcache_lookup(dev, line + count) == NIL) {
+        count++;
+      }
+      int ret = blkcache_line_io(dev, line, buffer, count, false);
+      if (ret < 0) {
+        return ret;
+      }
+      len = count * LINE_SIZE;
+    } else {
+      int ret = blkcache_fill(dev, line, &i);
+      if (ret < 0) {
+        return ret;
+      }
+      memcpy(buffer, blkcache_data(i) + skip, len);
+    }
+    buffer += len;
+    addr += len;
+    size -= len;
+  }
+  return 0;
+}
+
+int pwjs_blkcache_write(pwjs_blkcache_dev_t *dev, uint32_t block,
+                        uint32_t offset, const uint8_t *buffer, size_t size) {
+  if (!blkcache_enabled(dev) || blkcache_alloc() < 0) {
+    return dev->write(dev, block, offset, buffer, size);
+  }
+  bool bulk = size >= cache.size / 4;
+  bool write_back = (dev->mode == PWJS_BLKCACHE_WRITE_BACK) && !bulk;
+  if (!write_back) {
+    int ret = dev->write(dev, block, offset, buffer, size);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  // update the cached lines. A bulk write does not change whether a line is
+  // dirty, as the line holds the written bytes too.
+  uint64_t addr = (uint64_t)block * dev->block_size + offset;
+  while (size > 0) {
+    uint32_t line = (uint32_t)(addr / LINE_SIZE);
+    uint32_t skip = (uint32_t)(addr % LINE_SIZE);
+    size_t len = LINE_SIZE - skip;
+    if (len > size) {
+      len = size;
+    }
+    int16_t i = blkcache_lookup(dev, line);
+    int ret = 0;
+    if (i != NIL) {
+      stats.hits++;
+      blkcache_touch(i);
+    } else if (len == LINE_SIZE && !bulk) {
+      ret = blkcache_take(dev, line, &i);
+    } else if (write_back) {
+      ret = blkcache_fill(dev, line, &i);
+    }
+    if (ret < 0) {
+      return ret;
+    }
+    if (i != NIL) {
+      memcpy(blkcache_data(i) + skip, buffer, len);
+      if (write_back) {
+        cache.lines[i].dirty = true;
+      }
+    }
+    buffer += len;
+    addr += len;
+    size -= len;
+  }
+  return 0;
+}
+
+int pwjs_blkcache_flush(pwjs_blkcache_dev_t *dev) {
+  for (int i = 0; i < cache.count; i++) {
+    if (cache.lines[i].dirty && (dev == NULL || cache.lines[i].dev == dev)) {
+      int ret = blkcache_writeback(i);
+      if (ret < 0) {
+        return ret;
+      }
+    }
+  }
+  return 0;
+}
+
+void pwjs_blkcache_invalidate(pwjs_blkcache_dev_t *dev, uint32_t block) {
+  uint32_t lines_per_block = dev->block_size / LINE_SIZE;
+  for (int i = 0; i < cache.count; i++) {
+    if (cache.lines[i].dev == dev &&
+        cache.lines[i].line / lines_per_block == block) {
+      blkcache_drop(i);
+    }
+  }
+}
+
+void pwjs_blkcache_release(pwjs_blkcache_dev_t *dev) {
+  for (int i = 0; i < cache.count; i++) {
+    if (cache.lines[i].dev == dev) {
+      blkcache_drop(i);
+    }
+  }
+}
+
+void pwjs_blkcache_cleanup() {
+  // the devices still cached keep their data. The cache is freed anyway if
+  // a write-back fails, there is nothing left to retry it.
+  pwjs_blkcache_flush(NULL);
+  blkcache_free();
+  cache.size = PWJS_BLKCACHE_DEFAULT_SIZE;
+  pwjs_blkcache_reset_stats();
+}
+
+void pwjs_blkcache_get_stats(pwjs_blkcache_stats_t *result) {
+  *result = stats;
+  result->size = cache.size;
+  result->used = 0;
+  result->dirty = 0;
+  for (int i = 0; i < cache.count; i++) {
+    if (cache.lines[i].dev != NULL) {
+      result->used++;
+    }
+    if (cache.lines[i].dirty) {
+      result->dirty++;
+    }
+  }
+}
+
+void pwjs_blkcache_reset_stats() { memset(&stats, 0, sizeof(stats)); }
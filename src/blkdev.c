@@ -0,0 +1,46 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "blkdev.h"
+
+#include <stdlib.h>
+
+static void blkdev_freecb(void *handle) {
+  pwjs_blkdev_t *blkdev = (pwjs_blkdev_t *)handle;
+  if (blkdev->free != NULL) {
+    blkdev->free(blkdev);
+  }
+}
+
+static const jerry_object_native_info_t blkdev_info = {.free_cb =
+                                                           blkdev_freecb};
+
+void pwjs_blkdev_bind(jerry_value_t obj, pwjs_blkdev_t *blkdev) {
+  jerry_set_object_native_pointer(obj, blkdev, &blkdev_info);
+}
+
+pwjs_blkdev_t *pwjs_blkdev_get(jerry_value_t obj) {
+  void *native_pointer;
+  if (jerry_get_object_native_pointer(obj, &native_pointer, &blkdev_info)) {
+    return (pwjs_blkdev_t *)native_pointer;
+  }
+  return NULL;
+}
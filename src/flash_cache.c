@@ -0,0 +1,180 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "flash_cache.h"
+
+#include <string.h>
+
+#include "board.h"
+#include "err.h"
+#include "flash.h"
+#include "mem.h"
+
+#define PAGE_SIZE PICOWJS_FLASH_PAGE_SIZE
+#define PAGE_COUNT (PICOWJS_FLASH_SECTOR_SIZE / PICOWJS_FLASH_PAGE_SIZE)
+
+/**
+ * - sector : cached sector, -1 if none
+ * - dirty : bit mask of the dirty pages of the sector
+ * - pages : cached pages, allocated on first program
+ */
+static struct {
+  int sector;
+  uint32_t dirty;
+  uint8_t *pages;
+} cache = {-1, 0, NULL};
+
+static pwjs_flash_cache_stats_t stats;
+
+int pwjs_flash_cache_sync() {
+  if (cache.dirty == 0) {
+    return 0;
+  }
+  stats.syncs++;
+  int page = 0;
+  while (page < PAGE_COUNT) {
+    if ((cache.dirty & (1u << page)) == 0) {
+      page++;
+      continue;
+    }
+    int count = 1;
+    while (page + count < PAGE_COUNT &&
+           (cache.dirty & (1u << (page + count)))) {
+      count++;
+    }
+    int ret = pwjs_flash_program(cache.sector, page * PAGE_SIZE,
+                                 cache.pages + page * PAGE_SIZE,
+                                 count * PAGE_SIZE);
+    if (ret < 0) {
+      return ret;
+    }
+    stats.programs++;
+    stats.pages += count;
+    cache.dirty &= ~(((1u << count) - 1) << page);
+    page += count;
+  }
+  return 0;
+}
+
+int pwjs_flash_cache_program(uint32_t sector, uint32_t offset,
+                             const uint8_t *buffer, size_t size) {
+  if (offset + size > PICOWJS_FLASH_SECTOR_SIZE) {
+    return EINVAL;
+  }
+  if (cache.pages == NULL) {
+    cache.pages = pwjs_malloc(PWJS_MEM_FLASH, PICOWJS_FLASH_SECTOR_SIZE);
+  }
+  if (cache.pages == NULL || offset % PAGE_SIZE > 0 || size % PAGE_SIZE > 0) {
+    // out of memory, or partial pages left for the port to reject: write
+    // through, after the cached pages of the sector
+    if (cache.sector == (int)sector) {
+      int ret = pwjs_flash_cache_sync();
+      if (ret < 0) {
+        return ret;
+      }
+    }
+    uint32_t count = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+    stats.requested += count;
+    stats.programs++;
+    stats.pages += count;
+    return pwjs_flash_program(sector, offset, (uint8_t *)buffer, size);
+  }
+  if (cache.sector != (int)sector) {
+    int ret = pwjs_flash_cache_sync();
+    if (ret < 0) {
+      return ret;
+    }
+    cache.sector = sector;
+  }
+  for (size_t pos = 0; pos < size; pos += PAGE_SIZE) {
+    int page = (offset + pos) / PAGE_SIZE;
+    uint8_t *cached = cache.pages + page * PAGE_SIZE;
+    if (cache.dirty & (1u << page)) {
+      for (int i = 0; i < PAGE_SIZE; i++) {
+        cached[i] &= buffer[pos + i];
+      }
+      stats.merged++;
+    } else {
+      memcpy(cached, buffer + pos, PAGE_SIZE);
+      cache.dirty |= 1u << page;
+    }
+    stats.requested++;
+  }
+  return 0;
+}
+
+int pwjs_flash_cache_erase(uint32_t sector, size_t count) {
+  if (cache.sector >= (int)sector && cache.sector < (int)(sector + count)) {
+    for (int page = 0; page < PAGE_COUNT; page++) {
+      if (cache.dirty & (1u << page)) {
+        stats.dropped++;
+      }
+    }
+    cache.dirty = 0;
+    cache.sector = -1;
+  }
+  return pwjs_flash_erase(sector, count);
+}
+
+int pwjs_flash_cache_read(uint32_t sector, uint32_t offset, uint8_t *buffer,
+                          size_t size) {
+  memcpy(buffer,
+         pwjs_flash_addr + sector * PICOWJS_FLASH_SECTOR_SIZE + offset, size);
+  if (cache.dirty == 0) {
+    return 0;
+  }
+  // merge the dirty pages in the range
+  uint32_t start = sector * PICOWJS_FLASH_SECTOR_SIZE + offset;
+  uint32_t end = start + size;
+  uint32_t base = cache.sector * PICOWJS_FLASH_SECTOR_SIZE;
+  for (int page = 0; page < PAGE_COUNT; page++) {
+    uint32_t page_start = base + page * PAGE_SIZE;
+    if ((cache.dirty & (1u << page)) == 0 || page_start >= end ||
+        page_start + PAGE_SIZE <= start) {
+      continue;
+    }
+    uint32_t from = page_start > start ? page_start : start;
+    uint32_t to = page_start + PAGE_SIZE < end ? page_start + PAGE_SIZE : end;
+    const uint8_t *cached = cache.pages + (from - base);
+    for (uint32_t i = from; i < to; i++) {
+      buffer[i - start] &= *cached++;
+    }
+  }
+  return 0;
+}
+
+void pwjs_flash_cache_cleanup() {
+  pwjs_flash_cache_sync();
+  if (cache.pages != NULL) {
+    pwjs_free(cache.pages);
+    cache.pages = NULL;
+  }
+  cache.sector = -1;
+  cache.dirty = 0;
+}
+
+void pwjs_flash_cache_get_stats(pwjs_flash_cache_stats_t *out) {
+  *out = stats;
+}
+
+void pwjs_flash_cache_reset_stats() {
+  memset(&stats, 0, sizeof(stats));
+}
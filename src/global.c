@@ -33,6 +33,7 @@
 #include "jerryscript-ext/handler.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "mem.h"
 #include "picowjs_config.h"
 #include "picowjs_modules.h"
 #include "magic_strings.h"
@@ -230,7 +231,7 @@ JERRYXX_FUN(pulse_read_fn) {
   uint8_t trigger_start_state = 0;  // default is LOW
   size_t trigger_len = 0;
   uint32_t *trigger_buf = NULL;
-  uint32_t *buf = malloc(count * 4);
+  uint32_t *buf = pwjs_malloc(PWJS_MEM_CORE, count * 4);
 
   // read options
   if (JERRYXX_HAS_ARG(2)) {
@@ -248,7 +249,7 @@ JERRYXX_FUN(pulse_read_fn) {
       if (jerry_value_is_array(trigger_interval)) {
         trigger_len = jerry_get_array_length(trigger_interval);
         if (trigger_len > 0) {
-          trigger_buf = malloc(trigger_len * 4);
+          trigger_buf = pwjs_malloc(PWJS_MEM_CORE, trigger_len * 4);
           for (int i = 0; i < trigger_len; i++) {
             jerry_value_t item =
                 jerry_get_property_by_index(trigger_interval, i);
@@ -280,7 +281,7 @@ JERRYXX_FUN(pulse_read_fn) {
 
   // free trigger buffer
   if (trigger_buf) {
-    free(trigger_buf);
+    pwjs_free(trigger_buf);
   }
 
   // return pulse data
@@ -291,10 +292,10 @@ JERRYXX_FUN(pulse_read_fn) {
       jerry_release_value(jerry_set_property_by_index(output_array, i, val));
       jerry_release_value(val);
     }
-    free(buf);
+    pwjs_free(buf);
     return output_array;
   }
-  free(buf);
+  pwjs_free(buf);
   return jerry_create_null();
 }
 
@@ -330,7 +331,7 @@ JERRYXX_FUN(pulse_write_fn) {
   return jerry_create_number(length);
 }
 
-static void watch_close_cb(pwjs_io_handle_t *handle) { free(handle); }
+static void watch_close_cb(pwjs_io_handle_t *handle) { pwjs_free(handle); }
 
 static void set_watch_cb(pwjs_io_watch_handle_t *watch) {
   if (jerry_value_is_function(watch->watch_js_cb)) {
@@ -363,7 +364,8 @@ JERRYXX_FUN(set_watch_fn) {
   pwjs_io_watch_mode_t events =
       JERRYXX_GET_ARG_NUMBER_OPT(2, PWJS_IO_WATCH_MODE_CHANGE);
   uint32_t debounce = JERRYXX_GET_ARG_NUMBER_OPT(3, 0);
-  pwjs_io_watch_handle_t *watch = malloc(sizeof(pwjs_io_watch_handle_t));
+  pwjs_io_watch_handle_t *watch =
+      pwjs_malloc(PWJS_MEM_WATCH, sizeof(pwjs_io_watch_handle_t));
   pwjs_io_watch_init(watch);
   watch->watch_js_cb = jerry_acquire_value(callback);
   pwjs_io_watch_start(watch, set_watch_cb, pin, events, debounce);
@@ -514,7 +516,7 @@ static void register_global_interrupts() {
 /*                                                                          */
 /****************************************************************************/
 
-static void timer_close_cb(pwjs_io_handle_t *handle) { free(handle); }
+static void timer_close_cb(pwjs_io_handle_t *handle) { pwjs_free(handle); }
 
 static void set_timer_cb(pwjs_io_timer_handle_t *timer) {
   if (jerry_value_is_function(timer->timer_js_cb)) {
@@ -545,7 +547,8 @@ JERRYXX_FUN(set_timeout_fn) {
   JERRYXX_CHECK_ARG_NUMBER(1, "delay");
   jerry_value_t callback = JERRYXX_GET_ARG(0);
   uint64_t delay = (uint64_t)JERRYXX_GET_ARG_NUMBER(1);
-  pwjs_io_timer_handle_t *timer = malloc(sizeof(pwjs_io_timer_handle_t));
+  pwjs_io_timer_handle_t *timer =
+      pwjs_malloc(PWJS_MEM_TIMER, sizeof(pwjs_io_timer_handle_t));
   pwjs_io_timer_init(timer);
   timer->timer_js_cb = jerry_acquire_value(callback);
   pwjs_io_timer_start(timer, set_timer_cb, delay, false);
@@ -557,7 +560,8 @@ JERRYXX_FUN(set_interval_fn) {
   JERRYXX_CHECK_ARG_NUMBER(1, "delay");
   jerry_value_t callback = JERRYXX_GET_ARG(0);
   uint64_t delay = (uint64_t)JERRYXX_GET_ARG_NUMBER(1);
-  pwjs_io_timer_handle_t *timer = malloc(sizeof(pwjs_io_timer_handle_t));
+  pwjs_io_timer_handle_t *timer =
+      pwjs_malloc(PWJS_MEM_TIMER, sizeof(pwjs_io_timer_handle_t));
   pwjs_io_timer_init(timer);
   timer->timer_js_cb = jerry_acquire_value(callback);
   pwjs_io_timer_start(timer, set_timer_cb, delay, true);
@@ -704,7 +708,8 @@ JERRYXX_FUN(tone_fn) {
     }
     // setup timer for duration
     if (duration > 0) {
-      pwjs_io_timer_handle_t *timer = malloc(sizeof(pwjs_io_timer_handle_t));
+      pwjs_io_timer_handle_t *timer =
+          pwjs_malloc(PWJS_MEM_TIMER, sizeof(pwjs_io_timer_handle_t));
       pwjs_io_timer_init(timer);
       timer->tag = pin;
       pwjs_io_timer_start(timer, tone_timeout_cb, duration, false);
@@ -851,14 +856,49 @@ JERRYXX_FUN(process_get_builtin_module_fn) {
   return jerry_create_undefined();
 }
 
+static jerry_value_t create_mem_stats(pwjs_mem_stats_t *stats) {
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, MSTR_MEM_CURRENT, stats->current);
+  jerryxx_set_property_number(obj, MSTR_MEM_PEAK, stats->peak);
+  jerryxx_set_property_number(obj, MSTR_MEM_COUNT, stats->count);
+  jerryxx_set_property_number(obj, MSTR_MEM_ALLOCS, stats->allocs);
+  return obj;
+}
+
 JERRYXX_FUN(process_memory_usage_fn) {
+  JERRYXX_CHECK_ARG_OBJECT_OPT(0, "options");
+  bool detailed = false;
+  if (JERRYXX_HAS_ARG(0)) {
+    detailed = jerryxx_get_property_boolean(JERRYXX_GET_ARG(0),
+                                            MSTR_MEM_DETAILED, false);
+  }
   jerry_heap_stats_t stats = {0};
   bool stats_ret = jerry_get_memory_stats(&stats);
   if (stats_ret) {
     jerry_value_t obj = jerry_create_object();
-    jerryxx_set_property_number(obj, "heapTotal", stats.size);
-    jerryxx_set_property_number(obj, "heapUsed", stats.allocated_bytes);
-    jerryxx_set_property_number(obj, "heapPeak", stats.peak_allocated_bytes);
+    jerryxx_set_property_number(obj, MSTR_HEAP_TOTAL, stats.size);
+    jerryxx_set_property_number(obj, MSTR_HEAP_USED, stats.allocated_bytes);
+    jerryxx_set_property_number(obj, MSTR_HEAP_PEAK,
+                                stats.peak_allocated_bytes);
+    if (detailed) {
+      // native allocations (outside of JS heap) per module
+      pwjs_mem_stats_t mem_stats;
+      pwjs_mem_get_total(&mem_stats);
+      jerry_value_t native = create_mem_stats(&mem_stats);
+      jerryxx_set_property(obj, MSTR_MEM_NATIVE, native);
+      jerry_release_value(native);
+      jerry_value_t modules = jerry_create_object();
+      for (int i = 0; i < PWJS_MEM_ID_COUNT; i++) {
+        pwjs_mem_get_stats(i, &mem_stats);
+        if (mem_stats.allocs > 0) {
+          jerry_value_t module = create_mem_stats(&mem_stats);
+          jerryxx_set_property(modules, pwjs_mem_name(i), module);
+          jerry_release_value(module);
+        }
+      }
+      jerryxx_set_property(obj, MSTR_MEM_MODULES, modules);
+      jerry_release_value(modules);
+    }
     return obj;
   }
   return jerry_create_undefined();
@@ -1128,7 +1168,7 @@ static void register_global_text_decoder() {
 /*                                                                          */
 /****************************************************************************/
 
-static void base64_buffer_free_cb(void *native_p) { free(native_p); }
+static void base64_buffer_free_cb(void *native_p) { pwjs_free(native_p); }
 
 JERRYXX_FUN(btoa_fn) {
   JERRYXX_CHECK_ARG(0, "data")
@@ -1157,7 +1197,7 @@ JERRYXX_FUN(btoa_fn) {
   if (encoded_data != NULL && encoded_data_sz > 0) {
     jerry_value_t result =
         jerry_create_string_sz(encoded_data, encoded_data_sz - 1);
-    free(encoded_data);
+    pwjs_free(encoded_data);
     return result;
   } else {
     return jerry_create_undefined();
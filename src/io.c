@@ -26,6 +26,7 @@
 #include <stdlib.h>
 
 #include "gpio.h"
+#include "mem.h"
 #include "system.h"
 #include "tty.h"
 #include "uart.h"
@@ -40,6 +41,7 @@ static void pwjs_io_watch_run();
 static void pwjs_io_uart_run();
 static void pwjs_io_idle_run();
 static void pwjs_io_idle_run();
+static void pwjs_io_file_run();
 
 /* general handle functions */
 
@@ -92,6 +94,7 @@ void pwjs_io_init() {
   pwjs_list_init(&loop.uart_handles);
   pwjs_list_init(&loop.idle_handles);
   pwjs_list_init(&loop.stream_handles);
+  pwjs_list_init(&loop.file_handles);
   pwjs_list_init(&loop.closing_handles);
 }
 
@@ -102,6 +105,7 @@ void pwjs_io_cleanup() {
   // pwjs_io_idle_cleanup();
   // Do not cleanup tty I/O to keep terminal communication
   pwjs_io_stream_cleanup();
+  pwjs_io_file_cleanup();
 }
 
 void pwjs_io_run(bool infinite) {
@@ -112,13 +116,15 @@ void pwjs_io_run(bool infinite) {
     pwjs_io_watch_run();
     pwjs_io_uart_run();
     pwjs_io_idle_run();
+    pwjs_io_file_run();
     pwjs_io_handle_closing();
     pwjs_custom_infinite_loop();
 
     // quite if there no IO handles
     if (!infinite) {
       if (loop.timer_handles.head == NULL && loop.watch_handles.head == NULL &&
-          loop.uart_handles.head == NULL && loop.closing_handles.head == NULL) {
+          loop.uart_handles.head == NULL && loop.file_handles.head == NULL &&
+          loop.closing_handles.head == NULL) {
         loop.stop_flag = true;
       }
     }
@@ -160,7 +166,7 @@ void pwjs_io_timer_cleanup() {
   while (handle != NULL) {
     pwjs_io_timer_handle_t *next =
         (pwjs_io_timer_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
+    pwjs_free(handle);
     handle = next;
   }
   pwjs_list_init(&loop.timer_handles);
@@ -209,7 +215,7 @@ void pwjs_io_tty_cleanup() {
   while (handle != NULL) {
     pwjs_io_tty_handle_t *next =
         (pwjs_io_tty_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
+    pwjs_free(handle);
     handle = next;
   }
   pwjs_list_init(&loop.tty_handles);
@@ -270,7 +276,7 @@ void pwjs_io_watch_cleanup() {
   while (handle != NULL) {
     pwjs_io_watch_handle_t *next =
         (pwjs_io_watch_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
+    pwjs_free(handle);
     handle = next;
   }
   pwjs_list_init(&loop.watch_handles);
@@ -353,7 +359,7 @@ void pwjs_io_uart_cleanup() {
   while (handle != NULL) {
     pwjs_io_uart_handle_t *next =
         (pwjs_io_uart_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
+    pwjs_free(handle);
     handle = next;
   }
   pwjs_list_init(&loop.uart_handles);
@@ -403,7 +409,7 @@ void pwjs_io_idle_cleanup() {
   while (handle != NULL) {
     pwjs_io_idle_handle_t *next =
         (pwjs_io_idle_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
+    pwjs_free(handle);
     handle = next;
   }
   pwjs_list_init(&loop.idle_handles);
@@ -452,7 +458,7 @@ void pwjs_io_stream_cleanup() {
   while (handle != NULL) {
     pwjs_io_stream_handle_t *next =
         (pwjs_io_stream_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
+    pwjs_free(handle);
     handle = next;
   }
   pwjs_list_init(&loop.stream_handles);
@@ -477,4 +483,71 @@ static void pwjs_io_stream_run() {
     handle = (pwjs_io_stream_handle_t *)((pwjs_list_node_t *)handle)->next;
   }
 }
-*/
\ No newline at end of file
+*/
+
+/* file functions */
+
+void pwjs_io_file_init(pwjs_io_file_handle_t *file) {
+  pwjs_io_handle_init((pwjs_io_handle_t *)file, PWJS_IO_FILE);
+  file->fd = -1;
+  file->file_cb = NULL;
+}
+
+void pwjs_io_file_start(pwjs_io_file_handle_t *file, int fd,
+                        pwjs_io_file_cb file_cb) {
+  PWJS_IO_SET_FLAG_ON(file->base.flags, PWJS_IO_FLAG_ACTIVE);
+  file->fd = fd;
+  file->file_cb = file_cb;
+  pwjs_list_append(&loop.file_handles, (pwjs_list_node_t *)file);
+}
+
+/**
+ * A paused handle stays in the loop (and can be found by id) but its
+ * callback is not called until it is resumed.
+ */
+void pwjs_io_file_pause(pwjs_io_file_handle_t *file) {
+  PWJS_IO_SET_FLAG_OFF(file->base.flags, PWJS_IO_FLAG_ACTIVE);
+}
+
+void pwjs_io_file_resume(pwjs_io_file_handle_t *file) {
+  PWJS_IO_SET_FLAG_ON(file->base.flags, PWJS_IO_FLAG_ACTIVE);
+}
+
+void pwjs_io_file_stop(pwjs_io_file_handle_t *file) {
+  PWJS_IO_SET_FLAG_OFF(file->base.flags, PWJS_IO_FLAG_ACTIVE);
+  pwjs_list_remove(&loop.file_handles, (pwjs_list_node_t *)file);
+}
+
+pwjs_io_file_handle_t *pwjs_io_file_get_by_id(uint32_t id) {
+  return (pwjs_io_file_handle_t *)pwjs_io_handle_get_by_id(id,
+                                                           &loop.file_handles);
+}
+
+void pwjs_io_file_cleanup() {
+  pwjs_io_file_handle_t *handle = (pwjs_io_file_handle_t *)loop.file_handles.head;
+  while (handle != NULL) {
+    pwjs_io_file_handle_t *next =
+        (pwjs_io_file_handle_t *)((pwjs_list_node_t *)handle)->next;
+    pwjs_free(handle);
+    handle = next;
+  }
+  pwjs_list_init(&loop.file_handles);
+}
+
+static void pwjs_io_file_run() {
+  // Serve one active handle per iteration in round robin. The callback runs
+  // JS which may stop or close any file handle, so the list is not walked
+  // across callbacks.
+  pwjs_io_file_handle_t *handle = (pwjs_io_file_handle_t *)loop.file_handles.head;
+  while (handle != NULL) {
+    if (PWJS_IO_HAS_FLAG(handle->base.flags, PWJS_IO_FLAG_ACTIVE)) {
+      pwjs_list_remove(&loop.file_handles, (pwjs_list_node_t *)handle);
+      pwjs_list_append(&loop.file_handles, (pwjs_list_node_t *)handle);
+      if (handle->file_cb) {
+        handle->file_cb(handle);
+      }
+      return;
+    }
+    handle = (pwjs_io_file_handle_t *)((pwjs_list_node_t *)handle)->next;
+  }
+}
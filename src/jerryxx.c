@@ -30,6 +30,39 @@
 #include "repl.h"
 #include "tty.h"
 
+#define JERRYXX_KEY_NAME(id, str) str,
+static const char *const jerryxx_key_names[JERRYXX_KEY_MAX] = {
+    JERRYXX_KEYS(JERRYXX_KEY_NAME)};
+#undef JERRYXX_KEY_NAME
+
+static jerry_value_t jerryxx_keys[JERRYXX_KEY_MAX];
+
+/**
+ * Create the interned keys. Must be called after the magic strings are
+ * registered so that each key resolves to a magic string.
+ */
+void jerryxx_keys_init() {
+  for (int i = 0; i < JERRYXX_KEY_MAX; i++) {
+    jerryxx_keys[i] =
+        jerry_create_string((const jerry_char_t *)jerryxx_key_names[i]);
+  }
+}
+
+/**
+ * Release the interned keys. Must be called before jerry_cleanup().
+ */
+void jerryxx_keys_cleanup() {
+  for (int i = 0; i < JERRYXX_KEY_MAX; i++) {
+    jerry_release_value(jerryxx_keys[i]);
+    jerryxx_keys[i] = jerry_create_undefined();
+  }
+}
+
+/**
+ * Return an interned key. The value is borrowed and must not be released.
+ */
+jerry_value_t jerryxx_key(jerryxx_key_t key) { return jerryxx_keys[key]; }
+
 void jerryxx_set_property(jerry_value_t object, const char *name,
                           jerry_value_t value) {
   jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
@@ -68,6 +101,20 @@ void jerryxx_set_property_function(jerry_value_t object, const char *name,
   jerry_release_value(ext_fn);
 }
 
+void jerryxx_set_property_by_key(jerry_value_t object, jerryxx_key_t key,
+                                 jerry_value_t value) {
+  jerry_value_t ret = jerry_set_property(object, jerryxx_keys[key], value);
+  jerry_release_value(ret);
+}
+
+void jerryxx_set_property_number_by_key(jerry_value_t object,
+                                        jerryxx_key_t key, double value) {
+  jerry_value_t val = jerry_create_number(value);
+  jerry_value_t ret = jerry_set_property(object, jerryxx_keys[key], val);
+  jerry_release_value(ret);
+  jerry_release_value(val);
+}
+
 void jerryxx_define_own_property(jerry_value_t object, const char *name,
                                  jerry_external_handler_t getter,
                                  jerry_external_handler_t setter) {
@@ -110,6 +157,23 @@ double jerryxx_get_property_number(jerry_value_t object, const char *name,
   return value;
 }
 
+jerry_value_t jerryxx_get_property_by_key(jerry_value_t object,
+                                          jerryxx_key_t key) {
+  return jerry_get_property(object, jerryxx_keys[key]);
+}
+
+double jerryxx_get_property_number_by_key(jerry_value_t object,
+                                          jerryxx_key_t key,
+                                          double default_value) {
+  jerry_value_t ret = jerry_get_property(object, jerryxx_keys[key]);
+  double value = default_value;
+  if (jerry_value_is_number(ret)) {
+    value = jerry_get_number_value(ret);
+  }
+  jerry_release_value(ret);
+  return value;
+}
+
 bool jerryxx_get_property_boolean(jerry_value_t object, const char *name,
                                   bool default_value) {
   jerry_value_t prop = jerry_create_string((const jerry_char_t *)name);
@@ -140,7 +204,7 @@ bool jerryxx_delete_property(jerry_value_t object, const char *name) {
 }
 
 void jerryxx_array_push_string(jerry_value_t array, jerry_value_t item) {
-  jerry_value_t push = jerryxx_get_property(array, "push");
+  jerry_value_t push = jerryxx_get_property_by_key(array, JERRYXX_KEY_PUSH);
   jerry_value_t _args[] = {item};
   jerry_call_function(push, array, _args, 1);
   jerry_release_value(push);
@@ -169,10 +233,8 @@ void jerryxx_print_error(jerry_value_t value, bool print_stacktrace) {
   jerry_release_value(err_str);
   // print stack trace
   if (print_stacktrace && jerry_value_is_object(error_value)) {
-    jerry_value_t stack_str =
-        jerry_create_string((const jerry_char_t *)"stack");
-    jerry_value_t backtrace_val = jerry_get_property(error_value, stack_str);
-    jerry_release_value(stack_str);
+    jerry_value_t backtrace_val =
+        jerryxx_get_property_by_key(error_value, JERRYXX_KEY_STACK);
     if (!jerry_value_is_error(backtrace_val) &&
         jerry_value_is_array(backtrace_val)) {
       uint32_t length = jerry_get_array_length(backtrace_val);
@@ -239,7 +301,8 @@ jerry_size_t jerryxx_string_to_ascii_char_buffer(const jerry_value_t value,
 
 jerry_value_t jerryxx_call_require(const char *name) {
   jerry_value_t global_js = jerry_get_global_object();
-  jerry_value_t require_js = jerryxx_get_property(global_js, MSTR_REQUIRE);
+  jerry_value_t require_js =
+      jerryxx_get_property_by_key(global_js, JERRYXX_KEY_REQUIRE);
   jerry_value_t this_js = jerry_create_undefined();
   jerry_value_t name_js = jerry_create_string((const jerry_char_t *)name);
   jerry_value_t args_js[1] = {name_js};
@@ -259,18 +322,28 @@ jerry_value_t jerryxx_call_method(jerry_value_t obj, char *name,
   return ret;
 }
 
+jerry_value_t jerryxx_call_method_by_key(jerry_value_t obj, jerryxx_key_t key,
+                                         jerry_value_t *args, int args_count) {
+  jerry_value_t method = jerry_get_property(obj, jerryxx_keys[key]);
+  jerry_value_t ret = jerry_call_function(method, obj, args, args_count);
+  jerry_release_value(method);
+  return ret;
+}
+
 void jerryxx_inherit(jerry_value_t super_ctor, jerry_value_t sub_ctor) {
   // Subclass.prototype = Object.create(Superclass.prototype);
   jerry_value_t global = jerry_get_global_object();
-  jerry_value_t global_object = jerryxx_get_property(global, MSTR_OBJECT);
+  jerry_value_t global_object =
+      jerryxx_get_property_by_key(global, JERRYXX_KEY_OBJECT);
   jerry_value_t global_object_create =
-      jerryxx_get_property(global_object, MSTR_CREATE);
+      jerryxx_get_property_by_key(global_object, JERRYXX_KEY_CREATE);
   jerry_value_t super_ctor_prototype =
-      jerryxx_get_property(super_ctor, MSTR_PROTOTYPE);
+      jerryxx_get_property_by_key(super_ctor, JERRYXX_KEY_PROTOTYPE);
   jerry_value_t _args[1] = {super_ctor_prototype};
   jerry_value_t sub_ctor_prototype =
       jerry_call_function(global_object_create, global_object, _args, 1);
-  jerryxx_set_property(sub_ctor, MSTR_PROTOTYPE, sub_ctor_prototype);
+  jerryxx_set_property_by_key(sub_ctor, JERRYXX_KEY_PROTOTYPE,
+                              sub_ctor_prototype);
   jerry_release_value(sub_ctor_prototype);
   jerry_release_value(super_ctor_prototype);
   jerry_release_value(global_object_create);
@@ -278,5 +351,6 @@ void jerryxx_inherit(jerry_value_t super_ctor, jerry_value_t sub_ctor) {
   jerry_release_value(global);
 
   // Subclass.prototype.constructor = Subclass
-  jerryxx_set_property(sub_ctor_prototype, MSTR_CONSTRUCTOR, sub_ctor);
+  jerryxx_set_property_by_key(sub_ctor_prototype, JERRYXX_KEY_CONSTRUCTOR,
+                              sub_ctor);
 }
@@ -0,0 +1,145 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "mem.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Every allocation is prefixed with a header holding its size and owner, so
+ * pwjs_free() can account it without the caller passing the size. The union
+ * keeps the returned pointer aligned as malloc() would.
+ */
+typedef union {
+  struct {
+    uint32_t size;
+    uint8_t id;
+  } info;
+  max_align_t align;
+} mem_header_t;
+
+static const char *mem_names[PWJS_MEM_ID_COUNT] = {
+    "core",    "timer",   "watch",   "repl",     "prog",
+    "spi",     "i2c",     "uart",    "graphics", "storage",
+    "vfs_lfs", "vfs_fat", "net",     "flash",    "vfs",
+    "ramblkdev", "vfs_assets",
+};
+
+static pwjs_mem_stats_t mem_stats[PWJS_MEM_ID_COUNT];
+static pwjs_mem_stats_t mem_total;
+
+static void stats_add(pwjs_mem_stats_t *stats, uint32_t size) {
+  stats->current += size;
+  stats->count++;
+  stats->allocs++;
+  if (stats->current > stats->peak) {
+    stats->peak = stats->current;
+  }
+}
+
+static void stats_sub(pwjs_mem_stats_t *stats, uint32_t size) {
+  stats->current -= size;
+  stats->count--;
+}
+
+/**
+ * The header must not wrap the size around, and the size is kept in 32 bits
+ */
+#define MEM_SIZE_MAX (UINT32_MAX - sizeof(mem_header_t))
+
+void *pwjs_malloc(pwjs_mem_id_t id, size_t size) {
+  if (size > MEM_SIZE_MAX) {
+    return NULL;
+  }
+  mem_header_t *header = malloc(sizeof(mem_header_t) + size);
+  if (header == NULL) {
+    return NULL;
+  }
+  header->info.size = size;
+  header->info.id = id;
+  stats_add(&mem_stats[id], size);
+  stats_add(&mem_total, size);
+  return header + 1;
+}
+
+void *pwjs_calloc(pwjs_mem_id_t id, size_t nmemb, size_t size) {
+  size_t total = nmemb * size;
+  if (size != 0 && total / size != nmemb) {
+    return NULL;  // overflow
+  }
+  void *ptr = pwjs_malloc(id, total);
+  if (ptr != NULL) {
+    memset(ptr, 0, total);
+  }
+  return ptr;
+}
+
+void *pwjs_realloc(void *ptr, size_t size) {
+  if (ptr == NULL) {
+    return pwjs_malloc(PWJS_MEM_CORE, size);
+  }
+  if (size > MEM_SIZE_MAX) {
+    return NULL;
+  }
+  mem_header_t *header = (mem_header_t *)ptr - 1;
+  uint32_t old_size = header->info.size;
+  uint8_t id = header->info.id;
+  mem_header_t *new_header = realloc(header, sizeof(mem_header_t) + size);
+  if (new_header == NULL) {
+    return NULL;
+  }
+  new_header->info.size = size;
+  stats_sub(&mem_stats[id], old_size);
+  stats_sub(&mem_total, old_size);
+  stats_add(&mem_stats[id], size);
+  stats_add(&mem_total, size);
+  mem_stats[id].allocs--;  // a resize is not a new allocation
+  mem_total.allocs--;
+  return new_header + 1;
+}
+
+void pwjs_free(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  mem_header_t *header = (mem_header_t *)ptr - 1;
+  stats_sub(&mem_stats[header->info.id], header->info.size);
+  stats_sub(&mem_total, header->info.size);
+  free(header);
+}
+
+const char *pwjs_mem_name(pwjs_mem_id_t id) {
+  if (id < PWJS_MEM_ID_COUNT) {
+    return mem_names[id];
+  }
+  return "unknown";
+}
+
+void pwjs_mem_get_stats(pwjs_mem_id_t id, pwjs_mem_stats_t *stats) {
+  if (id < PWJS_MEM_ID_COUNT) {
+    *stats = mem_stats[id];
+  } else {
+    memset(stats, 0, sizeof(pwjs_mem_stats_t));
+  }
+}
+
+void pwjs_mem_get_total(pwjs_mem_stats_t *stats) { *stats = mem_total; }
@@ -14,4 +14,133 @@
  */
 
 
-module.exports = require('node:events')
+function EventEmitter() {
+  this._events = {};
+}
+
+module.exports = EventEmitter;
+module.exports.EventEmitter = EventEmitter;
+
+
+EventEmitter.prototype.emit = function(type) {
+  if (!this._events) {
+    this._events = {};
+  }
+
+  // About to emit 'error' event but there are no listeners for it.
+  if (type === 'error' && !this._events.error) {
+    var err = arguments[1];
+    if (err instanceof Error) {
+      throw err;
+    } else {
+      throw Error("Uncaught 'error' event");
+    }
+  }
+
+  var listeners = this._events[type];
+  if (Array.isArray(listeners)) {
+    listeners = listeners.slice();
+    var len = arguments.length;
+    var args = new Array(len - 1);
+    for (var i = 1; i < len; ++i) {
+      args[i - 1] = arguments[i];
+    }
+    for (var i = 0; i < listeners.length; ++i) {
+      listeners[i].apply(this, args);
+    }
+    return true;
+  }
+
+  return false;
+};
+
+
+EventEmitter.prototype.addListener = function(type, listener) {
+  if (typeof listener !== 'function') {
+    throw new TypeError('listener must be a function');
+  }
+
+  if (!this._events) {
+    this._events = {};
+  }
+  if (!this._events[type]) {
+    this._events[type] = [];
+  }
+
+  this._events[type].push(listener);
+
+  return this;
+};
+
+
+EventEmitter.prototype.on = EventEmitter.prototype.addListener;
+
+
+EventEmitter.prototype.once = function(type, listener) {
+  if (typeof listener !== 'function') {
+    throw new TypeError('listener must be a function');
+  }
+
+  var f = function() {
+    // here `this` is this not global, because EventEmitter binds event object
+    // for this when it calls back the handler.
+    this.removeListener(f.type, f);
+    f.listener.apply(this, arguments);
+  };
+
+  f.type = type;
+  f.listener = listener;
+
+  this.on(type, f);
+
+  return this;
+};
+
+
+EventEmitter.prototype.removeListener = function(type, listener) {
+  if (typeof listener !== 'function') {
+    throw new TypeError('listener must be a function');
+  }
+
+  var list = this._events && this._events[type];
+  if (Array.isArray(list)) {
+    for (var i = list.length - 1; i >= 0; --i) {
+      if (list[i] === listener ||
+          (list[i].listener && list[i].listener === listener)) {
+        list.splice(i, 1);
+        if (!list.length) {
+          delete this._events[type];
+        }
+        break;
+      }
+    }
+  }
+
+  return this;
+};
+
+
+EventEmitter.prototype.off = EventEmitter.prototype.removeListener;
+
+
+EventEmitter.prototype.removeAllListeners = function(type) {
+  if (arguments.length === 0) {
+    this._events = {};
+  } else if (this._events) {
+    delete this._events[type];
+  }
+
+  return this;
+};
+
+
+EventEmitter.prototype.listeners = function(type) {
+  var list = this._events && this._events[type];
+  return Array.isArray(list) ? list.slice() : [];
+};
+
+
+EventEmitter.prototype.listenerCount = function(type) {
+  var list = this._events && this._events[type];
+  return Array.isArray(list) ? list.length : 0;
+};
@@ -25,6 +25,7 @@
 #define MSTR_FLASH_FLASH "Flash"
 #define MSTR_FLASH_FLASH_ "flash"
 #define MSTR_FLASH_READ "read"
+#define MSTR_FLASH_READ_BLOCKS "readBlocks"
 #define MSTR_FLASH_WRITE "write"
 #define MSTR_FLASH_IOCTL "ioctl"
 
@@ -23,13 +23,87 @@
 
 #include <stdlib.h>
 
+#include "blkdev.h"
 #include "board.h"
 #include "err.h"
 #include "flash.h"
+#include "flash_cache.h"
 #include "flash_magic_strings.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
 #include "magic_strings.h"
+#include "mem.h"
+
+typedef struct {
+  pwjs_blkdev_t blkdev;
+  uint32_t base;
+  uint32_t count;
+} flash_handle_t;
+
+static int flash_blkdev_read(pwjs_blkdev_t *blkdev, uint32_t block,
+                             uint32_t offset, uint8_t *buffer, size_t size) {
+  flash_handle_t *handle = (flash_handle_t *)blkdev;
+  return pwjs_flash_cache_read(handle->base + block, offset, buffer, size);
+}
+
+static int flash_blkdev_write(pwjs_blkdev_t *blkdev, uint32_t block,
+                              uint32_t offset, const uint8_t *buffer,
+                              size_t size) {
+  flash_handle_t *handle = (flash_handle_t *)blkdev;
+  block += offset / PICOWJS_FLASH_SECTOR_SIZE;
+  offset %= PICOWJS_FLASH_SECTOR_SIZE;
+  while (size > 0) {
+    size_t len = PICOWJS_FLASH_SECTOR_SIZE - offset;
+    if (len > size) {
+      len = size;
+    }
+    int ret =
+        pwjs_flash_cache_program(handle->base + block, offset, buffer, len);
+    if (ret < 0) {
+      return ret;
+    }
+    buffer += len;
+    size -= len;
+    block++;
+    offset = 0;
+  }
+  return 0;
+}
+
+static int flash_blkdev_ioctl(pwjs_blkdev_t *blkdev, int op, int arg) {
+  flash_handle_t *handle = (flash_handle_t *)blkdev;
+  switch (op) {
+    case PWJS_BLKDEV_INIT:
+      return 0;
+    case PWJS_BLKDEV_SHUTDOWN:
+    case PWJS_BLKDEV_SYNC:
+      return pwjs_flash_cache_sync();
+    case PWJS_BLKDEV_BLOCK_COUNT:
+      return handle->count;
+    case PWJS_BLKDEV_BLOCK_SIZE:
+      return PICOWJS_FLASH_SECTOR_SIZE;
+    case PWJS_BLKDEV_ERASE:
+      return pwjs_flash_cache_erase(handle->base + arg, 1);
+    case PWJS_BLKDEV_BUFFER_SIZE:
+      return PICOWJS_FLASH_PAGE_SIZE;
+    default:
+      return -1;
+  }
+}
+
+static void flash_blkdev_free(pwjs_blkdev_t *blkdev) { pwjs_free(blkdev); }
+
+/**
+ * The flash is mapped through XIP. The cached pages are written back first
+ * so that the mapped memory is up to date.
+ */
+static const uint8_t *flash_blkdev_map(pwjs_blkdev_t *blkdev) {
+  flash_handle_t *handle = (flash_handle_t *)blkdev;
+  if (pwjs_flash_addr == NULL || pwjs_flash_cache_sync() < 0) {
+    return NULL;
+  }
+  return pwjs_flash_addr + handle->base * PICOWJS_FLASH_SECTOR_SIZE;
+}
 
 /**
  * Flash (block device) constructor
@@ -46,12 +120,64 @@ JERRYXX_FUN(flash_ctor_fn) {
   int size = PICOWJS_FLASH_SECTOR_SIZE;
 
   // set properties to this
-  jerryxx_set_property_number(JERRYXX_GET_THIS, "base", base);
-  jerryxx_set_property_number(JERRYXX_GET_THIS, "count", count);
-  jerryxx_set_property_number(JERRYXX_GET_THIS, "size", size);
+  jerryxx_set_property_number_by_key(JERRYXX_GET_THIS, JERRYXX_KEY_BASE, base);
+  jerryxx_set_property_number_by_key(JERRYXX_GET_THIS, JERRYXX_KEY_COUNT,
+                                     count);
+  jerryxx_set_property_number_by_key(JERRYXX_GET_THIS, JERRYXX_KEY_SIZE, size);
+
+  // bind the native block device for the file systems
+  flash_handle_t *handle =
+      (flash_handle_t *)pwjs_malloc(PWJS_MEM_FLASH, sizeof(flash_handle_t));
+  if (handle == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  handle->blkdev.read = flash_blkdev_read;
+  handle->blkdev.write = flash_blkdev_write;
+  handle->blkdev.ioctl = flash_blkdev_ioctl;
+  handle->blkdev.free = flash_blkdev_free;
+  handle->blkdev.map = flash_blkdev_map;
+  handle->base = base;
+  handle->count = count;
+  pwjs_blkdev_bind(JERRYXX_GET_THIS, &handle->blkdev);
   return jerry_create_undefined();
 }
 
+#define FLASH_GET_HANDLE(name)                                        \
+  flash_handle_t *name = (flash_handle_t *)pwjs_blkdev_get(this_val); \
+  if (name == NULL) {                                                 \
+    return jerry_create_error(                                        \
+        JERRY_ERROR_REFERENCE,                                        \
+        (const jerry_char_t *)"Failed to get native handle");         \
+  }
+
+/**
+ * Get the memory of a typed array, at its byteOffset
+ */
+static uint8_t *get_typedarray_pointer(jerry_value_t typedarray,
+                                       jerry_length_t *length) {
+  jerry_length_t byte_offset = 0;
+  jerry_value_t arrbuf =
+      jerry_get_typedarray_buffer(typedarray, &byte_offset, length);
+  uint8_t *pointer = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+  jerry_release_value(arrbuf);
+  return pointer;
+}
+
+/**
+ * Check that a range in bytes from the start of a block is in the device
+ */
+static bool flash_in_range(flash_handle_t *handle, uint32_t block,
+                           uint32_t offset, uint32_t length) {
+  uint64_t end = (uint64_t)block * PICOWJS_FLASH_SECTOR_SIZE + offset + length;
+  return block < handle->count &&
+         end <= (uint64_t)handle->count * PICOWJS_FLASH_SECTOR_SIZE;
+}
+
+static jerry_value_t flash_range_error() {
+  return jerry_create_error(JERRY_ERROR_RANGE,
+                            (const jerry_char_t *)"Out of flash range.");
+}
+
 /**
  * Flash.prototype.read()
  * args:
@@ -64,26 +190,58 @@ JERRYXX_FUN(flash_read_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "block")
   JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")
   JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")
+  FLASH_GET_HANDLE(handle)
   int block = JERRYXX_GET_ARG_NUMBER(0);
   jerry_value_t buffer = JERRYXX_GET_ARG(1);
   int offset = JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
-
-  // get buffer pointer
   jerry_length_t buffer_length = 0;
-  jerry_length_t buffer_offset = 0;
-  jerry_value_t arrbuf =
-      jerry_get_typedarray_buffer(buffer, &buffer_offset, &buffer_length);
-  uint8_t *buffer_pointer = jerry_get_arraybuffer_pointer(arrbuf);
-  jerry_release_value(arrbuf);
+  uint8_t *buffer_pointer = get_typedarray_pointer(buffer, &buffer_length);
 
   // printf("bd.read(%d, %d, %d)\r\n", block, buffer_length, offset);
 
   // read from flash
-  int base = jerryxx_get_property_number(JERRYXX_GET_THIS, "base", 0);
-  int size = jerryxx_get_property_number(JERRYXX_GET_THIS, "size", 0);
-  const uint8_t *addr = pwjs_flash_addr;
-  for (int i = 0; i < buffer_length; i++) {
-    buffer_pointer[i] = addr[((base + block) * size) + offset + i];
+  if (block < 0 || offset < 0 ||
+      !flash_in_range(handle, block, offset, buffer_length)) {
+    return flash_range_error();
+  }
+  int ret = flash_blkdev_read(&handle->blkdev, block, offset, buffer_pointer,
+                              buffer_length);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Flash.prototype.readBlocks()
+ * args:
+ *   start {number} first block
+ *   count {number} number of blocks
+ *   buffer {Uint8Array} at least count * block size bytes
+ */
+JERRYXX_FUN(flash_read_blocks_fn) {
+  // check and get args
+  JERRYXX_CHECK_ARG_NUMBER(0, "start")
+  JERRYXX_CHECK_ARG_NUMBER(1, "count")
+  JERRYXX_CHECK_ARG_TYPEDARRAY(2, "buffer")
+  FLASH_GET_HANDLE(handle)
+  int start = JERRYXX_GET_ARG_NUMBER(0);
+  int count = JERRYXX_GET_ARG_NUMBER(1);
+  jerry_value_t buffer = JERRYXX_GET_ARG(2);
+  jerry_length_t buffer_length = 0;
+  uint8_t *buffer_pointer = get_typedarray_pointer(buffer, &buffer_length);
+  if (start < 0 || count < 0 ||
+      !flash_in_range(handle, start, 0, count * PICOWJS_FLASH_SECTOR_SIZE)) {
+    return flash_range_error();
+  }
+  if (buffer_length < (uint32_t)count * PICOWJS_FLASH_SECTOR_SIZE) {
+    return jerry_create_error(JERRY_ERROR_RANGE,
+                              (const jerry_char_t *)"Buffer is too small.");
+  }
+  int ret = flash_blkdev_read(&handle->blkdev, start, 0, buffer_pointer,
+                              count * PICOWJS_FLASH_SECTOR_SIZE);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
   }
   return jerry_create_undefined();
 }
@@ -100,23 +258,30 @@ JERRYXX_FUN(flash_write_fn) {
   JERRYXX_CHECK_ARG_NUMBER(0, "block")
   JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")
   JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")
+  FLASH_GET_HANDLE(handle)
   int block = JERRYXX_GET_ARG_NUMBER(0);
   jerry_value_t buffer = JERRYXX_GET_ARG(1);
   int offset = JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
-
-  // get buffer pointer
   jerry_length_t buffer_length = 0;
-  jerry_length_t buffer_offset = 0;
-  jerry_value_t arrbuf =
-      jerry_get_typedarray_buffer(buffer, &buffer_offset, &buffer_length);
-  uint8_t *buffer_pointer = jerry_get_arraybuffer_pointer(arrbuf);
-  jerry_release_value(arrbuf);
+  uint8_t *buffer_pointer = get_typedarray_pointer(buffer, &buffer_length);
 
   // printf("bd.write(%d, %d, %d)\r\n", block, buffer_length, offset);
 
   // write to buffer
-  int base = jerryxx_get_property_number(JERRYXX_GET_THIS, "base", 0);
-  pwjs_flash_program(base + block, offset, buffer_pointer, buffer_length);
+  if (block < 0 || offset < 0 ||
+      !flash_in_range(handle, block, offset, buffer_length)) {
+    return flash_range_error();
+  }
+  // the write-back cache is for file system traffic, a direct write from JS
+  // is written through to the flash before returning
+  int ret = flash_blkdev_write(&handle->blkdev, block, offset, buffer_pointer,
+                               buffer_length);
+  if (ret == 0) {
+    ret = pwjs_flash_cache_sync();
+  }
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
   return jerry_create_undefined();
 }
 
@@ -130,33 +295,13 @@ JERRYXX_FUN(flash_ioctl_fn) {
   // check and get args
   JERRYXX_CHECK_ARG_NUMBER(0, "op")
   JERRYXX_CHECK_ARG_NUMBER_OPT(1, "arg")
+  FLASH_GET_HANDLE(handle)
   int op = JERRYXX_GET_ARG_NUMBER(0);
   int arg = JERRYXX_GET_ARG_NUMBER_OPT(1, 0);
-  int base = (int)jerryxx_get_property_number(JERRYXX_GET_THIS, "base", 0);
 
   // printf("bd.ioctl(%d, %d)\r\n", op, arg);
 
-  switch (op) {
-    case 1:  // init
-      return jerry_create_number(0);
-    case 2:  // shutdown
-      return jerry_create_number(0);
-    case 3:  // sync
-      return jerry_create_number(0);
-    case 4:  // block count
-      return jerry_create_number(
-          jerryxx_get_property_number(JERRYXX_GET_THIS, "count", 0));
-    case 5:  // block size
-      return jerry_create_number(
-          jerryxx_get_property_number(JERRYXX_GET_THIS, "size", 0));
-    case 6:  // erase block
-      pwjs_flash_erase(base + arg, 1);
-      return jerry_create_number(0);
-    case 7:  // buffer size (= flash page size)
-      return jerry_create_number(256);
-    default:
-      return jerry_create_number(-1);
-  }
+  return jerry_create_number(flash_blkdev_ioctl(&handle->blkdev, op, arg));
 }
 
 /**
@@ -169,6 +314,8 @@ jerry_value_t module_flash_init() {
   jerryxx_set_property(flash_ctor, MSTR_PROTOTYPE, flash_prototype);
   jerryxx_set_property_function(flash_prototype, MSTR_FLASH_READ,
                                 flash_read_fn);
+  jerryxx_set_property_function(flash_prototype, MSTR_FLASH_READ_BLOCKS,
+                                flash_read_blocks_fn);
   jerryxx_set_property_function(flash_prototype, MSTR_FLASH_WRITE,
                                 flash_write_fn);
   jerryxx_set_property_function(flash_prototype, MSTR_FLASH_IOCTL,
@@ -1,22 +1,646 @@
-process.binding(process.binding.fs); // init native fs
+const fs_native = process.binding(process.binding.fs);
 
-const fs = require('node:fs')
-const __path = require("node:path");
-const stats = fs.stat()
-let __cwd = "/";
+const __fstypes = {};
 
-exports.cwd = () => {
-  return __cwd;
+class Stats {
+  constructor(stat) {
+    this.type = stat.type;
+    this.size = stat.size;
+    this.mtimeMs = stat.mtime * 1000;
+    this.mtime = new Date(this.mtimeMs);
+  }
+
+  isFile() {
+    return this.type === 1;
+  }
+
+  isDirectory() {
+    return this.type === 2;
+  }
+}
+
+/**
+ * Registers a file system class (e.g. VFSLittleFS) under a type name
+ */
+exports.register = function (fsName, VFSClass) {
+  __fstypes[fsName] = VFSClass;
+};
+
+exports.unregister = function (fsName) {
+  delete __fstypes[fsName];
+};
+
+/**
+ * Mounts a block device on a path. When `format` is true, the device is
+ * formatted if it can't be mounted.
+ */
+exports.mount = function (path, blkdev, fsName, format, options) {
+  const VFSClass = __fstypes[fsName];
+  if (!VFSClass) {
+    throw new SystemError(-19); // ENODEV
+  }
+  const vfs = new VFSClass(blkdev);
+  try {
+    options ? vfs.mount(options) : vfs.mount();
+  } catch (err) {
+    if (!format) {
+      throw err;
+    }
+    options ? vfs.mkfs(options) : vfs.mkfs();
+    options ? vfs.mount(options) : vfs.mount();
+  }
+  fs_native.mount(path, vfs);
+};
+
+exports.unmount = function (path) {
+  const vfs = fs_native.unmount(path);
+  vfs.unmount();
+};
+
+exports.cwd = fs_native.cwd;
+exports.chdir = fs_native.chdir;
+/**
+ * Opens a file. flags are 'r', 'w', 'a' with the '+' and 'x' modifiers, and
+ * 'R' for files read or written at random positions (e.g. 'rR'): FatFs then
+ * keeps a map of the clusters of the file so that seeks don't walk the FAT.
+ */
+exports.open = fs_native.open;
+exports.close = fs_native.close;
+exports.read = fs_native.read;
+exports.write = fs_native.write;
+exports.readdir = fs_native.readdir;
+exports.mkdir = fs_native.mkdir;
+exports.unlink = fs_native.unlink;
+exports.rmdir = fs_native.rmdir;
+exports.rename = fs_native.rename;
+
+/**
+ * Whole-file access in a single native call. readFile() returns a
+ * Uint8Array, a string with {encoding: 'utf8'}, or fills {buffer} and
+ * returns the number of bytes read.
+ */
+exports.readFile = fs_native.readFile;
+exports.writeFile = fs_native.writeFile;
+exports.appendFile = fs_native.appendFile;
+
+/**
+ * Copies a file natively in 4 KB chunks, overwriting the destination
+ */
+exports.copyFile = fs_native.copyFile;
+
+/**
+ * Directory entry. size and mtime are only set when the directory was
+ * opened with {withStats: true}.
+ */
+class Dirent {
+  constructor(entry) {
+    this.name = entry.name;
+    this.type = entry.type;
+    if (entry.size !== undefined) {
+      this.size = entry.size;
+      this.mtimeMs = entry.mtime * 1000;
+      this.mtime = new Date(this.mtimeMs);
+    }
+  }
+
+  isFile() {
+    return this.type === 1;
+  }
+
+  isDirectory() {
+    return this.type === 2;
+  }
+}
+
+/**
+ * Open directory, read incrementally so that large directories are never
+ * held in the heap at once. The directory is closed at the end of the
+ * entries or by close().
+ */
+class Dir {
+  constructor(path, options) {
+    options = Object.assign({ withStats: false }, options);
+    this.path = path;
+    this._withStats = options.withStats;
+    this._fd = fs_native.opendir(path);
+  }
+
+  /**
+   * Returns the next entry, or null at the end
+   */
+  read() {
+    const entries = this.readBatch(1);
+    return entries.length > 0 ? entries[0] : null;
+  }
+
+  /**
+   * Returns up to `count` entries, an empty array at the end
+   */
+  readBatch(count) {
+    if (this._fd < 0) {
+      return [];
+    }
+    const entries = fs_native.dirRead(this._fd, count, this._withStats);
+    if (entries.length === 0) {
+      this.close();
+    }
+    return entries.map((entry) => new Dirent(entry));
+  }
+
+  close() {
+    if (this._fd >= 0) {
+      const fd = this._fd;
+      this._fd = -1;
+      fs_native.closedir(fd);
+    }
+  }
+}
+
+exports.Dir = Dir;
+exports.Dirent = Dirent;
+
+/**
+ * Opens a directory for incremental reading
+ * options:
+ *   withStats {boolean} include size and mtime in the entries
+ */
+exports.opendir = function (path, options) {
+  return new Dir(path, options);
+};
+
+/**
+ * Returns a Uint8Array mapping a file in place, without copying it to the
+ * heap. Only files of asset partitions (VFSAssets) on memory-mapped devices
+ * (Flash, RamBlockDev) can be mapped. The array is read-only.
+ */
+exports.mmap = fs_native.mmap;
+
+/**
+ * Block cache shared by the mounts opened with the blockCache option
+ * ('writethrough' or 'writeback'). configureBlockCache(size) sets its size
+ * in bytes, flushBlockCache() writes back the dirty blocks and
+ * blockCacheStats() returns the hit, miss and eviction counters.
+ */
+exports.configureBlockCache = fs_native.configureBlockCache;
+exports.flushBlockCache = fs_native.flushBlockCache;
+exports.blockCacheStats = fs_native.blockCacheStats;
+exports.resetBlockCacheStats = fs_native.resetBlockCacheStats;
+
+exports.stat = function (path) {
+  return new Stats(fs_native.stat(path));
+};
+
+exports.exists = function (path) {
+  try {
+    fs_native.stat(path);
+    return true;
+  } catch (err) {
+    return false;
+  }
+};
+
+/**
+ * Removes a file or a directory
+ * options:
+ *   recursive {boolean} remove the content of directories
+ *   force {boolean} ignore a non-existent path
+ */
+exports.rm = function (path, options) {
+  options = Object.assign({ recursive: false, force: false }, options);
+  let stat;
+  try {
+    stat = fs_native.stat(path);
+  } catch (err) {
+    if (options.force) {
+      return;
+    }
+    throw err;
+  }
+  if (stat.type !== 2) {
+    fs_native.unlink(path);
+    return;
+  }
+  if (options.recursive) {
+    const base = path.endsWith("/") ? path : path + "/";
+    fs_native.readdir(path).forEach((name) => {
+      exports.rm(base + name, options);
+    });
+  }
+  fs_native.rmdir(path);
+};
+
+/**
+ * The stream classes are defined on first use, so that loading fs (done at
+ * boot by the board) does not load the stream and events modules.
+ */
+let __streams = null;
+
+function __getStreams() {
+  if (__streams) {
+    return __streams;
+  }
+  const { Readable, Writable } = require("stream");
+
+  /**
+   * Readable stream of a file. Chunks are read in the I/O loop into a small
+   * pool of buffers which are reused, so a chunk is only valid until the next
+   * 'data' events. Copy it (chunk.slice()) to keep it.
+   * options:
+   *   start {number} position of the first byte, default 0
+   *   end {number} position of the last byte (inclusive), default end of file
+   *   highWaterMark {number} chunk size, default 4096
+   */
+  class ReadStream extends Readable {
+    constructor(path, options) {
+      super();
+      options = Object.assign(
+        { start: 0, end: Infinity, highWaterMark: 4096 },
+        options
+      );
+      this.path = path;
+      this.bytesRead = 0;
+      this._paused = false;
+      const length =
+        options.end === Infinity
+          ? -1
+          : Math.max(options.end - options.start + 1, 0);
+      this._handle = fs_native.createReadStream(
+        path,
+        options.start,
+        length,
+        options.highWaterMark,
+        (err, chunk) => {
+          if (err) {
+            this.emit("error", err);
+            this._afterDestroy();
+          } else if (chunk) {
+            this.bytesRead += chunk.length;
+            this.push(chunk);
+          } else {
+            this._afterEnd();
+            this._afterDestroy();
+          }
+        }
+      );
+    }
+
+    isPaused() {
+      return this._paused;
+    }
+
+    pause() {
+      this._paused = true;
+      fs_native.streamPause(this._handle);
+      return this;
+    }
+
+    resume() {
+      this._paused = false;
+      fs_native.streamResume(this._handle);
+      return this;
+    }
+
+    /**
+     * Writes all chunks to a writable stream, pausing while it is full
+     */
+    pipe(dest) {
+      this.on("data", (chunk) => {
+        if (dest.write(chunk) === false) {
+          this.pause();
+          dest.once("drain", () => {
+            this.resume();
+          });
+        }
+      });
+      this.once("end", () => {
+        dest.end();
+      });
+      return dest;
+    }
+
+    _destroy(cb) {
+      try {
+        fs_native.streamClose(this._handle);
+      } catch (err) {
+        cb(err);
+        return;
+      }
+      cb();
+    }
+  }
+
+  /**
+   * Writable stream of a file. Written data is copied into a queue of
+   * highWaterMark bytes which is written to the file in the I/O loop. write()
+   * returns false when the queue is full and 'drain' is emitted once it is
+   * written. Data not fitting the queue is written synchronously.
+   * options:
+   *   flags {string} default 'w'
+   *   highWaterMark {number} size of the queue, default 4096
+   */
+  class WriteStream extends Writable {
+    constructor(path, options) {
+      super();
+      options = Object.assign({ flags: "w", highWaterMark: 4096 }, options);
+      this.path = path;
+      this._handle = fs_native.createWriteStream(
+        path,
+        options.flags,
+        options.highWaterMark,
+        (err) => {
+          if (err) {
+            this.emit("error", err);
+          } else {
+            this.emit("drain");
+          }
+        }
+      );
+    }
+
+    write(chunk, cb) {
+      let ret = false;
+      try {
+        if (this.writableEnded) {
+          throw new SystemError(-9); // EBADF
+        }
+        ret = fs_native.streamWrite(this._handle, chunk);
+      } catch (err) {
+        if (cb) cb(err);
+        this.emit("error", err);
+        return false;
+      }
+      if (cb) cb();
+      return ret;
+    }
+
+    end(chunk, cb) {
+      if (typeof chunk === "function") {
+        cb = chunk;
+        chunk = undefined;
+      }
+      if (chunk) {
+        this.write(chunk);
+      }
+      if (cb) {
+        this.once("finish", cb);
+      }
+      if (!this.writableEnded) {
+        this.writableEnded = true;
+        this._destroy((err) => {
+          if (err) {
+            this.emit("error", err);
+          } else {
+            this._afterFinish();
+            this._afterDestroy();
+          }
+        });
+      }
+      return this;
+    }
+
+    _destroy(cb) {
+      try {
+        fs_native.streamClose(this._handle);
+      } catch (err) {
+        cb(err);
+        return;
+      }
+      cb();
+    }
+  }
+
+  __streams = { ReadStream: ReadStream, WriteStream: WriteStream };
+  return __streams;
+}
+
+/**
+ * Time budget of fs.promises per loop iteration, see configureIo()
+ */
+let __ioBudget = 5;
+
+/**
+ * Configures the chunked reads and writes of fs.promises. Each operation
+ * moves chunks of chunkSize bytes in the I/O loop until it has used
+ * `budget` ms of the loop iteration, so that timers, UART and network keep
+ * running during long file system work.
+ * options:
+ *   budget {number} in ms, default 5
+ *   chunkSize {number} default 1024
+ */
+exports.configureIo = function (options) {
+  options = Object.assign({ budget: 5, chunkSize: 1024 }, options);
+  fs_native.configureIo(options.budget, options.chunkSize);
+  __ioBudget = options.budget;
+};
+
+function __io(fd, write, buffer, position) {
+  return new Promise((resolve, reject) => {
+    fs_native.ioStart(fd, write, buffer, position, (err, bytes) => {
+      if (err) {
+        reject(err);
+      } else {
+        resolve(bytes);
+      }
+    });
+  });
+}
+
+function __toBytes(data) {
+  if (typeof data === "string") {
+    return new TextEncoder().encode(data);
+  }
+  if (ArrayBuffer.isView(data)) {
+    return new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+  }
+  throw new SystemError(-22); // EINVAL
+}
+
+function __encoding(options) {
+  return typeof options === "string" ? options : options && options.encoding;
 }
 
-exports.chdir = () => {
-  const _path = __path.resolve(path);
-  const _stat = fs.stat(_path);
-  if (_stat && _stat.isDirectory()) {
-    __cwd = _path;
-  } else {
-    throw new SystemError(-2); // ENOENT
+/**
+ * Yields to the I/O loop once `budget` ms have been used since `start`.
+ * Returns the start of the next slice.
+ */
+async function __yield(start) {
+  if (millis() - start < __ioBudget) {
+    return start;
   }
+  await new Promise((resolve) => setTimeout(resolve, 0));
+  return millis();
 }
 
-module.exports = require('node:fs')
\ No newline at end of file
+/**
+ * Promise-based file system. Reads and writes are split into chunks
+ * scheduled across loop iterations (see configureIo()), directory walks
+ * yield to the loop between entries once the budget is used. The other
+ * operations are short and run synchronously.
+ */
+const promises = {
+  open: async (path, flags) => fs_native.open(path, flags),
+  close: async (fd) => fs_native.close(fd),
+  stat: async (path) => exports.stat(path),
+  mkdir: async (path) => fs_native.mkdir(path),
+  unlink: async (path) => fs_native.unlink(path),
+  rmdir: async (path) => fs_native.rmdir(path),
+  rename: async (oldPath, newPath) => fs_native.rename(oldPath, newPath),
+
+  /**
+   * Reads into buffer[offset, offset + length) from position (the current
+   * position if null or -1). Resolves the number of bytes read.
+   */
+  async read(fd, buffer, offset, length, position) {
+    offset = offset || 0;
+    if (length === undefined) {
+      length = buffer.byteLength - offset;
+    }
+    const view = new Uint8Array(
+      buffer.buffer,
+      buffer.byteOffset + offset,
+      length
+    );
+    return __io(fd, false, view, position == null ? -1 : position);
+  },
+
+  /**
+   * Writes data (string or TypedArray) at position (the current position
+   * if null or -1). Resolves the number of bytes written.
+   */
+  async write(fd, data, offset, length, position) {
+    let bytes = __toBytes(data);
+    offset = offset || 0;
+    if (length === undefined) {
+      length = bytes.length - offset;
+    }
+    bytes = bytes.subarray(offset, offset + length);
+    return __io(fd, true, bytes, position == null ? -1 : position);
+  },
+
+  async readFile(path, options) {
+    const stat = fs_native.stat(path);
+    if (stat.type === 2) {
+      throw new SystemError(-21); // EISDIR
+    }
+    const fd = fs_native.open(path, "r");
+    let data = new Uint8Array(stat.size);
+    try {
+      const bytes = await __io(fd, false, data, 0);
+      if (bytes < data.length) {
+        data = data.subarray(0, bytes);
+      }
+    } finally {
+      fs_native.close(fd);
+    }
+    const encoding = __encoding(options);
+    if (encoding === "utf8" || encoding === "utf-8") {
+      return new TextDecoder().decode(data);
+    }
+    if (encoding) {
+      throw new SystemError(-22); // EINVAL
+    }
+    return data;
+  },
+
+  async writeFile(path, data, options) {
+    const flag = (options && options.flag) || "w";
+    const bytes = __toBytes(data);
+    const fd = fs_native.open(path, flag);
+    try {
+      await __io(fd, true, bytes, -1);
+    } finally {
+      fs_native.close(fd);
+    }
+  },
+
+  async appendFile(path, data, options) {
+    return promises.writeFile(
+      path,
+      data,
+      Object.assign({}, options, { flag: "a" })
+    );
+  },
+
+  async copyFile(src, dest) {
+    const buffer = new Uint8Array(4096);
+    const srcFd = fs_native.open(src, "r");
+    try {
+      const destFd = fs_native.open(dest, "w");
+      try {
+        let bytes;
+        while ((bytes = await __io(srcFd, false, buffer, -1)) > 0) {
+          await __io(destFd, true, buffer.subarray(0, bytes), -1);
+        }
+      } finally {
+        fs_native.close(destFd);
+      }
+    } finally {
+      fs_native.close(srcFd);
+    }
+  },
+
+  async readdir(path) {
+    const dir = new Dir(path);
+    const names = [];
+    let start = millis();
+    try {
+      let entries;
+      while ((entries = dir.readBatch(16)).length > 0) {
+        entries.forEach((entry) => names.push(entry.name));
+        start = await __yield(start);
+      }
+    } finally {
+      dir.close();
+    }
+    return names;
+  },
+
+  /**
+   * Removes a file or a directory, options as fs.rm(). A large tree is
+   * removed across loop iterations.
+   */
+  async rm(path, options) {
+    options = Object.assign({ recursive: false, force: false }, options);
+    let start = millis();
+    const remove = async (path) => {
+      let stat;
+      try {
+        stat = fs_native.stat(path);
+      } catch (err) {
+        if (options.force) {
+          return;
+        }
+        throw err;
+      }
+      if (stat.type === 2 && options.recursive) {
+        const base = path.endsWith("/") ? path : path + "/";
+        const names = await promises.readdir(path);
+        for (let i = 0; i < names.length; i++) {
+          await remove(base + names[i]);
+        }
+      }
+      stat.type === 2 ? fs_native.rmdir(path) : fs_native.unlink(path);
+      start = await __yield(start);
+    };
+    return remove(path);
+  },
+};
+
+exports.promises = promises;
+
+Object.defineProperty(exports, "ReadStream", {
+  get: () => __getStreams().ReadStream,
+  enumerable: true,
+});
+Object.defineProperty(exports, "WriteStream", {
+  get: () => __getStreams().WriteStream,
+  enumerable: true,
+});
+
+exports.createReadStream = function (path, options) {
+  return new (__getStreams().ReadStream)(path, options);
+};
+
+exports.createWriteStream = function (path, options) {
+  return new (__getStreams().WriteStream)(path, options);
+};
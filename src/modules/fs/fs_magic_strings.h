@@ -116,11 +116,40 @@
 #define MSTR_FS_WRITE_FILE_SYNC "writeFileSync"
 #define MSTR_FS_WRITEV_SYNC "writevSync"
 
-#define MSTR_FS_CWD ="cwd"
+#define MSTR_FS_CWD "cwd"
 #define MSTR_FS_CHDIR "chdir"
+#define MSTR_FS_MOUNT "mount"
+#define MSTR_FS_UNMOUNT "unmount"
+#define MSTR_FS_ENCODING "encoding"
+#define MSTR_FS_FLAG "flag"
+#define MSTR_FS_BUFFER "buffer"
+#define MSTR_FS_STREAM_WRITE "streamWrite"
+#define MSTR_FS_STREAM_PAUSE "streamPause"
+#define MSTR_FS_STREAM_RESUME "streamResume"
+#define MSTR_FS_STREAM_CLOSE "streamClose"
+#define MSTR_FS_DIR_READ "dirRead"
+#define MSTR_FS_CLOSEDIR "closedir"
+#define MSTR_FS_DIRENT_NAME "name"
+#define MSTR_FS_IO_START "ioStart"
+#define MSTR_FS_CONFIGURE_IO "configureIo"
+#define MSTR_FS_MMAP "mmap"
+#define MSTR_FS_MMAP_SOURCE "source"
+#define MSTR_FS_CONFIGURE_BLOCK_CACHE "configureBlockCache"
+#define MSTR_FS_FLUSH_BLOCK_CACHE "flushBlockCache"
+#define MSTR_FS_BLOCK_CACHE_STATS "blockCacheStats"
+#define MSTR_FS_RESET_BLOCK_CACHE_STATS "resetBlockCacheStats"
+#define MSTR_FS_CACHE_SIZE "size"
+#define MSTR_FS_CACHE_USED "used"
+#define MSTR_FS_CACHE_DIRTY "dirty"
+#define MSTR_FS_CACHE_HITS "hits"
+#define MSTR_FS_CACHE_MISSES "misses"
+#define MSTR_FS_CACHE_EVICTIONS "evictions"
+#define MSTR_FS_CACHE_WRITEBACKS "writebacks"
 
 #define MSTR_FS_STATS_IS_DIRECTORY "isDirectory"
+#define MSTR_FS_STATS_TYPE "type"
 #define MSTR_FS_STATS_SIZE "size"
+#define MSTR_FS_STATS_MTIME "mtime"
 
 
 #endif /* __FS_MAGIC_STRINGS_H */
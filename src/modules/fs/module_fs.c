@@ -19,154 +19,1638 @@
  * SOFTWARE.
  */
 
+#include "module_fs.h"
+
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include "board.h"
+#include "blkcache.h"
+#include "err.h"
 #include "fs_magic_strings.h"
+#include "io.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "mem.h"
 #include "repl.h"
+#include "system.h"
 #include "tty.h"
+#include "vfs.h"
 
-static void cmd_ls(pwjs_repl_state_t *state, char *arg) {
-  jerry_value_t fs = jerryxx_call_require("fs");
-  jerry_value_t path = jerryxx_call_require("path");
-  jerry_value_t cwd_js = jerryxx_call_method(fs, MSTR_FS_CWD, NULL, 0);
-  if (jerry_value_is_error(cwd_js)) {
-    jerryxx_print_error(cwd_js, true);
-  } else {
-    jerry_value_t args_js[1] = {cwd_js};
-    jerry_value_t file_array_js =
-        jerryxx_call_method(fs, MSTR_FS_READDIR, args_js, 1);
-    if (jerry_value_is_error(file_array_js)) {
-      jerryxx_print_error(file_array_js, true);
+/**
+ * Return a system error from a negative errno
+ */
+#define FS_CHECK_ERROR(ret)                                               \
+  if (ret < 0) {                                                          \
+    return jerry_create_error_from_value(create_system_error(ret), true); \
+  }
+
+/**
+ * Convert open flags given as a string ('r', 'w+', 'ax', ...) or a number
+ * (PWJS_VFS_FLAG_*). Returns -1 for invalid flags. A 'R' modifier (as in
+ * 'rR') tells that the file is accessed at random positions.
+ */
+static int fs_get_flags(jerry_value_t flags_js) {
+  if (jerry_value_is_number(flags_js)) {
+    return (int)jerry_get_number_value(flags_js);
+  }
+  if (!jerry_value_is_string(flags_js)) {
+    return -1;
+  }
+  JERRYXX_GET_STRING_AS_CHAR(flags_js, str)
+  int flags;
+  switch (str[0]) {
+    case 'r':
+      flags = PWJS_VFS_FLAG_READ;
+      break;
+    case 'w':
+      flags = PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE | PWJS_VFS_FLAG_TRUNC;
+      break;
+    case 'a':
+      flags = PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE | PWJS_VFS_FLAG_APPEND;
+      break;
+    default:
+      return -1;
+  }
+  for (char *p = str + 1; *p != '\0'; p++) {
+    if (*p == '+') {
+      flags |= PWJS_VFS_FLAG_READ | PWJS_VFS_FLAG_WRITE;
+    } else if (*p == 'x' && str[0] != 'r') {
+      flags |= PWJS_VFS_FLAG_EXCL;
+    } else if (*p == 'R') {
+      flags |= PWJS_VFS_FLAG_RANDOM;
     } else {
-      int len = jerry_get_array_length(file_array_js);
-      for (int i = 0; i < len; i++) {
-        jerry_value_t file_js = jerry_get_property_by_index(file_array_js, i);
-        jerry_value_t join_args[2] = {cwd_js, file_js};
-        jerry_value_t file_path_js =
-            jerryxx_call_method(path, "join", join_args, 2);
-        jerry_value_t stat_args[1] = {file_path_js};
-        jerry_value_t file_stat_js =
-            jerryxx_call_method(fs, MSTR_FS_STAT, stat_args, 1);
-        jerry_value_t is_dir_js = jerryxx_call_method(
-            file_stat_js, MSTR_FS_STATS_IS_DIRECTORY, NULL, 0);
-        bool is_dir = jerry_get_boolean_value(is_dir_js);
-        int file_size =
-            jerryxx_get_property_number(file_stat_js, MSTR_FS_STATS_SIZE, 0);
-        JERRYXX_GET_STRING_AS_CHAR(file_js, file_name);
-        if (is_dir) {
-          pwjs_repl_printf("<dir>\t%s\r\n", file_name);
-        } else {
-          pwjs_repl_printf("%u\t%s\r\n", file_size, file_name);
-        }
-        jerry_release_value(is_dir_js);
-        jerry_release_value(file_stat_js);
-        jerry_release_value(file_path_js);
-        jerry_release_value(file_js);
+      return -1;
+    }
+  }
+  return flags;
+}
+
+/**
+ * fs.mount()
+ * args:
+ *   path {string}
+ *   vfs {object} a mounted file system object (e.g. VFSLittleFS)
+ */
+JERRYXX_FUN(fs_mount_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_CHECK_ARG_OBJECT(1, "vfs")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  int ret = pwjs_vfs_mount(path, JERRYXX_GET_ARG(1));
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * fs.unmount()
+ * args:
+ *   path {string}
+ * returns {object} the file system object
+ */
+JERRYXX_FUN(fs_unmount_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  jerry_value_t vfs;
+  int ret = pwjs_vfs_unmount(path, &vfs);
+  FS_CHECK_ERROR(ret)
+  return vfs;
+}
+
+/**
+ * fs.cwd()
+ * returns {string}
+ */
+JERRYXX_FUN(fs_cwd_fn) {
+  return jerry_create_string((const jerry_char_t *)pwjs_vfs_getcwd());
+}
+
+/**
+ * fs.chdir()
+ * args:
+ *   path {string}
+ */
+JERRYXX_FUN(fs_chdir_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  int ret = pwjs_vfs_chdir(path);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * fs.open()
+ * args:
+ *   path {string}
+ *   flags {string|number} default 'r'
+ * returns {number} file descriptor
+ */
+JERRYXX_FUN(fs_open_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  int flags = PWJS_VFS_FLAG_READ;
+  if (JERRYXX_HAS_ARG(1) && !jerry_value_is_undefined(JERRYXX_GET_ARG(1))) {
+    flags = fs_get_flags(JERRYXX_GET_ARG(1));
+    if (flags < 0) {
+      return jerry_create_error_from_value(create_system_error(EINVAL), true);
+    }
+  }
+  int fd = pwjs_vfs_open(path, flags);
+  FS_CHECK_ERROR(fd)
+  return jerry_create_number(fd);
+}
+
+/**
+ * fs.close()
+ * args:
+ *   fd {number}
+ */
+JERRYXX_FUN(fs_close_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "fd")
+  int ret = pwjs_vfs_close((int)JERRYXX_GET_ARG_NUMBER(0));
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * Get the range of a read() or write() in its buffer argument
+ * args:
+ *   fd {number}
+ *   buffer {TypedArray}
+ *   offset {number} default 0
+ *   length {number} default to the end of the buffer
+ *   position {number} default the current position
+ */
+#define FS_GET_BUFFER_ARGS(fd, pointer, length, position)                    \
+  JERRYXX_CHECK_ARG_NUMBER(0, "fd")                                          \
+  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")                                  \
+  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")                                  \
+  JERRYXX_CHECK_ARG_NUMBER_OPT(3, "length")                                  \
+  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "position")                                \
+  int fd = (int)JERRYXX_GET_ARG_NUMBER(0);                                   \
+  jerry_length_t byte_offset = 0;                                            \
+  jerry_length_t byte_length = 0;                                            \
+  jerry_value_t arrbuf = jerry_get_typedarray_buffer(                        \
+      JERRYXX_GET_ARG(1), &byte_offset, &byte_length);                       \
+  uint8_t *pointer = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;    \
+  jerry_release_value(arrbuf);                                               \
+  double offset = JERRYXX_GET_ARG_NUMBER_OPT(2, 0);                          \
+  double length = JERRYXX_GET_ARG_NUMBER_OPT(3, byte_length - offset);       \
+  int64_t position = (int64_t)JERRYXX_GET_ARG_NUMBER_OPT(4, -1);             \
+  if (offset < 0 || length < 0 || offset + length > byte_length) {           \
+    return jerry_create_error(JERRY_ERROR_RANGE,                             \
+                              (const jerry_char_t *)"Out of buffer range."); \
+  }                                                                          \
+  pointer += (size_t)offset;
+
+/**
+ * fs.read()
+ * args:
+ *   fd {number}
+ *   buffer {TypedArray}
+ *   offset {number}
+ *   length {number}
+ *   position {number}
+ * returns {number} number of bytes read
+ */
+JERRYXX_FUN(fs_read_fn) {
+  FS_GET_BUFFER_ARGS(fd, pointer, length, position)
+  int ret = pwjs_vfs_read(fd, pointer, (size_t)length, position);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_number(ret);
+}
+
+/**
+ * fs.write()
+ * args:
+ *   fd {number}
+ *   buffer {TypedArray}
+ *   offset {number}
+ *   length {number}
+ *   position {number}
+ * returns {number} number of bytes written
+ */
+JERRYXX_FUN(fs_write_fn) {
+  FS_GET_BUFFER_ARGS(fd, pointer, length, position)
+  int ret = pwjs_vfs_write(fd, pointer, (size_t)length, position);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_number(ret);
+}
+
+/**
+ * fs.stat()
+ * args:
+ *   path {string}
+ * returns {object} {type, size, mtime}
+ */
+JERRYXX_FUN(fs_stat_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  pwjs_vfs_stat_t stat;
+  int ret = pwjs_vfs_stat(path, &stat);
+  FS_CHECK_ERROR(ret)
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, MSTR_FS_STATS_TYPE, stat.type);
+  jerryxx_set_property_number(obj, MSTR_FS_STATS_SIZE, stat.size);
+  jerryxx_set_property_number(obj, MSTR_FS_STATS_MTIME, stat.mtime);
+  return obj;
+}
+
+/**
+ * fs.readdir()
+ * args:
+ *   path {string}
+ * returns {string[]} array of file names
+ */
+JERRYXX_FUN(fs_readdir_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  int fd = pwjs_vfs_opendir(path);
+  FS_CHECK_ERROR(fd)
+  pwjs_vfs_dirent_t entry;
+  jerry_value_t files = jerry_create_array(0);
+  uint32_t count = 0;
+  int ret;
+  while ((ret = pwjs_vfs_readdir(fd, &entry)) > 0) {
+    jerry_value_t name = jerry_create_string((const jerry_char_t *)entry.name);
+    jerry_release_value(jerry_set_property_by_index(files, count++, name));
+    jerry_release_value(name);
+  }
+  pwjs_vfs_closedir(fd);
+  if (ret < 0) {
+    jerry_release_value(files);
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return files;
+}
+
+/**
+ * fs.opendir()
+ * args:
+ *   path {string}
+ * returns {number} directory descriptor
+ */
+JERRYXX_FUN(fs_opendir_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  int fd = pwjs_vfs_opendir(path);
+  FS_CHECK_ERROR(fd)
+  return jerry_create_number(fd);
+}
+
+/**
+ * Read the next entries of a directory descriptor. Only `count` entries
+ * are held in the heap at once, whatever the size of the directory.
+ * args:
+ *   fd {number}
+ *   count {number} maximum number of entries
+ *   stats {boolean} add size and mtime to the entries
+ * returns {object[]} entries {name, type, size, mtime}, empty at the end
+ */
+JERRYXX_FUN(fs_dir_read_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "fd")
+  JERRYXX_CHECK_ARG_NUMBER(1, "count")
+  JERRYXX_CHECK_ARG_BOOLEAN_OPT(2, "stats")
+  int fd = (int)JERRYXX_GET_ARG_NUMBER(0);
+  uint32_t count = (uint32_t)JERRYXX_GET_ARG_NUMBER(1);
+  bool stats = JERRYXX_GET_ARG_BOOLEAN_OPT(2, false);
+  pwjs_vfs_dirent_t entry;
+  jerry_value_t entries = jerry_create_array(0);
+  uint32_t index = 0;
+  int ret = 0;
+  while (index < count && (ret = pwjs_vfs_readdir(fd, &entry)) > 0) {
+    jerry_value_t obj = jerry_create_object();
+    jerryxx_set_property_string(obj, MSTR_FS_DIRENT_NAME, entry.name);
+    jerryxx_set_property_number(obj, MSTR_FS_STATS_TYPE, entry.type);
+    if (stats) {
+      jerryxx_set_property_number(obj, MSTR_FS_STATS_SIZE, entry.size);
+      jerryxx_set_property_number(obj, MSTR_FS_STATS_MTIME, entry.mtime);
+    }
+    jerry_release_value(jerry_set_property_by_index(entries, index++, obj));
+    jerry_release_value(obj);
+  }
+  if (ret < 0) {
+    jerry_release_value(entries);
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return entries;
+}
+
+/**
+ * Close a directory descriptor
+ * args:
+ *   fd {number}
+ */
+JERRYXX_FUN(fs_closedir_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "fd")
+  int ret = pwjs_vfs_closedir((int)JERRYXX_GET_ARG_NUMBER(0));
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * fs.mkdir(), fs.unlink(), fs.rmdir()
+ * args:
+ *   path {string}
+ */
+#define FS_PATH_FUN(name, fn)               \
+  JERRYXX_FUN(name) {                       \
+    JERRYXX_CHECK_ARG_STRING(0, "path")     \
+    JERRYXX_GET_ARG_STRING_AS_CHAR(0, path) \
+    int ret = fn(path);                     \
+    FS_CHECK_ERROR(ret)                     \
+    return jerry_create_undefined();        \
+  }
+
+FS_PATH_FUN(fs_mkdir_fn, pwjs_vfs_mkdir)
+FS_PATH_FUN(fs_unlink_fn, pwjs_vfs_unlink)
+FS_PATH_FUN(fs_rmdir_fn, pwjs_vfs_rmdir)
+
+/**
+ * fs.rename()
+ * args:
+ *   oldPath {string}
+ *   newPath {string}
+ */
+JERRYXX_FUN(fs_rename_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "oldPath")
+  JERRYXX_CHECK_ARG_STRING(1, "newPath")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, old_path)
+  JERRYXX_GET_ARG_STRING_AS_CHAR(1, new_path)
+  int ret = pwjs_vfs_rename(old_path, new_path);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * Get the encoding of the options of readFile() and writeFile(), given as
+ * a string or as an `encoding` property. Returns 1 for UTF-8, 0 for none
+ * (raw bytes) and -1 for an unsupported encoding.
+ */
+static int fs_get_encoding(jerry_value_t options) {
+  jerry_value_t encoding_js;
+  if (jerry_value_is_object(options)) {
+    encoding_js = jerryxx_get_property(options, MSTR_FS_ENCODING);
+  } else {
+    encoding_js = jerry_acquire_value(options);
+  }
+  int encoding = 0;
+  if (jerry_value_is_string(encoding_js)) {
+    JERRYXX_GET_STRING_AS_CHAR(encoding_js, name)
+    encoding = (strcmp(name, "utf8") == 0 || strcmp(name, "utf-8") == 0)
+                   ? 1
+                   : -1;
+  } else if (!jerry_value_is_undefined(encoding_js) &&
+             !jerry_value_is_null(encoding_js)) {
+    encoding = -1;
+  }
+  jerry_release_value(encoding_js);
+  return encoding;
+}
+
+/**
+ * Read until the buffer is full or the end of file. Returns the number of
+ * bytes read.
+ */
+static int fs_read_all(int fd, uint8_t *buffer, size_t size) {
+  size_t total = 0;
+  while (total < size) {
+    int ret = pwjs_vfs_read(fd, buffer + total, size - total, -1);
+    if (ret < 0) {
+      return ret;
+    }
+    if (ret == 0) {
+      break;
+    }
+    total += ret;
+  }
+  return total;
+}
+
+static int fs_write_all(int fd, const uint8_t *buffer, size_t size) {
+  size_t total = 0;
+  while (total < size) {
+    int ret = pwjs_vfs_write(fd, buffer + total, size - total, -1);
+    if (ret < 0) {
+      return ret;
+    }
+    if (ret == 0) {
+      return ENOSPC;
+    }
+    total += ret;
+  }
+  return total;
+}
+
+/**
+ * Read a file opened for readFile() into a new Uint8Array, a string or the
+ * caller's buffer
+ */
+static jerry_value_t fs_read_file(int fd, uint32_t size, int encoding,
+                                  jerry_value_t buffer) {
+  int ret;
+  if (jerry_value_is_typedarray(buffer)) {
+    jerry_length_t byte_offset = 0;
+    jerry_length_t byte_length = 0;
+    jerry_value_t arrbuf =
+        jerry_get_typedarray_buffer(buffer, &byte_offset, &byte_length);
+    uint8_t *pointer = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+    jerry_release_value(arrbuf);
+    ret = fs_read_all(fd, pointer, size < byte_length ? size : byte_length);
+    FS_CHECK_ERROR(ret)
+    return jerry_create_number(ret);
+  }
+  if (encoding == 1) {
+    uint8_t *data = pwjs_malloc(PWJS_MEM_VFS, size > 0 ? size : 1);
+    if (data == NULL) {
+      return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+    }
+    ret = fs_read_all(fd, data, size);
+    jerry_value_t str = jerry_create_undefined();
+    if (ret >= 0) {
+      // binary files or a cut multi-byte sequence are not valid UTF-8
+      if (jerry_is_valid_utf8_string(data, (jerry_size_t)ret)) {
+        str = jerry_create_string_sz_from_utf8(data, (jerry_size_t)ret);
+      } else {
+        str = jerry_create_error(JERRY_ERROR_TYPE,
+                                 (const jerry_char_t *)"Invalid UTF-8 data.");
       }
     }
-    jerry_release_value(file_array_js);
+    pwjs_free(data);
+    FS_CHECK_ERROR(ret)
+    return str;
+  }
+  jerry_value_t array = jerry_create_typedarray(JERRY_TYPEDARRAY_UINT8, size);
+  if (jerry_value_is_error(array)) {
+    return array;
+  }
+  ret = fs_read_all(fd, jerryxx_get_typedarray_buffer(array), size);
+  if (ret < 0) {
+    jerry_release_value(array);
+    return jerry_create_error_from_value(create_system_error(ret), true);
   }
-  jerry_release_value(cwd_js);
-  jerry_release_value(path);
-  jerry_release_value(fs);
+  if ((uint32_t)ret < size) {  // the file was truncated meanwhile
+    jerry_length_t byte_offset = 0;
+    jerry_length_t byte_length = 0;
+    jerry_value_t arrbuf =
+        jerry_get_typedarray_buffer(array, &byte_offset, &byte_length);
+    jerry_value_t view = jerry_create_typedarray_for_arraybuffer_sz(
+        JERRY_TYPEDARRAY_UINT8, arrbuf, 0, ret);
+    jerry_release_value(arrbuf);
+    jerry_release_value(array);
+    return view;
+  }
+  return array;
 }
 
-static void cmd_pwd(pwjs_repl_state_t *state, char *arg) {
-  jerry_value_t fs = jerryxx_call_require("fs");
-  jerry_value_t ret = jerryxx_call_method(fs, MSTR_FS_CWD, NULL, 0);
-  if (jerry_value_is_error(ret)) {
-    jerryxx_print_error(ret, true);
+/**
+ * fs.readFile()
+ * args:
+ *   path {string}
+ *   options {string|object} encoding, or
+ *     encoding {string} 'utf8' to return a string
+ *     buffer {TypedArray} read into this buffer (up to its length) and
+ *       return the number of bytes read
+ * returns {Uint8Array|string|number}
+ */
+JERRYXX_FUN(fs_read_file_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  jerry_value_t options =
+      JERRYXX_HAS_ARG(1) ? JERRYXX_GET_ARG(1) : jerry_create_undefined();
+  int encoding = fs_get_encoding(options);
+  if (encoding < 0) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+  pwjs_vfs_stat_t stat;
+  int ret = pwjs_vfs_stat(path, &stat);
+  FS_CHECK_ERROR(ret)
+  if (stat.type == PWJS_VFS_TYPE_DIR) {
+    return jerry_create_error_from_value(create_system_error(EISDIR), true);
+  }
+  int fd = pwjs_vfs_open(path, PWJS_VFS_FLAG_READ);
+  FS_CHECK_ERROR(fd)
+  jerry_value_t buffer = jerry_value_is_object(options)
+                             ? jerryxx_get_property(options, MSTR_FS_BUFFER)
+                             : jerry_create_undefined();
+  jerry_value_t result = fs_read_file(fd, stat.size, encoding, buffer);
+  jerry_release_value(buffer);
+  pwjs_vfs_close(fd);
+  return result;
+}
+
+/**
+ * Get the bytes of a string (in UTF-8) or a TypedArray. A string is copied
+ * into *str which the caller must free. Returns a negative errno, or 1 if
+ * data has a wrong type.
+ */
+static int fs_get_data(jerry_value_t data, const uint8_t **pointer,
+                       size_t *size, uint8_t **str) {
+  *str = NULL;
+  if (jerry_value_is_typedarray(data)) {
+    jerry_length_t byte_offset = 0;
+    jerry_length_t byte_length = 0;
+    jerry_value_t arrbuf =
+        jerry_get_typedarray_buffer(data, &byte_offset, &byte_length);
+    *pointer = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+    *size = byte_length;
+    jerry_release_value(arrbuf);
+  } else if (jerry_value_is_string(data)) {
+    *size = jerry_get_utf8_string_size(data);
+    *str = pwjs_malloc(PWJS_MEM_VFS, *size > 0 ? *size : 1);
+    if (*str == NULL) {
+      return ENOMEM;
+    }
+    jerry_string_to_utf8_char_buffer(data, *str, *size);
+    *pointer = *str;
   } else {
-    JERRYXX_GET_STRING_AS_CHAR(ret, cwd);
-    pwjs_repl_printf("%s\r\n", cwd);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Return a TypeError if fs_get_data() failed on the type of data
+ */
+#define FS_CHECK_DATA(ret)                                               \
+  if (ret > 0) {                                                         \
+    return jerry_create_error(                                           \
+        JERRY_ERROR_TYPE,                                                \
+        (const jerry_char_t *)"\"data\" argument must be a string or a " \
+                              "TypedArray");                             \
+  }                                                                      \
+  FS_CHECK_ERROR(ret)
+
+/**
+ * Write data (a string or a TypedArray) to a file
+ */
+static jerry_value_t fs_write_file(const char *path, jerry_value_t data,
+                                   jerry_value_t options, int flags) {
+  if (fs_get_encoding(options) < 0) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
   }
-  jerry_release_value(ret);
-  jerry_release_value(fs);
+  if (jerry_value_is_object(options)) {
+    jerry_value_t flag_js = jerryxx_get_property(options, MSTR_FS_FLAG);
+    if (!jerry_value_is_undefined(flag_js)) {
+      flags = fs_get_flags(flag_js);
+    }
+    jerry_release_value(flag_js);
+    if (flags < 0) {
+      return jerry_create_error_from_value(create_system_error(EINVAL), true);
+    }
+  }
+  const uint8_t *pointer;
+  size_t size;
+  uint8_t *str;
+  int ret = fs_get_data(data, &pointer, &size, &str);
+  FS_CHECK_DATA(ret)
+  int fd = pwjs_vfs_open(path, flags);
+  ret = fd;
+  if (fd >= 0) {
+    ret = fs_write_all(fd, pointer, size);
+    int close_ret = pwjs_vfs_close(fd);
+    if (ret >= 0) {
+      ret = close_ret;
+    }
+  }
+  pwjs_free(str);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * fs.writeFile()
+ * args:
+ *   path {string}
+ *   data {string|TypedArray} strings are written in UTF-8
+ *   options {string|object} encoding, or
+ *     encoding {string} 'utf8'
+ *     flag {string} default 'w'
+ */
+JERRYXX_FUN(fs_write_file_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_CHECK_ARG(1, "data")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  return fs_write_file(
+      path, JERRYXX_GET_ARG(1),
+      JERRYXX_HAS_ARG(2) ? JERRYXX_GET_ARG(2) : jerry_create_undefined(),
+      PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE | PWJS_VFS_FLAG_TRUNC);
+}
+
+/**
+ * fs.appendFile()
+ * args: see fs.writeFile(), the default flag is 'a'
+ */
+JERRYXX_FUN(fs_append_file_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_CHECK_ARG(1, "data")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  return fs_write_file(
+      path, JERRYXX_GET_ARG(1),
+      JERRYXX_HAS_ARG(2) ? JERRYXX_GET_ARG(2) : jerry_create_undefined(),
+      PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE | PWJS_VFS_FLAG_APPEND);
+}
+
+/**
+ * Chunk size of copies: a flash sector, so each chunk is one erase and
+ * whole page programs on the internal flash
+ */
+#define FS_COPY_CHUNK_SIZE 4096
+
+/**
+ * Copy a file in chunks through the given buffer. The copied size is added
+ * to `copied`.
+ */
+static int fs_copy_file(const char *src, const char *dest, uint8_t *buffer,
+                        uint32_t *copied) {
+  int src_fd = pwjs_vfs_open(src, PWJS_VFS_FLAG_READ);
+  if (src_fd < 0) {
+    return src_fd;
+  }
+  int dest_fd = pwjs_vfs_open(
+      dest, PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE | PWJS_VFS_FLAG_TRUNC);
+  if (dest_fd < 0) {
+    pwjs_vfs_close(src_fd);
+    return dest_fd;
+  }
+  int ret;
+  while ((ret = pwjs_vfs_read(src_fd, buffer, FS_COPY_CHUNK_SIZE, -1)) > 0) {
+    ret = fs_write_all(dest_fd, buffer, ret);
+    if (ret < 0) {
+      break;
+    }
+    *copied += ret;
+  }
+  int close_ret = pwjs_vfs_close(dest_fd);
+  pwjs_vfs_close(src_fd);
+  return ret < 0 ? ret : close_ret;
+}
+
+/**
+ * Copy a file, or a directory with its content. The paths are resolved
+ * and a directory is not copied into itself.
+ */
+static int fs_copy(const char *src, const char *dest, uint8_t *buffer,
+                   uint32_t *copied) {
+  char src_path[PWJS_VFS_PATH_MAX];
+  char dest_path[PWJS_VFS_PATH_MAX];
+  int ret = pwjs_vfs_resolve(src, src_path);
+  if (ret == 0) {
+    ret = pwjs_vfs_resolve(dest, dest_path);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  size_t length = strlen(src_path);
+  if (strncmp(src_path, dest_path, length) == 0 &&
+      (dest_path[length] == '\0' || dest_path[length] == '/' ||
+       length == 1)) {
+    return EINVAL;
+  }
+  pwjs_vfs_stat_t stat;
+  ret = pwjs_vfs_stat(src_path, &stat);
+  if (ret < 0) {
+    return ret;
+  }
+  if (stat.type != PWJS_VFS_TYPE_DIR) {
+    return fs_copy_file(src_path, dest_path, buffer, copied);
+  }
+  ret = pwjs_vfs_mkdir(dest_path);
+  if (ret < 0 && ret != EEXIST) {
+    return ret;
+  }
+  int fd = pwjs_vfs_opendir(src_path);
+  if (fd < 0) {
+    return fd;
+  }
+  pwjs_vfs_dirent_t entry;
+  while ((ret = pwjs_vfs_readdir(fd, &entry)) > 0) {
+    if (strlen(src_path) + strlen(entry.name) + 2 > PWJS_VFS_PATH_MAX ||
+        strlen(dest_path) + strlen(entry.name) + 2 > PWJS_VFS_PATH_MAX) {
+      ret = ENAMETOOLONG;
+      break;
+    }
+    char child_src[PWJS_VFS_PATH_MAX];
+    char child_dest[PWJS_VFS_PATH_MAX];
+    sprintf(child_src, "%s/%s", length > 1 ? src_path : "", entry.name);
+    sprintf(child_dest, "%s/%s", strcmp(dest_path, "/") ? dest_path : "",
+            entry.name);
+    ret = fs_copy(child_src, child_dest, buffer, copied);
+    if (ret < 0) {
+      break;
+    }
+  }
+  pwjs_vfs_closedir(fd);
+  return ret;
+}
+
+/**
+ * fs.copyFile()
+ * Copy a file natively in chunks, without going through the heap
+ * args:
+ *   src {string}
+ *   dest {string} overwritten if it exists
+ */
+JERRYXX_FUN(fs_copy_file_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "src")
+  JERRYXX_CHECK_ARG_STRING(1, "dest")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, src)
+  JERRYXX_GET_ARG_STRING_AS_CHAR(1, dest)
+  pwjs_vfs_stat_t stat;
+  int ret = pwjs_vfs_stat(src, &stat);
+  FS_CHECK_ERROR(ret)
+  if (stat.type == PWJS_VFS_TYPE_DIR) {
+    return jerry_create_error_from_value(create_system_error(EISDIR), true);
+  }
+  uint8_t *buffer = pwjs_malloc(PWJS_MEM_VFS, FS_COPY_CHUNK_SIZE);
+  if (buffer == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  uint32_t copied = 0;
+  ret = fs_copy(src, dest, buffer, &copied);
+  pwjs_free(buffer);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * Number of chunk buffers a read stream cycles through. A chunk is
+ * overwritten once the stream has delivered this many more chunks.
+ */
+#define FS_STREAM_POOL_SIZE 2
+
+/**
+ * Read stream handle. Chunks are read in the I/O loop directly into a pool
+ * of ArrayBuffers allocated once, so streaming a file of any size does not
+ * grow the heap.
+ */
+typedef struct {
+  pwjs_io_file_handle_t base;
+  int64_t position;    // position of the next read, -1 for the current one
+  uint32_t remaining;  // bytes to read until the end of the range
+  uint32_t chunk_size;
+  jerry_value_t pool[FS_STREAM_POOL_SIZE];
+  uint8_t pool_index;
+  jerry_value_t js_cb;
+} fs_read_stream_t;
+
+/**
+ * Write stream handle. Written data is copied into a bounded queue which is
+ * written to the file in the I/O loop. Data not fitting the queue is
+ * written through synchronously.
+ */
+typedef struct {
+  pwjs_io_file_handle_t base;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t size;
+  bool drain;  // call js_cb when the queue becomes empty
+  jerry_value_t js_cb;
+  uint8_t queue[];
+} fs_write_stream_t;
+
+static void fs_write_stream_cb(pwjs_io_file_handle_t *handle);
+static void fs_io_cb(pwjs_io_file_handle_t *handle);
+
+static void fs_stream_close_cb(pwjs_io_handle_t *handle) { pwjs_free(handle); }
+
+static void fs_stream_call(jerry_value_t js_cb, jerry_value_t *args_p,
+                           jerry_size_t args_cnt) {
+  jerry_value_t this_val = jerry_create_undefined();
+  jerry_value_t ret_val =
+      jerry_call_function(js_cb, this_val, args_p, args_cnt);
+  if (jerry_value_is_error(ret_val)) {
+    jerryxx_print_error(ret_val, true);
+  }
+  jerry_release_value(ret_val);
+  jerry_release_value(this_val);
+}
+
+/**
+ * Write the queued data of a write stream
+ */
+static int fs_write_stream_flush(fs_write_stream_t *stream) {
+  int ret = fs_write_all(stream->base.fd, stream->queue + stream->head,
+                         stream->tail - stream->head);
+  stream->head = 0;
+  stream->tail = 0;
+  return ret;
+}
+
+/**
+ * Flush a write stream, close the file and release the handle. Returns the
+ * first error.
+ */
+static int fs_stream_close(pwjs_io_file_handle_t *handle) {
+  int ret = 0;
+  if (handle->file_cb == fs_write_stream_cb) {
+    fs_write_stream_t *stream = (fs_write_stream_t *)handle;
+    ret = fs_write_stream_flush(stream);
+    jerry_release_value(stream->js_cb);
+  } else {
+    fs_read_stream_t *stream = (fs_read_stream_t *)handle;
+    for (int i = 0; i < FS_STREAM_POOL_SIZE; i++) {
+      jerry_release_value(stream->pool[i]);
+    }
+    jerry_release_value(stream->js_cb);
+  }
+  int close_ret = pwjs_vfs_close(handle->fd);
+  if (ret >= 0) {
+    ret = close_ret;
+  }
+  pwjs_io_file_stop(handle);
+  pwjs_io_handle_close((pwjs_io_handle_t *)handle, fs_stream_close_cb);
+  return ret;
+}
+
+/**
+ * Read a chunk and pass it to the JS callback as callback(err, chunk). The
+ * chunk is null at the end of the range, the stream is closed then.
+ */
+static void fs_read_stream_cb(pwjs_io_file_handle_t *handle) {
+  fs_read_stream_t *stream = (fs_read_stream_t *)handle;
+  jerry_value_t arrbuf = stream->pool[stream->pool_index];
+  size_t length = stream->remaining < stream->chunk_size ? stream->remaining
+                                                         : stream->chunk_size;
+  int ret = 0;
+  if (length > 0) {
+    ret = pwjs_vfs_read(handle->fd, jerry_get_arraybuffer_pointer(arrbuf),
+                        length, stream->position);
+    stream->position = -1;
+  }
+  // the callback may close the stream
+  jerry_value_t js_cb = jerry_acquire_value(stream->js_cb);
+  jerry_value_t args_p[2];
+  if (ret > 0) {
+    stream->remaining -= ret;
+    stream->pool_index = (stream->pool_index + 1) % FS_STREAM_POOL_SIZE;
+    args_p[0] = jerry_create_undefined();
+    args_p[1] = jerry_create_typedarray_for_arraybuffer_sz(
+        JERRY_TYPEDARRAY_UINT8, arrbuf, 0, ret);
+  } else {
+    int close_ret = fs_stream_close(handle);
+    if (ret == 0) {
+      ret = close_ret;
+    }
+    args_p[0] = ret < 0 ? create_system_error(ret) : jerry_create_undefined();
+    args_p[1] = jerry_create_null();
+  }
+  fs_stream_call(js_cb, args_p, 2);
+  jerry_release_value(args_p[0]);
+  jerry_release_value(args_p[1]);
+  jerry_release_value(js_cb);
+}
+
+/**
+ * Write the queued data and call the JS callback as callback(err) on an
+ * error, or as callback() when a full queue has been drained.
+ */
+static void fs_write_stream_cb(pwjs_io_file_handle_t *handle) {
+  fs_write_stream_t *stream = (fs_write_stream_t *)handle;
+  int ret = 0;
+  if (stream->tail > stream->head) {
+    ret = pwjs_vfs_write(handle->fd, stream->queue + stream->head,
+                         stream->tail - stream->head, -1);
+    if (ret == 0) {
+      ret = ENOSPC;
+    }
+  }
+  if (ret > 0) {
+    stream->head += ret;
+    if (stream->head < stream->tail) {
+      return;
+    }
+  }
+  // empty (or failed) queue, wait for the next write
+  stream->head = 0;
+  stream->tail = 0;
+  pwjs_io_file_pause(handle);
+  if (ret < 0 || stream->drain) {
+    stream->drain = false;
+    jerry_value_t js_cb = jerry_acquire_value(stream->js_cb);
+    jerry_value_t error =
+        ret < 0 ? create_system_error(ret) : jerry_create_undefined();
+    fs_stream_call(js_cb, &error, 1);
+    jerry_release_value(error);
+    jerry_release_value(js_cb);
+  }
+}
+
+/**
+ * fs.createReadStream()
+ * args:
+ *   path {string}
+ *   start {number} position of the first byte
+ *   length {number} bytes to read, -1 to read to the end of file
+ *   chunkSize {number}
+ *   callback {Function} (err, chunk)
+ * returns {number} the stream handle id
+ */
+JERRYXX_FUN(fs_create_read_stream_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_CHECK_ARG_NUMBER(1, "start")
+  JERRYXX_CHECK_ARG_NUMBER(2, "length")
+  JERRYXX_CHECK_ARG_NUMBER(3, "chunkSize")
+  JERRYXX_CHECK_ARG_FUNCTION(4, "callback")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  double start = JERRYXX_GET_ARG_NUMBER(1);
+  double length = JERRYXX_GET_ARG_NUMBER(2);
+  double chunk_size = JERRYXX_GET_ARG_NUMBER(3);
+  if (start < 0 || chunk_size < 1) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+  int fd = pwjs_vfs_open(path, PWJS_VFS_FLAG_READ);
+  FS_CHECK_ERROR(fd)
+  fs_read_stream_t *stream =
+      pwjs_malloc(PWJS_MEM_VFS, sizeof(fs_read_stream_t));
+  if (stream == NULL) {
+    pwjs_vfs_close(fd);
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  pwjs_io_file_init(&stream->base);
+  stream->position = (int64_t)start;
+  stream->remaining =
+      (length < 0 || length > UINT32_MAX) ? UINT32_MAX : (uint32_t)length;
+  stream->chunk_size = (uint32_t)chunk_size;
+  for (int i = 0; i < FS_STREAM_POOL_SIZE; i++) {
+    stream->pool[i] = jerry_create_arraybuffer(stream->chunk_size);
+  }
+  stream->pool_index = 0;
+  stream->js_cb = jerry_acquire_value(JERRYXX_GET_ARG(4));
+  pwjs_io_file_start(&stream->base, fd, fs_read_stream_cb);
+  return jerry_create_number(stream->base.base.id);
+}
+
+/**
+ * fs.createWriteStream()
+ * args:
+ *   path {string}
+ *   flags {string|number}
+ *   highWaterMark {number} size of the write queue
+ *   callback {Function} (err), called without err on 'drain'
+ * returns {number} the stream handle id
+ */
+JERRYXX_FUN(fs_create_write_stream_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_CHECK_ARG(1, "flags")
+  JERRYXX_CHECK_ARG_NUMBER(2, "highWaterMark")
+  JERRYXX_CHECK_ARG_FUNCTION(3, "callback")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  int flags = fs_get_flags(JERRYXX_GET_ARG(1));
+  double size = JERRYXX_GET_ARG_NUMBER(2);
+  if (flags < 0 || size < 1) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+  fs_write_stream_t *stream =
+      pwjs_malloc(PWJS_MEM_VFS, sizeof(fs_write_stream_t) + (size_t)size);
+  if (stream == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  int fd = pwjs_vfs_open(path, flags);
+  if (fd < 0) {
+    pwjs_free(stream);
+    return jerry_create_error_from_value(create_system_error(fd), true);
+  }
+  pwjs_io_file_init(&stream->base);
+  stream->head = 0;
+  stream->tail = 0;
+  stream->size = (uint32_t)size;
+  stream->drain = false;
+  stream->js_cb = jerry_acquire_value(JERRYXX_GET_ARG(3));
+  pwjs_io_file_start(&stream->base, fd, fs_write_stream_cb);
+  pwjs_io_file_pause(&stream->base);
+  return jerry_create_number(stream->base.base.id);
+}
+
+/**
+ * Get the stream handle of the id given as the first argument
+ */
+#define FS_GET_STREAM(handle)                                               \
+  JERRYXX_CHECK_ARG_NUMBER(0, "id")                                         \
+  pwjs_io_file_handle_t *handle =                                           \
+      pwjs_io_file_get_by_id((uint32_t)JERRYXX_GET_ARG_NUMBER(0));          \
+  if (handle == NULL || handle->file_cb == fs_io_cb) {                      \
+    return jerry_create_error_from_value(create_system_error(EBADF), true); \
+  }
+
+/**
+ * Queue data on a write stream
+ * args:
+ *   id {number}
+ *   data {string|TypedArray}
+ * returns {boolean} false if the queue is full, callback() is called once
+ *   it has been drained
+ */
+JERRYXX_FUN(fs_stream_write_fn) {
+  FS_GET_STREAM(handle)
+  JERRYXX_CHECK_ARG(1, "data")
+  if (handle->file_cb != fs_write_stream_cb) {
+    return jerry_create_error_from_value(create_system_error(EBADF), true);
+  }
+  fs_write_stream_t *stream = (fs_write_stream_t *)handle;
+  const uint8_t *pointer;
+  size_t size;
+  uint8_t *str;
+  int ret = fs_get_data(JERRYXX_GET_ARG(1), &pointer, &size, &str);
+  FS_CHECK_DATA(ret)
+  if (size > stream->size - stream->tail && stream->head > 0) {
+    memmove(stream->queue, stream->queue + stream->head,
+            stream->tail - stream->head);
+    stream->tail -= stream->head;
+    stream->head = 0;
+  }
+  if (size <= stream->size - stream->tail) {
+    memcpy(stream->queue + stream->tail, pointer, size);
+    stream->tail += size;
+    pwjs_io_file_resume(handle);
+  } else {
+    // write through, keeping the order of the data
+    ret = fs_write_stream_flush(stream);
+    if (ret >= 0) {
+      ret = fs_write_all(handle->fd, pointer, size);
+    }
+  }
+  pwjs_free(str);
+  FS_CHECK_ERROR(ret)
+  if (stream->tail - stream->head < stream->size) {
+    return jerry_create_boolean(true);
+  }
+  stream->drain = true;
+  return jerry_create_boolean(false);
+}
+
+/**
+ * Stop reading chunks of a read stream
+ * args:
+ *   id {number}
+ */
+JERRYXX_FUN(fs_stream_pause_fn) {
+  FS_GET_STREAM(handle)
+  if (handle->file_cb != fs_write_stream_cb) {
+    pwjs_io_file_pause(handle);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Resume reading chunks of a read stream
+ * args:
+ *   id {number}
+ */
+JERRYXX_FUN(fs_stream_resume_fn) {
+  FS_GET_STREAM(handle)
+  if (handle->file_cb != fs_write_stream_cb) {
+    pwjs_io_file_resume(handle);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Close a stream. The queue of a write stream is flushed first. Closing a
+ * stream which already ended does nothing.
+ * args:
+ *   id {number}
+ */
+JERRYXX_FUN(fs_stream_close_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "id")
+  pwjs_io_file_handle_t *handle =
+      pwjs_io_file_get_by_id((uint32_t)JERRYXX_GET_ARG_NUMBER(0));
+  if (handle != NULL && handle->file_cb != fs_io_cb) {
+    int ret = fs_stream_close(handle);
+    FS_CHECK_ERROR(ret)
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * Time budget (ms) and chunk size of the chunked reads and writes of
+ * fs.promises. A job moves chunks until its budget of the loop iteration
+ * is spent, and at least one chunk per iteration.
+ */
+static uint32_t fs_io_budget = 5;
+static uint32_t fs_io_chunk_size = 1024;
+
+/**
+ * Chunked read or write of a buffer, driven by the I/O loop. The file
+ * descriptor remains owned by the caller.
+ */
+typedef struct {
+  pwjs_io_file_handle_t base;
+  bool write;
+  int64_t position;  // position of the next chunk, -1 for the current one
+  uint8_t *pointer;
+  uint32_t length;
+  uint32_t done;
+  jerry_value_t buffer;  // keeps the data alive
+  jerry_value_t js_cb;
+} fs_io_t;
+
+static void fs_io_cb(pwjs_io_file_handle_t *handle) {
+  fs_io_t *io = (fs_io_t *)handle;
+  uint64_t start = pwjs_gettime();
+  int ret = 0;
+  do {
+    uint32_t size = io->length - io->done;
+    if (size > fs_io_chunk_size) {
+      size = fs_io_chunk_size;
+    }
+    if (size == 0) {
+      break;
+    }
+    ret = io->write ? pwjs_vfs_write(handle->fd, io->pointer + io->done, size,
+                                     io->position)
+                    : pwjs_vfs_read(handle->fd, io->pointer + io->done, size,
+                                    io->position);
+    if (ret == 0 && io->write) {
+      ret = ENOSPC;
+    }
+    if (ret > 0) {
+      io->done += ret;
+      if (io->position >= 0) {
+        io->position += ret;
+      }
+    }
+  } while (ret > 0 && pwjs_gettime() - start < fs_io_budget);
+  if (ret > 0 && io->done < io->length) {
+    return;  // continue in the next iteration
+  }
+  // done, at the end of file or failed
+  jerry_value_t js_cb = io->js_cb;
+  jerry_value_t args_p[2] = {
+      ret < 0 ? create_system_error(ret) : jerry_create_undefined(),
+      jerry_create_number(io->done)};
+  jerry_release_value(io->buffer);
+  pwjs_io_file_stop(handle);
+  pwjs_io_handle_close((pwjs_io_handle_t *)handle, fs_stream_close_cb);
+  fs_stream_call(js_cb, args_p, 2);
+  jerry_release_value(args_p[0]);
+  jerry_release_value(args_p[1]);
+  jerry_release_value(js_cb);
+}
+
+/**
+ * Start a chunked read or write
+ * args:
+ *   fd {number}
+ *   write {boolean}
+ *   buffer {TypedArray} data to write, or to read into
+ *   position {number} -1 for the current position
+ *   callback {Function} (err, bytes)
+ */
+JERRYXX_FUN(fs_io_start_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "fd")
+  JERRYXX_CHECK_ARG_BOOLEAN(1, "write")
+  JERRYXX_CHECK_ARG_TYPEDARRAY(2, "buffer")
+  JERRYXX_CHECK_ARG_NUMBER(3, "position")
+  JERRYXX_CHECK_ARG_FUNCTION(4, "callback")
+  fs_io_t *io = pwjs_malloc(PWJS_MEM_VFS, sizeof(fs_io_t));
+  if (io == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  jerry_length_t byte_offset = 0;
+  jerry_length_t byte_length = 0;
+  jerry_value_t arrbuf = jerry_get_typedarray_buffer(
+      JERRYXX_GET_ARG(2), &byte_offset, &byte_length);
+  pwjs_io_file_init(&io->base);
+  io->write = JERRYXX_GET_ARG_BOOLEAN(1);
+  double position = JERRYXX_GET_ARG_NUMBER(3);
+  io->position = position < 0 ? -1 : (int64_t)position;
+  io->pointer = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+  io->length = byte_length;
+  io->done = 0;
+  io->buffer = arrbuf;
+  io->js_cb = jerry_acquire_value(JERRYXX_GET_ARG(4));
+  pwjs_io_file_start(&io->base, (int)JERRYXX_GET_ARG_NUMBER(0), fs_io_cb);
+  return jerry_create_undefined();
+}
+
+/**
+ * fs.configureIo()
+ * args:
+ *   budget {number} time budget of a job per loop iteration in ms
+ *   chunkSize {number}
+ */
+JERRYXX_FUN(fs_configure_io_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "budget")
+  JERRYXX_CHECK_ARG_NUMBER(1, "chunkSize")
+  double budget = JERRYXX_GET_ARG_NUMBER(0);
+  double chunk_size = JERRYXX_GET_ARG_NUMBER(1);
+  if (budget < 0 || budget > 1000 || chunk_size < 1 ||
+      chunk_size > 0x100000) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+  fs_io_budget = (uint32_t)budget;
+  fs_io_chunk_size = (uint32_t)chunk_size;
+  return jerry_create_undefined();
+}
+
+/**
+ * Print an error of a REPL command. Returns true if there was an error.
+ */
+static bool print_error(int err) {
+  if (err >= 0) {
+    return false;
+  }
+  jerry_value_t error = create_system_error(err);
+  jerryxx_print_error(error, false);
+  jerry_release_value(error);
+  return true;
+}
+
+static bool check_arg(char *arg) {
+  if (arg == NULL) {
+    return !print_error(EINVAL);
+  }
+  return true;
+}
+
+static void cmd_ls(pwjs_repl_state_t *state, char *arg) {
+  int fd = pwjs_vfs_opendir(arg != NULL ? arg : pwjs_vfs_getcwd());
+  if (print_error(fd)) {
+    return;
+  }
+  pwjs_vfs_dirent_t entry;
+  int ret;
+  while ((ret = pwjs_vfs_readdir(fd, &entry)) > 0) {
+    if (entry.type == PWJS_VFS_TYPE_DIR) {
+      pwjs_repl_printf("<dir>\t%s\r\n", entry.name);
+    } else {
+      pwjs_repl_printf("%u\t%s\r\n", entry.size, entry.name);
+    }
+  }
+  pwjs_vfs_closedir(fd);
+  print_error(ret);
+}
+
+static void cmd_pwd(pwjs_repl_state_t *state, char *arg) {
+  pwjs_repl_printf("%s\r\n", pwjs_vfs_getcwd());
 }
 
 static void cmd_cd(pwjs_repl_state_t *state, char *arg) {
-  jerry_value_t fs = jerryxx_call_require("fs");
-  jerry_value_t path_js = jerry_create_string((const jerry_char_t *)arg);
-  jerry_value_t args_js[1] = {path_js};
-  jerry_value_t ret = jerryxx_call_method(fs, MSTR_FS_CHDIR, args_js, 1);
-  if (jerry_value_is_error(ret)) {
-    jerryxx_print_error(ret, true);
+  if (check_arg(arg)) {
+    print_error(pwjs_vfs_chdir(arg));
   }
-  jerry_release_value(ret);
-  jerry_release_value(path_js);
-  jerry_release_value(fs);
 }
 
 static void cmd_mkdir(pwjs_repl_state_t *state, char *arg) {
-  jerry_value_t fs = jerryxx_call_require("fs");
-  jerry_value_t path_js = jerry_create_string((const jerry_char_t *)arg);
-  jerry_value_t args_js[1] = {path_js};
-  jerry_value_t ret = jerryxx_call_method(fs, MSTR_FS_MKDIR, args_js, 1);
-  if (jerry_value_is_error(ret)) {
-    jerryxx_print_error(ret, true);
+  if (check_arg(arg)) {
+    print_error(pwjs_vfs_mkdir(arg));
   }
-  jerry_release_value(ret);
-  jerry_release_value(path_js);
-  jerry_release_value(fs);
 }
 
 static void cmd_rm(pwjs_repl_state_t *state, char *arg) {
-  jerry_value_t fs = jerryxx_call_require("fs");
-  jerry_value_t path_js = jerry_create_string((const jerry_char_t *)arg);
-  jerry_value_t args_js[1] = {path_js};
-  jerry_value_t ret = jerryxx_call_method(fs, MSTR_FS_RM, args_js, 1);
-  if (jerry_value_is_error(ret)) {
-    jerryxx_print_error(ret, true);
+  if (!check_arg(arg)) {
+    return;
+  }
+  pwjs_vfs_stat_t stat;
+  int ret = pwjs_vfs_stat(arg, &stat);
+  if (ret == 0) {
+    ret = (stat.type == PWJS_VFS_TYPE_DIR) ? pwjs_vfs_rmdir(arg)
+                                           : pwjs_vfs_unlink(arg);
   }
-  jerry_release_value(ret);
-  jerry_release_value(path_js);
-  jerry_release_value(fs);
+  print_error(ret);
 }
 
 static void cmd_cat(pwjs_repl_state_t *state, char *arg) {
-  jerry_value_t fs = jerryxx_call_require("fs");
-  jerry_value_t path_js = jerry_create_string((const jerry_char_t *)arg);
-  jerry_value_t args_js[1] = {path_js};
-  jerry_value_t fd = jerryxx_call_method(fs, MSTR_FS_OPEN, args_js, 1);
-  int buf_size = 128;
-  jerry_value_t buf_js =
-      jerry_create_typedarray(JERRY_TYPEDARRAY_UINT8, buf_size);
-  jerry_value_t buf_size_js = jerry_create_number(buf_size);
-  uint8_t *buf = jerryxx_get_typedarray_buffer(buf_js);
-  int pos = 0;
-  int read_bytes = 0;
-  do {
-    jerry_value_t pos_js = jerry_create_number(pos);
-    jerry_value_t read_args_js[5] = {fd, buf_js, 0, buf_size_js, pos_js};
-    jerry_value_t ret = jerryxx_call_method(fs, MSTR_FS_READ, read_args_js, 5);
-    read_bytes = jerry_get_number_value(ret);
+  if (!check_arg(arg)) {
+    return;
+  }
+  int fd = pwjs_vfs_open(arg, PWJS_VFS_FLAG_READ);
+  if (print_error(fd)) {
+    return;
+  }
+  uint8_t buf[128];
+  int read_bytes;
+  while ((read_bytes = pwjs_vfs_read(fd, buf, sizeof(buf), -1)) > 0) {
     for (int i = 0; i < read_bytes; i++) {
       pwjs_tty_putc(buf[i]);
     }
-    pos += read_bytes;
-    jerry_release_value(ret);
-    jerry_release_value(pos_js);
-  } while (read_bytes == buf_size);
+  }
+  pwjs_vfs_close(fd);
   pwjs_tty_printf("\r\n");
-  jerry_release_value(buf_size_js);
-  jerry_release_value(buf_js);
-  jerry_release_value(fd);
-  jerry_release_value(path_js);
-  jerry_release_value(fs);
+  print_error(read_bytes);
+}
+
+/**
+ * fs.mmap()
+ * Map a file stored contiguously in memory-mapped storage (e.g. a file of
+ * an asset partition on the internal flash) without copying it. The array
+ * must not be written, and is valid until its file system is formatted.
+ * args:
+ *   path {string}
+ * returns:
+ *   {Uint8Array}
+ */
+JERRYXX_FUN(fs_mmap_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "path")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  const uint8_t *addr;
+  uint32_t size;
+  jerry_value_t vfs_obj;
+  int ret = pwjs_vfs_mmap(path, &addr, &size, &vfs_obj);
+  FS_CHECK_ERROR(ret)
+  jerry_value_t arraybuffer =
+      jerry_create_arraybuffer_external(size, (uint8_t *)addr, NULL);
+  jerry_value_t array = jerry_create_typedarray_for_arraybuffer(
+      JERRY_TYPEDARRAY_UINT8, arraybuffer);
+  jerry_release_value(arraybuffer);
+  // keep the file system and its device alive with the array
+  jerryxx_set_property(array, MSTR_FS_MMAP_SOURCE, vfs_obj);
+  return array;
+}
+
+/**
+ * fs.configureBlockCache()
+ * args:
+ *   size {number} size of the block cache in bytes, 0 to disable it
+ */
+JERRYXX_FUN(fs_configure_block_cache_fn) {
+  JERRYXX_CHECK_ARG_NUMBER(0, "size")
+  double size = JERRYXX_GET_ARG_NUMBER(0);
+  if (size < 0 || size > 0x7fffffff) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+  int ret = pwjs_blkcache_configure((uint32_t)size);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
+}
+
+/**
+ * fs.flushBlockCache()
+ * Write back the dirty blocks of all the mounts
+ */
+JERRYXX_FUN(fs_flush_block_cache_fn) {
+  int ret = pwjs_blkcache_flush(NULL);
+  FS_CHECK_ERROR(ret)
+  return jerry_create_undefined();
 }
 
-/*
+/**
+ * fs.blockCacheStats()
+ * returns:
+ *   {object} {size, used, dirty, hits, misses, evictions, writebacks}
+ */
+JERRYXX_FUN(fs_block_cache_stats_fn) {
+  pwjs_blkcache_stats_t stats;
+  pwjs_blkcache_get_stats(&stats);
+  jerry_value_t obj = jerry_create_object();
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_SIZE, stats.size);
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_USED, stats.used);
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_DIRTY, stats.dirty);
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_HITS, stats.hits);
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_MISSES, stats.misses);
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_EVICTIONS, stats.evictions);
+  jerryxx_set_property_number(obj, MSTR_FS_CACHE_WRITEBACKS,
+                              stats.writebacks);
+  return obj;
+}
+
+/**
+ * fs.resetBlockCacheStats()
+ */
+JERRYXX_FUN(fs_reset_block_cache_stats_fn) {
+  pwjs_blkcache_reset_stats();
+  return jerry_create_undefined();
+}
+
+/**
+ * Print the size and the throughput of a transfer
+ */
+static void print_throughput(uint32_t bytes, uint64_t start) {
+  uint32_t ms = (uint32_t)(pwjs_gettime() - start);
+  pwjs_repl_printf("%u bytes in %u ms (%u KB/s)\r\n", bytes, ms,
+                   ms > 0 ? (uint32_t)((uint64_t)bytes * 1000 / 1024 / ms) : 0);
+}
+
+/**
+ * Return the last component of a path
+ */
+static const char *path_basename(const char *path) {
+  const char *name = strrchr(path, '/');
+  return name != NULL ? name + 1 : path;
+}
+
+/**
+ * Join a directory and a file name into `path` of PWJS_VFS_PATH_MAX bytes
+ */
+static int join_path(const char *dir, const char *name, char *path) {
+  size_t length = strlen(dir);
+  bool slash = length > 0 && dir[length - 1] != '/';
+  if (length + strlen(name) + (slash ? 2 : 1) > PWJS_VFS_PATH_MAX) {
+    return ENAMETOOLONG;
+  }
+  sprintf(path, slash ? "%s/%s" : "%s%s", dir, name);
+  return 0;
+}
+
+/**
+ * cp command. The destination may be an existing directory to copy into.
+ */
 static void cmd_cp(pwjs_repl_state_t *state, char *arg) {
-  // copy file (or entire directory)
+  if (state->argc < 3) {
+    print_error(EINVAL);
+    return;
+  }
+  const char *src = state->argv[1];
+  const char *dest = state->argv[2];
+  char path[PWJS_VFS_PATH_MAX];
+  pwjs_vfs_stat_t stat;
+  if (pwjs_vfs_stat(dest, &stat) == 0 && stat.type == PWJS_VFS_TYPE_DIR) {
+    if (print_error(join_path(dest, path_basename(src), path))) {
+      return;
+    }
+    dest = path;
+  }
+  uint8_t *buffer = pwjs_malloc(PWJS_MEM_VFS, FS_COPY_CHUNK_SIZE);
+  if (buffer == NULL) {
+    print_error(ENOMEM);
+    return;
+  }
+  uint32_t copied = 0;
+  uint64_t start = pwjs_gettime();
+  int ret = fs_copy(src, dest, buffer, &copied);
+  pwjs_free(buffer);
+  if (!print_error(ret)) {
+    print_throughput(copied, start);
+  }
+}
+
+/**
+ * Size of each buffer of the .ftr writer: four 1 KB YMODEM packets, and a
+ * flash sector
+ */
+#define FTR_BUFFER_SIZE 4096
+
+/**
+ * State of the .ftr command. Received packets are copied into one buffer
+ * while the other, once full, is written to the file after the packet is
+ * acknowledged, that is while the sender transmits the next packet.
+ */
+typedef struct {
+  const char *dir;
+  int fd;  // -1 if no file is open
+  char path[PWJS_VFS_PATH_MAX];
+  uint32_t remaining;  // bytes of the current file still to receive
+  bool sized;          // false if the sender left out the file size
+  uint8_t *buffers[2];
+  uint32_t fill;       // bytes in the current buffer
+  uint8_t current;     // index of the buffer being filled
+  uint32_t pending;    // bytes of the other buffer to write, 0 if none
+  int error;
+  uint32_t files;
+  uint32_t bytes;
+} fs_ftr_t;
+
+static fs_ftr_t ftr;
+
+/**
+ * Write the pending buffer of the .ftr writer
+ */
+static int ftr_write_pending() {
+  if (ftr.pending > 0) {
+    int ret = fs_write_all(ftr.fd, ftr.buffers[1 - ftr.current], ftr.pending);
+    ftr.pending = 0;
+    if (ret < 0) {
+      ftr.error = ret;
+      return ret;
+    }
+  }
+  return 0;
 }
 
+/**
+ * Write the buffers and close the file being received
+ */
+static int ftr_close_file() {
+  if (ftr.fd < 0) {
+    return 0;
+  }
+  int ret = ftr_write_pending();
+  if (ret == 0 && ftr.fill > 0) {
+    ret = fs_write_all(ftr.fd, ftr.buffers[ftr.current], ftr.fill);
+  }
+  ftr.fill = 0;
+  int close_ret = pwjs_vfs_close(ftr.fd);
+  ftr.fd = -1;
+  if (ret < 0 || close_ret < 0) {
+    ftr.error = ret < 0 ? ret : close_ret;
+    return ftr.error;
+  }
+  ftr.files++;
+  return 0;
+}
+
+static int ftr_header_cb(uint8_t *file_name, size_t file_size) {
+  // in batch mode, a header follows the previous file
+  if (ftr_close_file() < 0) {
+    pwjs_vfs_unlink(ftr.path);
+    return -1;
+  }
+  int ret =
+      join_path(ftr.dir, path_basename((const char *)file_name), ftr.path);
+  if (ret == 0) {
+    ret = pwjs_vfs_open(ftr.path, PWJS_VFS_FLAG_WRITE | PWJS_VFS_FLAG_CREATE |
+                                      PWJS_VFS_FLAG_TRUNC);
+  }
+  if (ret < 0) {
+    ftr.error = ret;
+    return -1;
+  }
+  ftr.fd = ret;
+  ftr.remaining = file_size;
+  // the size field is optional, without it the padding of the last packet
+  // can not be told apart from the data and is kept
+  ftr.sized = file_size > 0;
+  return 0;
+}
+
+static int ftr_packet_cb(uint8_t *data, size_t len) {
+  // the last packet is padded up to the packet size
+  if (ftr.sized) {
+    if (len > ftr.remaining) {
+      len = ftr.remaining;
+    }
+    ftr.remaining -= len;
+  }
+  ftr.bytes += len;
+  while (len > 0) {
+    uint32_t size = FTR_BUFFER_SIZE - ftr.fill;
+    if (size > len) {
+      size = len;
+    }
+    memcpy(ftr.buffers[ftr.current] + ftr.fill, data, size);
+    ftr.fill += size;
+    data += size;
+    len -= size;
+    if (ftr.fill == FTR_BUFFER_SIZE) {
+      // the flush callback was not called yet (the other buffer is still
+      // pending), so write it now before reusing it
+      if (ftr_write_pending() < 0) {
+        return -1;
+      }
+      ftr.pending = ftr.fill;
+      ftr.current = 1 - ftr.current;
+      ftr.fill = 0;
+    }
+  }
+  return 0;
+}
+
+static int ftr_flush_cb() { return ftr_write_pending(); }
+
+static void ftr_footer_cb() {
+  // the footer can not abort the session, the error is kept in ftr.error
+  // and reported once the transfer ends
+  if (ftr_close_file() < 0) {
+    pwjs_vfs_unlink(ftr.path);
+  }
+}
+
+/**
+ * .ftr command. Receive files via YMODEM (batch mode is supported) and
+ * write them into a directory, the current directory by default.
+ */
 static void cmd_ftr(pwjs_repl_state_t *state, char *arg) {
-  // transfer a file via ymodem
+  pwjs_vfs_stat_t stat;
+  const char *dir = arg != NULL ? arg : pwjs_vfs_getcwd();
+  int ret = pwjs_vfs_stat(dir, &stat);
+  if (ret == 0 && stat.type != PWJS_VFS_TYPE_DIR) {
+    ret = ENOTDIR;
+  }
+  if (print_error(ret)) {
+    return;
+  }
+  memset(&ftr, 0, sizeof(ftr));
+  ftr.dir = dir;
+  ftr.fd = -1;
+  ftr.buffers[0] = pwjs_malloc(PWJS_MEM_VFS, FTR_BUFFER_SIZE * 2);
+  if (ftr.buffers[0] == NULL) {
+    print_error(ENOMEM);
+    return;
+  }
+  ftr.buffers[1] = ftr.buffers[0] + FTR_BUFFER_SIZE;
+  pwjs_tty_printf("Transfer files via YMODEM... (press 'a' to abort)\r\n");
+  uint64_t start = pwjs_gettime();
+  pwjs_ymodem_status_t result = pwjs_repl_ymodem_receive(
+      ftr_header_cb, ftr_packet_cb, ftr_footer_cb, ftr_flush_cb);
+  if (ftr.fd >= 0) {
+    // remove the partially received file
+    pwjs_vfs_close(ftr.fd);
+    ftr.fd = -1;
+    pwjs_vfs_unlink(ftr.path);
+  }
+  pwjs_free(ftr.buffers[0]);
+  pwjs_tty_printf("\r\n");
+  if (ftr.error < 0) {
+    print_error(ftr.error);
+  } else if (result == PWJS_YMODEM_OK) {
+    pwjs_repl_printf("%u file(s), ", ftr.files);
+    print_throughput(ftr.bytes, start);
+  } else if (result == PWJS_YMODEM_ABORT) {
+    pwjs_tty_printf("Aborted\r\n");
+  } else {
+    pwjs_tty_printf("Failed to receive\r\n");
+  }
 }
-*/
 
 /**
  * Initialize 'fs' module
@@ -178,7 +1662,56 @@ jerry_value_t module_fs_init() {
   pwjs_repl_register_command("mkdir", "Create directory", cmd_mkdir);
   pwjs_repl_register_command("rm", "Remove file or directory", cmd_rm);
   pwjs_repl_register_command("cat", "Print the content of file", cmd_cat);
-  // pwjs_repl_register_command(".cp", "Copy file", cmd_cp);
-  // pwjs_repl_register_command(".ftr", "File transfer", cmd_ftr);
-  return jerry_create_undefined();
+  pwjs_repl_register_command("cp", "Copy file or directory", cmd_cp);
+  pwjs_repl_register_command(".ftr", "Receive files via YMODEM", cmd_ftr);
+
+  /* fs native module exports */
+  jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property_function(exports, MSTR_FS_MOUNT, fs_mount_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_UNMOUNT, fs_unmount_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CWD, fs_cwd_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CHDIR, fs_chdir_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_OPEN, fs_open_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CLOSE, fs_close_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_READ, fs_read_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_WRITE, fs_write_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_STAT, fs_stat_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_READDIR, fs_readdir_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_OPENDIR, fs_opendir_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_DIR_READ, fs_dir_read_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CLOSEDIR, fs_closedir_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_MKDIR, fs_mkdir_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_UNLINK, fs_unlink_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_RMDIR, fs_rmdir_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_RENAME, fs_rename_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_READ_FILE, fs_read_file_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_WRITE_FILE, fs_write_file_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_APPEND_FILE,
+                                fs_append_file_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_COPY_FILE, fs_copy_file_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CREATE_READ_STREAM,
+                                fs_create_read_stream_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CREATE_WRITE_STREAM,
+                                fs_create_write_stream_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_STREAM_WRITE,
+                                fs_stream_write_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_STREAM_PAUSE,
+                                fs_stream_pause_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_STREAM_RESUME,
+                                fs_stream_resume_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_STREAM_CLOSE,
+                                fs_stream_close_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_IO_START, fs_io_start_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CONFIGURE_IO,
+                                fs_configure_io_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_MMAP, fs_mmap_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_CONFIGURE_BLOCK_CACHE,
+                                fs_configure_block_cache_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_FLUSH_BLOCK_CACHE,
+                                fs_flush_block_cache_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_BLOCK_CACHE_STATS,
+                                fs_block_cache_stats_fn);
+  jerryxx_set_property_function(exports, MSTR_FS_RESET_BLOCK_CACHE_STATS,
+                                fs_reset_block_cache_stats_fn);
+  return exports;
 }
@@ -33,10 +33,11 @@
 #include "jerryscript.h"
 #include "jerryxx.h"
 #include "magic_strings.h"
+#include "mem.h"
 
 gc_font_t custom_font;
 
-static void gc_handle_freecb(void *handle) { free(handle); }
+static void gc_handle_freecb(void *handle) { pwjs_free(handle); }
 
 static const jerry_object_native_info_t gc_handle_info = {.free_cb =
                                                               gc_handle_freecb};
@@ -54,7 +55,8 @@ JERRYXX_FUN(gc_ctor_fn) {
   JERRYXX_CHECK_ARG_OBJECT_OPT(2, "options");
 
   // set native handle
-  gc_handle_t *gc_handle = (gc_handle_t *)malloc(sizeof(gc_handle_t));
+  gc_handle_t *gc_handle =
+      (gc_handle_t *)pwjs_malloc(PWJS_MEM_GRAPHICS, sizeof(gc_handle_t));
   gc_handle->color = 1;
   gc_handle->fill_color = 1;
   gc_handle->font = NULL;
@@ -632,7 +634,8 @@ JERRYXX_FUN(buffered_gc_ctor_fn) {
   JERRYXX_CHECK_ARG_OBJECT_OPT(2, "options");
 
   // set native handle
-  gc_handle_t *gc_handle = (gc_handle_t *)malloc(sizeof(gc_handle_t));
+  gc_handle_t *gc_handle =
+      (gc_handle_t *)pwjs_malloc(PWJS_MEM_GRAPHICS, sizeof(gc_handle_t));
   gc_handle->color = 1;
   gc_handle->fill_color = 1;
   gc_handle->font = NULL;
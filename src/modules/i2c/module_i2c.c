@@ -26,11 +26,12 @@
 #include "i2c_magic_strings.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "mem.h"
 
 #define I2C_DEFAULT_MODE PWJS_I2C_MASTER
 #define I2C_DEFAULT_BAUDRATE 100000  // 100kbps
 
-static void buffer_free_cb(void *native_p) { free(native_p); }
+static void buffer_free_cb(void *native_p) { pwjs_free(native_p); }
 
 /**
  * I2C() constructor
@@ -201,7 +202,7 @@ JERRYXX_FUN(i2c_read_fn) {
   // read data with optional parameters (address, timeout)
   uint8_t address = 0;
   uint32_t timeout = 5000;
-  uint8_t *buf = malloc(length);
+  uint8_t *buf = pwjs_malloc(PWJS_MEM_I2C, length);
   int ret = 0;
   if (i2cmode == PWJS_I2C_SLAVE) {
     JERRYXX_CHECK_ARG_NUMBER_OPT(1, "timeout");
@@ -217,7 +218,7 @@ JERRYXX_FUN(i2c_read_fn) {
 
   // return an Uint8Array
   if (ret < 0) {
-    free(buf);
+    pwjs_free(buf);
     return jerry_create_error_from_value(create_system_error(ret), true);
   } else {
     jerry_value_t array_buffer =
@@ -319,7 +320,7 @@ JERRYXX_FUN(i2c_memread_fn) {
   uint16_t memAddressSize = (uint16_t)JERRYXX_GET_ARG_NUMBER_OPT(3, 8);
   uint32_t timeout = (uint32_t)JERRYXX_GET_ARG_NUMBER_OPT(4, 5000);
 
-  uint8_t *buf = malloc(length);
+  uint8_t *buf = pwjs_malloc(PWJS_MEM_I2C, length);
 
   // check this.bus number
   jerry_value_t bus_value =
@@ -344,7 +345,7 @@ JERRYXX_FUN(i2c_memread_fn) {
 
   // return an Uint8Array
   if (ret < 0) {
-    free(buf);
+    pwjs_free(buf);
     return jerry_create_error_from_value(create_system_error(ret), true);
   } else {
     jerry_value_t array_buffer =
@@ -29,6 +29,7 @@
 #include "lwip/tcp.h"
 #include "lwip/udp.h"
 #include "lwip/dns.h"
+#include "mem.h"
 #include "system.h"
 
 #include "dhcpserver.h"
@@ -103,7 +104,7 @@ __socket_t __socket_info;
 
 dhcp_server_t dhcp_server;
 
-static void buffer_free_cb(void *native_p) { free(native_p); }
+static void buffer_free_cb(void *native_p) { pwjs_free(native_p); }
 
 bool pwjs_is_valid_fd(int8_t fd) {
   if ((fd >= 0) && (fd < PWJS_MAX_SOCKET_NO)) {
@@ -263,7 +264,7 @@ static int __scan_cb(void *env, const cyw43_ev_scan_result_t *result) {
   if (__p_scan_result && __p_scan_result->scanning) {
     __p_scan_result->prev_time_ms = pwjs_gettime();
     __scan_queue_t *p_new_node =
-        (__scan_queue_t *)malloc(sizeof(__scan_queue_t));
+        (__scan_queue_t *)pwjs_malloc(PWJS_MEM_NET, sizeof(__scan_queue_t));
     if (p_new_node == NULL) {
       return -1;
     }
@@ -288,7 +289,8 @@ JERRYXX_FUN(pico_cyw43_wifi_scan) {
   if (JERRYXX_HAS_ARG(0)) {  // Do nothing if callback is NULL
     jerry_value_t callback = JERRYXX_GET_ARG(0);
     jerry_value_t scan_js_cb = jerry_acquire_value(callback);
-    __p_scan_result = (__scan_result_t *)malloc(sizeof(__scan_result_t));
+    __p_scan_result =
+        (__scan_result_t *)pwjs_malloc(PWJS_MEM_NET, sizeof(__scan_result_t));
     __p_scan_result->prev_time_ms = pwjs_gettime();
     __p_scan_result->queue_size = 0;
     __p_scan_result->p_scan_result_queue = NULL;
@@ -324,7 +326,7 @@ JERRYXX_FUN(pico_cyw43_wifi_scan) {
       uint8_t index = 0;
       while (current) {
         jerry_value_t obj = jerry_create_object();
-        char *str_buff = (char *)calloc(1, 33);
+        char *str_buff = (char *)pwjs_calloc(PWJS_MEM_NET, 1, 33);
         memcpy(str_buff, current->data.ssid, current->data.ssid_len);
         jerryxx_set_property_string(obj, MSTR_PICO_CYW43_SCANINFO_SSID,
                                     str_buff);
@@ -357,10 +359,10 @@ JERRYXX_FUN(pico_cyw43_wifi_scan) {
             jerry_set_property_by_index(scan_array, index++, obj);
         jerry_release_value(ret);
         jerry_release_value(obj);
-        free(str_buff);
+        pwjs_free(str_buff);
         __scan_queue_t *remove = current;
         current = current->next;
-        free(remove);
+        pwjs_free(remove);
       }
       jerry_value_t errno = jerryxx_get_property_number(
           JERRYXX_GET_THIS, MSTR_PICO_CYW43_WIFI_ERRNO, 0);
@@ -372,7 +374,7 @@ JERRYXX_FUN(pico_cyw43_wifi_scan) {
       jerry_release_value(scan_js_cb);
       jerry_release_value(scan_array);
     }
-    free(__p_scan_result);
+    pwjs_free(__p_scan_result);
     __p_scan_result = NULL;
   }
   return jerry_create_undefined();
@@ -420,7 +422,7 @@ JERRYXX_FUN(pico_cyw43_wifi_connect) {
   }
   if (jerry_value_is_string(pw)) {
     jerry_size_t len = jerryxx_get_ascii_string_size(pw);
-    pw_str = (uint8_t *)malloc(len + 1);
+    pw_str = (uint8_t *)pwjs_malloc(PWJS_MEM_NET, len + 1);
     jerryxx_string_to_ascii_char_buffer(pw, pw_str, len);
     if (len >= 8) { // Min lenght of the WPA is 8.
       auth = CYW43_AUTH_WPA2_MIXED_PSK; // Default auth is changed.
@@ -429,7 +431,7 @@ JERRYXX_FUN(pico_cyw43_wifi_connect) {
   }
   if (jerry_value_is_string(security)) {
     jerry_size_t len = jerryxx_get_ascii_string_size(security);
-    uint8_t *security_str = (uint8_t *)malloc(len + 1);
+    uint8_t *security_str = (uint8_t *)pwjs_malloc(PWJS_MEM_NET, len + 1);
     jerryxx_string_to_ascii_char_buffer(security, security_str, len);
     security_str[len] = '\0';
     if (!strcmp((const char *)security_str, "WPA2_WPA_PSK")) {
@@ -443,7 +445,7 @@ JERRYXX_FUN(pico_cyw43_wifi_connect) {
     } else if (!strcmp((const char *)security_str, "OPEN")) {
       auth = CYW43_AUTH_OPEN;
     }
-    free(security_str);
+    pwjs_free(security_str);
   }
   jerry_release_value(ssid);
   jerry_release_value(bssid);
@@ -452,7 +454,7 @@ JERRYXX_FUN(pico_cyw43_wifi_connect) {
   int connect_ret = cyw43_arch_wifi_connect_bssid_timeout_ms(
       (char *)__cyw43_drv.current_ssid, bssid_ptr, (char *)pw_str, auth, CONNECT_TIMEOUT);
   if (pw_str) {
-    free(pw_str);
+    pwjs_free(pw_str);
   }
   if (connect_ret) {
     jerryxx_set_property_number(JERRYXX_GET_THIS, MSTR_PICO_CYW43_WIFI_ERRNO,
@@ -734,7 +736,8 @@ static err_t __net_data_received(int8_t fd, struct tcp_pcb *tpcb,
       if (__socket_info.socket[read_fd].state == NET_SOCKET_STATE_CLOSED)
         return err;
       if (p->tot_len > 0) {
-        uint8_t *receiver_buffer = (uint8_t *)malloc(sizeof(uint8_t) * p->tot_len);
+        uint8_t *receiver_buffer =
+            (uint8_t *)pwjs_malloc(PWJS_MEM_NET, sizeof(uint8_t) * p->tot_len);
         uint32_t buff_offset = 0;
         for (struct pbuf *q = p; q != NULL; q = q->next) {
           memcpy((uint8_t *)(receiver_buffer + buff_offset), q->payload, q->len);
@@ -745,11 +748,11 @@ static err_t __net_data_received(int8_t fd, struct tcp_pcb *tpcb,
           tcp_recved(tpcb, p->tot_len);
         }
         if ( __socket_info.socket[read_fd].obj == 0) {
-          free(receiver_buffer);
+          pwjs_free(receiver_buffer);
           return err;
         }
-        jerry_value_t read_js_cb = jerryxx_get_property(
-            __socket_info.socket[read_fd].obj, MSTR_PICO_CYW43_SOCKET_READ_CB);
+        jerry_value_t read_js_cb = jerryxx_get_property_by_key(
+            __socket_info.socket[read_fd].obj, JERRYXX_KEY_READ_CB);
         if (jerry_value_is_function(read_js_cb)) {
           jerry_value_t this_val = jerry_create_undefined();
           jerry_value_t buffer =
@@ -762,7 +765,7 @@ static err_t __net_data_received(int8_t fd, struct tcp_pcb *tpcb,
           jerry_release_value(data);
           jerry_release_value(this_val);
         } else {
-          free(receiver_buffer);
+          pwjs_free(receiver_buffer);
         }
         jerry_release_value(read_js_cb);
       }
@@ -821,7 +824,7 @@ static err_t __tcp_server_accept_cb(void *arg, struct tcp_pcb *newpcb,
     int8_t *server_fd = (int8_t *)arg;
     int8_t fd = pwjs_get_socket_fd();
     if (pwjs_is_valid_fd(*server_fd) && pwjs_is_valid_fd(fd)) {
-      char *p_str_buff = (char *)malloc(18);
+      char *p_str_buff = (char *)pwjs_malloc(PWJS_MEM_NET, 18);
       __socket_info.socket[fd].server_fd = *server_fd;
       __socket_info.socket[fd].tcp_server_pcb = NULL;
       __socket_info.socket[fd].state = NET_SOCKET_STATE_CONNECTED;
@@ -853,7 +856,7 @@ static err_t __tcp_server_accept_cb(void *arg, struct tcp_pcb *newpcb,
       jerryxx_set_property_number(__socket_info.socket[fd].obj,
                                   MSTR_PICO_CYW43_SOCKET_RPORT,
                                   __socket_info.socket[fd].rport);
-      free(p_str_buff);
+      pwjs_free(p_str_buff);
       __socket_info.socket[fd].tcp_pcb = newpcb;
       cyw43_arch_lwip_check();
       tcp_arg(__socket_info.socket[fd].tcp_pcb, &(__socket_info.socket[fd].fd));
@@ -934,11 +937,11 @@ JERRYXX_FUN(pico_cyw43_network_connect) {
                                 (const jerry_char_t *)"DNS Error: DNS access error.");
     }
     __socket_info.socket[fd].rport = port;
-    char *p_str_buff = (char *)malloc(16);
+    char *p_str_buff = (char *)pwjs_malloc(PWJS_MEM_NET, 16);
     sprintf(p_str_buff, "%s", ipaddr_ntoa(&(__socket_info.socket[fd].raddr)));
     jerryxx_set_property_string(__socket_info.socket[fd].obj,
                                 MSTR_PICO_CYW43_SOCKET_RADDR, p_str_buff);
-    free(p_str_buff);
+    pwjs_free(p_str_buff);
     jerryxx_set_property_number(__socket_info.socket[fd].obj,
                                 MSTR_PICO_CYW43_SOCKET_RPORT,
                                 __socket_info.socket[fd].rport);
@@ -1016,7 +1019,7 @@ JERRYXX_FUN(pico_cyw43_network_write) {
                          ((__socket_info.socket[fd].ptcl == NET_SOCKET_STREAM) &&
                           (__socket_info.socket[fd].state >= NET_SOCKET_STATE_CONNECTED)))) {
     jerry_size_t data_str_sz = jerryxx_get_ascii_string_size(data);
-    char *data_str = calloc(1, data_str_sz + 1);
+    char *data_str = pwjs_calloc(PWJS_MEM_NET, 1, data_str_sz + 1);
     jerryxx_string_to_ascii_char_buffer(data, (uint8_t *)data_str, data_str_sz);
     err_t err = ERR_OK;
     cyw43_arch_lwip_begin();
@@ -1042,7 +1045,7 @@ JERRYXX_FUN(pico_cyw43_network_write) {
       jerryxx_set_property_number(JERRYXX_GET_THIS,
                                   MSTR_PICO_CYW43_NETWORK_ERRNO, 0);
     }
-    free(data_str);
+    pwjs_free(data_str);
   } else {
     jerryxx_set_property_number(JERRYXX_GET_THIS,
                                 MSTR_PICO_CYW43_NETWORK_ERRNO, -1);
@@ -1200,11 +1203,11 @@ JERRYXX_FUN(pico_cyw43_network_bind) {
                                 (const jerry_char_t *)"DNS Error: DNS access error.");
     }
     __socket_info.socket[fd].lport = port;
-    char *p_str_buff = (char *)malloc(16);
+    char *p_str_buff = (char *)pwjs_malloc(PWJS_MEM_NET, 16);
     sprintf(p_str_buff, "%s", ipaddr_ntoa(&(laddr)));
     jerryxx_set_property_string(__socket_info.socket[fd].obj,
                                 MSTR_PICO_CYW43_SOCKET_LADDR, p_str_buff);
-    free(p_str_buff);
+    pwjs_free(p_str_buff);
     jerryxx_set_property_number(__socket_info.socket[fd].obj,
                                 MSTR_PICO_CYW43_SOCKET_LPORT,
                                 __socket_info.socket[fd].lport);
@@ -1349,7 +1352,7 @@ JERRYXX_FUN(pico_cyw43_wifi_ap_mode) {
       jerry_release_value(password);
       return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)"PASSWORD need to have at least 8 characters");
     }
-    pw_str = (uint8_t *)malloc(len + 1);
+    pw_str = (uint8_t *)pwjs_malloc(PWJS_MEM_NET, len + 1);
     jerryxx_string_to_ascii_char_buffer(password, pw_str, len);
     pw_str[len] = '\0';
   }
@@ -1359,12 +1362,12 @@ JERRYXX_FUN(pico_cyw43_wifi_ap_mode) {
   jerry_value_t gateway = jerryxx_get_property(ap_info, MSTR_PICO_CYW43_WIFI_APMODE_GATEWAY);
   if (jerry_value_is_string(gateway)) {
     len = jerryxx_get_ascii_string_size(gateway);
-    str_buffer = (uint8_t *)malloc(len + 1);
+    str_buffer = (uint8_t *)pwjs_malloc(PWJS_MEM_NET, len + 1);
     jerryxx_string_to_ascii_char_buffer(gateway, str_buffer, len);
     str_buffer[len] = '\0';
     if (ipaddr_aton((const char *)str_buffer, &(gw)) == false) {
-      free(pw_str);
-      free(str_buffer);
+      pwjs_free(pw_str);
+      pwjs_free(str_buffer);
       jerry_release_value(gateway);
       return jerry_create_error(JERRY_ERROR_COMMON,
                                 (const jerry_char_t *)"Can't decode Gateway IP Address");
@@ -1376,19 +1379,19 @@ JERRYXX_FUN(pico_cyw43_wifi_ap_mode) {
     jerryxx_set_property_string(JERRYXX_GET_THIS, MSTR_PICO_CYW43_WIFI_APMODE_GATEWAY,
                                 "192.168.4.1");
   }
-  free(str_buffer);
+  pwjs_free(str_buffer);
   jerry_release_value(gateway);
 
   // validate subnet mask
   jerry_value_t subnet_mask = jerryxx_get_property(ap_info, MSTR_PICO_CYW43_WIFI_APMODE_SUBNET_MASK);
   if (jerry_value_is_string(subnet_mask)) {
     len = jerryxx_get_ascii_string_size(subnet_mask);
-    str_buffer = (uint8_t *)malloc(len + 1);
+    str_buffer = (uint8_t *)pwjs_malloc(PWJS_MEM_NET, len + 1);
     jerryxx_string_to_ascii_char_buffer(subnet_mask, str_buffer, len);
     str_buffer[len] = '\0';
     if (ipaddr_aton((const char *)str_buffer, &(mask)) == false) {
-      free(pw_str);
-      free(str_buffer);
+      pwjs_free(pw_str);
+      pwjs_free(str_buffer);
       jerry_release_value(subnet_mask);
       return jerry_create_error(JERRY_ERROR_COMMON,
                                 (const jerry_char_t *)"Can't decode Subnet Mask");
@@ -1400,7 +1403,7 @@ JERRYXX_FUN(pico_cyw43_wifi_ap_mode) {
     jerryxx_set_property_string(JERRYXX_GET_THIS, MSTR_PICO_CYW43_WIFI_APMODE_SUBNET_MASK,
                                 "255.255.255.0");
   }
-  free(str_buffer);
+  pwjs_free(str_buffer);
   jerry_release_value(subnet_mask);
 
   // init driver
@@ -1409,7 +1412,7 @@ JERRYXX_FUN(pico_cyw43_wifi_ap_mode) {
   }
 
   cyw43_arch_enable_ap_mode((char *) __cyw43_drv.current_ssid, (char *) pw_str, CYW43_AUTH_WPA2_AES_PSK);
-  free(pw_str);
+  pwjs_free(pw_str);
   // start DHCP server
 	dhcp_server_init(&dhcp_server, &gw, &mask);
 
@@ -1460,22 +1463,23 @@ JERRYXX_FUN(pico_cyw43_wifi_ap_get_stas) {
   int num_stas, max_stas, MAC_len = 18;
   // get max stas
   cyw43_wifi_ap_get_max_stas(&cyw43_state, &max_stas);
-  // declare
-  uint8_t *macs = (uint8_t*)malloc(num_stas * 6);
-  jerry_value_t MAC_array = jerry_create_array (num_stas);
+  // declare (num_stas is only known after reading, size for max_stas)
+  uint8_t *macs = (uint8_t*)pwjs_malloc(PWJS_MEM_NET, max_stas * 6);
   //uint8_t macs[32 * 6];
   cyw43_wifi_ap_get_stas(&cyw43_state, &num_stas, macs);
-  char **mac_strs = (char **)malloc(num_stas * sizeof(char *));
+  jerry_value_t MAC_array = jerry_create_array (num_stas);
+  char mac_str[MAC_len];
   for (int i = 0; i < num_stas; i++) {
-    mac_strs[i] = (char *)malloc(MAC_len * sizeof(char));
-    sprintf(mac_strs[i], "%02x:%02x:%02x:%02x:%02x:%02x", macs[i*6], macs[i*6+1], macs[i*6+2], macs[i*6+3], macs[i*6+4], macs[i*6+5]);
+    sprintf(mac_str, "%02x:%02x:%02x:%02x:%02x:%02x", macs[i * 6],
+            macs[i * 6 + 1], macs[i * 6 + 2], macs[i * 6 + 3], macs[i * 6 + 4],
+            macs[i * 6 + 5]);
     // add to the array
-    jerry_value_t prop = jerry_create_string((const jerry_char_t *)mac_strs[i]);
+    jerry_value_t prop = jerry_create_string((const jerry_char_t *)mac_str);
     jerry_release_value(jerry_set_property_by_index(MAC_array, i, prop));
     jerry_release_value(prop);
   }
   // deallocate memory
-  free(macs);
+  pwjs_free(macs);
   // return the list of macs
   return MAC_array;
 }
@@ -0,0 +1,5 @@
+list(APPEND SOURCES
+  ${SRC_DIR}/modules/ramblkdev/module_ramblkdev.c)
+
+include_directories(
+  ${SRC_DIR}/modules/ramblkdev)
@@ -0,0 +1,259 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "module_ramblkdev.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "blkdev.h"
+#include "err.h"
+#include "jerryscript.h"
+#include "jerryxx.h"
+#include "magic_strings.h"
+#include "mem.h"
+#include "ramblkdev_magic_strings.h"
+
+#define RAMBLKDEV_BUFFER_SIZE 256
+
+/**
+ * RAM block device. The blocks are kept in a single arena allocated with
+ * the handle, so the device is released at once when it is collected.
+ */
+typedef struct {
+  pwjs_blkdev_t blkdev;
+  uint32_t block_size;
+  uint32_t count;
+  uint8_t arena[];
+} ramblkdev_handle_t;
+
+/**
+ * Check that a range in bytes from the start of a block is in the device
+ */
+static bool ramblkdev_in_range(ramblkdev_handle_t *handle, uint32_t block,
+                               uint32_t offset, size_t size) {
+  uint64_t end = (uint64_t)block * handle->block_size + offset + size;
+  return block < handle->count &&
+         end <= (uint64_t)handle->count * handle->block_size;
+}
+
+static int ramblkdev_blkdev_read(pwjs_blkdev_t *blkdev, uint32_t block,
+                                 uint32_t offset, uint8_t *buffer,
+                                 size_t size) {
+  ramblkdev_handle_t *handle = (ramblkdev_handle_t *)blkdev;
+  if (!ramblkdev_in_range(handle, block, offset, size)) {
+    return EINVAL;
+  }
+  memcpy(buffer, handle->arena + block * handle->block_size + offset, size);
+  return 0;
+}
+
+static int ramblkdev_blkdev_write(pwjs_blkdev_t *blkdev, uint32_t block,
+                                  uint32_t offset, const uint8_t *buffer,
+                                  size_t size) {
+  ramblkdev_handle_t *handle = (ramblkdev_handle_t *)blkdev;
+  if (!ramblkdev_in_range(handle, block, offset, size)) {
+    return EINVAL;
+  }
+  memcpy(handle->arena + block * handle->block_size + offset, buffer, size);
+  return 0;
+}
+
+static int ramblkdev_blkdev_ioctl(pwjs_blkdev_t *blkdev, int op, int arg) {
+  ramblkdev_handle_t *handle = (ramblkdev_handle_t *)blkdev;
+  switch (op) {
+    case PWJS_BLKDEV_INIT:
+    case PWJS_BLKDEV_SHUTDOWN:
+    case PWJS_BLKDEV_SYNC:
+      return 0;
+    case PWJS_BLKDEV_BLOCK_COUNT:
+      return handle->count;
+    case PWJS_BLKDEV_BLOCK_SIZE:
+      return handle->block_size;
+    case PWJS_BLKDEV_ERASE:
+      if (arg < 0 || (uint32_t)arg >= handle->count) {
+        return EINVAL;
+      }
+      memset(handle->arena + arg * handle->block_size, 0xff,
+             handle->block_size);
+      return 0;
+    case PWJS_BLKDEV_BUFFER_SIZE:
+      return handle->block_size < RAMBLKDEV_BUFFER_SIZE
+                 ? handle->block_size
+                 : RAMBLKDEV_BUFFER_SIZE;
+    default:
+      return EINVAL;
+  }
+}
+
+static void ramblkdev_blkdev_free(pwjs_blkdev_t *blkdev) { pwjs_free(blkdev); }
+
+static const uint8_t *ramblkdev_blkdev_map(pwjs_blkdev_t *blkdev) {
+  return ((ramblkdev_handle_t *)blkdev)->arena;
+}
+
+/**
+ * RamBlockDev constructor
+ * args:
+ *   count {number} number of blocks
+ *   size {number} block size, default 512
+ */
+JERRYXX_FUN(ramblkdev_ctor_fn) {
+  // check and get args
+  JERRYXX_CHECK_ARG_NUMBER(0, "count")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(1, "size")
+  int count = JERRYXX_GET_ARG_NUMBER(0);
+  int size = JERRYXX_GET_ARG_NUMBER_OPT(1, 512);
+  // the arena size must not wrap around on the 32-bit target
+  if (count < 1 || size < 1 ||
+      (size_t)count > (SIZE_MAX - sizeof(ramblkdev_handle_t)) / (size_t)size) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+
+  // allocate the blocks with the handle, erased
+  ramblkdev_handle_t *handle = (ramblkdev_handle_t *)pwjs_malloc(
+      PWJS_MEM_RAMBLKDEV,
+      sizeof(ramblkdev_handle_t) + (size_t)count * (size_t)size);
+  if (handle == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  handle->blkdev.read = ramblkdev_blkdev_read;
+  handle->blkdev.write = ramblkdev_blkdev_write;
+  handle->blkdev.ioctl = ramblkdev_blkdev_ioctl;
+  handle->blkdev.free = ramblkdev_blkdev_free;
+  handle->blkdev.map = ramblkdev_blkdev_map;
+  handle->block_size = size;
+  handle->count = count;
+  memset(handle->arena, 0xff, (size_t)count * (size_t)size);
+
+  // set properties to this
+  jerryxx_set_property_number_by_key(JERRYXX_GET_THIS, JERRYXX_KEY_COUNT,
+                                     count);
+  jerryxx_set_property_number_by_key(JERRYXX_GET_THIS, JERRYXX_KEY_SIZE, size);
+  pwjs_blkdev_bind(JERRYXX_GET_THIS, &handle->blkdev);
+  return jerry_create_undefined();
+}
+
+#define RAMBLKDEV_GET_HANDLE(name)                                            \
+  ramblkdev_handle_t *name = (ramblkdev_handle_t *)pwjs_blkdev_get(this_val); \
+  if (name == NULL) {                                                         \
+    return jerry_create_error(                                                \
+        JERRY_ERROR_REFERENCE,                                                \
+        (const jerry_char_t *)"Failed to get native handle");                 \
+  }
+
+/**
+ * Get the memory of a typed array, at its byteOffset
+ */
+static uint8_t *get_typedarray_pointer(jerry_value_t typedarray,
+                                       jerry_length_t *length) {
+  jerry_length_t byte_offset = 0;
+  jerry_value_t arrbuf =
+      jerry_get_typedarray_buffer(typedarray, &byte_offset, length);
+  uint8_t *pointer = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+  jerry_release_value(arrbuf);
+  return pointer;
+}
+
+/**
+ * Get the block, buffer and offset arguments of read() and write()
+ */
+#define RAMBLKDEV_GET_ARGS(handle, block, pointer, length, offset)           \
+  JERRYXX_CHECK_ARG_NUMBER(0, "block")                                       \
+  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")                                  \
+  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")                                  \
+  RAMBLKDEV_GET_HANDLE(handle)                                               \
+  int block = JERRYXX_GET_ARG_NUMBER(0);                                     \
+  int offset = JERRYXX_GET_ARG_NUMBER_OPT(2, 0);                             \
+  jerry_length_t length = 0;                                                 \
+  uint8_t *pointer = get_typedarray_pointer(JERRYXX_GET_ARG(1), &length);    \
+  if (block < 0 || offset < 0 ||                                             \
+      !ramblkdev_in_range(handle, block, offset, length)) {                  \
+    return jerry_create_error(JERRY_ERROR_RANGE,                             \
+                              (const jerry_char_t *)"Out of device range."); \
+  }
+
+/**
+ * RamBlockDev.prototype.read()
+ * args:
+ *   block {number}
+ *   buffer {Uint8Array}
+ *   offset {number}
+ */
+JERRYXX_FUN(ramblkdev_read_fn) {
+  RAMBLKDEV_GET_ARGS(handle, block, pointer, length, offset)
+  ramblkdev_blkdev_read(&handle->blkdev, block, offset, pointer, length);
+  return jerry_create_undefined();
+}
+
+/**
+ * RamBlockDev.prototype.write()
+ * args:
+ *   block {number}
+ *   buffer {Uint8Array}
+ *   offset {number}
+ */
+JERRYXX_FUN(ramblkdev_write_fn) {
+  RAMBLKDEV_GET_ARGS(handle, block, pointer, length, offset)
+  ramblkdev_blkdev_write(&handle->blkdev, block, offset, pointer, length);
+  return jerry_create_undefined();
+}
+
+/**
+ * RamBlockDev.prototype.ioctl()
+ * args:
+ *   op {number}
+ *   arg {number}
+ */
+JERRYXX_FUN(ramblkdev_ioctl_fn) {
+  // check and get args
+  JERRYXX_CHECK_ARG_NUMBER(0, "op")
+  JERRYXX_CHECK_ARG_NUMBER_OPT(1, "arg")
+  RAMBLKDEV_GET_HANDLE(handle)
+  int op = JERRYXX_GET_ARG_NUMBER(0);
+  int arg = JERRYXX_GET_ARG_NUMBER_OPT(1, 0);
+  return jerry_create_number(ramblkdev_blkdev_ioctl(&handle->blkdev, op, arg));
+}
+
+/**
+ * Initialize 'ramblkdev' module and return exports
+ */
+jerry_value_t module_ramblkdev_init() {
+  /* RamBlockDev class */
+  jerry_value_t ramblkdev_ctor =
+      jerry_create_external_function(ramblkdev_ctor_fn);
+  jerry_value_t ramblkdev_prototype = jerry_create_object();
+  jerryxx_set_property(ramblkdev_ctor, MSTR_PROTOTYPE, ramblkdev_prototype);
+  jerryxx_set_property_function(ramblkdev_prototype, MSTR_RAMBLKDEV_READ,
+                                ramblkdev_read_fn);
+  jerryxx_set_property_function(ramblkdev_prototype, MSTR_RAMBLKDEV_WRITE,
+                                ramblkdev_write_fn);
+  jerryxx_set_property_function(ramblkdev_prototype, MSTR_RAMBLKDEV_IOCTL,
+                                ramblkdev_ioctl_fn);
+  jerry_release_value(ramblkdev_prototype);
+
+  /* ramblkdev module exports */
+  jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property(exports, MSTR_RAMBLKDEV_RAMBLKDEV, ramblkdev_ctor);
+  jerry_release_value(ramblkdev_ctor);
+  return exports;
+}
@@ -1,4 +1,5 @@
 list(APPEND SOURCES
+  ${SRC_DIR}/modules/sdcard/sdcard.c
   ${SRC_DIR}/modules/sdcard/module_sdcard.c)
 
 include_directories(
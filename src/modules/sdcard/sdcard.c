@@ -0,0 +1,511 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sdcard.h"
+
+#include <stdlib.h>
+
+#include "board.h"
+#include "err.h"
+#include "gpio.h"
+#include "spi.h"
+#include "system.h"
+
+#define SD_BLOCK 512
+#define SD_CMD0 0   /* GO_IDLE_STATE */
+#define SD_CMD1 1   /* SEND_OP_COND */
+#define SD_CMD6 6   /* SWITCH_FUNC */
+#define SD_CMD8 8   /* SEND_IF_COND */
+#define SD_CMD9 9   /* SEND_CSD */
+#define SD_CMD10 10 /* SEND_CID */
+#define SD_CMD12 12 /* STOP_TRANSMISSION */
+#define SD_CMD13 13 /* SEND_STATUS */
+#define SD_CMD16 16 /* SET_BLOCKLEN */
+#define SD_CMD17 17 /* READ_SINGLE_BLOCK */
+#define SD_CMD18 18 /* READ_MULTIPLE_BLOCK */
+#define SD_CMD23 23 /* SET_BLOCK_COUNT */
+#define SD_CMD24 24 /* WRITE_BLOCK */
+#define SD_CMD25 25 /* WRITE_MULTIPLE_BLOCK */
+#define SD_CMD32 32 /* ERASE_ER_BLK_START */
+#define SD_CMD33 33 /* ERASE_ER_BLK_END */
+#define SD_CMD38 38 /* ERASE */
+#define SD_CMD42 42 /* LOCK_UNLOCK */
+#define SD_CMD55 55 /* APP_CMD */
+#define SD_CMD56 56 /* GEN_CMD */
+#define SD_CMD58 58 /* READ_OCR */
+#define SD_CMD59 59 /* CRC_ON_OFF */
+
+#define ACMD_FLAG 0x80             /* ACMD BIT */
+#define SD_ACMD13 (ACMD_FLAG + 13) /* APP_SD_STATUS */
+#define SD_ACMD22 (ACMD_FLAG + 22) /* APP_SEND_NUM_WR_BLOCKS */
+#define SD_ACMD23 (ACMD_FLAG + 23) /* APP_SET_WR_BLK_ERASE_COUNT */
+#define SD_ACMD41 (ACMD_FLAG + 41) /* APP_SEND_OP_COND */
+#define SD_ACMD42 (ACMD_FLAG + 42) /* APP_SET_CLR_CARD_DETECT */
+#define SD_ACMD51 (ACMD_FLAG + 51) /* APP_SEND_SCR */
+
+#define R1_IN_IDLE 0x01
+#define R1_ERASE_RESET 0x02
+#define R1_ILLEGAL_CMD 0x04
+#define R1_CRC_ERROR 0x08
+#define R1_ERASE_SEQ_ERROR 0x10
+#define R1_ADDRESS_ERROR 0x20
+#define R1_PARAMETER_ERROR 0x40
+#define R1_ERRORS                                                        \
+  (R1_ERASE_RESET | R1_ILLEGAL_CMD | R1_CRC_ERROR | R1_ERASE_SEQ_ERROR | \
+   R1_ADDRESS_ERROR | R1_PARAMETER_ERROR)
+
+#define SD_TYPE_NONE 0
+#define SD_TYPE_MMC 0x01
+#define SD_TYPE_SDSC1 0x02
+#define SD_TYPE_SDSC2 0x04
+#define SD_TYPE_SDHC 0x08
+#define SD_TYPE_SDSC (SD_TYPE_SDSC1 | SD_TYPE_SDSC2)
+
+#define SD_STATUS_INIT 0x01
+
+#define FAST_BAUDRATE 25000000 /* 25 MHZ */
+
+#define CS_HIGH pwjs_gpio_write(__sdcard_handle.cs_pin, PWJS_GPIO_HIGH)
+#define CS_LOW pwjs_gpio_write(__sdcard_handle.cs_pin, PWJS_GPIO_LOW)
+
+typedef struct __sdcard_handle_s {
+  uint8_t bus;
+  uint8_t cs_pin;
+  uint8_t status;
+  uint8_t sd_type;
+  int size;
+  int count;
+} __sdcard_handle_t;
+
+static __sdcard_handle_t __sdcard_handle;
+
+static int __wait_for_ready(uint32_t timeout_ms) {
+  uint8_t send = 0xFF;
+  uint8_t receive;
+  uint64_t start_ms = pwjs_gettime();
+  do {
+    pwjs_spi_sendrecv(__sdcard_handle.bus, &send, &receive, 1, 100);
+  } while ((receive != 0xFF) && (pwjs_gettime() < start_ms + timeout_ms));
+  if (receive == 0xFF) {
+    return 0;
+  }
+  return ETIMEDOUT;
+}
+
+static void __deselect(void) {
+  uint8_t send = 0xFF;
+  CS_HIGH;
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);  // dummy clock
+}
+
+static int __select(void) {
+  uint8_t send = 0xFF;
+  CS_LOW;
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);  // dummy clock
+  if (__wait_for_ready(500) < 0) {
+    __deselect();
+    return ETIMEDOUT;
+  }
+  return 0;
+}
+
+/**
+ * @brief send sdcard command
+ *
+ * @param command command
+ * @param arg argument
+ * @param response response of the command (output)
+ * @return uint8_t 1 is R1, uint8_t2 is R2. minus value if the function return
+ * error.
+ */
+static int __send_command(uint8_t command, uint32_t arg, uint8_t crc) {
+  uint8_t res = 0;
+  uint8_t res2 = 0;
+  int ret;
+  uint8_t retry = 10;
+  uint8_t command_buffer[6];
+  if (command & ACMD_FLAG) {
+    res = __send_command(SD_CMD55, 0, 0x00);
+    if (res & R1_ERRORS) {
+      return res;
+    }
+    command &= ~ACMD_FLAG;
+  }
+  if (command != SD_CMD12) {
+    __deselect();
+    if (__select() < 0) {
+      return ETIMEDOUT;
+    }
+  }
+  command_buffer[0] = (0x40 | command);
+  command_buffer[1] = ((arg >> 24) & 0xFF);
+  command_buffer[2] = ((arg >> 16) & 0xFF);
+  command_buffer[3] = ((arg >> 8) & 0xFF);
+  command_buffer[4] = (arg & 0xFF);
+  command_buffer[5] = (crc | 0x01);  // Dummy CRC because CRC is not checked.
+  pwjs_spi_send(__sdcard_handle.bus, command_buffer, 6, 600);
+  // receive response
+  if ((command == SD_CMD12) || (command == SD_CMD38)) {  // R1b response
+    do {
+      pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &res, 1, 100);
+    } while ((res > 0) && --retry);
+  } else {
+    do {
+      pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &res, 1, 100);
+    } while ((res & 0x80) && --retry);
+  }
+  if (command == SD_CMD13) {  // R2 response
+    pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &res2, 1, 100);
+  }
+  ret = ((res2 << 8) | res);
+  return ret;
+}
+
+/**
+ * Address of a block in the commands: SDHC cards are addressed by block,
+ * the others by byte
+ */
+static uint32_t __block_address(uint32_t block) {
+  if (__sdcard_handle.sd_type & SD_TYPE_SDHC) {
+    return block;
+  }
+  return block * __sdcard_handle.size;
+}
+
+/**
+ * Release the card after a transaction
+ */
+static void __release(void) {
+  uint8_t send = 0xFF;
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);
+  CS_HIGH;
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);
+}
+
+static int __receive_data(uint8_t *buff, unsigned int length) {
+  int ret = 0;
+  uint8_t tocken;
+  const uint32_t timeout_ms = 200;
+  uint64_t start_ms = pwjs_gettime();
+  do {
+    pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);
+  } while (tocken == 0xFF && pwjs_gettime() < start_ms + timeout_ms);
+  if (tocken == 0xFE) {
+    pwjs_spi_recv(__sdcard_handle.bus, 0xFF, buff, length, length * 10);
+    pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);  // CRC
+    pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);  // CRC
+  } else {
+    ret = ETIMEDOUT;
+  }
+  return ret;
+}
+
+static int __receive_datablock(uint8_t *buff, unsigned int length) {
+  int ret = __receive_data(buff, length);
+  __release();
+  return ret;
+}
+
+/**
+ * Send a data block with the start token (0xFE for CMD24, 0xFC for CMD25)
+ * and wait until the card has written it
+ */
+static int __send_data(uint8_t tocken, const uint8_t *buff,
+                       unsigned int length) {
+  int ret = 0;
+  pwjs_spi_send(__sdcard_handle.bus, &tocken, 1, 100);  // Send start token
+  pwjs_spi_send(__sdcard_handle.bus, (uint8_t *)buff, length,
+                length * 10);  // Send data
+  const uint32_t timeout_ms = 300;
+  uint64_t start_ms = pwjs_gettime();
+  do {
+    pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);
+  } while (tocken == 0xFF && pwjs_gettime() < start_ms + timeout_ms);
+  if ((tocken & 0x1F) == 0x05) {  // Dsta accepted
+    start_ms = pwjs_gettime();
+    do {
+      pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);
+    } while (tocken == 0x00 && pwjs_gettime() < start_ms + timeout_ms);
+  } else {
+    ret = ETIMEDOUT;
+  }
+  return ret;
+}
+
+static int __send_datablock(const uint8_t *buff, unsigned int length) {
+  int ret = __send_data(0xFE, buff, length);
+  __release();
+  return ret;
+}
+
+int sdcard_erase_blocks(uint32_t start, uint32_t end) {
+  int ret = 0;
+  if ((__send_command(SD_CMD32, __block_address(start), 0x00) != 0) ||
+      (__send_command(SD_CMD33, __block_address(end), 0x00) != 0) ||
+      (__send_command(SD_CMD38, 0, 0x00) != 0)) {
+    ret = ETIMEDOUT;
+  }
+  __release();
+  return ret;
+}
+
+int sdcard_init(void) {
+  uint8_t send = 0xFF;
+  uint64_t start_ms;
+  const uint16_t timeout_ms = 1000;
+  uint8_t resp[16];
+  int res;
+  if ((__sdcard_handle.status & SD_STATUS_INIT)) {
+    return EALREADY;
+  }
+  CS_HIGH;
+  pwjs_delay(1);                                        // 1ms delay
+  for (int i = 0; i < 10; i++) {                      // 80 cycle clock
+    pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);  // dummy clock
+  }
+  CS_LOW;
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);  // dummy clock
+  if (__send_command(SD_CMD0, 0, 0x94) == R1_IN_IDLE) {
+    start_ms = pwjs_gettime();
+    if (__send_command(SD_CMD8, 0x1AA, 0x86) == R1_IN_IDLE) {
+      pwjs_spi_recv(__sdcard_handle.bus, 0xFF, resp, 4, 400);
+      if ((resp[2] == 0x01) && (resp[3] == 0xAA)) {
+        do {
+          res = __send_command(SD_ACMD41, 0x40000000, 0x00);
+        } while ((res != 0) && (pwjs_gettime() < start_ms + timeout_ms));
+        if (res == 0) {
+          __sdcard_handle.sd_type = SD_TYPE_SDSC2;
+          if (__send_command(SD_CMD58, 0, 0x00) == 0) {
+            pwjs_spi_recv(__sdcard_handle.bus, 0xFF, resp, 4, 400);
+            if (resp[0] & 0x40) {
+              __sdcard_handle.sd_type |= SD_TYPE_SDHC;
+            }
+          }
+        }
+      }
+    } else {
+      uint8_t next_cmd;
+      if (__send_command(SD_ACMD41, 0, 0x00) <= R1_IN_IDLE) {
+        __sdcard_handle.sd_type = SD_TYPE_SDSC1;
+        next_cmd = SD_ACMD41;
+      } else {
+        __sdcard_handle.sd_type = SD_TYPE_MMC;
+        next_cmd = SD_CMD1;
+      }
+      do {
+        res = __send_command(next_cmd, 0, 0x00);
+      } while ((res != 0) && (pwjs_gettime() < start_ms + timeout_ms));
+      if (res == 0) {
+        res = __send_command(SD_CMD16, SD_BLOCK, 0x00);
+        if (res != 0) {
+          __sdcard_handle.sd_type = SD_TYPE_NONE;
+        }
+      } else {
+        __sdcard_handle.sd_type = SD_TYPE_NONE;
+      }
+    }
+  }
+  if (__sdcard_handle.sd_type != SD_TYPE_NONE) {
+    res = __send_command(SD_CMD9, 0, 0x00);
+    if (res != 0) {
+      __sdcard_handle.sd_type = SD_TYPE_NONE;
+    } else {
+      uint8_t data = 0;
+      uint8_t retry = 10;
+      do {
+        pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &data, 1, 100);
+      } while ((data != 0xFE) && --retry);
+      pwjs_spi_recv(__sdcard_handle.bus, 0xFF, resp, 16, 1600);
+      int bl_len = (resp[5] & 0x0F);
+      __sdcard_handle.size = (1 << bl_len);
+      if (resp[0] == 0x00) {
+        int c_size =
+            (((resp[6] & 0x3) << 10) | (resp[7] << 2) | (resp[8] >> 6));
+        int c_size_multi = (((resp[9] & 0x3) << 1) | (resp[10] >> 7));
+        __sdcard_handle.count = (c_size + 1) * (1 << (c_size_multi + 2));
+      } else if (resp[0] == 0x40) {
+        int c_size = (((resp[7] & 0x3F) << 16) | (resp[8] << 8) | resp[9]);
+        c_size++;
+        __sdcard_handle.count = (c_size << 10);
+      }
+    }
+  }
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);
+  CS_HIGH;
+  pwjs_spi_send(__sdcard_handle.bus, &send, 1, 100);
+
+  if (__sdcard_handle.sd_type != SD_TYPE_NONE) {
+    __sdcard_handle.status |= SD_STATUS_INIT;
+    pwjs_set_spi_baudrate(__sdcard_handle.bus, FAST_BAUDRATE);
+  }
+  return (int)__sdcard_handle.status;
+}
+
+static void init_sd(void) {
+  __sdcard_handle.bus = 0;
+  __sdcard_handle.cs_pin = 0;
+  __sdcard_handle.sd_type = SD_TYPE_NONE;
+  __sdcard_handle.status = 0;
+  __sdcard_handle.count = 0;
+  __sdcard_handle.size = 0;
+}
+
+void sdcard_setup(uint8_t bus, uint8_t cs_pin) {
+  init_sd();
+  __sdcard_handle.bus = bus;
+  __sdcard_handle.cs_pin = cs_pin;
+}
+
+void sdcard_shutdown(void) { init_sd(); }
+
+bool sdcard_is_ready(void) {
+  return (__sdcard_handle.status & SD_STATUS_INIT) != 0;
+}
+
+int sdcard_get_block_count(void) { return __sdcard_handle.count; }
+
+int sdcard_get_block_size(void) { return __sdcard_handle.size; }
+
+/**
+ * Read blocks, with READ_MULTIPLE_BLOCK for more than one block
+ */
+int sdcard_read_blocks(uint32_t block, uint8_t *buffer, uint32_t count) {
+  int ret = 0;
+  if (count == 0) {
+    return 0;
+  }
+  if (count == 1) {
+    if (__send_command(SD_CMD17, __block_address(block), 0x00) != 0) {
+      __release();
+      return EIO;
+    }
+    return __receive_datablock(buffer, __sdcard_handle.size) < 0 ? EIO : 0;
+  }
+  if (__send_command(SD_CMD18, __block_address(block), 0x00) != 0) {
+    __release();
+    return EIO;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (__receive_data(buffer, __sdcard_handle.size) < 0) {
+      ret = EIO;
+      break;
+    }
+    buffer += __sdcard_handle.size;
+  }
+  __send_command(SD_CMD12, 0, 0x00);
+  __wait_for_ready(500);
+  __release();
+  return ret;
+}
+
+/**
+ * Write blocks, with WRITE_MULTIPLE_BLOCK for more than one block. The
+ * card is told the number of blocks first so that it can pre-erase them.
+ */
+int sdcard_write_blocks(uint32_t block, const uint8_t *buffer,
+                        uint32_t count) {
+  int ret = 0;
+  if (count == 0) {
+    return 0;
+  }
+  if (count == 1) {
+    if (__send_command(SD_CMD24, __block_address(block), 0x00) != 0) {
+      __release();
+      return EIO;
+    }
+    return __send_datablock(buffer, __sdcard_handle.size) < 0 ? EIO : 0;
+  }
+  if (!(__sdcard_handle.sd_type & SD_TYPE_MMC)) {
+    __send_command(SD_ACMD23, count, 0x00);
+  }
+  if (__send_command(SD_CMD25, __block_address(block), 0x00) != 0) {
+    __release();
+    return EIO;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (__send_data(0xFC, buffer, __sdcard_handle.size) < 0) {
+      ret = EIO;
+      break;
+    }
+    buffer += __sdcard_handle.size;
+  }
+  uint8_t tocken = 0xFD;  // Stop token
+  pwjs_spi_send(__sdcard_handle.bus, &tocken, 1, 100);
+  pwjs_spi_recv(__sdcard_handle.bus, 0xFF, &tocken, 1, 10);  // Stuff byte
+  if (__wait_for_ready(500) < 0) {
+    ret = EIO;
+  }
+  __release();
+  return ret;
+}
+
+static int sdcard_blkdev_read(pwjs_blkdev_t *blkdev, uint32_t block,
+                              uint32_t offset, uint8_t *buffer, size_t size) {
+  if (!(__sdcard_handle.status & SD_STATUS_INIT)) {
+    return EIO;
+  }
+  return sdcard_read_blocks(block, buffer, size / __sdcard_handle.size);
+}
+
+static int sdcard_blkdev_write(pwjs_blkdev_t *blkdev, uint32_t block,
+                               uint32_t offset, const uint8_t *buffer,
+                               size_t size) {
+  if (!(__sdcard_handle.status & SD_STATUS_INIT)) {
+    return EIO;
+  }
+  return sdcard_write_blocks(block, buffer, size / __sdcard_handle.size);
+}
+
+static int sdcard_blkdev_ioctl(pwjs_blkdev_t *blkdev, int op, int arg) {
+  int ret;
+  switch (op) {
+    case PWJS_BLKDEV_INIT:
+      ret = sdcard_init();
+      if (ret == EALREADY) {
+        return __sdcard_handle.status;
+      }
+      return ret > 0 ? ret : EIO;
+    case PWJS_BLKDEV_SHUTDOWN:
+      init_sd();
+      return 0;
+    case PWJS_BLKDEV_SYNC:
+      return 0;
+    case PWJS_BLKDEV_BLOCK_COUNT:
+      return __sdcard_handle.count;
+    case PWJS_BLKDEV_BLOCK_SIZE:
+    case PWJS_BLKDEV_BUFFER_SIZE:
+      return __sdcard_handle.size;
+    case PWJS_BLKDEV_ERASE:
+      if (!(__sdcard_handle.status & SD_STATUS_INIT)) {
+        return EIO;
+      }
+      return sdcard_erase_blocks(arg, arg);
+    default:
+      return EINVAL;
+  }
+}
+
+// the card state is global, all SDCard objects share the same device
+pwjs_blkdev_t sdcard_blkdev = {.read = sdcard_blkdev_read,
+                               .write = sdcard_blkdev_write,
+                               .ioctl = sdcard_blkdev_ioctl,
+                               .free = NULL,
+                               .map = NULL};
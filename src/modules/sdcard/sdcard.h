@@ -0,0 +1,58 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef __SDCARD_H
+#define __SDCARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "blkdev.h"
+
+/**
+ * SD card in SPI mode. The card state is global: a single card is driven,
+ * on the bus and with the CS pin given to sdcard_setup(). The bus must be
+ * set up by the caller.
+ */
+void sdcard_setup(uint8_t bus, uint8_t cs_pin);
+
+/**
+ * Initialize the card. Return the status (> 0) or a negative error code,
+ * EALREADY if already initialized.
+ */
+int sdcard_init(void);
+void sdcard_shutdown(void);
+bool sdcard_is_ready(void);
+int sdcard_get_block_count(void);
+int sdcard_get_block_size(void);
+
+/**
+ * Transfer count blocks, with a multiple block command for more than one
+ */
+int sdcard_read_blocks(uint32_t block, uint8_t *buffer, uint32_t count);
+int sdcard_write_blocks(uint32_t block, const uint8_t *buffer,
+                        uint32_t count);
+int sdcard_erase_blocks(uint32_t start, uint32_t end);
+
+extern pwjs_blkdev_t sdcard_blkdev;
+
+#endif /* __SDCARD_H */
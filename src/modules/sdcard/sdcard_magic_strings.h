@@ -24,7 +24,9 @@
 
 #define MSTR_SDCARD_SDCARD "SDCard"
 #define MSTR_SDCARD_READ "read"
+#define MSTR_SDCARD_READ_BLOCKS "readBlocks"
 #define MSTR_SDCARD_WRITE "write"
+#define MSTR_SDCARD_WRITE_BLOCKS "writeBlocks"
 #define MSTR_SDCARD_IOCTL "ioctl"
 #define MSTR_SDCARD_SPI_MISO "miso"
 #define MSTR_SDCARD_SPI_MOSI "mosi"
@@ -24,6 +24,7 @@
 #include "err.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "mem.h"
 #include "spi.h"
 #include "spi_magic_strings.h"
 
@@ -31,7 +32,7 @@
 #define SPI_DEFAULT_BAUDRATE 3000000
 #define SPI_DEFAULT_BITORDER PWJS_SPI_BITORDER_MSB
 
-static void buffer_free_cb(void *native_p) { free(native_p); }
+static void buffer_free_cb(void *native_p) { pwjs_free(native_p); }
 
 /**
  * SPI() constructor
@@ -119,11 +120,11 @@ JERRYXX_FUN(spi_transfer_fn) {
         jerry_get_typedarray_buffer(data, &byteOffset, &byteLength);
     size_t len = jerry_get_arraybuffer_byte_length(array_buffer);
     uint8_t *tx_buf = jerry_get_arraybuffer_pointer(array_buffer);
-    uint8_t *rx_buf = malloc(len);
+    uint8_t *rx_buf = pwjs_malloc(PWJS_MEM_SPI, len);
     int ret = pwjs_spi_sendrecv(bus, tx_buf, rx_buf, len, timeout);
     jerry_release_value(array_buffer);
     if (ret < 0) {
-      free(rx_buf);
+      pwjs_free(rx_buf);
       return jerry_create_error_from_value(create_system_error(ret), true);
     } else {
       jerry_value_t buffer =
@@ -136,11 +137,11 @@ JERRYXX_FUN(spi_transfer_fn) {
   } else if (jerry_value_is_string(data)) { /* for string */
     jerry_size_t len = jerryxx_get_ascii_string_size(data);
     uint8_t tx_buf[len];
-    uint8_t *rx_buf = malloc(len);
+    uint8_t *rx_buf = pwjs_malloc(PWJS_MEM_SPI, len);
     jerryxx_string_to_ascii_char_buffer(data, tx_buf, len);
     int ret = pwjs_spi_sendrecv(bus, tx_buf, rx_buf, len, timeout);
     if (ret < 0) {
-      free(rx_buf);
+      pwjs_free(rx_buf);
       return jerry_create_error_from_value(create_system_error(ret), true);
     } else {
       jerry_value_t buffer =
@@ -237,12 +238,12 @@ JERRYXX_FUN(spi_recv_fn) {
   jerry_release_value(bus_value);
 
   // recv data
-  uint8_t *buf = malloc(length);
+  uint8_t *buf = pwjs_malloc(PWJS_MEM_SPI, length);
   int ret = pwjs_spi_recv(bus, 0, buf, length, timeout);
 
   // return an Uin8Array
   if (ret < 0) {
-    free(buf);
+    pwjs_free(buf);
     return jerry_create_error_from_value(create_system_error(ret), true);
   } else {
     jerry_value_t array_buffer =
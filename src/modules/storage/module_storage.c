@@ -20,10 +20,12 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "err.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "mem.h"
 #include "storage.h"
 #include "storage_magic_strings.h"
 
@@ -34,8 +36,17 @@ JERRYXX_FUN(storage_set_item_fn) {
   JERRYXX_CHECK_ARG_STRING(0, "key")
   JERRYXX_CHECK_ARG_STRING(1, "value")
   JERRYXX_GET_ARG_STRING_AS_CHAR(0, key)
-  JERRYXX_GET_ARG_STRING_AS_CHAR(1, value)
+  // values may span several pages, keep them off the stack
+  jerry_size_t value_sz = jerry_get_string_size(JERRYXX_GET_ARG(1));
+  char *value = (char *)pwjs_malloc(PWJS_MEM_STORAGE, value_sz + 1);
+  if (value == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  jerry_string_to_char_buffer(JERRYXX_GET_ARG(1), (jerry_char_t *)value,
+                              value_sz);
+  value[value_sz] = '\0';
   int ret = storage_set_item(key, value);
+  pwjs_free(value);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
@@ -48,15 +59,55 @@ JERRYXX_FUN(storage_set_item_fn) {
 JERRYXX_FUN(storage_get_item_fn) {
   JERRYXX_CHECK_ARG_STRING(0, "key")
   JERRYXX_GET_ARG_STRING_AS_CHAR(0, key)
-  int len = storage_get_value_length(key);
+  const uint8_t *value;
+  bool bytes;
+  int len = storage_get_item_ref(key, &value, &bytes);
+  if (len < 0 || bytes) {
+    return jerry_create_null();
+  }
+  // create the string straight from flash
+  return jerry_create_string_sz((const jerry_char_t *)value, len);
+}
+
+/**
+ * exports.setItemBytes function
+ */
+JERRYXX_FUN(storage_set_item_bytes_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "key")
+  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "value")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, key)
+  jerry_length_t byte_offset = 0;
+  jerry_length_t byte_length = 0;
+  jerry_value_t arrbuf = jerry_get_typedarray_buffer(
+      JERRYXX_GET_ARG(1), &byte_offset, &byte_length);
+  uint8_t *buf = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+  jerry_release_value(arrbuf);
+  int ret = storage_set_item_bytes(key, buf, byte_length);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * exports.getItemBytes function
+ */
+JERRYXX_FUN(storage_get_item_bytes_fn) {
+  JERRYXX_CHECK_ARG_STRING(0, "key")
+  JERRYXX_GET_ARG_STRING_AS_CHAR(0, key)
+  const uint8_t *value;
+  bool bytes;
+  int len = storage_get_item_ref(key, &value, &bytes);
   if (len < 0) {
     return jerry_create_null();
   }
-  char *buf = (char *)malloc(len);
-  storage_get_value(key, buf);
-  jerry_value_t value = jerry_create_string_sz((const jerry_char_t *)buf, len);
-  free(buf);
-  return value;
+  // copy once from flash, the record may move on the next write
+  jerry_value_t array = jerry_create_typedarray(JERRY_TYPEDARRAY_UINT8, len);
+  if (jerry_value_is_error(array)) {
+    return array;
+  }
+  memcpy(jerryxx_get_typedarray_buffer(array), value, len);
+  return array;
 }
 
 /**
@@ -69,6 +120,89 @@ JERRYXX_FUN(storage_remove_item_fn) {
   return jerry_create_undefined();
 }
 
+/**
+ * exports.batch function. Each entry is a [key, value] pair, value is a
+ * string, a TypedArray, or null to remove the key.
+ */
+JERRYXX_FUN(storage_batch_fn) {
+  JERRYXX_CHECK_ARG_ARRAY(0, "entries")
+  jerry_value_t entries = JERRYXX_GET_ARG(0);
+  int count = jerry_get_array_length(entries);
+  if (count == 0) {
+    return jerry_create_undefined();
+  }
+  storage_batch_op_t *ops = (storage_batch_op_t *)pwjs_malloc(
+      PWJS_MEM_STORAGE, count * sizeof(storage_batch_op_t));
+  if (ops == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  memset(ops, 0, count * sizeof(storage_batch_op_t));
+  // the strings are copied, the typedarrays are referenced by the entries
+  int ret = 0;
+  for (int i = 0; ret == 0 && i < count; i++) {
+    jerry_value_t entry = jerry_get_property_by_index(entries, i);
+    jerry_value_t key = jerry_get_property_by_index(entry, 0);
+    jerry_value_t value = jerry_get_property_by_index(entry, 1);
+    if (!jerry_value_is_string(key) ||
+        !(jerry_value_is_string(value) || jerry_value_is_typedarray(value) ||
+          jerry_value_is_null(value) || jerry_value_is_undefined(value))) {
+      ret = EINVAL;
+    } else {
+      jerry_size_t key_sz = jerry_get_string_size(key);
+      ops[i].key = (char *)pwjs_malloc(PWJS_MEM_STORAGE, key_sz + 1);
+      if (ops[i].key == NULL) {
+        ret = ENOMEM;
+      } else {
+        jerry_string_to_char_buffer(key, (jerry_char_t *)ops[i].key, key_sz);
+        ops[i].key[key_sz] = '\0';
+      }
+    }
+    if (ret == 0 && jerry_value_is_string(value)) {
+      jerry_size_t value_sz = jerry_get_string_size(value);
+      uint8_t *buf = (uint8_t *)pwjs_malloc(PWJS_MEM_STORAGE, value_sz + 1);
+      if (buf == NULL) {
+        ret = ENOMEM;
+      } else {
+        jerry_string_to_char_buffer(value, (jerry_char_t *)buf, value_sz);
+        ops[i].value = buf;
+        ops[i].length = value_sz;
+      }
+    } else if (ret == 0 && jerry_value_is_typedarray(value)) {
+      jerry_length_t byte_offset = 0;
+      jerry_length_t byte_length = 0;
+      jerry_value_t arrbuf =
+          jerry_get_typedarray_buffer(value, &byte_offset, &byte_length);
+      ops[i].value = jerry_get_arraybuffer_pointer(arrbuf) + byte_offset;
+      ops[i].length = byte_length;
+      ops[i].bytes = true;
+      jerry_release_value(arrbuf);
+    }
+    jerry_release_value(value);
+    jerry_release_value(key);
+    jerry_release_value(entry);
+  }
+  if (ret == 0) {
+    ret = storage_write_batch(ops, count);
+  }
+  for (int i = 0; i < count; i++) {
+    if (ops[i].key != NULL) {
+      pwjs_free(ops[i].key);
+    }
+    if (ops[i].value != NULL && !ops[i].bytes) {
+      pwjs_free((void *)ops[i].value);
+    }
+  }
+  pwjs_free(ops);
+  if (ret == EINVAL) {
+    return jerry_create_error(JERRY_ERROR_TYPE,
+                              (const jerry_char_t *)"invalid batch entry");
+  }
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return jerry_create_undefined();
+}
+
 /**
  * exports.clear function
  */
@@ -101,10 +235,10 @@ JERRYXX_FUN(storage_key_fn) {
   if (len < 0) {
     return jerry_create_null();
   }
-  char *buf = (char *)malloc(len);
+  char *buf = (char *)pwjs_malloc(PWJS_MEM_STORAGE, len);
   storage_get_key(index, buf);
   jerry_value_t ret = jerry_create_string_sz((const jerry_char_t *)buf, len);
-  free(buf);
+  pwjs_free(buf);
   return ret;
 }
 
@@ -118,8 +252,13 @@ jerry_value_t module_storage_init() {
                                 storage_set_item_fn);
   jerryxx_set_property_function(exports, MSTR_STORAGE_GET_ITEM,
                                 storage_get_item_fn);
+  jerryxx_set_property_function(exports, MSTR_STORAGE_SET_ITEM_BYTES,
+                                storage_set_item_bytes_fn);
+  jerryxx_set_property_function(exports, MSTR_STORAGE_GET_ITEM_BYTES,
+                                storage_get_item_bytes_fn);
   jerryxx_set_property_function(exports, MSTR_STORAGE_REMOVE_ITEM,
                                 storage_remove_item_fn);
+  jerryxx_set_property_function(exports, MSTR_STORAGE_BATCH, storage_batch_fn);
   jerryxx_set_property_function(exports, MSTR_STORAGE_CLEAR, storage_clear_fn);
   jerryxx_set_property_function(exports, MSTR_STORAGE_KEY, storage_key_fn);
   jerryxx_set_property_function(exports, MSTR_STORAGE_LENGTH,
@@ -21,29 +21,74 @@
 
 #include "storage.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "err.h"
 #include "flash.h"
 
-// int get_available_slot();
-// storage_slot_data_t *slot_get_data(int slot);
-// int slot_set_data(slot_data_t *, key, value);
-// int slot_write(slot, slot_data);
-// int slot_find(char *key);
+/**
+ * RAM index of the live records, built from flash on first access:
+ * - table : open-addressing hash table (key hash -> slot, -1 if empty)
+ * - hashes : key hash of each slot, compared before touching flash
+ * - live : live slots in insertion order, so key(i) and length are O(1)
+ */
+#define INDEX_SIZE (SLOT_COUNT * 2)
 
-static int slot_new() {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(pwjs_flash_addr + (SECTOR_BASE * PICOWJS_FLASH_SECTOR_SIZE));
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot_data =
-        (storage_slot_data_t *)(STORAGE_ADDR + i * SLOT_SIZE);
-    if (slot_data->status == SS_EMPTY) {
-      return i;
-    }
+static struct {
+  bool ready;
+  int16_t table[INDEX_SIZE];
+  uint32_t hashes[SLOT_COUNT];
+  int16_t live[SLOT_COUNT];
+  int live_count;
+} storage_index;
+
+/**
+ * State of the log:
+ * - active : sector the records are appended to (-1 if none)
+ * - next_slot : next free slot in the active sector
+ * - seq : seq of the next record
+ * - sector_seq : seq of the next opened sector
+ * - commit_slot : latest commit record (-1 if none), kept like a live record
+ * - commit_seq : seq of the latest commit record, the batch records with a
+ *   lower seq are committed
+ * - live_slots : slots of the live records per sector, to pick the sector
+ *   to collect
+ * - damaged : sectors holding a torn record, their records are checked
+ *   when walked until the sector is collected
+ */
+static struct {
+  int active;
+  int next_slot;
+  uint32_t seq;
+  uint32_t sector_seq;
+  int commit_slot;
+  uint32_t commit_seq;
+  uint16_t live_slots[SECTOR_COUNT];
+  bool damaged[SECTOR_COUNT];
+} storage_log;
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len) {
+  static const uint32_t table[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+      0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+      0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
+    crc = (crc >> 4) ^ table[crc & 0x0F];
   }
-  return -1;  // storage full
+  return crc;
+}
+
+static uint32_t key_hash(const char *key, int len) {
+  uint32_t hash = 2166136261u;  // FNV-1a
+  for (int i = 0; i < len; i++) {
+    hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+  }
+  return hash;
 }
 
 static storage_slot_data_t *slot_get_data(int slot) {
@@ -52,158 +97,947 @@ static storage_slot_data_t *slot_get_data(int slot) {
   return (storage_slot_data_t *)(STORAGE_ADDR + (slot * SLOT_SIZE));
 }
 
-static void slot_set_data(storage_slot_data_t *slot_data, char *key,
-                          char *value) {
-  size_t key_length = strlen(key);
-  size_t value_length = strlen(value);
-  memcpy(slot_data->buffer, key, key_length);
-  memcpy(slot_data->buffer + key_length, value, value_length);
-  slot_data->status = SS_USE;
-  slot_data->key_length = key_length;
-  slot_data->value_length = value_length;
+static int record_get_count(size_t key_length, size_t value_length) {
+  return (STORAGE_RECORD_HEADER_SIZE + key_length + value_length +
+          SLOT_SIZE - 1) /
+         SLOT_SIZE;
+}
+
+/**
+ * Return the number of slots used by the record
+ */
+static int slot_get_count(storage_slot_data_t *slot_data) {
+  return record_get_count(slot_data->key_length, slot_data->value_length);
+}
+
+/**
+ * Return the CRC of the record: the header but the status, then the key and
+ * the value. The CRC of a padding record covers the header only.
+ */
+static uint32_t record_crc(storage_slot_data_t *header, const char *key,
+                           const uint8_t *value) {
+  uint32_t crc = crc32_update(0xFFFFFFFF, (uint8_t *)header + 1,
+                              offsetof(storage_slot_data_t, crc) - 1);
+  if (header->status != SS_PAD) {
+    crc = crc32_update(crc, (const uint8_t *)key, header->key_length);
+    crc = crc32_update(crc, value, header->value_length);
+  }
+  return ~crc;
+}
+
+/**
+ * Return true if a complete record, within count slots, starts at the slot
+ */
+static bool record_is_valid(int slot, int count) {
+  storage_slot_data_t *slot_data = slot_get_data(slot);
+  if (slot_data->status == SS_EMPTY || slot_get_count(slot_data) > count) {
+    return false;
+  }
+  return record_crc(slot_data, slot_data->buffer,
+                    (uint8_t *)slot_data->buffer + slot_data->key_length) ==
+         slot_data->crc;
+}
+
+static bool slot_is_erased(int slot) {
+  const uint32_t *words = (const uint32_t *)slot_get_data(slot);
+  for (int i = 0; i < SLOT_SIZE / 4; i++) {
+    if (words[i] != 0xFFFFFFFF) {
+      return false;
+    }
+  }
+  return true;
 }
 
-static void slot_write(int slot, storage_slot_data_t *slot_data) {
+static bool slot_is_batch(storage_slot_data_t *slot_data) {
+  return slot_data->status == SS_BATCH ||
+         slot_data->status == SS_BATCH_BYTES ||
+         slot_data->status == SS_BATCH_REMOVE;
+}
+
+/**
+ * Return true if the record holds a value: a single write, or a write of a
+ * committed batch
+ */
+static bool slot_is_used(storage_slot_data_t *slot_data) {
+  if (slot_data->status == SS_BATCH || slot_data->status == SS_BATCH_BYTES) {
+    return slot_data->seq < storage_log.commit_seq;
+  }
+  return slot_data->status == SS_USE || slot_data->status == SS_USE_BYTES;
+}
+
+static bool slot_is_bytes(storage_slot_data_t *slot_data) {
+  return slot_data->status == SS_USE_BYTES ||
+         slot_data->status == SS_BATCH_BYTES;
+}
+
+static storage_sector_header_t *sector_get_header(int sector) {
+  return (storage_sector_header_t *)slot_get_data(sector * SLOTS_PER_SECTOR);
+}
+
+/**
+ * Return the first record at or after the slot j of the sector, or -1 after
+ * the last record. In a damaged sector the records are checked, and the
+ * slots not starting a valid record are skipped one at a time.
+ */
+static int record_seek(int sector, int j) {
+  for (; j < SLOTS_PER_SECTOR; j++) {
+    int slot = sector * SLOTS_PER_SECTOR + j;
+    if (!storage_log.damaged[sector]) {
+      return slot_get_data(slot)->status == SS_EMPTY ? -1 : j;
+    }
+    if (record_is_valid(slot, SLOTS_PER_SECTOR - j)) {
+      return j;
+    }
+  }
+  return -1;
+}
+
+static int record_first(int sector) { return record_seek(sector, 1); }
+
+static int record_next(int sector, int j) {
+  storage_slot_data_t *slot_data = slot_get_data(sector * SLOTS_PER_SECTOR + j);
+  return record_seek(sector, j + slot_get_count(slot_data));
+}
+
+/**
+ * Program a slot. The data must be in RAM, not in the (XIP) flash.
+ */
+static int slot_write(int slot, void *data) {
   int sector = (slot * SLOT_SIZE) / PICOWJS_FLASH_SECTOR_SIZE;
   int offset = (slot * SLOT_SIZE) % PICOWJS_FLASH_SECTOR_SIZE;
-  pwjs_flash_program(SECTOR_BASE + sector, offset, (uint8_t *)slot_data,
-                   SLOT_SIZE);
+  return pwjs_flash_program(SECTOR_BASE + sector, offset, (uint8_t *)data,
+                          SLOT_SIZE);
 }
 
-static int slot_find(char *key, int len) {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(pwjs_flash_addr + (SECTOR_BASE * PICOWJS_FLASH_SECTOR_SIZE));
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot_data =
-        (storage_slot_data_t *)(STORAGE_ADDR + i * SLOT_SIZE);
-    if (slot_data->status == SS_USE && slot_data->key_length == len &&
-        strncmp(slot_data->buffer, key, len) == 0) {
-      return i;
+// --------------------------------------------------------------------------
+// RAM INDEX
+// --------------------------------------------------------------------------
+
+static void index_reset() {
+  for (int i = 0; i < INDEX_SIZE; i++) {
+    storage_index.table[i] = -1;
+  }
+  storage_index.live_count = 0;
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    storage_log.live_slots[i] = 0;
+  }
+  storage_log.commit_slot = -1;
+  storage_log.commit_seq = 0;
+}
+
+static void index_insert(int slot, uint32_t hash) {
+  int pos = hash % INDEX_SIZE;
+  while (storage_index.table[pos] >= 0) {
+    pos = (pos + 1) % INDEX_SIZE;
+  }
+  storage_index.table[pos] = slot;
+  storage_index.hashes[slot] = hash;
+  storage_index.live[storage_index.live_count++] = slot;
+  storage_log.live_slots[slot / SLOTS_PER_SECTOR] +=
+      slot_get_count(slot_get_data(slot));
+}
+
+/**
+ * Point the entry at the table position to another slot (a newer or a
+ * moved record of the same key)
+ */
+static void index_move(int pos, int slot) {
+  int old_slot = storage_index.table[pos];
+  storage_index.table[pos] = slot;
+  storage_index.hashes[slot] = storage_index.hashes[old_slot];
+  for (int i = 0; i < storage_index.live_count; i++) {
+    if (storage_index.live[i] == old_slot) {
+      storage_index.live[i] = slot;
+      break;
     }
   }
-  return -1;  // not found
+  storage_log.live_slots[old_slot / SLOTS_PER_SECTOR] -=
+      slot_get_count(slot_get_data(old_slot));
+  storage_log.live_slots[slot / SLOTS_PER_SECTOR] +=
+      slot_get_count(slot_get_data(slot));
 }
 
 /**
- * Return index-th slot in USE status
+ * Remove the entry at the table position, shifting back the entries of the
+ * same probe chain so that lookups never need tombstones.
  */
-static int slot_find_by_index(int index) {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(pwjs_flash_addr + (SECTOR_BASE * PICOWJS_FLASH_SECTOR_SIZE));
-  int pos = 0;
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot =
-        (storage_slot_data_t *)(STORAGE_ADDR + (i * SLOT_SIZE));
-    if (slot->status == SS_USE) {
-      if (pos == index) {
-        return i;
+static void index_remove(int pos) {
+  int slot = storage_index.table[pos];
+  int next = (pos + 1) % INDEX_SIZE;
+  while (storage_index.table[next] >= 0) {
+    int home = storage_index.hashes[storage_index.table[next]] % INDEX_SIZE;
+    // move the entry back if its home is not in the (pos, next] range
+    if ((next > pos && (home <= pos || home > next)) ||
+        (next < pos && (home <= pos && home > next))) {
+      storage_index.table[pos] = storage_index.table[next];
+      pos = next;
+    }
+    next = (next + 1) % INDEX_SIZE;
+  }
+  storage_index.table[pos] = -1;
+  // keep the live slots in order
+  for (int i = 0; i < storage_index.live_count; i++) {
+    if (storage_index.live[i] == slot) {
+      memmove(&storage_index.live[i], &storage_index.live[i + 1],
+              (storage_index.live_count - i - 1) * sizeof(int16_t));
+      storage_index.live_count--;
+      break;
+    }
+  }
+  storage_log.live_slots[slot / SLOTS_PER_SECTOR] -=
+      slot_get_count(slot_get_data(slot));
+}
+
+/**
+ * Return the hash table position of the key, or -1 if not found
+ */
+static int index_find(const char *key, int len) {
+  uint32_t hash = key_hash(key, len);
+  int pos = hash % INDEX_SIZE;
+  while (storage_index.table[pos] >= 0) {
+    int slot = storage_index.table[pos];
+    if (storage_index.hashes[slot] == hash) {
+      storage_slot_data_t *slot_data = slot_get_data(slot);
+      if (slot_data->key_length == len &&
+          memcmp(slot_data->buffer, key, len) == 0) {
+        return pos;
       }
-      pos++;
     }
+    pos = (pos + 1) % INDEX_SIZE;
   }
   return -1;
 }
 
-static char *slot_get_key(storage_slot_data_t *slot_data) {
-  return (char *)(slot_data->buffer);
+/**
+ * Point to the latest commit record (a new one or a moved one)
+ */
+static void index_set_commit(int slot) {
+  if (storage_log.commit_slot >= 0) {
+    storage_log.live_slots[storage_log.commit_slot / SLOTS_PER_SECTOR]--;
+  }
+  storage_log.commit_slot = slot;
+  storage_log.commit_seq = slot_get_data(slot)->seq;
+  storage_log.live_slots[slot / SLOTS_PER_SECTOR]++;
 }
 
-static char *slot_get_value(storage_slot_data_t *slot_data) {
-  return (char *)(slot_data->buffer + slot_data->key_length);
+/**
+ * Return true if the slot holds the live record of its key
+ */
+static bool index_is_live(int slot) {
+  storage_slot_data_t *slot_data = slot_get_data(slot);
+  int pos = index_find(slot_data->buffer, slot_data->key_length);
+  return pos >= 0 && storage_index.table[pos] == slot;
 }
 
-int storage_set_item(char *key, char *value) {
-  if (strlen(key) + strlen(value) > SLOT_DATA_MAX) {
-    return ESTGSIZE;
+// --------------------------------------------------------------------------
+// SECTORS
+// --------------------------------------------------------------------------
+
+/**
+ * Return true if the header is of this layout and was not torn. A torn
+ * sector open happens before any record is written, so the sector can be
+ * formatted again.
+ */
+static bool sector_is_valid(storage_sector_header_t *header) {
+  return header->magic == STORAGE_MAGIC &&
+         header->erase_count == ~header->erase_count_check &&
+         (header->seq == STORAGE_SEQ_FREE
+              ? header->seq_check == STORAGE_SEQ_FREE
+              : header->seq == ~header->seq_check);
+}
+
+static int sector_write_header(int sector, uint32_t erase_count,
+                               uint32_t seq) {
+  uint8_t page[SLOT_SIZE];
+  memset(page, 0xFF, SLOT_SIZE);
+  storage_sector_header_t *header = (storage_sector_header_t *)page;
+  header->magic = STORAGE_MAGIC;
+  header->erase_count = erase_count;
+  header->erase_count_check = ~erase_count;
+  header->seq = seq;
+  header->seq_check = seq == STORAGE_SEQ_FREE ? STORAGE_SEQ_FREE : ~seq;
+  return slot_write(sector * SLOTS_PER_SECTOR, page);
+}
+
+static int sector_format(int sector, uint32_t erase_count) {
+  int ret = pwjs_flash_erase(SECTOR_BASE + sector, 1);
+  if (ret < 0) {
+    return ret;
+  }
+  storage_log.damaged[sector] = false;
+  return sector_write_header(sector, erase_count, STORAGE_SEQ_FREE);
+}
+
+/**
+ * Return the free sector with the lowest erase count, or -1 if none
+ */
+static int sector_pick_free(int *free_count) {
+  int sector = -1;
+  *free_count = 0;
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    storage_sector_header_t *header = sector_get_header(i);
+    if (header->seq == STORAGE_SEQ_FREE) {
+      (*free_count)++;
+      if (sector < 0 ||
+          header->erase_count < sector_get_header(sector)->erase_count) {
+        sector = i;
+      }
+    }
   }
+  return sector;
+}
+
+/**
+ * Make the free sector the active sector of the log
+ */
+static int sector_open(int sector) {
+  storage_sector_header_t *header = sector_get_header(sector);
+  int ret = sector_write_header(sector, header->erase_count,
+                                storage_log.sector_seq++);
+  if (ret < 0) {
+    return ret;
+  }
+  storage_log.active = sector;
+  storage_log.next_slot = 1;
+  return 0;
+}
+
+/**
+ * Pick the sector to collect: the one with the fewest live records (ties
+ * broken by erase count), or the least-erased one if it lags the most-erased
+ * sector by more than STORAGE_WEAR_DELTA. Only the sectors with at most
+ * max_live slots of live records are considered.
+ */
+static int sector_pick_victim(int exclude, int max_live) {
+  int victim = -1;
+  int coldest = -1;
+  uint32_t max_erase_count = 0;
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    storage_sector_header_t *header = sector_get_header(i);
+    if (header->erase_count > max_erase_count) {
+      max_erase_count = header->erase_count;
+    }
+    if (i == exclude || header->seq == STORAGE_SEQ_FREE ||
+        storage_log.live_slots[i] > max_live) {
+      continue;
+    }
+    if (victim < 0 ||
+        storage_log.live_slots[i] < storage_log.live_slots[victim] ||
+        (storage_log.live_slots[i] == storage_log.live_slots[victim] &&
+         header->erase_count < sector_get_header(victim)->erase_count)) {
+      victim = i;
+    }
+    if (coldest < 0 ||
+        header->erase_count < sector_get_header(coldest)->erase_count) {
+      coldest = i;
+    }
+  }
+  if (coldest >= 0 && sector_get_header(coldest)->erase_count +
+                              STORAGE_WEAR_DELTA <
+                          max_erase_count) {
+    return coldest;
+  }
+  return victim;
+}
+
+/**
+ * Copy the live records of the victim to the active sector and erase the
+ * victim. The records keep their seq, so an interrupted move leaves
+ * identical copies which are resolved on the next mount. As for new
+ * records, the first slot of a record is written last. The moved records
+ * of a committed batch become single writes, so the latest commit record
+ * is the only one to keep.
+ */
+static int sector_move(int victim) {
   storage_slot_data_t temp;
+  for (int i = record_first(victim); i >= 0; i = record_next(victim, i)) {
+    int slot = victim * SLOTS_PER_SECTOR + i;
+    storage_slot_data_t *slot_data = slot_get_data(slot);
+    int count = slot_get_count(slot_data);
+    bool used = slot_is_used(slot_data) && index_is_live(slot);
+    if (used || slot == storage_log.commit_slot) {
+      int new_slot = storage_log.active * SLOTS_PER_SECTOR +
+                     storage_log.next_slot;
+      for (int j = 1; j <= count; j++) {
+        memcpy(&temp, slot_get_data(slot + (j % count)), SLOT_SIZE);
+        if (used && j == count) {
+          temp.status = slot_is_bytes(&temp) ? SS_USE_BYTES : SS_USE;
+        }
+        int ret = slot_write(new_slot + (j % count), &temp);
+        if (ret < 0) {
+          return ret;
+        }
+      }
+      storage_log.next_slot += count;
+      if (used) {
+        index_move(index_find(slot_data->buffer, slot_data->key_length),
+                   new_slot);
+      } else {
+        index_set_commit(new_slot);
+      }
+    }
+  }
+  return sector_format(victim, sector_get_header(victim)->erase_count + 1);
+}
 
-  // if key found, remove it
-  int slot = slot_find(key, strlen(key));
-  if (slot >= 0) {
-    storage_slot_data_t *old_slot_data = slot_get_data(slot);
-    memcpy(&temp, old_slot_data, sizeof(storage_slot_data_t));
-    temp.status = SS_REMOVED;
-    slot_write(slot, &temp);
+/**
+ * Free a sector when none is left, as after an interrupted collection:
+ * move a sector into the room left in the active sector.
+ */
+static int sector_reclaim() {
+  int room = storage_log.active >= 0
+                 ? SLOTS_PER_SECTOR - storage_log.next_slot
+                 : 0;
+  int victim = sector_pick_victim(storage_log.active, room);
+  if (victim < 0) {
+    return ESTGFULL;
   }
+  return sector_move(victim);
+}
 
-  // create new slot
-  int new_slot = slot_new();
-  if (new_slot < 0) {
+/**
+ * Collect one sector into the free sector, which becomes the active sector
+ */
+static int sector_collect() {
+  int free_count;
+  int sector = sector_pick_free(&free_count);
+  if (sector < 0) {
+    return sector_reclaim();
+  }
+  // a sector full of live records can not be collected
+  int victim = sector_pick_victim(-1, SLOTS_PER_SECTOR - 2);
+  if (victim < 0) {
     return ESTGFULL;
-  } else {
-    slot_set_data(&temp, key, value);
-    slot_write(new_slot, &temp);
+  }
+  int ret = sector_open(sector);
+  if (ret < 0) {
+    return ret;
+  }
+  return sector_move(victim);
+}
+
+// --------------------------------------------------------------------------
+// LOG
+// --------------------------------------------------------------------------
+
+static int slot_mark_removed(int slot) {
+  uint8_t page[SLOT_SIZE];
+  memset(page, 0xFF, SLOT_SIZE);
+  page[0] = SS_REMOVED;  // clears the status bits only
+  return slot_write(slot, page);
+}
+
+/**
+ * Mark the records of the key older than seq as removed, the live one last
+ * so that an interrupted removal never brings back an older value.
+ */
+static int key_remove(const char *key, int len, uint32_t seq) {
+  int pos = index_find(key, len);
+  int live_slot = pos >= 0 ? storage_index.table[pos] : -1;
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    if (sector_get_header(i)->seq == STORAGE_SEQ_FREE) {
+      continue;
+    }
+    for (int j = record_first(i); j >= 0; j = record_next(i, j)) {
+      int slot = i * SLOTS_PER_SECTOR + j;
+      storage_slot_data_t *slot_data = slot_get_data(slot);
+      if (slot != live_slot && slot_is_used(slot_data) &&
+          slot_data->seq < seq && slot_data->key_length == len &&
+          memcmp(slot_data->buffer, key, len) == 0) {
+        int ret = slot_mark_removed(slot);
+        if (ret < 0) {
+          return ret;
+        }
+      }
+    }
+  }
+  if (live_slot >= 0 && slot_get_data(live_slot)->seq < seq) {
+    int ret = slot_mark_removed(live_slot);
+    if (ret < 0) {
+      return ret;
+    }
+    index_remove(pos);
   }
   return 0;
 }
 
-int storage_get_value_length(char *key) {
-  int slot = slot_find(key, strlen(key));
+/**
+ * Discard the records of an interrupted batch and finish the removals of
+ * the committed batches. A removal record is marked removed once done.
+ */
+static int batch_recover() {
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    if (sector_get_header(i)->seq == STORAGE_SEQ_FREE) {
+      continue;
+    }
+    for (int j = record_first(i); j >= 0; j = record_next(i, j)) {
+      int slot = i * SLOTS_PER_SECTOR + j;
+      storage_slot_data_t *slot_data = slot_get_data(slot);
+      if (!slot_is_batch(slot_data)) {
+        continue;
+      }
+      int ret = 0;
+      if (slot_data->seq < storage_log.commit_seq &&
+          slot_data->status == SS_BATCH_REMOVE) {
+        ret = key_remove(slot_data->buffer, slot_data->key_length,
+                         slot_data->seq);
+      }
+      if (ret == 0 && (slot_data->seq >= storage_log.commit_seq ||
+                       slot_data->status == SS_BATCH_REMOVE)) {
+        ret = slot_mark_removed(slot);
+      }
+      if (ret < 0) {
+        return ret;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Scan the sectors, check the records and build the RAM index. Sectors
+ * without a valid header (erased, torn, or written in another layout) are
+ * formatted. A sector holding a record which fails its CRC is damaged: its
+ * records are checked when walked, skipping the slots of the torn record,
+ * until the sector is collected. A damaged active sector is still appended
+ * to, after its torn slot which is marked removed.
+ */
+void storage_mount() {
+  index_reset();
+  storage_log.active = -1;
+  storage_log.next_slot = SLOTS_PER_SECTOR;
+  storage_log.seq = 0;
+  storage_log.sector_seq = 0;
+  // a lost erase count (interrupted format) is assumed to be the highest
+  uint32_t max_erase_count = 0;
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    storage_sector_header_t *header = sector_get_header(i);
+    if (sector_is_valid(header) && header->erase_count > max_erase_count) {
+      max_erase_count = header->erase_count;
+    }
+  }
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    storage_sector_header_t *header = sector_get_header(i);
+    if (!sector_is_valid(header)) {
+      sector_format(i, max_erase_count);
+      continue;
+    }
+    storage_log.damaged[i] = false;
+    if (header->seq == STORAGE_SEQ_FREE) {
+      continue;
+    }
+    int j = 1;
+    while (j < SLOTS_PER_SECTOR) {
+      int slot = i * SLOTS_PER_SECTOR + j;
+      if (slot_get_data(slot)->status == SS_EMPTY) {
+        break;
+      }
+      if (!record_is_valid(slot, SLOTS_PER_SECTOR - j)) {
+        storage_log.damaged[i] = true;
+        break;
+      }
+      j += slot_get_count(slot_get_data(slot));
+    }
+  }
+  // the latest commit record tells the committed batch records
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    if (sector_get_header(i)->seq == STORAGE_SEQ_FREE) {
+      continue;
+    }
+    for (int j = record_first(i); j >= 0; j = record_next(i, j)) {
+      int slot = i * SLOTS_PER_SECTOR + j;
+      storage_slot_data_t *slot_data = slot_get_data(slot);
+      if (slot_data->status == SS_COMMIT &&
+          (storage_log.commit_slot < 0 ||
+           slot_data->seq > storage_log.commit_seq)) {
+        index_set_commit(slot);
+      }
+    }
+  }
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    storage_sector_header_t *header = sector_get_header(i);
+    if (header->seq == STORAGE_SEQ_FREE) {
+      continue;
+    }
+    int end = 1;
+    for (int j = record_first(i); j >= 0; j = record_next(i, j)) {
+      int slot = i * SLOTS_PER_SECTOR + j;
+      storage_slot_data_t *slot_data = slot_get_data(slot);
+      end = j + slot_get_count(slot_data);
+      if (slot_data->status != SS_REMOVED && slot_data->status != SS_PAD &&
+          slot_data->seq >= storage_log.seq) {
+        storage_log.seq = slot_data->seq + 1;
+      }
+      if (!slot_is_used(slot_data)) {
+        continue;
+      }
+      int pos = index_find(slot_data->buffer, slot_data->key_length);
+      if (pos < 0) {
+        index_insert(slot,
+                     key_hash(slot_data->buffer, slot_data->key_length));
+      } else {
+        // copies of equal seq: prefer the newer sector (interrupted move)
+        int old_slot = storage_index.table[pos];
+        uint32_t old_seq = slot_get_data(old_slot)->seq;
+        if (old_seq < slot_data->seq ||
+            (old_seq == slot_data->seq &&
+             sector_get_header(old_slot / SLOTS_PER_SECTOR)->seq <
+                 header->seq)) {
+          index_move(pos, slot);
+        }
+      }
+    }
+    if (storage_log.active < 0 || header->seq >= storage_log.sector_seq) {
+      storage_log.active = i;
+      storage_log.next_slot = end;
+    }
+    if (header->seq >= storage_log.sector_seq) {
+      storage_log.sector_seq = header->seq + 1;
+    }
+  }
+  storage_index.ready = true;
+
+  // the slots after the last record are erased, unless a write was
+  // interrupted. Cover them with a padding record if its first slot is
+  // erased, else the first slot is torn: mark it removed so that the
+  // sector is found damaged on every mount.
+  for (int j = SLOTS_PER_SECTOR - 1;
+       storage_log.active >= 0 && j >= storage_log.next_slot; j--) {
+    int slot = storage_log.active * SLOTS_PER_SECTOR + storage_log.next_slot;
+    if (slot_is_erased(storage_log.active * SLOTS_PER_SECTOR + j)) {
+      continue;
+    }
+    if (slot_is_erased(slot)) {
+      storage_slot_data_t temp;
+      memset(&temp, 0xFF, sizeof(storage_slot_data_t));
+      temp.status = SS_PAD;
+      temp.key_length = 0;
+      temp.value_length = (j + 1 - storage_log.next_slot) * SLOT_SIZE -
+                          STORAGE_RECORD_HEADER_SIZE;
+      temp.crc = record_crc(&temp, NULL, NULL);
+      slot_write(slot, &temp);
+    } else {
+      slot_mark_removed(slot);
+      storage_log.damaged[storage_log.active] = true;
+    }
+    storage_log.next_slot = j + 1;
+    break;
+  }
+  batch_recover();
+
+  // a move was interrupted after the free sector was opened, finish it
+  int free_count;
+  sector_pick_free(&free_count);
+  if (free_count == 0) {
+    sector_reclaim();
+  }
+}
+
+static void storage_init() {
+  if (!storage_index.ready) {
+    storage_mount();
+  }
+}
+
+/**
+ * Allocate contiguous slots at the head of the log. One sector is always
+ * kept free for the collection, and a sector is collected only when the
+ * active sector has no room, so each allocation moves at most a few
+ * sectors.
+ */
+static int slot_alloc(int count) {
+  for (int i = 0; i <= SECTOR_COUNT; i++) {
+    if (storage_log.active >= 0 &&
+        storage_log.next_slot + count <= SLOTS_PER_SECTOR) {
+      int slot = storage_log.active * SLOTS_PER_SECTOR + storage_log.next_slot;
+      storage_log.next_slot += count;
+      return slot;
+    }
+    int free_count;
+    int sector = sector_pick_free(&free_count);
+    int ret = free_count > 1 ? sector_open(sector) : sector_collect();
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return ESTGFULL;
+}
+
+// --------------------------------------------------------------------------
+// PUBLIC FUNCTIONS
+// --------------------------------------------------------------------------
+
+/**
+ * Append a record. The first slot holds the header, the key and the head
+ * of the value, the rest of the value follows in the next slots. The first
+ * slot is written last, so a record is only visible once it is complete.
+ */
+static int record_write(int slot, uint8_t status, char *key,
+                        size_t key_length, const uint8_t *value,
+                        size_t value_length) {
+  storage_slot_data_t temp;
+  size_t head = SLOT_DATA_MAX - key_length;
+  if (head > value_length) {
+    head = value_length;
+  }
+  int ret = 0;
+  int next = slot + 1;
+  for (size_t pos = head; ret == 0 && pos < value_length; pos += SLOT_SIZE) {
+    if (value_length - pos >= SLOT_SIZE) {
+      ret = slot_write(next++, (void *)(value + pos));
+    } else {
+      memset(&temp, 0xFF, SLOT_SIZE);
+      memcpy(&temp, value + pos, value_length - pos);
+      ret = slot_write(next++, &temp);
+    }
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  memset(&temp, 0xFF, sizeof(storage_slot_data_t));
+  temp.status = status;
+  temp.key_length = key_length;
+  temp.value_length = value_length;
+  temp.seq = storage_log.seq++;
+  temp.crc = record_crc(&temp, key, value);
+  memcpy(temp.buffer, key, key_length);
+  memcpy(temp.buffer + key_length, value, head);
+  return slot_write(slot, &temp);
+}
+
+static int storage_write(char *key, const uint8_t *value, size_t length,
+                         uint8_t status) {
+  size_t key_length = strlen(key);
+  if (key_length > SLOT_DATA_MAX ||
+      STORAGE_RECORD_HEADER_SIZE + key_length + length > STORAGE_RECORD_MAX) {
+    return ESTGSIZE;
+  }
+  storage_init();
+
+  // the older record is left in place, the newer seq supersedes it
+  int slot = slot_alloc(record_get_count(key_length, length));
   if (slot < 0) {
+    return slot;
+  }
+  int ret = record_write(slot, status, key, key_length, value, length);
+  if (ret < 0) {
+    return ret;
+  }
+  int pos = index_find(key, key_length);
+  if (pos >= 0) {
+    index_move(pos, slot);
+  } else {
+    index_insert(slot, key_hash(key, key_length));
+  }
+  return 0;
+}
+
+int storage_set_item(char *key, char *value) {
+  return storage_write(key, (uint8_t *)value, strlen(value), SS_USE);
+}
+
+int storage_set_item_bytes(char *key, const uint8_t *value, size_t length) {
+  return storage_write(key, value, length, SS_USE_BYTES);
+}
+
+int storage_get_item_ref(char *key, const uint8_t **value, bool *bytes) {
+  storage_init();
+  int pos = index_find(key, strlen(key));
+  if (pos < 0) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
+  storage_slot_data_t *slot_data = slot_get_data(storage_index.table[pos]);
+  *value = (const uint8_t *)(slot_data->buffer + slot_data->key_length);
+  *bytes = slot_is_bytes(slot_data);
   return slot_data->value_length;
 }
 
+int storage_get_value_length(char *key) {
+  storage_init();
+  int pos = index_find(key, strlen(key));
+  if (pos < 0) {
+    return ESTGNOKEY;
+  }
+  return slot_get_data(storage_index.table[pos])->value_length;
+}
+
 int storage_get_value(char *key, char *value) {
-  int slot = slot_find(key, strlen(key));
-  if (slot < 0) {
+  storage_init();
+  int pos = index_find(key, strlen(key));
+  if (pos < 0) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  strcpy(value, slot_get_value(slot_data));
+  storage_slot_data_t *slot_data = slot_get_data(storage_index.table[pos]);
+  memcpy(value, slot_data->buffer + slot_data->key_length,
+         slot_data->value_length);
   return 0;
 }
 
 int storage_get_key_length(int index) {
-  int slot = slot_find_by_index(index);
-  if (slot < 0) {
+  storage_init();
+  if (index < 0 || index >= storage_index.live_count) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  return slot_data->key_length;
+  return slot_get_data(storage_index.live[index])->key_length;
 }
 
 int storage_get_key(int index, char *key) {
-  int slot = slot_find_by_index(index);
-  if (slot < 0) {
+  storage_init();
+  if (index < 0 || index >= storage_index.live_count) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  strcpy(key, slot_get_key(slot_data));
+  storage_slot_data_t *slot_data = slot_get_data(storage_index.live[index]);
+  memcpy(key, slot_data->buffer, slot_data->key_length);
   return 0;
 }
 
 int storage_remove_item(char *key) {
-  int slot = slot_find(key, strlen(key));
-  if (slot < 0) {
+  storage_init();
+  int len = strlen(key);
+  if (index_find(key, len) < 0) {
     return ESTGNOKEY;
   }
-  storage_slot_data_t *slot_data = slot_get_data(slot);
-  storage_slot_data_t temp;
-  memcpy(&temp, slot_data, sizeof(storage_slot_data_t));
-  temp.status = SS_REMOVED;
-  slot_write(slot, &temp);
+  return key_remove(key, len, UINT32_MAX);
+}
+
+/**
+ * Make room for the records of a batch and its commit record. No sector
+ * may be collected while they are written, as the collection would drop
+ * the records not committed yet. A collection into a new sector does not
+ * add free sectors, so sectors are first moved into the room left in the
+ * active sector.
+ */
+static int batch_reserve(storage_batch_op_t *ops, int count) {
+  for (int i = 0; i <= SECTOR_COUNT * 2; i++) {
+    int free_count;
+    sector_pick_free(&free_count);
+    int room = storage_log.active >= 0
+                   ? SLOTS_PER_SECTOR - storage_log.next_slot
+                   : 0;
+    int opened = 0;
+    for (int j = 0; j <= count; j++) {
+      int n = j < count ? record_get_count(strlen(ops[j].key), ops[j].length)
+                        : 1;
+      if (n > room) {
+        opened++;
+        room = SLOTS_PER_SECTOR - 1;
+      }
+      room -= n;
+    }
+    // keep one free sector for the collection
+    if (opened < free_count) {
+      return 0;
+    }
+    int ret = sector_reclaim();
+    if (ret == ESTGFULL) {
+      ret = sector_collect();
+    }
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return ESTGFULL;
+}
+
+/**
+ * Write the records of the batch, then the commit record. On failure the
+ * storage is mounted again, which discards the records written so far.
+ */
+static int batch_write(storage_batch_op_t *ops, int count, int16_t *slots) {
+  int ret = batch_reserve(ops, count);
+  for (int i = 0; ret == 0 && i < count; i++) {
+    size_t key_length = strlen(ops[i].key);
+    uint8_t status = SS_BATCH_REMOVE;
+    if (ops[i].value != NULL) {
+      status = ops[i].bytes ? SS_BATCH_BYTES : SS_BATCH;
+    }
+    slots[i] = slot_alloc(record_get_count(key_length, ops[i].length));
+    if (slots[i] < 0) {
+      return slots[i];
+    }
+    ret = record_write(slots[i], status, ops[i].key, key_length,
+                       ops[i].value != NULL ? ops[i].value : (uint8_t *)"",
+                       ops[i].length);
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  int slot = slot_alloc(1);
+  if (slot < 0) {
+    return slot;
+  }
+  ret = record_write(slot, SS_COMMIT, "", 0, (uint8_t *)"", 0);
+  if (ret < 0) {
+    return ret;
+  }
+  index_set_commit(slot);
   return 0;
 }
 
-int storage_clear() {
-  return pwjs_flash_erase(PICOWJS_STORAGE_SECTOR_BASE,
-                        PICOWJS_STORAGE_SECTOR_COUNT);
+int storage_write_batch(storage_batch_op_t *ops, int count) {
+  int16_t slots[SLOT_COUNT];
+  if (count >= SLOT_COUNT) {
+    return ESTGSIZE;
+  }
+  for (int i = 0; i < count; i++) {
+    size_t key_length = strlen(ops[i].key);
+    if (ops[i].value == NULL) {
+      ops[i].length = 0;
+    }
+    if (key_length > SLOT_DATA_MAX ||
+        STORAGE_RECORD_HEADER_SIZE + key_length + ops[i].length >
+            STORAGE_RECORD_MAX) {
+      return ESTGSIZE;
+    }
+  }
+  if (count < 1) {
+    return 0;
+  }
+  storage_init();
+  int ret = batch_write(ops, count, slots);
+  if (ret < 0) {
+    storage_index.ready = false;
+    return ret;
+  }
+
+  // committed, update the index and carry out the removals
+  for (int i = 0; ret == 0 && i < count; i++) {
+    size_t key_length = strlen(ops[i].key);
+    if (ops[i].value == NULL) {
+      ret = key_remove(ops[i].key, key_length, slot_get_data(slots[i])->seq);
+      if (ret == 0) {
+        ret = slot_mark_removed(slots[i]);
+      }
+      continue;
+    }
+    int pos = index_find(ops[i].key, key_length);
+    if (pos >= 0) {
+      index_move(pos, slots[i]);
+    } else {
+      index_insert(slots[i], key_hash(ops[i].key, key_length));
+    }
+  }
+  if (ret < 0) {
+    // the removals are finished on mount
+    storage_index.ready = false;
+  }
+  return ret;
 }
 
-int storage_get_item_count() {
-  const uint8_t *STORAGE_ADDR =
-      (uint8_t *)(pwjs_flash_addr + (SECTOR_BASE * PICOWJS_FLASH_SECTOR_SIZE));
-  int len = 0;
-  for (int i = 0; i < SLOT_COUNT; i++) {
-    storage_slot_data_t *slot =
-        (storage_slot_data_t *)(STORAGE_ADDR + (i * SLOT_SIZE));
-    if (slot->status == SS_USE) {
-      len++;
+int storage_clear() {
+  storage_init();
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    int ret = sector_format(i, sector_get_header(i)->erase_count + 1);
+    if (ret < 0) {
+      return ret;
     }
   }
-  return len;
+  storage_index.ready = false;
+  storage_init();
+  return 0;
+}
+
+int storage_get_item_count() {
+  storage_init();
+  return storage_index.live_count;
 }
@@ -19,6 +19,8 @@
  * SOFTWARE.
  */
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "board.h"
@@ -27,27 +29,94 @@
 #define SECTOR_BASE PICOWJS_STORAGE_SECTOR_BASE
 #define SECTOR_COUNT PICOWJS_STORAGE_SECTOR_COUNT
 #define SLOT_SIZE PICOWJS_FLASH_PAGE_SIZE
-#define SLOT_DATA_MAX (SLOT_SIZE - 3)
+#define SLOT_DATA_MAX (SLOT_SIZE - STORAGE_RECORD_HEADER_SIZE)
 #define SLOT_COUNT ((SECTOR_COUNT * PICOWJS_FLASH_SECTOR_SIZE) / SLOT_SIZE)
+#define SLOTS_PER_SECTOR (PICOWJS_FLASH_SECTOR_SIZE / SLOT_SIZE)
+
+/**
+ * The storage is a log of records. The first slot of each sector holds a
+ * sector header, the other slots hold records appended in order. A record
+ * spans as many contiguous slots of a sector as its key and value need. The
+ * sector seq orders the sectors of the log, the record seq orders the
+ * versions of a key (the highest seq wins). The CRC of a record covers
+ * everything but the status, which is changed in place, so a torn write is
+ * detected and skipped on mount.
+ *
+ * The records of a batch are written with a batch status and published by
+ * a commit record written after them. The records of a batch older than
+ * the latest commit record are committed, the newer ones belong to an
+ * interrupted batch and are discarded on mount.
+ */
+#define STORAGE_MAGIC 0x034B5350 /* "PSK" + layout version */
+#define STORAGE_SEQ_FREE 0xFFFFFFFF
+#define STORAGE_RECORD_HEADER_SIZE 12
+#define STORAGE_RECORD_MAX ((SLOTS_PER_SECTOR - 1) * SLOT_SIZE)
+
+/**
+ * Garbage collection moves the least-erased sector, even if it is full of
+ * live records, once the erase counts differ by more than this.
+ */
+#define STORAGE_WEAR_DELTA 16
 
 typedef enum {
   SS_REMOVED = 0x00,
-  SS_USE = 0xF0,
+  SS_USE = 0xF0,          /* string value */
+  SS_USE_BYTES = 0xB0,    /* binary value */
+  SS_BATCH = 0x70,        /* string value of a batch */
+  SS_BATCH_BYTES = 0x30,  /* binary value of a batch */
+  SS_BATCH_REMOVE = 0x60, /* removal of a batch */
+  SS_COMMIT = 0xE0,       /* commit of the batches before it */
+  SS_PAD = 0x10,          /* slots of an interrupted write */
   SS_EMPTY = 0xFF,
 } storage_slot_status_t;
 
+typedef struct {
+  uint32_t magic;
+  uint32_t erase_count;
+  uint32_t erase_count_check; /* ~erase_count */
+  uint32_t seq;               /* STORAGE_SEQ_FREE until the sector is opened */
+  uint32_t seq_check;         /* ~seq once opened, to detect a torn write */
+} storage_sector_header_t;
+
 typedef struct {
   uint8_t status;
   uint8_t key_length;
-  uint8_t value_length;
+  uint16_t value_length;
+  uint32_t seq;
+  uint32_t crc;
   char buffer[SLOT_DATA_MAX];
 } storage_slot_data_t;
 
+typedef struct {
+  char *key;
+  const uint8_t *value; /* NULL to remove the key */
+  size_t length;
+  bool bytes;
+} storage_batch_op_t;
+
+/**
+ * Scan the storage, skipping the torn records, and build the RAM index.
+ * This is done on first access, call it again to force a recovery pass.
+ */
+void storage_mount();
 int storage_set_item(char *key, char *value);
+int storage_set_item_bytes(char *key, const uint8_t *value, size_t length);
+
+/**
+ * Return the length of the value and point to it in flash. The pointer is
+ * valid until the next write to the storage.
+ */
+int storage_get_item_ref(char *key, const uint8_t **value, bool *bytes);
 int storage_get_value_length(char *key);
 int storage_get_value(char *key, char *value);
 int storage_get_key_length(int index);
 int storage_get_key(int index, char *key);
 int storage_remove_item(char *key);
+
+/**
+ * Apply the operations in order, atomically: either all or none of them
+ * survive a power loss.
+ */
+int storage_write_batch(storage_batch_op_t *ops, int count);
 int storage_clear();
 int storage_get_item_count();
@@ -1,42 +1,60 @@
 const storage_native = process.binding(process.binding.storage);
 
-function sweep() {
-  let cache = {};
-  let len = storage_native.length();
-  for (let i = 0; i < len; i++) {
-    let k1 = storage_native.key(i);
-    cache[k1] = storage_native.getItem(k1);
-  }
-  storage_native.clear();
-  let keys = Object.keys(cache);
-  for (let j = 0; j < keys.length; j++) {
-    let k2 = keys[j];
-    storage_native.setItem(k2, cache[k2]);
-  }
-}
-
 exports.setItem = function (key, value) {
-  try {
-    storage_native.setItem(key, value);
-  } catch (err) {
-    if (err.errno === -142) {
-      // storage full
-      sweep();
-      storage_native.setItem(key, value);
-    } else {
-      throw err;
-    }
-  }
+  storage_native.setItem(key, value);
 };
 
 exports.getItem = function (key) {
   return storage_native.getItem(key);
 };
 
+exports.setItemBytes = function (key, value) {
+  storage_native.setItemBytes(key, value);
+};
+
+/**
+ * Returns a Uint8Array copy of any value. Values written with
+ * setItemBytes() are not strings, getItem() returns null for them.
+ */
+exports.getItemBytes = function (key) {
+  return storage_native.getItemBytes(key);
+};
+
 exports.removeItem = function (key) {
   return storage_native.removeItem(key);
 };
 
+/**
+ * Applies [key, value] entries atomically, a null value removes the key.
+ * After a power loss either all or none of the entries are applied.
+ */
+exports.batch = function (entries) {
+  storage_native.batch(entries);
+};
+
+/**
+ * Calls fn with an object staging setItem(), setItemBytes() and
+ * removeItem(), then applies them as a single batch. Nothing is written
+ * if fn throws.
+ */
+exports.transaction = function (fn) {
+  const entries = [];
+  const tx = {
+    setItem: function (key, value) {
+      entries.push([key, value]);
+    },
+    setItemBytes: function (key, value) {
+      entries.push([key, value]);
+    },
+    removeItem: function (key) {
+      entries.push([key, null]);
+    },
+  };
+  const result = fn(tx);
+  storage_native.batch(entries);
+  return result;
+};
+
 exports.clear = function () {
   return storage_native.clear();
 };
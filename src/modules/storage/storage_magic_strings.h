@@ -26,7 +26,10 @@
 #define MSTR_STORAGE_STORAGE_ "storage"
 #define MSTR_STORAGE_SET_ITEM "setItem"
 #define MSTR_STORAGE_GET_ITEM "getItem"
+#define MSTR_STORAGE_SET_ITEM_BYTES "setItemBytes"
+#define MSTR_STORAGE_GET_ITEM_BYTES "getItemBytes"
 #define MSTR_STORAGE_REMOVE_ITEM "removeItem"
+#define MSTR_STORAGE_BATCH "batch"
 #define MSTR_STORAGE_CLEAR "clear"
 #define MSTR_STORAGE_LENGTH "length"
 #define MSTR_STORAGE_KEY "key"
@@ -25,6 +25,7 @@
 #include "io.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
+#include "mem.h"
 #include "uart.h"
 #include "uart_magic_strings.h"
 
@@ -62,7 +63,7 @@ static void uart_read_cb(pwjs_io_uart_handle_t *handle, uint8_t *buf,
   }
 }
 
-static void uart_close_cb(pwjs_io_handle_t *handle) { free(handle); }
+static void uart_close_cb(pwjs_io_handle_t *handle) { pwjs_free(handle); }
 
 /**
  * uart_native constructor
@@ -125,7 +126,8 @@ JERRYXX_FUN(uart_ctor_fn) {
   jerryxx_set_property(JERRYXX_GET_THIS, "callback", callback);
 
   // setup io handle
-  pwjs_io_uart_handle_t *handle = malloc(sizeof(pwjs_io_uart_handle_t));
+  pwjs_io_uart_handle_t *handle =
+      pwjs_malloc(PWJS_MEM_UART, sizeof(pwjs_io_uart_handle_t));
   pwjs_io_uart_init(handle);
   handle->read_js_cb = jerry_acquire_value(callback);
   jerryxx_set_property_number(JERRYXX_GET_THIS, "handle_id", handle->base.id);
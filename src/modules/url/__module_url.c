@@ -25,194 +25,40 @@
 #include "jerryxx.h"
 #include "module_url.h"
 #include "url_magic_strings.h"
+#include "url_parser.h"
 
-static int fndch(const char *buf, char ch, int start, int end) {
-  for (int i = start; i <= end; i++) {
-    if (buf[i] == ch) {
-      return i;
-    }
+static jerry_value_t url_part(const char *input, pwjs_url_range_t *range) {
+  if (range->s >= 0) {
+    return jerry_create_string_sz((const jerry_char_t *)input + range->s,
+                                  range->e - range->s + 1);
   }
-  return -1;
+  return jerry_create_string((const jerry_char_t *)"");
+}
+
+static void url_set_part(jerry_value_t this_val, const char *name,
+                         const char *input, pwjs_url_range_t *range) {
+  jerry_value_t part = url_part(input, range);
+  jerryxx_set_property(this_val, name, part);
+  jerry_release_value(part);
 }
 
 JERRYXX_FUN(url_ctor_fn) {
   JERRYXX_CHECK_ARG_STRING_OPT(0, "input")
-  int protocol_s = -1;
-  int protocol_e = -1;
-  int origin_s = -1;
-  int origin_e = -1;
-  int path_s = -1;
-  int path_e = -1;
-  int auth_s = -1;
-  int auth_e = -1;
-  int host_s = -1;
-  int host_e = -1;
-  int user_s = -1;
-  int user_e = -1;
-  int pass_s = -1;
-  int pass_e = -1;
-  int hostname_s = -1;
-  int hostname_e = -1;
-  int port_s = -1;
-  int port_e = -1;
-  int pathname_s = -1;
-  int pathname_e = -1;
-  int hash_s = -1;
-  int hash_e = -1;
-  int search_s = -1;
-  int search_e = -1;
   if (args_cnt > 0) {
     JERRYXX_GET_ARG_STRING_AS_CHAR(0, input)
-    // extract protocol from href
-    for (int i = 0; i <= input_sz - 3; i++) {
-      if (input[i] == ':' && input[i + 1] == '/' && input[i + 2] == '/') {
-        protocol_s = 0;
-        protocol_e = i;
-        break;
-      }
-    }
-    if (protocol_e > 0) {
-      origin_s = protocol_e + 3;  // exclude protocol part
-      origin_e = input_sz - 1;
-      // split origin + path
-      int p1 = fndch(input, '/', origin_s, origin_e);
-      if (p1 < 0) p1 = fndch(input, '?', origin_s, origin_e);
-      if (p1 < 0) p1 = fndch(input, '#', origin_s, origin_e);
-      if (p1 >= 0) {
-        origin_e = p1 - 1;
-        path_s = p1;
-        path_e = input_sz - 1;
-      }
-      if (origin_e >= 0) {
-        // split auth + host
-        host_s = origin_s;
-        host_e = origin_e;
-        int p2 = fndch(input, '@', origin_s, origin_e);
-        if (p2 >= 0) {
-          auth_s = origin_s;
-          auth_e = p2 - 1;
-          host_s = p2 + 1;
-          // split username + password
-          user_s = auth_s;
-          user_e = auth_e;
-          int p3 = fndch(input, ':', auth_s, auth_e);
-          if (p3 >= 0) {
-            pass_s = p3 + 1;
-            pass_e = user_e;
-            user_e = p3 - 1;
-          }
-        }
-        // split hostname + port
-        hostname_s = host_s;
-        hostname_e = host_e;
-        int p4 = fndch(input, ':', host_s, host_e);
-        if (p4 >= 0) {
-          port_s = p4 + 1;
-          port_e = host_e;
-          hostname_e = p4 - 1;
-        }
-      }
-      if (path_s >= 0) {
-        // extract hash from path
-        int p5 = fndch(input, '#', path_s, path_e);
-        if (p5 >= 0) {
-          hash_s = p5 + 1;
-          hash_e = path_e;
-          path_e = p5 - 1;
-        }
-        // extract search from path
-        int p6 = fndch(input, '?', path_s, path_e);
-        if (p6 >= 0) {
-          search_s = p6;
-          search_e = path_e;
-          path_e = p6 - 1;
-        }
-        // extract pathname
-        if (input[path_s] == '/') {
-          pathname_s = path_s;
-          pathname_e = path_e;
-        }
-      }
-    } else {
+    pwjs_url_t url;
+    if (pwjs_url_parse(input, input_sz, &url) < 0) {
       return jerry_create_error(JERRY_ERROR_TYPE,
                                 (const jerry_char_t *)"Invalid URL");
     }
-    // create properties
-    jerry_value_t protocol;
-    if (protocol_s >= 0) {
-      protocol =
-          jerry_create_string_sz((const jerry_char_t *)input + protocol_s,
-                                 protocol_e - protocol_s + 1);
-    } else {
-      protocol = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t username;
-    if (user_s >= 0) {
-      username = jerry_create_string_sz((const jerry_char_t *)input + user_s,
-                                        user_e - user_s + 1);
-    } else {
-      username = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t password;
-    if (pass_s >= 0) {
-      password = jerry_create_string_sz((const jerry_char_t *)input + pass_s,
-                                        pass_e - pass_s + 1);
-    } else {
-      password = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t hostname;
-    if (hostname_s >= 0) {
-      hostname =
-          jerry_create_string_sz((const jerry_char_t *)input + hostname_s,
-                                 hostname_e - hostname_s + 1);
-    } else {
-      hostname = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t port;
-    if (port_s >= 0) {
-      port = jerry_create_string_sz((const jerry_char_t *)input + port_s,
-                                    port_e - port_s + 1);
-    } else {
-      port = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t pathname;
-    if (pathname_s >= 0) {
-      pathname =
-          jerry_create_string_sz((const jerry_char_t *)input + pathname_s,
-                                 pathname_e - pathname_s + 1);
-    } else {
-      pathname = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t search;
-    if (search_s >= 0) {
-      search = jerry_create_string_sz((const jerry_char_t *)input + search_s,
-                                      search_e - search_s + 1);
-    } else {
-      search = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerry_value_t hash;
-    if (hash_s >= 0) {
-      hash = jerry_create_string_sz((const jerry_char_t *)input + hash_s,
-                                    hash_e - hash_s + 1);
-    } else {
-      hash = jerry_create_string((const jerry_char_t *)"");
-    }
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_PROTOCOL, protocol);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_USERNAME, username);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_PASSWORD, password);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_HOSTNAME, hostname);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_PORT, port);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_PATHNAME, pathname);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_SEARCH, search);
-    jerryxx_set_property(JERRYXX_GET_THIS, MSTR_URL_HASH, hash);
-    jerry_release_value(protocol);
-    jerry_release_value(username);
-    jerry_release_value(password);
-    jerry_release_value(hostname);
-    jerry_release_value(port);
-    jerry_release_value(pathname);
-    jerry_release_value(search);
-    jerry_release_value(hash);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_PROTOCOL, input, &url.protocol);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_USERNAME, input, &url.username);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_PASSWORD, input, &url.password);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_HOSTNAME, input, &url.hostname);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_PORT, input, &url.port);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_PATHNAME, input, &url.pathname);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_SEARCH, input, &url.search);
+    url_set_part(JERRYXX_GET_THIS, MSTR_URL_HASH, input, &url.hash);
   }
   return jerry_create_undefined();
 }
@@ -0,0 +1,123 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "url_parser.h"
+
+#include "err.h"
+
+static int fndch(const char *buf, char ch, int start, int end) {
+  for (int i = start; i <= end; i++) {
+    if (buf[i] == ch) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void range_set(pwjs_url_range_t *range, int s, int e) {
+  range->s = s;
+  range->e = e;
+}
+
+int pwjs_url_parse(const char *input, int len, pwjs_url_t *url) {
+  int origin_s = -1;
+  int origin_e = -1;
+  int path_s = -1;
+  int path_e = -1;
+  int auth_s = -1;
+  int auth_e = -1;
+  int host_s = -1;
+  int host_e = -1;
+  range_set(&url->protocol, -1, -1);
+  range_set(&url->username, -1, -1);
+  range_set(&url->password, -1, -1);
+  range_set(&url->hostname, -1, -1);
+  range_set(&url->port, -1, -1);
+  range_set(&url->pathname, -1, -1);
+  range_set(&url->search, -1, -1);
+  range_set(&url->hash, -1, -1);
+  // extract protocol from href
+  for (int i = 0; i <= len - 3; i++) {
+    if (input[i] == ':' && input[i + 1] == '/' && input[i + 2] == '/') {
+      range_set(&url->protocol, 0, i);
+      break;
+    }
+  }
+  if (url->protocol.e <= 0) {
+    range_set(&url->protocol, -1, -1);
+    return EINVAL;
+  }
+  origin_s = url->protocol.e + 3;  // exclude protocol part
+  origin_e = len - 1;
+  // split origin + path
+  int p1 = fndch(input, '/', origin_s, origin_e);
+  if (p1 < 0) p1 = fndch(input, '?', origin_s, origin_e);
+  if (p1 < 0) p1 = fndch(input, '#', origin_s, origin_e);
+  if (p1 >= 0) {
+    origin_e = p1 - 1;
+    path_s = p1;
+    path_e = len - 1;
+  }
+  if (origin_e >= 0) {
+    // split auth + host
+    host_s = origin_s;
+    host_e = origin_e;
+    int p2 = fndch(input, '@', origin_s, origin_e);
+    if (p2 >= 0) {
+      auth_s = origin_s;
+      auth_e = p2 - 1;
+      host_s = p2 + 1;
+      // split username + password
+      range_set(&url->username, auth_s, auth_e);
+      int p3 = fndch(input, ':', auth_s, auth_e);
+      if (p3 >= 0) {
+        range_set(&url->password, p3 + 1, auth_e);
+        url->username.e = p3 - 1;
+      }
+    }
+    // split hostname + port
+    range_set(&url->hostname, host_s, host_e);
+    int p4 = fndch(input, ':', host_s, host_e);
+    if (p4 >= 0) {
+      range_set(&url->port, p4 + 1, host_e);
+      url->hostname.e = p4 - 1;
+    }
+  }
+  if (path_s >= 0) {
+    // extract hash from path
+    int p5 = fndch(input, '#', path_s, path_e);
+    if (p5 >= 0) {
+      range_set(&url->hash, p5 + 1, path_e);
+      path_e = p5 - 1;
+    }
+    // extract search from path
+    int p6 = fndch(input, '?', path_s, path_e);
+    if (p6 >= 0) {
+      range_set(&url->search, p6, path_e);
+      path_e = p6 - 1;
+    }
+    // extract pathname
+    if (input[path_s] == '/') {
+      range_set(&url->pathname, path_s, path_e);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,54 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_URL_PARSER_H
+#define __PWJS_URL_PARSER_H
+
+/**
+ * A part of URL given as a range [s, e] of the input. s is -1 if the part
+ * is not present.
+ */
+typedef struct {
+  int s;
+  int e;
+} pwjs_url_range_t;
+
+typedef struct {
+  pwjs_url_range_t protocol;
+  pwjs_url_range_t username;
+  pwjs_url_range_t password;
+  pwjs_url_range_t hostname;
+  pwjs_url_range_t port;
+  pwjs_url_range_t pathname;
+  pwjs_url_range_t search;
+  pwjs_url_range_t hash;
+} pwjs_url_t;
+
+/**
+ * Split an absolute URL into its parts.
+ * @param input URL string (not necessarily null-terminated)
+ * @param len length of input
+ * @param url parts of the URL
+ * @return 0 on success, or EINVAL if input has no protocol.
+ */
+int pwjs_url_parse(const char *input, int len, pwjs_url_t *url);
+
+#endif /* __PWJS_URL_PARSER_H */
@@ -0,0 +1,6 @@
+list(APPEND SOURCES
+  ${SRC_DIR}/modules/vfs_assets/vfs_assets.c
+  ${SRC_DIR}/modules/vfs_assets/module_vfs_assets.c)
+
+include_directories(
+  ${SRC_DIR}/modules/vfs_assets)
@@ -0,0 +1,159 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "module_vfs_assets.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "blkdev.h"
+#include "err.h"
+#include "jerryscript.h"
+#include "jerryxx.h"
+#include "magic_strings.h"
+#include "mem.h"
+#include "vfs.h"
+#include "vfs_assets.h"
+#include "vfs_assets_magic_strings.h"
+
+/**
+ * Get the native handle of a VFSAssets object
+ */
+#define VFS_ASSETS_GET_HANDLE(name)                                          \
+  vfs_assets_handle_t *name = (vfs_assets_handle_t *)pwjs_vfs_get(this_val); \
+  if (name == NULL || name->vfs.ops != &vfs_assets_ops) {                    \
+    return jerry_create_error(                                               \
+        JERRY_ERROR_REFERENCE,                                               \
+        (const jerry_char_t *)"Failed to get native handle");                \
+  }
+
+/**
+ * VFSAssets constructor
+ * args:
+ *   blkdev {object} native block device (e.g. Flash, RamBlockDev)
+ */
+JERRYXX_FUN(vfs_assets_ctor_fn) {
+  // check and get args
+  JERRYXX_CHECK_ARG_OBJECT(0, "blkdev")
+  jerry_value_t blkdev_js = JERRYXX_GET_ARG(0);
+  pwjs_blkdev_t *blkdev = pwjs_blkdev_get(blkdev_js);
+  if (blkdev == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENODEV), true);
+  }
+
+  // the index entries must not span program units
+  int block_count = blkdev->ioctl(blkdev, PWJS_BLKDEV_BLOCK_COUNT, 0);
+  int block_size = blkdev->ioctl(blkdev, PWJS_BLKDEV_BLOCK_SIZE, 0);
+  int unit_size = blkdev->ioctl(blkdev, PWJS_BLKDEV_BUFFER_SIZE, 0);
+  if (block_count <= 0 || block_size <= 0 || unit_size <= 0 ||
+      unit_size % VFS_ASSETS_ENTRY_SIZE > 0 || block_size % unit_size > 0) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
+  }
+  uint32_t index_blocks =
+      (VFS_ASSETS_INDEX_SIZE + block_size - 1) / block_size;
+  if (index_blocks >= (uint32_t)block_count) {
+    return jerry_create_error_from_value(create_system_error(ENOSPC), true);
+  }
+
+  // initialize vfs native handle
+  vfs_assets_handle_t *vfs_handle = (vfs_assets_handle_t *)pwjs_malloc(
+      PWJS_MEM_VFS_ASSETS, sizeof(vfs_assets_handle_t));
+  if (vfs_handle == NULL) {
+    return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+  }
+  vfs_handle->vfs.ops = &vfs_assets_ops;
+  vfs_handle->blkdev_js = jerry_acquire_value(blkdev_js);
+  vfs_handle->blkdev = blkdev;
+  vfs_handle->block_size = block_size;
+  vfs_handle->block_count = block_count;
+  vfs_handle->unit_size = unit_size;
+  vfs_handle->index_size = index_blocks * block_size;
+  vfs_handle->count = 0;
+  vfs_handle->data_end = vfs_handle->index_size;
+  vfs_handle->writer = NULL;
+
+  // assign native handle in js object
+  pwjs_vfs_bind(this_val, &vfs_handle->vfs);
+  return jerry_create_undefined();
+}
+
+/**
+ * VFSAssets.prototype.mkfs()
+ */
+JERRYXX_FUN(vfs_assets_mkfs_fn) {
+  VFS_ASSETS_GET_HANDLE(vfs_handle)
+  vfs_handle->blkdev->ioctl(vfs_handle->blkdev, PWJS_BLKDEV_INIT, 0);
+  int ret = vfs_assets_format(vfs_handle);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * VFSAssets.prototype.mount()
+ */
+JERRYXX_FUN(vfs_assets_mount_fn) {
+  VFS_ASSETS_GET_HANDLE(vfs_handle)
+  vfs_handle->blkdev->ioctl(vfs_handle->blkdev, PWJS_BLKDEV_INIT, 0);
+  int ret = vfs_assets_load(vfs_handle);
+  if (ret < 0) {
+    return jerry_create_error_from_value(create_system_error(ret), true);
+  }
+  return jerry_create_undefined();
+}
+
+/**
+ * VFSAssets.prototype.unmount()
+ */
+JERRYXX_FUN(vfs_assets_unmount_fn) {
+  VFS_ASSETS_GET_HANDLE(vfs_handle)
+  if (vfs_handle->writer != NULL) {
+    return jerry_create_error_from_value(create_system_error(EBUSY), true);
+  }
+  vfs_handle->blkdev->ioctl(vfs_handle->blkdev, PWJS_BLKDEV_SHUTDOWN, 0);
+  return jerry_create_undefined();
+}
+
+/**
+ * Initialize vfs_assets module and return exports
+ */
+jerry_value_t module_vfs_assets_init() {
+  /* VFSAssets class */
+  jerry_value_t vfs_assets_ctor =
+      jerry_create_external_function(vfs_assets_ctor_fn);
+  jerry_value_t vfs_assets_prototype = jerry_create_object();
+  jerryxx_set_property(vfs_assets_ctor, MSTR_PROTOTYPE, vfs_assets_prototype);
+  jerryxx_set_property_function(vfs_assets_prototype, MSTR_VFS_ASSETS_MKFS,
+                                vfs_assets_mkfs_fn);
+  jerryxx_set_property_function(vfs_assets_prototype, MSTR_VFS_ASSETS_MOUNT,
+                                vfs_assets_mount_fn);
+  jerryxx_set_property_function(vfs_assets_prototype, MSTR_VFS_ASSETS_UNMOUNT,
+                                vfs_assets_unmount_fn);
+  jerry_release_value(vfs_assets_prototype);
+
+  /* vfs_assets module exports */
+  jerry_value_t exports = jerry_create_object();
+  jerryxx_set_property(exports, MSTR_VFS_ASSETS_VFSASSETS, vfs_assets_ctor);
+  jerry_release_value(vfs_assets_ctor);
+
+  return exports;
+}
@@ -0,0 +1,452 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "vfs_assets.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+#include "mem.h"
+#include "rtc.h"
+
+static uint32_t vfs_assets_device_size(vfs_assets_handle_t *handle) {
+  return handle->block_count * handle->block_size;
+}
+
+/**
+ * Read from a device address, across blocks
+ */
+static int vfs_assets_read_device(vfs_assets_handle_t *handle, uint32_t addr,
+                                  uint8_t *buffer, size_t size) {
+  return handle->blkdev->read(handle->blkdev, addr / handle->block_size,
+                              addr % handle->block_size, buffer, size);
+}
+
+/**
+ * Program a unit at a device address, erasing the block when the unit is
+ * the first one of the block
+ */
+static int vfs_assets_program(vfs_assets_handle_t *handle, uint32_t addr,
+                              const uint8_t *unit) {
+  uint32_t block = addr / handle->block_size;
+  uint32_t offset = addr % handle->block_size;
+  if (offset == 0) {
+    int ret =
+        handle->blkdev->ioctl(handle->blkdev, PWJS_BLKDEV_ERASE, block);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return handle->blkdev->write(handle->blkdev, block, offset, unit,
+                               handle->unit_size);
+}
+
+static int vfs_assets_read_entry(vfs_assets_handle_t *handle, uint32_t index,
+                                 vfs_assets_entry_t *entry) {
+  int ret = vfs_assets_read_device(handle, (index + 1) * VFS_ASSETS_ENTRY_SIZE,
+                                   (uint8_t *)entry, sizeof(*entry));
+  entry->name[VFS_ASSETS_NAME_MAX] = '\0';
+  return ret;
+}
+
+/**
+ * Program an entry in its free slot, with the unit holding it
+ */
+static int vfs_assets_write_entry(vfs_assets_handle_t *handle, uint32_t index,
+                                  const vfs_assets_entry_t *entry) {
+  uint32_t addr = (index + 1) * VFS_ASSETS_ENTRY_SIZE;
+  uint32_t unit_addr = addr - addr % handle->unit_size;
+  uint8_t *unit = pwjs_malloc(PWJS_MEM_VFS_ASSETS, handle->unit_size);
+  if (unit == NULL) {
+    return ENOMEM;
+  }
+  int ret = vfs_assets_read_device(handle, unit_addr, unit, handle->unit_size);
+  if (ret >= 0) {
+    memcpy(unit + (addr - unit_addr), entry, sizeof(*entry));
+    ret = handle->blkdev->write(handle->blkdev, unit_addr / handle->block_size,
+                                unit_addr % handle->block_size, unit,
+                                handle->unit_size);
+  }
+  pwjs_free(unit);
+  return ret;
+}
+
+/**
+ * Find a file by path. Returns ENOENT, or EISDIR for the root.
+ */
+static int vfs_assets_find(vfs_assets_handle_t *handle, const char *path,
+                           vfs_assets_entry_t *entry) {
+  const char *name = (path[0] == '/') ? path + 1 : path;
+  if (name[0] == '\0') {
+    return EISDIR;
+  }
+  for (uint32_t i = 0; i < handle->count; i++) {
+    int ret = vfs_assets_read_entry(handle, i, entry);
+    if (ret < 0) {
+      return ret;
+    }
+    if (strcmp(entry->name, name) == 0) {
+      return 0;
+    }
+  }
+  return ENOENT;
+}
+
+int vfs_assets_format(vfs_assets_handle_t *handle) {
+  uint8_t *unit = pwjs_malloc(PWJS_MEM_VFS_ASSETS, handle->unit_size);
+  if (unit == NULL) {
+    return ENOMEM;
+  }
+  memset(unit, 0xff, handle->unit_size);
+  vfs_assets_header_t *header = (vfs_assets_header_t *)unit;
+  header->magic = VFS_ASSETS_MAGIC;
+  header->version = VFS_ASSETS_VERSION;
+  header->block_size = handle->block_size;
+  header->index_size = handle->index_size;
+  int ret = 0;
+  for (uint32_t addr = handle->block_size; addr < handle->index_size;
+       addr += handle->block_size) {
+    ret = handle->blkdev->ioctl(handle->blkdev, PWJS_BLKDEV_ERASE,
+                                addr / handle->block_size);
+    if (ret < 0) {
+      break;
+    }
+  }
+  if (ret >= 0) {
+    ret = vfs_assets_program(handle, 0, unit);
+  }
+  pwjs_free(unit);
+  return ret < 0 ? ret : 0;
+}
+
+int vfs_assets_load(vfs_assets_handle_t *handle) {
+  vfs_assets_header_t header;
+  int ret = vfs_assets_read_device(handle, 0, (uint8_t *)&header,
+                                   sizeof(header));
+  if (ret < 0) {
+    return ret;
+  }
+  if (header.magic != VFS_ASSETS_MAGIC ||
+      header.version != VFS_ASSETS_VERSION ||
+      header.block_size != handle->block_size ||
+      header.index_size != handle->index_size) {
+    return EINVAL;
+  }
+  handle->count = 0;
+  handle->data_end = handle->index_size;
+  vfs_assets_entry_t entry;
+  while (handle->count < VFS_ASSETS_ENTRY_MAX) {
+    ret = vfs_assets_read_entry(handle, handle->count, &entry);
+    if (ret < 0) {
+      return ret;
+    }
+    if (entry.offset == 0xffffffff) {
+      break;
+    }
+    if (entry.offset < handle->data_end ||
+        entry.size > vfs_assets_device_size(handle) - entry.offset) {
+      return EIO;
+    }
+    uint32_t end = entry.offset + entry.size;
+    handle->data_end = end + (handle->block_size - end % handle->block_size) %
+                                 handle->block_size;
+    handle->count++;
+  }
+  return 0;
+}
+
+static int vfs_assets_open(pwjs_vfs_t *vfs, const char *path, int flags,
+                           void **file) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_file_t *asset =
+      pwjs_malloc(PWJS_MEM_VFS_ASSETS, sizeof(vfs_assets_file_t));
+  if (asset == NULL) {
+    return ENOMEM;
+  }
+  asset->position = 0;
+  asset->buffer = NULL;
+  int ret = vfs_assets_find(handle, path, &asset->entry);
+  if (!(flags & PWJS_VFS_FLAG_WRITE)) {
+    if (ret < 0) {
+      pwjs_free(asset);
+      return ret;
+    }
+    *file = asset;
+    return 0;
+  }
+
+  // add a file after the last one. Existing files can't be rewritten.
+  const char *name = (path[0] == '/') ? path + 1 : path;
+  if (ret != ENOENT) {
+    ret = (ret == 0) ? EEXIST : ret;
+  } else if (!(flags & PWJS_VFS_FLAG_CREATE) || strchr(name, '/') != NULL) {
+    ret = ENOENT;
+  } else if (strlen(name) > VFS_ASSETS_NAME_MAX) {
+    ret = ENAMETOOLONG;
+  } else if (handle->writer != NULL) {
+    ret = EBUSY;
+  } else if (handle->count == VFS_ASSETS_ENTRY_MAX ||
+             handle->data_end >= vfs_assets_device_size(handle)) {
+    ret = ENOSPC;
+  } else {
+    asset->buffer = pwjs_malloc(PWJS_MEM_VFS_ASSETS, handle->unit_size);
+    ret = (asset->buffer == NULL) ? ENOMEM : 0;
+  }
+  if (ret < 0) {
+    pwjs_free(asset);
+    return ret;
+  }
+  memset(&asset->entry, 0, sizeof(asset->entry));
+  asset->entry.offset = handle->data_end;
+  asset->entry.mtime = (uint32_t)(pwjs_rtc_get_time() / 1000);
+  strcpy(asset->entry.name, name);
+  handle->writer = asset;
+  *file = asset;
+  return 0;
+}
+
+/**
+ * Program the last partial unit of the file being added and its entry, and
+ * sync the device so that the file is on it once closed
+ */
+static int vfs_assets_commit(vfs_assets_handle_t *handle,
+                             vfs_assets_file_t *asset) {
+  uint32_t fill = asset->entry.size % handle->unit_size;
+  if (fill > 0) {
+    memset(asset->buffer + fill, 0xff, handle->unit_size - fill);
+    int ret = vfs_assets_program(
+        handle, asset->entry.offset + asset->entry.size - fill, asset->buffer);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  int ret = vfs_assets_write_entry(handle, handle->count, &asset->entry);
+  if (ret < 0) {
+    return ret;
+  }
+  uint32_t end = asset->entry.offset + asset->entry.size;
+  handle->data_end =
+      end + (handle->block_size - end % handle->block_size) %
+                handle->block_size;
+  handle->count++;
+  return handle->blkdev->ioctl(handle->blkdev, PWJS_BLKDEV_SYNC, 0);
+}
+
+static int vfs_assets_close(pwjs_vfs_t *vfs, void *file) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_file_t *asset = (vfs_assets_file_t *)file;
+  int ret = 0;
+  if (asset->buffer != NULL) {
+    ret = vfs_assets_commit(handle, asset);
+    handle->writer = NULL;
+    pwjs_free(asset->buffer);
+  }
+  pwjs_free(asset);
+  return ret;
+}
+
+static int vfs_assets_read(pwjs_vfs_t *vfs, void *file, uint8_t *buffer,
+                           size_t size) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_file_t *asset = (vfs_assets_file_t *)file;
+  if (asset->buffer != NULL) {
+    return EBADF;
+  }
+  if (asset->position >= asset->entry.size) {
+    return 0;
+  }
+  if (size > asset->entry.size - asset->position) {
+    size = asset->entry.size - asset->position;
+  }
+  int ret = vfs_assets_read_device(
+      handle, asset->entry.offset + asset->position, buffer, size);
+  if (ret < 0) {
+    return ret;
+  }
+  asset->position += size;
+  return (int)size;
+}
+
+static int vfs_assets_write(pwjs_vfs_t *vfs, void *file, const uint8_t *buffer,
+                            size_t size) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_file_t *asset = (vfs_assets_file_t *)file;
+  if (asset->buffer == NULL) {
+    return EBADF;
+  }
+  uint32_t room = vfs_assets_device_size(handle) - asset->entry.offset -
+                  asset->entry.size;
+  if (size > room) {
+    if (room == 0) {
+      return ENOSPC;
+    }
+    size = room;
+  }
+  size_t written = 0;
+  while (written < size) {
+    uint32_t fill = asset->entry.size % handle->unit_size;
+    size_t len = handle->unit_size - fill;
+    if (len > size - written) {
+      len = size - written;
+    }
+    memcpy(asset->buffer + fill, buffer + written, len);
+    if (fill + len == handle->unit_size) {
+      int ret = vfs_assets_program(
+          handle, asset->entry.offset + asset->entry.size - fill,
+          asset->buffer);
+      if (ret < 0) {
+        return ret;
+      }
+    }
+    asset->entry.size += len;
+    written += len;
+  }
+  asset->position = asset->entry.size;
+  return (int)written;
+}
+
+static int vfs_assets_seek(pwjs_vfs_t *vfs, void *file, uint32_t position) {
+  vfs_assets_file_t *asset = (vfs_assets_file_t *)file;
+  if (asset->buffer != NULL && position != asset->entry.size) {
+    return ESPIPE;  // files are written sequentially
+  }
+  asset->position = position;
+  return 0;
+}
+
+static int vfs_assets_stat(pwjs_vfs_t *vfs, const char *path,
+                           pwjs_vfs_stat_t *stat) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_entry_t entry;
+  int ret = vfs_assets_find(handle, path, &entry);
+  if (ret == EISDIR) {
+    stat->type = PWJS_VFS_TYPE_DIR;
+    stat->size = 0;
+    stat->mtime = 0;
+    return 0;
+  }
+  if (ret < 0) {
+    return ret;
+  }
+  stat->type = PWJS_VFS_TYPE_FILE;
+  stat->size = entry.size;
+  stat->mtime = entry.mtime;
+  return 0;
+}
+
+static int vfs_assets_opendir(pwjs_vfs_t *vfs, const char *path, void **dir) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_entry_t entry;
+  int ret = vfs_assets_find(handle, path, &entry);
+  if (ret != EISDIR) {
+    return (ret == 0) ? ENOTDIR : ret;
+  }
+  uint32_t *next = pwjs_malloc(PWJS_MEM_VFS_ASSETS, sizeof(uint32_t));
+  if (next == NULL) {
+    return ENOMEM;
+  }
+  *next = 0;
+  *dir = next;
+  return 0;
+}
+
+static int vfs_assets_readdir(pwjs_vfs_t *vfs, void *dir,
+                              pwjs_vfs_dirent_t *entry) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  uint32_t *next = (uint32_t *)dir;
+  if (*next >= handle->count) {
+    return 0;
+  }
+  vfs_assets_entry_t asset;
+  int ret = vfs_assets_read_entry(handle, *next, &asset);
+  if (ret < 0) {
+    return ret;
+  }
+  (*next)++;
+  strcpy(entry->name, asset.name);
+  entry->type = PWJS_VFS_TYPE_FILE;
+  entry->size = asset.size;
+  entry->mtime = asset.mtime;
+  return 1;
+}
+
+static int vfs_assets_closedir(pwjs_vfs_t *vfs, void *dir) {
+  pwjs_free(dir);
+  return 0;
+}
+
+static int vfs_assets_mkdir(pwjs_vfs_t *vfs, const char *path) {
+  return EROFS;  // files can only be added
+}
+
+static int vfs_assets_remove(pwjs_vfs_t *vfs, const char *path) {
+  return EROFS;
+}
+
+static int vfs_assets_rename(pwjs_vfs_t *vfs, const char *old_path,
+                             const char *new_path) {
+  return EROFS;
+}
+
+static int vfs_assets_mmap(pwjs_vfs_t *vfs, const char *path,
+                           const uint8_t **addr, uint32_t *size) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  vfs_assets_entry_t entry;
+  int ret = vfs_assets_find(handle, path, &entry);
+  if (ret < 0) {
+    return ret;
+  }
+  const uint8_t *base = (handle->blkdev->map != NULL)
+                            ? handle->blkdev->map(handle->blkdev)
+                            : NULL;
+  if (base == NULL) {
+    return ENODEV;
+  }
+  *addr = base + entry.offset;
+  *size = entry.size;
+  return 0;
+}
+
+static void vfs_assets_free(pwjs_vfs_t *vfs) {
+  vfs_assets_handle_t *handle = (vfs_assets_handle_t *)vfs;
+  jerry_release_value(handle->blkdev_js);
+  pwjs_free(handle);
+}
+
+const pwjs_vfs_ops_t vfs_assets_ops = {
+    .open = vfs_assets_open,
+    .close = vfs_assets_close,
+    .read = vfs_assets_read,
+    .write = vfs_assets_write,
+    .seek = vfs_assets_seek,
+    .stat = vfs_assets_stat,
+    .opendir = vfs_assets_opendir,
+    .readdir = vfs_assets_readdir,
+    .closedir = vfs_assets_closedir,
+    .mkdir = vfs_assets_mkdir,
+    .unlink = vfs_assets_remove,
+    .rename = vfs_assets_rename,
+    .rmdir = vfs_assets_remove,
+    .mmap = vfs_assets_mmap,
+    .free = vfs_assets_free,
+};
@@ -0,0 +1,103 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __VFSASSETS_H
+#define __VFSASSETS_H
+
+#include <stdint.h>
+
+#include "blkdev.h"
+#include "jerryscript.h"
+#include "vfs.h"
+
+/**
+ * Asset partition: a flat, write-once file system whose files are stored
+ * contiguously, so that they can be mapped from memory-mapped devices
+ * (e.g. the internal flash through XIP) instead of being copied.
+ *
+ * The partition starts with an index of VFS_ASSETS_INDEX_SIZE bytes
+ * (rounded up to whole blocks): a header, then one entry per file in the
+ * order the files were added. An entry is programmed once, when its file
+ * is closed, so a free entry reads as erased (0xff). Each file starts at a
+ * block boundary after the previous one. Files can't be modified or
+ * removed, mkfs() clears the partition.
+ */
+#define VFS_ASSETS_MAGIC 0x53414a50  // "PJAS"
+#define VFS_ASSETS_VERSION 1
+#define VFS_ASSETS_INDEX_SIZE 4096
+#define VFS_ASSETS_NAME_MAX 51
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t block_size;
+  uint32_t index_size;
+  uint8_t reserved[48];
+} vfs_assets_header_t;
+
+typedef struct {
+  uint32_t offset;  // from the start of the device, 0xffffffff if free
+  uint32_t size;
+  uint32_t mtime;
+  char name[VFS_ASSETS_NAME_MAX + 1];
+} vfs_assets_entry_t;
+
+#define VFS_ASSETS_ENTRY_SIZE 64
+#define VFS_ASSETS_ENTRY_MAX (VFS_ASSETS_INDEX_SIZE / VFS_ASSETS_ENTRY_SIZE - 1)
+
+typedef struct vfs_assets_handle_s vfs_assets_handle_t;
+typedef struct vfs_assets_file_s vfs_assets_file_t;
+
+struct vfs_assets_handle_s {
+  pwjs_vfs_t vfs;
+  jerry_value_t blkdev_js;
+  pwjs_blkdev_t *blkdev;
+  uint32_t block_size;
+  uint32_t block_count;
+  uint32_t unit_size;    // program size of the device
+  uint32_t index_size;   // index size in bytes, whole blocks
+  uint32_t count;        // number of files
+  uint32_t data_end;     // device address where the next file starts
+  vfs_assets_file_t *writer;  // file being added, NULL if none
+};
+
+struct vfs_assets_file_s {
+  vfs_assets_entry_t entry;
+  uint32_t position;
+  uint8_t *buffer;  // unit_size bytes not programmed yet, NULL for readers
+};
+
+/**
+ * File system operations of asset partitions
+ */
+extern const pwjs_vfs_ops_t vfs_assets_ops;
+
+/**
+ * Erase the index and write an empty one
+ */
+int vfs_assets_format(vfs_assets_handle_t *handle);
+
+/**
+ * Read the index: the number of files and the end of the data
+ */
+int vfs_assets_load(vfs_assets_handle_t *handle);
+
+#endif /* __VFSASSETS_H */
@@ -25,34 +25,41 @@
 #include <string.h>
 #include <time.h>
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "diskio.h"
 #include "err.h"
 #include "io.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
 #include "magic_strings.h"
+#include "mem.h"
 #include "rtc.h"
 #include "tty.h"
 #include "utils.h"
+#include "vfs.h"
 #include "vfs_fat.h"
 #include "vfs_fat_magic_strings.h"
 
-extern vfs_fat_root_t vfs_fat_root;
-
-static void vfs_handle_freecb(void *handle) {
-  vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)handle;
-  jerry_release_value(vfs_handle->blkdev_js);
-  vfs_fat_handle_remove(vfs_handle);
-  free(vfs_handle->fat_fs);
-  free(handle);
-}
-
-static const jerry_object_native_info_t vfs_handle_info = {
-    .free_cb = vfs_handle_freecb};
+/**
+ * Get the native handle of a VFSFatFS object
+ */
+#define VFS_FAT_GET_HANDLE(name)                                       \
+  vfs_fat_handle_t *name = (vfs_fat_handle_t *)pwjs_vfs_get(this_val); \
+  if (name == NULL || name->vfs.ops != &vfs_fat_ops) {                 \
+    return jerry_create_error(                                         \
+        JERRY_ERROR_REFERENCE,                                         \
+        (const jerry_char_t *)"Failed to get native handle");          \
+  }
 
-static int blkdev_ioctl(jerry_value_t blkdev_js, int op, int arg) {
+static int blkdev_ioctl(vfs_fat_handle_t *vfs_handle, int op, int arg) {
   // pwjs_tty_printf("blkdev_ioctl(%d, %d)\r\n", op, arg);
-  jerry_value_t ioctl_js = jerryxx_get_property(blkdev_js, "ioctl");
+  if (vfs_handle->blkdev != NULL) {
+    return vfs_handle->blkdev->ioctl(vfs_handle->blkdev, op, arg);
+  }
+  jerry_value_t blkdev_js = vfs_handle->blkdev_js;
+  jerry_value_t ioctl_js =
+      jerryxx_get_property_by_key(blkdev_js, JERRYXX_KEY_IOCTL);
   jerry_value_t op_js = jerry_create_number(op);
   jerry_value_t arg_js = jerry_create_number(arg);
   jerry_value_t args[2] = {op_js, arg_js};
@@ -69,54 +76,30 @@ static int blkdev_ioctl(jerry_value_t blkdev_js, int op, int arg) {
   return ret_value;
 }
 
-static int ret_conversion(int ret) {
-  int new_ret = 0;  // OK
-  if (ret != 0) {
-    switch (ret) {
-      case FR_NO_FILE:
-      case FR_NO_PATH:
-      case FR_INVALID_NAME:
-      case FR_INVALID_DRIVE:
-        new_ret = ENOENT;
-        break;
-      case FR_EXIST:
-        new_ret = EEXIST;
-        break;
-      case FR_WRITE_PROTECTED:
-        new_ret = EROFS;
-        break;
-      case FR_LOCKED:
-        new_ret = ETXTBSY;
-        break;
-      case FR_INVALID_PARAMETER:
-        new_ret = EINVAL;
-        break;
-      default:
-        new_ret = EIO;
-        break;
-    }
+/**
+ * Block size of the device, asked once
+ */
+static int blkdev_block_size(vfs_fat_handle_t *vfs_handle) {
+  if (vfs_handle->block_size == 0) {
+    vfs_handle->block_size = blkdev_ioctl(vfs_handle, 5, 0);
   }
-
-  return new_ret;
+  return vfs_handle->block_size;
 }
-DRESULT disk_read(void *drv,    /* [IN] Physical drive nmuber (0..) */
-                  BYTE *buff,   /* [OUT] Pointer to the read data buffer */
-                  DWORD sector, /* [IN] Start sector number */
-                  UINT count    /* [IN] Number of sectros to read */
-) {
-  if (count == 0) {  // Support drive 0 only
-    return RES_PARERR;
+
+static int blkdev_read_raw(vfs_fat_handle_t *vfs_handle, uint32_t block,
+                           uint32_t offset, uint8_t *buffer, size_t size) {
+  if (vfs_handle->blkdev != NULL) {
+    return vfs_handle->blkdev->read(vfs_handle->blkdev, block, offset, buffer,
+                                    size);
   }
-  // get native vfs handle
-  vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)drv;
-  int block_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  jerry_value_t arraybuffer = jerry_create_arraybuffer_external(
-      count * block_size, (uint8_t *)buff, NULL);
+  jerry_value_t arraybuffer =
+      jerry_create_arraybuffer_external(size, buffer, NULL);
   jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
       JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t read_js = jerryxx_get_property(vfs_handle->blkdev_js, "read");
-  jerry_value_t block_js = jerry_create_number(sector);
-  jerry_value_t offset_js = jerry_create_number(0);
+  jerry_value_t read_js =
+      jerryxx_get_property_by_key(vfs_handle->blkdev_js, JERRYXX_KEY_READ);
+  jerry_value_t block_js = jerry_create_number(block);
+  jerry_value_t offset_js = jerry_create_number(offset);
   jerry_value_t args[3] = {block_js, buffer_js, offset_js};
   jerry_value_t ret =
       jerry_call_function(read_js, vfs_handle->blkdev_js, args, 3);
@@ -126,28 +109,24 @@ DRESULT disk_read(void *drv,    /* [IN] Physical drive nmuber (0..) */
   jerry_release_value(read_js);
   jerry_release_value(buffer_js);
   jerry_release_value(arraybuffer);
-  return RES_OK;
+  return 0;
 }
 
-DRESULT disk_write(
-    void *drv,        /* [IN] Physical drive nmuber (0..) */
-    const BYTE *buff, /* [IN] Pointer to the data to be written */
-    DWORD sector,     /* [IN] Sector number to write from */
-    UINT count        /* [IN] Number of sectors to write */
-) {
-  if (count == 0) {  // Support drive 0 only
-    return RES_PARERR;
+static int blkdev_write_raw(vfs_fat_handle_t *vfs_handle, uint32_t block,
+                            uint32_t offset, const uint8_t *buffer,
+                            size_t size) {
+  if (vfs_handle->blkdev != NULL) {
+    return vfs_handle->blkdev->write(vfs_handle->blkdev, block, offset,
+                                     buffer, size);
   }
-  // get native vfs handle
-  vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)drv;
-  int block_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  jerry_value_t arraybuffer = jerry_create_arraybuffer_external(
-      count * block_size, (uint8_t *)buff, NULL);
+  jerry_value_t arraybuffer =
+      jerry_create_arraybuffer_external(size, (uint8_t *)buffer, NULL);
   jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
       JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t write_js = jerryxx_get_property(vfs_handle->blkdev_js, "write");
-  jerry_value_t block_js = jerry_create_number(sector);
-  jerry_value_t offset_js = jerry_create_number(0);
+  jerry_value_t write_js =
+      jerryxx_get_property_by_key(vfs_handle->blkdev_js, JERRYXX_KEY_WRITE);
+  jerry_value_t block_js = jerry_create_number(block);
+  jerry_value_t offset_js = jerry_create_number(offset);
   jerry_value_t args[3] = {block_js, buffer_js, offset_js};
   jerry_value_t ret =
       jerry_call_function(write_js, vfs_handle->blkdev_js, args, 3);
@@ -157,7 +136,53 @@ DRESULT disk_write(
   jerry_release_value(write_js);
   jerry_release_value(buffer_js);
   jerry_release_value(arraybuffer);
-  return RES_OK;
+  return 0;
+}
+
+static int blkdev_cache_read(pwjs_blkcache_dev_t *dev, uint32_t block,
+                             uint32_t offset, uint8_t *buffer, size_t size) {
+  return blkdev_read_raw((vfs_fat_handle_t *)dev->owner, block, offset,
+                         buffer, size);
+}
+
+static int blkdev_cache_write(pwjs_blkcache_dev_t *dev, uint32_t block,
+                              uint32_t offset, const uint8_t *buffer,
+                              size_t size) {
+  return blkdev_write_raw((vfs_fat_handle_t *)dev->owner, block, offset,
+                          buffer, size);
+}
+
+DRESULT disk_read(void *drv,    /* [IN] Physical drive nmuber (0..) */
+                  BYTE *buff,   /* [OUT] Pointer to the read data buffer */
+                  DWORD sector, /* [IN] Start sector number */
+                  UINT count    /* [IN] Number of sectros to read */
+) {
+  if (count == 0) {  // Support drive 0 only
+    return RES_PARERR;
+  }
+  // get native vfs handle
+  vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)drv;
+  vfs_handle->cache.block_size = blkdev_block_size(vfs_handle);
+  int ret = pwjs_blkcache_read(&vfs_handle->cache, sector, 0, buff,
+                               count * vfs_handle->cache.block_size);
+  return ret < 0 ? RES_ERROR : RES_OK;
+}
+
+DRESULT disk_write(
+    void *drv,        /* [IN] Physical drive nmuber (0..) */
+    const BYTE *buff, /* [IN] Pointer to the data to be written */
+    DWORD sector,     /* [IN] Sector number to write from */
+    UINT count        /* [IN] Number of sectors to write */
+) {
+  if (count == 0) {  // Support drive 0 only
+    return RES_PARERR;
+  }
+  // get native vfs handle
+  vfs_fat_handle_t *vfs_handle = (vfs_fat_handle_t *)drv;
+  vfs_handle->cache.block_size = blkdev_block_size(vfs_handle);
+  int ret = pwjs_blkcache_write(&vfs_handle->cache, sector, 0, buff,
+                                count * vfs_handle->cache.block_size);
+  return ret < 0 ? RES_ERROR : RES_OK;
 }
 
 DRESULT disk_ioctl(void *drv, /* [IN] Physical drive nmuber (0..) */
@@ -173,18 +198,21 @@ DRESULT disk_ioctl(void *drv, /* [IN] Physical drive nmuber (0..) */
   switch (cmd) {
     int res;
     case CTRL_SYNC:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 3, 0);
+      if (pwjs_blkcache_flush(&vfs_handle->cache) < 0) {
+        break;
+      }
+      res = blkdev_ioctl(vfs_handle, 3, 0);
       if (res == 0) {
         ret = RES_OK;
       }
       break;
     case GET_SECTOR_COUNT:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 4, 0);
+      res = blkdev_ioctl(vfs_handle, 4, 0);
       *(DWORD *)buff = (DWORD)res;
       ret = RES_OK;
       break;
     case GET_SECTOR_SIZE:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
+      res = blkdev_block_size(vfs_handle);
       *(WORD *)buff = (WORD)res;
       ret = RES_OK;
       break;
@@ -197,11 +225,12 @@ DRESULT disk_ioctl(void *drv, /* [IN] Physical drive nmuber (0..) */
       ret = RES_OK;
       break;
     case IOCTL_INIT:
-      res = blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
+      res = blkdev_ioctl(vfs_handle, 1, 0);
       if (res < 0) {
         break;
       }
       vfs_handle->status &= ~STA_NOINIT;
+      vfs_handle->block_size = 0;
       *(DSTATUS *)buff = (DSTATUS)vfs_handle->status;
       ret = RES_OK;
       break;
@@ -248,16 +277,23 @@ JERRYXX_FUN(vfsfat_ctor_fn) {
 
   // initialize vfs native handle
   vfs_fat_handle_t *vfs_handle =
-      (vfs_fat_handle_t *)malloc(sizeof(vfs_fat_handle_t));
-  vfs_fat_handle_init(vfs_handle);
-  vfs_fat_handle_add(vfs_handle);
+      (vfs_fat_handle_t *)pwjs_malloc(PWJS_MEM_VFS_FAT,
+                                      sizeof(vfs_fat_handle_t));
+  vfs_handle->vfs.ops = &vfs_fat_ops;
   vfs_handle->blkdev_js = blkdev;
   jerry_acquire_value(vfs_handle->blkdev_js);
-  vfs_handle->fat_fs = (FATFS *)malloc(sizeof(FATFS));
+  vfs_handle->blkdev = pwjs_blkdev_get(blkdev);
+  vfs_handle->block_size = 0;
+  vfs_handle->fat_fs = (FATFS *)pwjs_malloc(PWJS_MEM_VFS_FAT, sizeof(FATFS));
   vfs_handle->fat_fs->drv = (void *)vfs_handle;
   vfs_handle->status = STA_NOINIT;
+  vfs_handle->cache.read = blkdev_cache_read;
+  vfs_handle->cache.write = blkdev_cache_write;
+  vfs_handle->cache.owner = vfs_handle;
+  vfs_handle->cache.block_size = 0;
+  vfs_handle->cache.mode = PWJS_BLKCACHE_NONE;
   // assign native handle in js object
-  jerry_set_object_native_pointer(this_val, vfs_handle, &vfs_handle_info);
+  pwjs_vfs_bind(this_val, &vfs_handle->vfs);
   return jerry_create_undefined();
 }
 
@@ -266,16 +302,16 @@ JERRYXX_FUN(vfsfat_ctor_fn) {
  */
 JERRYXX_FUN(vfs_fat_mkfs_fn) {
   // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
+  VFS_FAT_GET_HANDLE(vfs_handle)
 
   // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
-  int32_t buff_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  BYTE *buff = (BYTE *)malloc(sizeof(BYTE) * buff_size);
+  blkdev_ioctl(vfs_handle, 1, 0);
+  int32_t buff_size = blkdev_ioctl(vfs_handle, 5, 0);
+  BYTE *buff = (BYTE *)pwjs_malloc(PWJS_MEM_VFS_FAT, sizeof(BYTE) * buff_size);
   // make fs (format)
   FRESULT ret = f_mkfs(vfs_handle->fat_fs, FM_ANY, 0, buff, buff_size);
-  free(buff);
-  int err = ret_conversion(ret);
+  pwjs_free(buff);
+  int err = vfs_fat_errno(ret);
   if (err < 0) {
     return jerry_create_error_from_value(create_system_error(err), true);
   }
@@ -283,321 +319,58 @@ JERRYXX_FUN(vfs_fat_mkfs_fn) {
 }
 
 /**
- * VFSFAT.prototype.mount()
+ * Get the block cache mode from the blockCache option, or EINVAL
  */
-JERRYXX_FUN(vfs_fat_mount_fn) {
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-
-  // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
-
-  FRESULT ret = f_mount(vfs_handle->fat_fs);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
+static int vfs_fat_get_cache_mode(jerry_value_t options,
+                                  pwjs_blkcache_mode_t mode) {
+  jerry_value_t value = jerryxx_get_property(options, MSTR_VFS_FAT_BLOCK_CACHE);
+  int ret = mode;
+  if (jerry_value_is_string(value)) {
+    char name[16];
+    jerry_size_t len = jerry_string_to_char_buffer(
+        value, (jerry_char_t *)name, sizeof(name) - 1);
+    name[len] = '\0';
+    ret = pwjs_blkcache_parse_mode(name);
+  } else if (!jerry_value_is_undefined(value)) {
+    ret = EINVAL;
   }
-  return jerry_create_undefined();
-}
-
-/**
- * VFSFAT.prototype.unmount()
- */
-JERRYXX_FUN(vfs_fat_unmount_fn) {
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-
-  FRESULT ret = f_umount(vfs_handle->fat_fs);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-
-  // shutdown block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 2, 0);
-  return jerry_create_undefined();
+  jerry_release_value(value);
+  return ret;
 }
 
 /**
- * VFSFAT.prototype.open()
+ * VFSFAT.prototype.mount()
  * args:
- *   path {string}
- *   flags {number} See enum vfs_fat_open_flags
- *   mode {number}
- * returns {number} - id
+ *   options {object}
+ *     blockCache {string} 'none' (default), 'writethrough' or 'writeback'
+ *       to access the device through the shared block cache
  */
-JERRYXX_FUN(vfs_fat_open_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_CHECK_ARG_NUMBER(1, "flags")
-  JERRYXX_CHECK_ARG_NUMBER(2, "mode")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
-  int flags = (int)JERRYXX_GET_ARG_NUMBER(1);
-  // int mode = (int)JERRYXX_GET_ARG_NUMBER(2);
-
-  // convert flags to fat_flags
-  BYTE fat_flags = 0;
-  if (flags & VFS_FLAG_EXCL) fat_flags |= FA_CREATE_NEW;
-  if (flags & VFS_FLAG_TRUNC) fat_flags |= FA_CREATE_ALWAYS;
-  if (flags & VFS_FLAG_READ) fat_flags |= FA_READ;
-  if (flags & VFS_FLAG_WRITE) fat_flags |= FA_WRITE;
-  if (flags & VFS_FLAG_APPEND) fat_flags |= FA_OPEN_APPEND;
-  if (flags & VFS_FLAG_CREATE) fat_flags |= FA_CREATE_ALWAYS;
+JERRYXX_FUN(vfs_fat_mount_fn) {
+  JERRYXX_CHECK_ARG_OBJECT_OPT(0, "options")
 
   // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-
-  // create file handle
-  vfs_fat_file_handle_t *file = malloc(sizeof(vfs_fat_file_handle_t));
-  FIL *fp = (FIL *)malloc(sizeof(FIL));
-  file->fat_fp = fp;
-
-  // file open
-  FRESULT ret = f_open(vfs_handle->fat_fs, file->fat_fp, path, fat_flags);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    free(fp);
-    free(file);
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-
-  // add file handle and return the id
-  vfs_fat_file_add(vfs_handle, file);
-  uint32_t id = file->id;
-  return jerry_create_number(id);
-}
-
-/**
- * VFSFAT.prototype.write()
- * args:
- *   id {number}
- *   buffer {TypedArray}
- *   offset {number}
- *   length {number}
- *   position {number}
- * returns {number} - number of bytes written
- */
-JERRYXX_FUN(vfs_fat_write_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_NUMBER(0, "id")
-  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(3, "length")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "position")
-  uint32_t id = (uint32_t)JERRYXX_GET_ARG_NUMBER(0);
-  jerry_value_t buffer = JERRYXX_GET_ARG(1);
-  jerry_length_t buf_length = 0;
-  jerry_length_t buf_offset = 0;
-  jerry_value_t arrbuf =
-      jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
-  jerry_release_value(arrbuf);
-  UINT offset = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
-  UINT length = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
-  FSIZE_t position = (FSIZE_t)JERRYXX_GET_ARG_NUMBER_OPT(4, -1);
-
-  // get native file handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  VFS_FAT_GET_FILE_HANDLE(vfs_handle, file, id)
-
-  // set position
-  if (position > -1) {
-    FRESULT ret = f_lseek(file->fat_fp, position);
-    int err = ret_conversion(ret);
-    if (err < 0) {
-      return jerry_create_error_from_value(create_system_error(err), true);
+  VFS_FAT_GET_HANDLE(vfs_handle)
+  if (JERRYXX_HAS_ARG(0)) {
+    int mode =
+        vfs_fat_get_cache_mode(JERRYXX_GET_ARG(0), vfs_handle->cache.mode);
+    if (mode < 0) {
+      return jerry_create_error_from_value(create_system_error(mode), true);
     }
-  }
-
-  // file write
-  UINT out_length = 0;
-  FRESULT ret =
-      f_write(file->fat_fp, (void *)(buffer_p + offset), length, &out_length);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-
-  // return number of bytes written
-  return jerry_create_number(out_length);
-}
-
-/**
- * VFSFAT.prototype.read()
- * args:
- *   id {number}
- *   buffer {TypedArray}
- *   offset {number}
- *   length {number}
- *   position {number}
- * returns {number} - number of bytes read
- */
-JERRYXX_FUN(vfs_fat_read_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_NUMBER(0, "id")
-  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(3, "length")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "position")
-  uint32_t id = (uint32_t)JERRYXX_GET_ARG_NUMBER(0);
-  jerry_value_t buffer = JERRYXX_GET_ARG(1);
-  jerry_length_t buf_length = 0;
-  jerry_length_t buf_offset = 0;
-  jerry_value_t arrbuf =
-      jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
-  jerry_release_value(arrbuf);
-  UINT offset = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
-  UINT length = (UINT)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
-  FSIZE_t position = (FSIZE_t)JERRYXX_GET_ARG_NUMBER_OPT(4, -1);
-
-  // get native file handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  VFS_FAT_GET_FILE_HANDLE(vfs_handle, file, id)
-
-  // set position
-  if (position > -1) {
-    FRESULT ret = f_lseek(file->fat_fp, position);
-    int err = ret_conversion(ret);
-    if (err < 0) {
-      return jerry_create_error_from_value(create_system_error(err), true);
+    if ((pwjs_blkcache_mode_t)mode != vfs_handle->cache.mode) {
+      int err = pwjs_blkcache_flush(&vfs_handle->cache);
+      if (err < 0) {
+        return jerry_create_error_from_value(create_system_error(err), true);
+      }
+      pwjs_blkcache_release(&vfs_handle->cache);
+      vfs_handle->cache.mode = (pwjs_blkcache_mode_t)mode;
     }
   }
 
-  // file read
-  UINT out_length = 0;
-  FRESULT ret =
-      f_read(file->fat_fp, (void *)(buffer_p + offset), length, &out_length);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-
-  // return number of bytes read
-  return jerry_create_number(out_length);
-}
-
-/**
- * VFSFAT.prototype.close()
- * args:
- *   id {number}
- */
-JERRYXX_FUN(vfs_fat_close_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_NUMBER(0, "id")
-  uint32_t id = (uint32_t)JERRYXX_GET_ARG_NUMBER(0);
-
-  // get native file handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  VFS_FAT_GET_FILE_HANDLE(vfs_handle, file, id)
-
-  // file close
-  FRESULT ret = f_close(file->fat_fp);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-  free(file->fat_fp);
-  // remote file handle
-  vfs_fat_file_remove(vfs_handle, file);
-  free(file);
-
-  // return
-  return jerry_create_undefined();
-}
-
-/**
- * VFSFAT.prototype.stat()
- * args:
- *   path {string}
- * returns {fs.Stats}
- */
-JERRYXX_FUN(vfs_fat_stat_fn) {  // check and get args
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
-  if (strcmp(path, "/") == 0) {
-    jerry_value_t obj = jerry_create_object();
-    jerryxx_set_property_number(obj, "type", 2);
-    jerryxx_set_property_number(obj, "size", 0);
-    return obj;
-  }
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  // file stat
-  FILINFO *info = (FILINFO *)malloc(sizeof(FILINFO));
-  FRESULT ret = f_stat(vfs_handle->fat_fs, path, info);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    free(info);
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-
-  // return stat object {type, size}
-  jerry_value_t obj = jerry_create_object();
-  jerryxx_set_property_number(obj, "type", info->fattrib & AM_DIR ? 2 : 1);
-  jerryxx_set_property_number(obj, "size",
-                              info->fattrib & AM_DIR ? 0 : info->fsize);
-  free(info);
-  return obj;
-}
-
-/**
- * VFSFAT.prototype.rename()
- * args:
- *   oldPath {string}
- *   newPath {string}
- */
-JERRYXX_FUN(vfs_fat_rename_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING_OPT(0, "oldPath")
-  JERRYXX_CHECK_ARG_STRING_OPT(1, "newPath")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, old_path)
-  JERRYXX_GET_ARG_STRING_AS_CHAR(1, new_path)
-
-  // file rename
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  FRESULT ret = f_rename(vfs_handle->fat_fs, old_path, new_path);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-  return jerry_create_undefined();
-}
-
-/**
- * VFSFAT.prototype.unlink()
- * args:
- *   path {string}
- */
-JERRYXX_FUN(vfs_fat_unlink_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING_OPT(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
-
-  // file delete
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  FRESULT ret = f_unlink(vfs_handle->fat_fs, path);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
-  return jerry_create_undefined();
-}
-
-/**
- * VFSFAT.prototype.mkdir()
- * args:
- *   path {string}
- */
-JERRYXX_FUN(vfs_fat_mkdir_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+  // initialize block device
+  blkdev_ioctl(vfs_handle, 1, 0);
 
-  // create a directory
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  FRESULT ret = f_mkdir(vfs_handle->fat_fs, path);
-  int err = ret_conversion(ret);
+  FRESULT ret = f_mount(vfs_handle->fat_fs);
+  int err = vfs_fat_errno(ret);
   if (err < 0) {
     return jerry_create_error_from_value(create_system_error(err), true);
   }
@@ -605,71 +378,25 @@ JERRYXX_FUN(vfs_fat_mkdir_fn) {
 }
 
 /**
- * VFSFAT.prototype.readdir()
- * args:
- *   path {string}
- * returns {string[]} - array of filenames
+ * VFSFAT.prototype.unmount()
  */
-JERRYXX_FUN(vfs_fat_readdir_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+JERRYXX_FUN(vfs_fat_unmount_fn) {
+  // get native vfs handle
+  VFS_FAT_GET_HANDLE(vfs_handle)
 
-  // read dir
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  FF_DIR dir;
-  FILINFO *info = (FILINFO *)malloc(sizeof(FILINFO));
-  FRESULT ret = f_opendir(vfs_handle->fat_fs, &dir, path);
-  int err = ret_conversion(ret);
+  FRESULT ret = f_umount(vfs_handle->fat_fs);
+  int err = vfs_fat_errno(ret);
   if (err < 0) {
-    free(info);
     return jerry_create_error_from_value(create_system_error(err), true);
   }
-  jerry_value_t files = jerry_create_array(0);
-  while (true) {
-    ret = f_readdir(&dir, info);
-    err = ret_conversion(ret);
-    if (err < 0) {
-      free(info);
-      return jerry_create_error_from_value(create_system_error(err), true);
-    }
-    if (info->fname[0] == 0) {
-      break;
-    }
-    // add to array except '.', '..'
-    if (strcmp(info->fname, ".") != 0 && strcmp(info->fname, "..") != 0) {
-      jerry_value_t item =
-          jerry_create_string((const jerry_char_t *)(info->fname));
-      jerryxx_array_push_string(files, item);
-      jerry_release_value(item);
-    }
-  }
-  free(info);
-  ret = f_closedir(&dir);
-  err = ret_conversion(ret);
+  err = pwjs_blkcache_flush(&vfs_handle->cache);
+  pwjs_blkcache_release(&vfs_handle->cache);
   if (err < 0) {
     return jerry_create_error_from_value(create_system_error(err), true);
   }
-  return files;
-}
-
-/**
- * VFSFAT.prototype.rmdir()
- * args:
- *   path {string}
- */
-JERRYXX_FUN(vfs_fat_rmdir_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING_OPT(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
 
-  // file delete
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_fat_handle_t, vfs_handle_info);
-  FRESULT ret = f_unlink(vfs_handle->fat_fs, path);
-  int err = ret_conversion(ret);
-  if (err < 0) {
-    return jerry_create_error_from_value(create_system_error(err), true);
-  }
+  // shutdown block device
+  blkdev_ioctl(vfs_handle, 2, 0);
   return jerry_create_undefined();
 }
 
@@ -677,7 +404,6 @@ JERRYXX_FUN(vfs_fat_rmdir_fn) {
  * Initialize fs_native object and return exportsio
  */
 jerry_value_t module_vfs_fat_init() {
-  vfs_fat_init();
   /* VFSFat class */
   jerry_value_t vfs_fat_ctor = jerry_create_external_function(vfsfat_ctor_fn);
   jerry_value_t vfs_fat_prototype = jerry_create_object();
@@ -688,26 +414,6 @@ jerry_value_t module_vfs_fat_init() {
                                 vfs_fat_mount_fn);
   jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_UNMOUNT,
                                 vfs_fat_unmount_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_OPEN,
-                                vfs_fat_open_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_WRITE,
-                                vfs_fat_write_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_READ,
-                                vfs_fat_read_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_CLOSE,
-                                vfs_fat_close_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_STAT,
-                                vfs_fat_stat_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_RENAME,
-                                vfs_fat_rename_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_UNLINK,
-                                vfs_fat_unlink_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_MKDIR,
-                                vfs_fat_mkdir_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_READDIR,
-                                vfs_fat_readdir_fn);
-  jerryxx_set_property_function(vfs_fat_prototype, MSTR_VFS_FAT_RMDIR,
-                                vfs_fat_rmdir_fn);
   jerry_release_value(vfs_fat_prototype);
 
   /* VFSFatFS module exports */
@@ -21,66 +21,300 @@
 
 #include "vfs_fat.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "err.h"
 #include "ff.h"
-#include "gpio.h"
-#include "rtc.h"
-#include "spi.h"
-#include "system.h"
-
-vfs_fat_root_t vfs_fat_root;
-
-void vfs_fat_init() {
-  vfs_fat_root.file_id_count = 0;
-  pwjs_list_init(&vfs_fat_root.vfs_fat_handles);
-}
-
-void vfs_fat_cleanup() {
-  vfs_fat_handle_t *handle =
-      (vfs_fat_handle_t *)vfs_fat_root.vfs_fat_handles.head;
-  while (handle != NULL) {
-    vfs_fat_handle_t *next =
-        (vfs_fat_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
-    handle = next;
+#include "mem.h"
+
+typedef struct {
+  FF_DIR dir;
+  FILINFO info;
+} vfs_fat_dir_t;
+
+/**
+ * Initial and maximum number of items of a cluster link map. The map takes
+ * two items per fragment of the file plus two, so the maximum (1 KB) covers
+ * 127 fragments. The seeks of a more fragmented file walk the FAT chain.
+ */
+#define VFS_FAT_LINKMAP_INIT 16
+#define VFS_FAT_LINKMAP_MAX 256
+
+/**
+ * Open file. A file opened with PWJS_VFS_FLAG_RANDOM gets a cluster link map
+ * (FatFs fast seek) on its first seek, so that seeks no longer walk the FAT
+ * chain from the start of the file.
+ */
+typedef struct {
+  FIL fp;
+  DWORD *linkmap;  // NULL until the first seek, or if invalidated
+  bool random;     // false too if the file is too fragmented for the map
+} vfs_fat_file_t;
+
+int vfs_fat_errno(FRESULT ret) {
+  switch (ret) {
+    case FR_OK:
+      return 0;
+    case FR_NO_FILE:
+    case FR_NO_PATH:
+    case FR_INVALID_NAME:
+    case FR_INVALID_DRIVE:
+      return ENOENT;
+    case FR_EXIST:
+      return EEXIST;
+    case FR_WRITE_PROTECTED:
+      return EROFS;
+    case FR_LOCKED:
+      return ETXTBSY;
+    case FR_INVALID_PARAMETER:
+      return EINVAL;
+    default:
+      return EIO;
+  }
+}
+
+/**
+ * Convert a FAT date and time (UTC, see get_fattime()) to seconds since 1970
+ */
+static uint32_t vfs_fat_mtime(WORD fdate, WORD ftime) {
+  int32_t year = (fdate >> 9) + 1980;
+  int32_t month = (fdate >> 5) & 0x0f;
+  int32_t day = fdate & 0x1f;
+  if (month < 1 || month > 12 || day < 1) {
+    return 0;
+  }
+  // days since 1970-01-01, counting years from March
+  if (month <= 2) {
+    year--;
+  }
+  int32_t yoe = year % 400;
+  int32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  int32_t days = (year / 400) * 146097 + yoe * 365 + yoe / 4 - yoe / 100 +
+                 doy - 719468;
+  return (uint32_t)days * 86400 + (ftime >> 11) * 3600 +
+         ((ftime >> 5) & 0x3f) * 60 + (ftime & 0x1f) * 2;
+}
+
+static int vfs_fat_open(pwjs_vfs_t *vfs, const char *path, int flags,
+                        void **file) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+
+  // convert flags to fat_flags
+  BYTE fat_flags = 0;
+  if (flags & PWJS_VFS_FLAG_READ) fat_flags |= FA_READ;
+  if (flags & PWJS_VFS_FLAG_WRITE) fat_flags |= FA_WRITE;
+  if (flags & PWJS_VFS_FLAG_CREATE) fat_flags |= FA_OPEN_ALWAYS;
+  if (flags & PWJS_VFS_FLAG_APPEND) fat_flags |= FA_OPEN_APPEND;
+  if (flags & PWJS_VFS_FLAG_TRUNC) fat_flags |= FA_CREATE_ALWAYS;
+  if (flags & PWJS_VFS_FLAG_EXCL) fat_flags |= FA_CREATE_NEW;
+
+  vfs_fat_file_t *fat_file =
+      (vfs_fat_file_t *)pwjs_malloc(PWJS_MEM_VFS_FAT, sizeof(vfs_fat_file_t));
+  if (fat_file == NULL) {
+    return ENOMEM;
+  }
+  FRESULT ret = f_open(handle->fat_fs, &fat_file->fp, path, fat_flags);
+  if (ret != FR_OK) {
+    pwjs_free(fat_file);
+    return vfs_fat_errno(ret);
   }
-  pwjs_list_init(&vfs_fat_root.vfs_fat_handles);
+  fat_file->linkmap = NULL;
+  fat_file->random = (flags & PWJS_VFS_FLAG_RANDOM) != 0;
+  *file = fat_file;
+  return 0;
 }
 
-void vfs_fat_handle_init(vfs_fat_handle_t *handle) {
-  pwjs_list_init(&handle->file_handles);
+/**
+ * Leave the fast seek mode, which can't grow the file
+ */
+static void vfs_fat_drop_linkmap(vfs_fat_file_t *fat_file) {
+  if (fat_file->linkmap != NULL) {
+    fat_file->fp.cltbl = NULL;
+    pwjs_free(fat_file->linkmap);
+    fat_file->linkmap = NULL;
+  }
 }
 
-void vfs_fat_handle_add(vfs_fat_handle_t *handle) {
-  pwjs_list_append(&vfs_fat_root.vfs_fat_handles, (pwjs_list_node_t *)handle);
+/**
+ * Create the cluster link map of a file, growing it up to
+ * VFS_FAT_LINKMAP_MAX items. Returns false if the file can't be mapped.
+ */
+static bool vfs_fat_create_linkmap(vfs_fat_file_t *fat_file) {
+  DWORD size = VFS_FAT_LINKMAP_INIT;
+  while (size <= VFS_FAT_LINKMAP_MAX) {
+    DWORD *linkmap =
+        (DWORD *)pwjs_malloc(PWJS_MEM_VFS_FAT, sizeof(DWORD) * size);
+    if (linkmap == NULL) {
+      return false;
+    }
+    linkmap[0] = size;
+    fat_file->fp.cltbl = linkmap;
+    FRESULT ret = f_lseek(&fat_file->fp, CREATE_LINKMAP);
+    if (ret == FR_OK) {
+      fat_file->linkmap = linkmap;
+      return true;
+    }
+    fat_file->fp.cltbl = NULL;
+    size = linkmap[0];  // the required size
+    pwjs_free(linkmap);
+    if (ret != FR_NOT_ENOUGH_CORE) {
+      return false;
+    }
+  }
+  return false;
 }
 
-void vfs_fat_handle_remove(vfs_fat_handle_t *handle) {
-  pwjs_list_remove(&vfs_fat_root.vfs_fat_handles, (pwjs_list_node_t *)handle);
+static int vfs_fat_close(pwjs_vfs_t *vfs, void *file) {
+  vfs_fat_file_t *fat_file = (vfs_fat_file_t *)file;
+  FRESULT ret = f_close(&fat_file->fp);
+  pwjs_free(fat_file->linkmap);
+  pwjs_free(fat_file);
+  return vfs_fat_errno(ret);
 }
 
-void vfs_fat_file_add(vfs_fat_handle_t *handle, vfs_fat_file_handle_t *file) {
-  vfs_fat_root.file_id_count++;
-  file->id = vfs_fat_root.file_id_count;
-  pwjs_list_append(&handle->file_handles, (pwjs_list_node_t *)file);
+static int vfs_fat_read(pwjs_vfs_t *vfs, void *file, uint8_t *buffer,
+                        size_t size) {
+  UINT length = 0;
+  FRESULT ret =
+      f_read(&((vfs_fat_file_t *)file)->fp, buffer, size, &length);
+  return ret == FR_OK ? (int)length : vfs_fat_errno(ret);
 }
 
-void vfs_fat_file_remove(vfs_fat_handle_t *handle,
-                         vfs_fat_file_handle_t *file) {
-  pwjs_list_remove(&handle->file_handles, (pwjs_list_node_t *)file);
+static int vfs_fat_write(pwjs_vfs_t *vfs, void *file, const uint8_t *buffer,
+                         size_t size) {
+  vfs_fat_file_t *fat_file = (vfs_fat_file_t *)file;
+  if (fat_file->linkmap != NULL &&
+      f_tell(&fat_file->fp) + size > f_size(&fat_file->fp)) {
+    // the map is created again on the next seek
+    vfs_fat_drop_linkmap(fat_file);
+  }
+  UINT length = 0;
+  FRESULT ret = f_write(&fat_file->fp, buffer, size, &length);
+  return ret == FR_OK ? (int)length : vfs_fat_errno(ret);
 }
 
-vfs_fat_file_handle_t *vfs_fat_file_get_by_id(vfs_fat_handle_t *handle,
-                                              uint32_t file_id) {
-  vfs_fat_file_handle_t *file =
-      (vfs_fat_file_handle_t *)handle->file_handles.head;
-  while (file != NULL) {
-    if (file->id == file_id) {
-      return file;
+static int vfs_fat_seek(pwjs_vfs_t *vfs, void *file, uint32_t position) {
+  vfs_fat_file_t *fat_file = (vfs_fat_file_t *)file;
+  if (position > f_size(&fat_file->fp)) {
+    // seeking past the end grows the file
+    vfs_fat_drop_linkmap(fat_file);
+  } else if (fat_file->random && fat_file->linkmap == NULL) {
+    fat_file->random = vfs_fat_create_linkmap(fat_file);
+  }
+  return vfs_fat_errno(f_lseek(&fat_file->fp, position));
+}
+
+static int vfs_fat_stat(pwjs_vfs_t *vfs, const char *path,
+                        pwjs_vfs_stat_t *stat) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+  if (strcmp(path, "/") == 0) {
+    stat->type = PWJS_VFS_TYPE_DIR;
+    stat->size = 0;
+    stat->mtime = 0;
+    return 0;
+  }
+  FILINFO *info = (FILINFO *)pwjs_malloc(PWJS_MEM_VFS_FAT, sizeof(FILINFO));
+  if (info == NULL) {
+    return ENOMEM;
+  }
+  FRESULT ret = f_stat(handle->fat_fs, path, info);
+  if (ret == FR_OK) {
+    stat->type = (info->fattrib & AM_DIR) ? PWJS_VFS_TYPE_DIR
+                                          : PWJS_VFS_TYPE_FILE;
+    stat->size = (info->fattrib & AM_DIR) ? 0 : info->fsize;
+    stat->mtime = vfs_fat_mtime(info->fdate, info->ftime);
+  }
+  pwjs_free(info);
+  return vfs_fat_errno(ret);
+}
+
+static int vfs_fat_opendir(pwjs_vfs_t *vfs, const char *path, void **dir) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+  vfs_fat_dir_t *fat_dir =
+      (vfs_fat_dir_t *)pwjs_malloc(PWJS_MEM_VFS_FAT, sizeof(vfs_fat_dir_t));
+  if (fat_dir == NULL) {
+    return ENOMEM;
+  }
+  FRESULT ret = f_opendir(handle->fat_fs, &fat_dir->dir, path);
+  if (ret != FR_OK) {
+    pwjs_free(fat_dir);
+    return vfs_fat_errno(ret);
+  }
+  *dir = fat_dir;
+  return 0;
+}
+
+static int vfs_fat_readdir(pwjs_vfs_t *vfs, void *dir,
+                           pwjs_vfs_dirent_t *entry) {
+  vfs_fat_dir_t *fat_dir = (vfs_fat_dir_t *)dir;
+  FILINFO *info = &fat_dir->info;
+  while (true) {
+    FRESULT ret = f_readdir(&fat_dir->dir, info);
+    if (ret != FR_OK) {
+      return vfs_fat_errno(ret);
+    }
+    if (info->fname[0] == 0) {
+      return 0;
+    }
+    // skip '.', '..'
+    if (strcmp(info->fname, ".") != 0 && strcmp(info->fname, "..") != 0) {
+      break;
     }
-    file = (vfs_fat_file_handle_t *)((pwjs_list_node_t *)file)->next;
   }
-  return NULL;
-}
\ No newline at end of file
+  strncpy(entry->name, info->fname, PWJS_VFS_NAME_MAX);
+  entry->name[PWJS_VFS_NAME_MAX] = '\0';
+  entry->type = (info->fattrib & AM_DIR) ? PWJS_VFS_TYPE_DIR
+                                         : PWJS_VFS_TYPE_FILE;
+  entry->size = (info->fattrib & AM_DIR) ? 0 : info->fsize;
+  entry->mtime = vfs_fat_mtime(info->fdate, info->ftime);
+  return 1;
+}
+
+static int vfs_fat_closedir(pwjs_vfs_t *vfs, void *dir) {
+  FRESULT ret = f_closedir(&((vfs_fat_dir_t *)dir)->dir);
+  pwjs_free(dir);
+  return vfs_fat_errno(ret);
+}
+
+static int vfs_fat_mkdir(pwjs_vfs_t *vfs, const char *path) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+  return vfs_fat_errno(f_mkdir(handle->fat_fs, path));
+}
+
+static int vfs_fat_unlink(pwjs_vfs_t *vfs, const char *path) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+  return vfs_fat_errno(f_unlink(handle->fat_fs, path));
+}
+
+static int vfs_fat_rename(pwjs_vfs_t *vfs, const char *old_path,
+                          const char *new_path) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+  return vfs_fat_errno(f_rename(handle->fat_fs, old_path, new_path));
+}
+
+static void vfs_fat_free(pwjs_vfs_t *vfs) {
+  vfs_fat_handle_t *handle = (vfs_fat_handle_t *)vfs;
+  pwjs_blkcache_release(&handle->cache);
+  jerry_release_value(handle->blkdev_js);
+  pwjs_free(handle->fat_fs);
+  pwjs_free(handle);
+}
+
+const pwjs_vfs_ops_t vfs_fat_ops = {
+    .open = vfs_fat_open,
+    .close = vfs_fat_close,
+    .read = vfs_fat_read,
+    .write = vfs_fat_write,
+    .seek = vfs_fat_seek,
+    .stat = vfs_fat_stat,
+    .opendir = vfs_fat_opendir,
+    .readdir = vfs_fat_readdir,
+    .closedir = vfs_fat_closedir,
+    .mkdir = vfs_fat_mkdir,
+    .unlink = vfs_fat_unlink,
+    .rename = vfs_fat_rename,
+    .rmdir = vfs_fat_unlink,
+    .free = vfs_fat_free,
+};
@@ -22,63 +22,33 @@
 #ifndef __VFSFAT_H
 #define __VFSFAT_H
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "diskio.h"
 #include "ff.h"
 #include "jerryscript.h"
-#include "utils.h"
+#include "vfs.h"
 
-#define VFS_FAT_GET_FILE_HANDLE(vfs_handle, file, id)                    \
-  vfs_fat_file_handle_t *file = vfs_fat_file_get_by_id(vfs_handle, id);  \
-  if (file == NULL) {                                                    \
-    return jerry_create_error_from_value(create_system_error(-9), true); \
-  }
-
-#define VFS_GET_FS_HANDLE(root, vfs_handle, pdrv)                        \
-  vfs_fat_handle_t *vfs_handle = vfs_fat_get_fs_by_drv(root, pdrv);      \
-  if (vfs_handle == NULL) {                                              \
-    return jerry_create_error_from_value(create_system_error(-5), true); \
-  }
-
-typedef struct vfs_fat_root_s vfs_fat_root_t;
 typedef struct vfs_fat_handle_s vfs_fat_handle_t;
-typedef struct vfs_fat_file_handle_s vfs_fat_file_handle_t;
-
-// File open flags
-enum vfs_fat_open_flags {
-  VFS_FLAG_READ = 1,
-  VFS_FLAG_WRITE = 2,
-  VFS_FLAG_CREATE = 4,
-  VFS_FLAG_APPEND = 8,
-  VFS_FLAG_EXCL = 16,
-  VFS_FLAG_TRUNC = 32,
-};
-
-struct vfs_fat_root_s {
-  uint32_t file_id_count;
-  pwjs_list_t vfs_fat_handles;
-};
 
 struct vfs_fat_handle_s {
-  pwjs_list_node_t base;
+  pwjs_vfs_t vfs;
   jerry_value_t blkdev_js;
-  pwjs_list_t file_handles;
+  pwjs_blkdev_t *blkdev;  // native block device, NULL if implemented in JS
+  uint32_t block_size;
   FATFS *fat_fs;
   DSTATUS status;
+  pwjs_blkcache_dev_t cache;
 };
 
-struct vfs_fat_file_handle_s {
-  pwjs_list_node_t base;
-  uint32_t id;
-  FIL *fat_fp;
-};
+/**
+ * File system operations of FatFs
+ */
+extern const pwjs_vfs_ops_t vfs_fat_ops;
+
+/**
+ * Convert a FatFs result to a negative errno (0 for FR_OK)
+ */
+int vfs_fat_errno(FRESULT ret);
 
-void vfs_fat_init();
-void vfs_fat_cleanup();
-void vfs_fat_handle_init(vfs_fat_handle_t *);
-void vfs_fat_handle_add(vfs_fat_handle_t *);
-void vfs_fat_handle_remove(vfs_fat_handle_t *);
-void vfs_fat_file_add(vfs_fat_handle_t *, vfs_fat_file_handle_t *);
-void vfs_fat_file_remove(vfs_fat_handle_t *, vfs_fat_file_handle_t *);
-vfs_fat_file_handle_t *vfs_fat_file_get_by_id(vfs_fat_handle_t *, uint32_t);
-vfs_fat_handle_t *vfs_fat_get_fs_by_drv(vfs_fat_root_t *handle, BYTE pdrv);
 #endif /* __VFSFAT_H */
\ No newline at end of file
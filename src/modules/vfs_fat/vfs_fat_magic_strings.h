@@ -26,27 +26,6 @@
 #define MSTR_VFS_FAT_MKFS "mkfs"
 #define MSTR_VFS_FAT_MOUNT "mount"
 #define MSTR_VFS_FAT_UNMOUNT "unmount"
-#define MSTR_VFS_FAT_OPEN "open"
-#define MSTR_VFS_FAT_WRITE "write"
-#define MSTR_VFS_FAT_READ "read"
-#define MSTR_VFS_FAT_CLOSE "close"
-#define MSTR_VFS_FAT_STAT "stat"
-#define MSTR_VFS_FAT_RENAME "rename"
-#define MSTR_VFS_FAT_UNLINK "unlink"
-#define MSTR_VFS_FAT_MKDIR "mkdir"
-#define MSTR_VFS_FAT_READDIR "readdir"
-#define MSTR_VFS_FAT_RMDIR "rmdir"
-#define MSTR_VFS_FAT_PATH "path"
-#define MSTR_VFS_FAT_OLD_PATH "oldPath"
-#define MSTR_VFS_FAT_NEW_PATH "newPath"
-#define MSTR_VFS_FAT_FLAGS "flags"
-#define MSTR_VFS_FAT_MODE "mode"
-#define MSTR_VFS_FAT_ID "id"
-#define MSTR_VFS_FAT_BUFFER "buffer"
-#define MSTR_VFS_FAT_OFFSET "offset"
-#define MSTR_VFS_FAT_LENGTH "length"
-#define MSTR_VFS_FAT_POSITION "position"
-#define MSTR_VFS_FAT_TYPE "type"
-#define MSTR_VFS_FAT_SIZE "size"
+#define MSTR_VFS_FAT_BLOCK_CACHE "blockCache"
 
 #endif /* __VFS_FAT_MAGIC_STRINGS_H */
@@ -22,32 +22,40 @@
 #include "module_vfs_lfs.h"
 
 #include <stdlib.h>
+#include <string.h>
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "err.h"
 #include "io.h"
 #include "jerryscript.h"
 #include "jerryxx.h"
 #include "lfs.h"
 #include "magic_strings.h"
+#include "mem.h"
+#include "vfs.h"
 #include "vfs_lfs.h"
 #include "vfs_lfs_magic_strings.h"
 
-static void vfs_handle_freecb(void *handle) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)handle;
-  free(vfs_handle->config.lookahead_buffer);
-  free(vfs_handle->config.prog_buffer);
-  free(vfs_handle->config.read_buffer);
-  jerry_release_value(vfs_handle->blkdev_js);
-  vfs_lfs_handle_remove(handle);
-  free(handle);
-}
-
-static const jerry_object_native_info_t vfs_handle_info = {
-    .free_cb = vfs_handle_freecb};
+/**
+ * Get the native handle of a VFSLittleFS object
+ */
+#define VFS_LFS_GET_HANDLE(name)                                       \
+  vfs_lfs_handle_t *name = (vfs_lfs_handle_t *)pwjs_vfs_get(this_val); \
+  if (name == NULL || name->vfs.ops != &vfs_lfs_ops) {                 \
+    return jerry_create_error(                                         \
+        JERRY_ERROR_REFERENCE,                                         \
+        (const jerry_char_t *)"Failed to get native handle");          \
+  }
 
-static int blkdev_ioctl(jerry_value_t blkdev_js, int op, int arg) {
+static int blkdev_ioctl(vfs_lfs_handle_t *vfs_handle, int op, int arg) {
   // pwjs_tty_printf("blkdev_ioctl(%d, %d)\r\n", op, arg);
-  jerry_value_t ioctl_js = jerryxx_get_property(blkdev_js, "ioctl");
+  if (vfs_handle->blkdev != NULL) {
+    return vfs_handle->blkdev->ioctl(vfs_handle->blkdev, op, arg);
+  }
+  jerry_value_t blkdev_js = vfs_handle->blkdev_js;
+  jerry_value_t ioctl_js =
+      jerryxx_get_property_by_key(blkdev_js, JERRYXX_KEY_IOCTL);
   jerry_value_t op_js = jerry_create_number(op);
   jerry_value_t arg_js = jerry_create_number(arg);
   jerry_value_t args[2] = {op_js, arg_js};
@@ -64,17 +72,21 @@ static int blkdev_ioctl(jerry_value_t blkdev_js, int op, int arg) {
   return ret_value;
 }
 
-static int blkdev_read(const struct lfs_config *c, lfs_block_t block,
-                       lfs_off_t off, void *buffer, lfs_size_t size) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
+static int blkdev_read_raw(vfs_lfs_handle_t *vfs_handle, lfs_block_t block,
+                           lfs_off_t off, void *buffer, lfs_size_t size) {
   // call blockdev.read(block, buffer, offset)
   // pwjs_tty_printf("blkdev_read(lfs_config, %d, %d, buffer, %d)\r\n", block,
   // off, size);
+  if (vfs_handle->blkdev != NULL) {
+    return vfs_handle->blkdev->read(vfs_handle->blkdev, block, off,
+                                    (uint8_t *)buffer, size);
+  }
   jerry_value_t arraybuffer =
       jerry_create_arraybuffer_external(size, (uint8_t *)buffer, NULL);
   jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
       JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t read_js = jerryxx_get_property(vfs_handle->blkdev_js, "read");
+  jerry_value_t read_js =
+      jerryxx_get_property_by_key(vfs_handle->blkdev_js, JERRYXX_KEY_READ);
   jerry_value_t block_js = jerry_create_number(block);
   jerry_value_t offset_js = jerry_create_number(off);
   jerry_value_t args[3] = {block_js, buffer_js, offset_js};
@@ -89,17 +101,22 @@ static int blkdev_read(const struct lfs_config *c, lfs_block_t block,
   return 0;
 }
 
-static int blkdev_prog(const struct lfs_config *c, lfs_block_t block,
-                       lfs_off_t off, const void *buffer, lfs_size_t size) {
-  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
+static int blkdev_prog_raw(vfs_lfs_handle_t *vfs_handle, lfs_block_t block,
+                           lfs_off_t off, const void *buffer,
+                           lfs_size_t size) {
   // call blockdev.write(block, buffer, offset)
   // pwjs_tty_printf("blkdev_prog(lfs_config, %d, %d, buffer, %d)\r\n", block,
   // off, size);
+  if (vfs_handle->blkdev != NULL) {
+    return vfs_handle->blkdev->write(vfs_handle->blkdev, block, off,
+                                     (const uint8_t *)buffer, size);
+  }
   jerry_value_t arraybuffer =
       jerry_create_arraybuffer_external(size, (uint8_t *)buffer, NULL);
   jerry_value_t buffer_js = jerry_create_typedarray_for_arraybuffer(
       JERRY_TYPEDARRAY_UINT8, arraybuffer);
-  jerry_value_t write_js = jerryxx_get_property(vfs_handle->blkdev_js, "write");
+  jerry_value_t write_js =
+      jerryxx_get_property_by_key(vfs_handle->blkdev_js, JERRYXX_KEY_WRITE);
   jerry_value_t block_js = jerry_create_number(block);
   jerry_value_t offset_js = jerry_create_number(off);
   jerry_value_t args[3] = {block_js, buffer_js, offset_js};
@@ -114,18 +131,99 @@ static int blkdev_prog(const struct lfs_config *c, lfs_block_t block,
   return 0;
 }
 
+static int blkdev_cache_read(pwjs_blkcache_dev_t *dev, uint32_t block,
+                             uint32_t offset, uint8_t *buffer, size_t size) {
+  return blkdev_read_raw((vfs_lfs_handle_t *)dev->owner, block, offset,
+                         buffer, size);
+}
+
+static int blkdev_cache_write(pwjs_blkcache_dev_t *dev, uint32_t block,
+                              uint32_t offset, const uint8_t *buffer,
+                              size_t size) {
+  return blkdev_prog_raw((vfs_lfs_handle_t *)dev->owner, block, offset,
+                         buffer, size);
+}
+
+/**
+ * Read the device through the block cache
+ */
+static int blkdev_read_device(vfs_lfs_handle_t *vfs_handle,
+                              lfs_block_t block, lfs_off_t off, void *buffer,
+                              lfs_size_t size) {
+  return pwjs_blkcache_read(&vfs_handle->cache, block, off, (uint8_t *)buffer,
+                            size);
+}
+
+/**
+ * Read through the read-ahead buffer. When a read starts where the previous
+ * one ended, the following bytes are fetched with it: up to the end of the
+ * block for JS block devices, across blocks for native ones.
+ */
+static int blkdev_read(const struct lfs_config *c, lfs_block_t block,
+                       lfs_off_t off, void *buffer, lfs_size_t size) {
+  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
+  uint64_t addr = (uint64_t)block * c->block_size + off;
+  bool sequential = (addr == vfs_handle->read_end);
+  vfs_handle->read_end = addr + size;
+  if (vfs_handle->read_ahead == NULL) {
+    return blkdev_read_device(vfs_handle, block, off, buffer, size);
+  }
+  if (addr >= vfs_handle->read_ahead_start &&
+      addr + size <=
+          vfs_handle->read_ahead_start + vfs_handle->read_ahead_length) {
+    memcpy(buffer,
+           vfs_handle->read_ahead + (addr - vfs_handle->read_ahead_start),
+           size);
+    return 0;
+  }
+  uint64_t end = (vfs_handle->blkdev != NULL)
+                     ? (uint64_t)c->block_count * c->block_size
+                     : (uint64_t)(block + 1) * c->block_size;
+  uint32_t length = vfs_handle->read_ahead_size;
+  if (addr + length > end) {
+    length = end - addr;
+  }
+  if (!sequential || length <= size) {
+    return blkdev_read_device(vfs_handle, block, off, buffer, size);
+  }
+  vfs_handle->read_ahead_length = 0;
+  int ret = blkdev_read_device(vfs_handle, block, off, vfs_handle->read_ahead,
+                               length);
+  if (ret < 0) {
+    return ret;
+  }
+  vfs_handle->read_ahead_start = addr;
+  vfs_handle->read_ahead_length = length;
+  memcpy(buffer, vfs_handle->read_ahead, size);
+  return 0;
+}
+
+static int blkdev_prog(const struct lfs_config *c, lfs_block_t block,
+                       lfs_off_t off, const void *buffer, lfs_size_t size) {
+  vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
+  vfs_handle->read_ahead_length = 0;
+  return pwjs_blkcache_write(&vfs_handle->cache, block, off,
+                             (const uint8_t *)buffer, size);
+}
+
 static int blkdev_erase(const struct lfs_config *c, lfs_block_t block) {
   vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
   // pwjs_tty_printf("blkdev_erase(lfs_config, %d)\r\n", block);
-  blkdev_ioctl(vfs_handle->blkdev_js, 6, block);
-  return 0;
+  vfs_handle->read_ahead_length = 0;
+  pwjs_blkcache_invalidate(&vfs_handle->cache, block);
+  int ret = blkdev_ioctl(vfs_handle, 6, block);
+  return ret < 0 ? ret : 0;
 }
 
 static int blkdev_sync(const struct lfs_config *c) {
   vfs_lfs_handle_t *vfs_handle = (vfs_lfs_handle_t *)c->context;
   // pwjs_tty_printf("blkdev_sync(lfs_config)\r\n");
-  blkdev_ioctl(vfs_handle->blkdev_js, 3, 0);
-  return 0;
+  int ret = pwjs_blkcache_flush(&vfs_handle->cache);
+  if (ret < 0) {
+    return ret;
+  }
+  ret = blkdev_ioctl(vfs_handle, 3, 0);
+  return ret < 0 ? ret : 0;
 }
 
 /**
@@ -140,19 +238,20 @@ JERRYXX_FUN(vfslfs_ctor_fn) {
 
   // initialize vfs native handle
   vfs_lfs_handle_t *vfs_handle =
-      (vfs_lfs_handle_t *)malloc(sizeof(vfs_lfs_handle_t));
-  vfs_lfs_handle_init(vfs_handle);
-  vfs_lfs_handle_add(vfs_handle);
+      (vfs_lfs_handle_t *)pwjs_malloc(PWJS_MEM_VFS_LFS,
+                                      sizeof(vfs_lfs_handle_t));
+  vfs_handle->vfs.ops = &vfs_lfs_ops;
   vfs_handle->blkdev_js = blkdev;
   jerry_acquire_value(vfs_handle->blkdev_js);
+  vfs_handle->blkdev = pwjs_blkdev_get(blkdev);
   vfs_handle->config.context = vfs_handle;
   vfs_handle->config.read = blkdev_read;
   vfs_handle->config.prog = blkdev_prog;
   vfs_handle->config.erase = blkdev_erase;
   vfs_handle->config.sync = blkdev_sync;
-  int block_count = blkdev_ioctl(vfs_handle->blkdev_js, 4, 0);
-  int block_size = blkdev_ioctl(vfs_handle->blkdev_js, 5, 0);
-  int unit_size = blkdev_ioctl(vfs_handle->blkdev_js, 7, 0);
+  int block_count = blkdev_ioctl(vfs_handle, 4, 0);
+  int block_size = blkdev_ioctl(vfs_handle, 5, 0);
+  int unit_size = blkdev_ioctl(vfs_handle, 7, 0);
   vfs_handle->config.read_size = unit_size;
   vfs_handle->config.prog_size = unit_size;
   vfs_handle->config.block_size = block_size;
@@ -163,296 +262,151 @@ JERRYXX_FUN(vfslfs_ctor_fn) {
   vfs_handle->config.file_max = 1024 * 1024 * 16;  // 16MB
   vfs_handle->config.attr_max = 512;
   vfs_handle->config.block_cycles = 500;
-  vfs_handle->config.read_buffer = malloc(vfs_handle->config.cache_size);
-  vfs_handle->config.prog_buffer = malloc(vfs_handle->config.cache_size);
+  vfs_handle->config.read_buffer =
+      pwjs_malloc(PWJS_MEM_VFS_LFS, vfs_handle->config.cache_size);
+  vfs_handle->config.prog_buffer =
+      pwjs_malloc(PWJS_MEM_VFS_LFS, vfs_handle->config.cache_size);
   vfs_handle->config.lookahead_buffer =
-      malloc(vfs_handle->config.lookahead_size);
+      pwjs_malloc(PWJS_MEM_VFS_LFS, vfs_handle->config.lookahead_size);
+  vfs_handle->read_ahead = NULL;
+  vfs_handle->read_ahead_size = 0;
+  vfs_handle->read_ahead_start = 0;
+  vfs_handle->read_ahead_length = 0;
+  vfs_handle->read_end = 0;
+  vfs_handle->cache.read = blkdev_cache_read;
+  vfs_handle->cache.write = blkdev_cache_write;
+  vfs_handle->cache.owner = vfs_handle;
+  vfs_handle->cache.block_size = block_size;
+  vfs_handle->cache.mode = PWJS_BLKCACHE_NONE;
 
   // assign native handle in js object
-  jerry_set_object_native_pointer(this_val, vfs_handle, &vfs_handle_info);
-
-  return jerry_create_undefined();
-}
+  pwjs_vfs_bind(this_val, &vfs_handle->vfs);
 
-/**
- * VFSLittleFS.prototype.mkfs()
- */
-JERRYXX_FUN(vfs_lfs_mkfs_fn) {
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-
-  // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
-
-  // make fs (format)
-  int ret = lfs_format(&vfs_handle->lfs, &vfs_handle->config);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
-  }
   return jerry_create_undefined();
 }
 
 /**
- * VFSLittleFS.prototype.mount()
+ * Reallocate a buffer, keeping the old one if out of memory
  */
-JERRYXX_FUN(vfs_lfs_mount_fn) {
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-
-  // initialize block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 1, 0);
-
-  // mount vfs
-  int ret = lfs_mount(&vfs_handle->lfs, &vfs_handle->config);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+static bool vfs_lfs_resize(void **buffer, size_t size) {
+  void *new_buffer = NULL;
+  if (size > 0) {
+    new_buffer = pwjs_malloc(PWJS_MEM_VFS_LFS, size);
+    if (new_buffer == NULL) {
+      return false;
+    }
   }
-  return jerry_create_undefined();
+  pwjs_free(*buffer);
+  *buffer = new_buffer;
+  return true;
 }
 
 /**
- * VFSLittleFS.prototype.unmount()
+ * Get the block cache mode from the blockCache option, or EINVAL
  */
-JERRYXX_FUN(vfs_lfs_unmount_fn) {
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-
-  // unmount vfs
-  int ret = lfs_unmount(&vfs_handle->lfs);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+static int vfs_lfs_get_cache_mode(jerry_value_t options,
+                                  pwjs_blkcache_mode_t mode) {
+  jerry_value_t value = jerryxx_get_property(options, MSTR_VFS_LFS_BLOCK_CACHE);
+  int ret = mode;
+  if (jerry_value_is_string(value)) {
+    char name[16];
+    jerry_size_t len = jerry_string_to_char_buffer(
+        value, (jerry_char_t *)name, sizeof(name) - 1);
+    name[len] = '\0';
+    ret = pwjs_blkcache_parse_mode(name);
+  } else if (!jerry_value_is_undefined(value)) {
+    ret = EINVAL;
   }
-
-  // shutdown block device
-  blkdev_ioctl(vfs_handle->blkdev_js, 2, 0);
-  return jerry_create_undefined();
+  jerry_release_value(value);
+  return ret;
 }
 
 /**
- * VFSLittleFS.prototype.open()
- * args:
- *   path {string}
- *   flags {number} See enum vfslfs_open_flags
- *   mode {number}
- * returns {number} - id
+ * Apply mount options to the littlefs configuration:
+ *   cacheSize {number} read, program and file cache size, a multiple of
+ *     the device unit size dividing the block size
+ *   lookaheadSize {number} lookahead buffer size, a multiple of 8 (each
+ *     byte tracks 8 blocks)
+ *   blockCycles {number} erase cycles before moving metadata, -1 to disable
+ *     wear leveling
+ *   readAhead {number} bytes read ahead for sequential reads, a multiple
+ *     of the device unit size, 0 to disable
+ *   blockCache {string} 'none' (default), 'writethrough' or 'writeback' to
+ *     access the device through the shared block cache
  */
-JERRYXX_FUN(vfs_lfs_open_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_CHECK_ARG_NUMBER(1, "flags")
-  JERRYXX_CHECK_ARG_NUMBER(2, "mode")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
-  int flags = (int)JERRYXX_GET_ARG_NUMBER(1);
-  // int mode = (int)JERRYXX_GET_ARG_NUMBER(2);
-
-  // convert flags to lfs_flags
-  int lfs_flags = 0;
-  if (flags & VFS_FLAG_READ) lfs_flags |= LFS_O_RDONLY;
-  if (flags & VFS_FLAG_WRITE) lfs_flags |= LFS_O_WRONLY;
-  if (flags & VFS_FLAG_CREATE) lfs_flags |= LFS_O_CREAT;
-  if (flags & VFS_FLAG_APPEND) lfs_flags |= LFS_O_APPEND;
-  if (flags & VFS_FLAG_EXCL) lfs_flags |= LFS_O_EXCL;
-  if (flags & VFS_FLAG_TRUNC) lfs_flags |= LFS_O_TRUNC;
-
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-
-  // create file handle
-  vfs_lfs_file_handle_t *file = malloc(sizeof(vfs_lfs_file_handle_t));
-
-  // file open
-  int ret = lfs_file_open(&vfs_handle->lfs, &file->lfs_file, path, lfs_flags);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+static jerry_value_t vfs_lfs_configure(vfs_lfs_handle_t *vfs_handle,
+                                       jerry_value_t options) {
+  struct lfs_config *config = &vfs_handle->config;
+  lfs_size_t unit_size = config->read_size;
+  lfs_size_t cache_size = (lfs_size_t)jerryxx_get_property_number(
+      options, MSTR_VFS_LFS_CACHE_SIZE, config->cache_size);
+  lfs_size_t lookahead_size = (lfs_size_t)jerryxx_get_property_number(
+      options, MSTR_VFS_LFS_LOOKAHEAD_SIZE, config->lookahead_size);
+  int32_t block_cycles = (int32_t)jerryxx_get_property_number(
+      options, MSTR_VFS_LFS_BLOCK_CYCLES, config->block_cycles);
+  uint32_t read_ahead = (uint32_t)jerryxx_get_property_number(
+      options, MSTR_VFS_LFS_READ_AHEAD, vfs_handle->read_ahead_size);
+  int mode = vfs_lfs_get_cache_mode(options, vfs_handle->cache.mode);
+  if (cache_size == 0 || cache_size % unit_size > 0 ||
+      config->block_size % cache_size > 0 || lookahead_size == 0 ||
+      lookahead_size % 8 > 0 || block_cycles == 0 ||
+      read_ahead % unit_size > 0 || mode < 0) {
+    return jerry_create_error_from_value(create_system_error(EINVAL), true);
   }
-
-  // add file handle and return the id
-  vfs_lfs_file_add(vfs_handle, file);
-  uint32_t id = file->id;
-  return jerry_create_number(id);
-}
-
-/**
- * VFSLittleFS.prototype.write()
- * args:
- *   id {number}
- *   buffer {TypedArray}
- *   offset {number}
- *   length {number}
- *   position {number}
- * returns {number} - number of bytes written
- */
-JERRYXX_FUN(vfs_lfs_write_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_NUMBER(0, "id")
-  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(3, "length")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "position")
-  uint32_t id = (uint32_t)JERRYXX_GET_ARG_NUMBER(0);
-  jerry_value_t buffer = JERRYXX_GET_ARG(1);
-  jerry_length_t buf_length = 0;
-  jerry_length_t buf_offset = 0;
-  jerry_value_t arrbuf =
-      jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
-  jerry_release_value(arrbuf);
-  int offset = (int)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
-  int length = (int)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
-  int position = (int)JERRYXX_GET_ARG_NUMBER_OPT(4, -1);
-
-  // get native file handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-  VFS_LFS_GET_FILE_HANDLE(vfs_handle, file, id)
-
-  // set position
-  if (position > -1) {
-    int pos = lfs_file_seek(&vfs_handle->lfs, &file->lfs_file, position,
-                            LFS_SEEK_SET);
-    if (pos < 0) {
-      return jerry_create_error_from_value(create_system_error(pos), true);
+  if ((pwjs_blkcache_mode_t)mode != vfs_handle->cache.mode) {
+    int ret = pwjs_blkcache_flush(&vfs_handle->cache);
+    if (ret < 0) {
+      return jerry_create_error_from_value(create_system_error(ret), true);
     }
+    pwjs_blkcache_release(&vfs_handle->cache);
+    vfs_handle->cache.mode = (pwjs_blkcache_mode_t)mode;
   }
-
-  // file write
-  int ret = lfs_file_write(&vfs_handle->lfs, &file->lfs_file,
-                           (void *)(buffer_p + offset), length);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
-  }
-
-  // return number of bytes written
-  return jerry_create_number(ret);
-}
-
-/**
- * VFSLittleFS.prototype.read()
- * args:
- *   id {number}
- *   buffer {TypedArray}
- *   offset {number}
- *   length {number}
- *   position {number}
- * returns {number} - number of bytes read
- */
-JERRYXX_FUN(vfs_lfs_read_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_NUMBER(0, "id")
-  JERRYXX_CHECK_ARG_TYPEDARRAY(1, "buffer")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(2, "offset")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(3, "length")
-  JERRYXX_CHECK_ARG_NUMBER_OPT(4, "position")
-  uint32_t id = (uint32_t)JERRYXX_GET_ARG_NUMBER(0);
-  jerry_value_t buffer = JERRYXX_GET_ARG(1);
-  jerry_length_t buf_length = 0;
-  jerry_length_t buf_offset = 0;
-  jerry_value_t arrbuf =
-      jerry_get_typedarray_buffer(buffer, &buf_offset, &buf_length);
-  uint8_t *buffer_p = jerry_get_arraybuffer_pointer(arrbuf);
-  jerry_release_value(arrbuf);
-  int offset = (int)JERRYXX_GET_ARG_NUMBER_OPT(2, 0);
-  int length = (int)JERRYXX_GET_ARG_NUMBER_OPT(3, buf_length);
-  int position = (int)JERRYXX_GET_ARG_NUMBER_OPT(4, -1);
-
-  // get native file handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-  VFS_LFS_GET_FILE_HANDLE(vfs_handle, file, id)
-
-  // set position
-  if (position > -1) {
-    int pos = lfs_file_seek(&vfs_handle->lfs, &file->lfs_file, position,
-                            LFS_SEEK_SET);
-    if (pos < 0) {
-      return jerry_create_error_from_value(create_system_error(pos), true);
+  if (cache_size != config->cache_size) {
+    if (!vfs_lfs_resize(&config->read_buffer, cache_size) ||
+        !vfs_lfs_resize(&config->prog_buffer, cache_size)) {
+      return jerry_create_error_from_value(create_system_error(ENOMEM), true);
     }
+    config->cache_size = cache_size;
   }
-
-  // file read
-  int ret = lfs_file_read(&vfs_handle->lfs, &file->lfs_file,
-                          (uint8_t *)(buffer_p + offset), length);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+  if (lookahead_size != config->lookahead_size) {
+    if (!vfs_lfs_resize(&config->lookahead_buffer, lookahead_size)) {
+      return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+    }
+    config->lookahead_size = lookahead_size;
   }
-
-  // return number of bytes read
-  return jerry_create_number(ret);
-}
-
-/**
- * VFSLittleFS.prototype.close()
- * args:
- *   id {number}
- */
-JERRYXX_FUN(vfs_lfs_close_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_NUMBER(0, "id")
-  uint32_t id = (uint32_t)JERRYXX_GET_ARG_NUMBER(0);
-
-  // get native file handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-  VFS_LFS_GET_FILE_HANDLE(vfs_handle, file, id)
-
-  // file close
-  int ret = lfs_file_close(&vfs_handle->lfs, &file->lfs_file);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+  if (read_ahead != vfs_handle->read_ahead_size) {
+    if (!vfs_lfs_resize((void **)&vfs_handle->read_ahead, read_ahead)) {
+      return jerry_create_error_from_value(create_system_error(ENOMEM), true);
+    }
+    vfs_handle->read_ahead_size = read_ahead;
   }
-
-  // remote file handle
-  vfs_lfs_file_remove(vfs_handle, file);
-  free(file);
-
-  // return
+  vfs_handle->read_ahead_length = 0;
+  config->block_cycles = block_cycles;
   return jerry_create_undefined();
 }
 
 /**
- * VFSLittleFS.prototype.stat()
+ * VFSLittleFS.prototype.mkfs()
  * args:
- *   path {string}
- * returns {fs.Stats}
+ *   options {object} see vfs_lfs_configure()
  */
-JERRYXX_FUN(vfs_lfs_stat_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+JERRYXX_FUN(vfs_lfs_mkfs_fn) {
+  JERRYXX_CHECK_ARG_OBJECT_OPT(0, "options")
 
   // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-
-  // file stat
-  struct lfs_info info;
-  int ret = lfs_stat(&vfs_handle->lfs, path, &info);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+  VFS_LFS_GET_HANDLE(vfs_handle)
+  if (JERRYXX_HAS_ARG(0)) {
+    jerry_value_t ret = vfs_lfs_configure(vfs_handle, JERRYXX_GET_ARG(0));
+    if (jerry_value_is_error(ret)) {
+      return ret;
+    }
   }
 
-  // return stat object {type, size}
-  jerry_value_t obj = jerry_create_object();
-  jerryxx_set_property_number(obj, "type", info.type);
-  jerryxx_set_property_number(obj, "size",
-                              info.type == LFS_TYPE_REG ? info.size : 0);
-  return obj;
-}
-
-/**
- * VFSLittleFS.prototype.rename()
- * args:
- *   oldPath {string}
- *   newPath {string}
- */
-JERRYXX_FUN(vfs_lfs_rename_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING_OPT(0, "oldPath")
-  JERRYXX_CHECK_ARG_STRING_OPT(1, "newPath")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, old_path)
-  JERRYXX_GET_ARG_STRING_AS_CHAR(1, new_path)
-
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
+  // initialize block device
+  blkdev_ioctl(vfs_handle, 1, 0);
 
-  // file rename
-  int ret = lfs_rename(&vfs_handle->lfs, old_path, new_path);
+  // make fs (format)
+  int ret = lfs_format(&vfs_handle->lfs, &vfs_handle->config);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
@@ -460,41 +414,27 @@ JERRYXX_FUN(vfs_lfs_rename_fn) {
 }
 
 /**
- * VFSLittleFS.prototype.unlink()
+ * VFSLittleFS.prototype.mount()
  * args:
- *   path {string}
+ *   options {object} see vfs_lfs_configure()
  */
-JERRYXX_FUN(vfs_lfs_unlink_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING_OPT(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
+JERRYXX_FUN(vfs_lfs_mount_fn) {
+  JERRYXX_CHECK_ARG_OBJECT_OPT(0, "options")
 
   // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info)
-
-  // file delete
-  int ret = lfs_remove(&vfs_handle->lfs, path);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
+  VFS_LFS_GET_HANDLE(vfs_handle)
+  if (JERRYXX_HAS_ARG(0)) {
+    jerry_value_t ret = vfs_lfs_configure(vfs_handle, JERRYXX_GET_ARG(0));
+    if (jerry_value_is_error(ret)) {
+      return ret;
+    }
   }
-  return jerry_create_undefined();
-}
-
-/**
- * VFSLittleFS.prototype.mkdir()
- * args:
- *   path {string}
- */
-JERRYXX_FUN(vfs_lfs_mkdir_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
 
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info)
+  // initialize block device
+  blkdev_ioctl(vfs_handle, 1, 0);
 
-  // create a directory
-  int ret = lfs_mkdir(&vfs_handle->lfs, path);
+  // mount vfs
+  int ret = lfs_mount(&vfs_handle->lfs, &vfs_handle->config);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
@@ -502,68 +442,25 @@ JERRYXX_FUN(vfs_lfs_mkdir_fn) {
 }
 
 /**
- * VFSLittleFS.prototype.readdir()
- * args:
- *   path {string}
- * returns {string[]} - array of filenames
+ * VFSLittleFS.prototype.unmount()
  */
-JERRYXX_FUN(vfs_lfs_readdir_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
-
+JERRYXX_FUN(vfs_lfs_unmount_fn) {
   // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
+  VFS_LFS_GET_HANDLE(vfs_handle)
 
-  // read dir
-  lfs_dir_t dir;
-  struct lfs_info info;
-  int ret = lfs_dir_open(&vfs_handle->lfs, &dir, path);
+  // unmount vfs
+  int ret = lfs_unmount(&vfs_handle->lfs);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
-  jerry_value_t files = jerry_create_array(0);
-  while (true) {
-    ret = lfs_dir_read(&vfs_handle->lfs, &dir, &info);
-    if (ret < 0) {
-      return jerry_create_error_from_value(create_system_error(ret), true);
-    }
-    if (ret == 0) {
-      break;
-    }
-    // add to array except '.', '..'
-    if (strcmp(info.name, ".") != 0 && strcmp(info.name, "..") != 0) {
-      jerry_value_t item =
-          jerry_create_string((const jerry_char_t *)(info.name));
-      jerryxx_array_push_string(files, item);
-      jerry_release_value(item);
-    }
-  }
-  ret = lfs_dir_close(&vfs_handle->lfs, &dir);
+  ret = pwjs_blkcache_flush(&vfs_handle->cache);
+  pwjs_blkcache_release(&vfs_handle->cache);
   if (ret < 0) {
     return jerry_create_error_from_value(create_system_error(ret), true);
   }
-  return files;
-}
 
-/**
- * VFSLittleFS.prototype.rmdir()
- * args:
- *   path {string}
- */
-JERRYXX_FUN(vfs_lfs_rmdir_fn) {
-  // check and get args
-  JERRYXX_CHECK_ARG_STRING_OPT(0, "path")
-  JERRYXX_GET_ARG_STRING_AS_CHAR(0, path)
-
-  // get native vfs handle
-  JERRYXX_GET_NATIVE_HANDLE(vfs_handle, vfs_lfs_handle_t, vfs_handle_info);
-
-  // remove directory
-  int ret = lfs_remove(&vfs_handle->lfs, path);
-  if (ret < 0) {
-    return jerry_create_error_from_value(create_system_error(ret), true);
-  }
+  // shutdown block device
+  blkdev_ioctl(vfs_handle, 2, 0);
   return jerry_create_undefined();
 }
 
@@ -581,26 +478,6 @@ jerry_value_t module_vfs_lfs_init() {
                                 vfs_lfs_mount_fn);
   jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_UNMOUNT,
                                 vfs_lfs_unmount_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_OPEN,
-                                vfs_lfs_open_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_WRITE,
-                                vfs_lfs_write_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_READ,
-                                vfs_lfs_read_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_CLOSE,
-                                vfs_lfs_close_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_STAT,
-                                vfs_lfs_stat_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_RENAME,
-                                vfs_lfs_rename_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_UNLINK,
-                                vfs_lfs_unlink_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_MKDIR,
-                                vfs_lfs_mkdir_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_READDIR,
-                                vfs_lfs_readdir_fn);
-  jerryxx_set_property_function(vfs_lfs_prototype, MSTR_VFS_LFS_RMDIR,
-                                vfs_lfs_rmdir_fn);
   jerry_release_value(vfs_lfs_prototype);
 
   /* vfslittlefs module exports */
@@ -21,62 +21,190 @@
 
 #include "vfs_lfs.h"
 
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "err.h"
 #include "lfs.h"
-#include "utils.h"
+#include "mem.h"
 
-static vfs_lfs_root_t vfs_lfs_root;
+static int vfs_lfs_open(pwjs_vfs_t *vfs, const char *path, int flags,
+                        void **file) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
 
-void vfs_lfs_init() {
-  vfs_lfs_root.file_id_count = 0;
-  pwjs_list_init(&vfs_lfs_root.vfs_lfs_handles);
-}
+  // convert flags to lfs_flags
+  int lfs_flags = 0;
+  if (flags & PWJS_VFS_FLAG_READ) lfs_flags |= LFS_O_RDONLY;
+  if (flags & PWJS_VFS_FLAG_WRITE) lfs_flags |= LFS_O_WRONLY;
+  if (flags & PWJS_VFS_FLAG_CREATE) lfs_flags |= LFS_O_CREAT;
+  if (flags & PWJS_VFS_FLAG_APPEND) lfs_flags |= LFS_O_APPEND;
+  if (flags & PWJS_VFS_FLAG_EXCL) lfs_flags |= LFS_O_EXCL;
+  if (flags & PWJS_VFS_FLAG_TRUNC) lfs_flags |= LFS_O_TRUNC;
 
-void vfs_lfs_cleanup() {
-  vfs_lfs_handle_t *handle =
-      (vfs_lfs_handle_t *)vfs_lfs_root.vfs_lfs_handles.head;
-  while (handle != NULL) {
-    vfs_lfs_handle_t *next =
-        (vfs_lfs_handle_t *)((pwjs_list_node_t *)handle)->next;
-    free(handle);
-    handle = next;
+  // create file handle, with its cache (littlefs would malloc it)
+  vfs_lfs_file_handle_t *lfs_file =
+      pwjs_malloc(PWJS_MEM_VFS_LFS, sizeof(vfs_lfs_file_handle_t));
+  if (lfs_file == NULL) {
+    return ENOMEM;
+  }
+  memset(&lfs_file->config, 0, sizeof(lfs_file->config));
+  lfs_file->config.buffer =
+      pwjs_malloc(PWJS_MEM_VFS_LFS, handle->config.cache_size);
+  if (lfs_file->config.buffer == NULL) {
+    pwjs_free(lfs_file);
+    return ENOMEM;
+  }
+  int ret = lfs_file_opencfg(&handle->lfs, &lfs_file->lfs_file, path,
+                             lfs_flags, &lfs_file->config);
+  if (ret < 0) {
+    pwjs_free(lfs_file->config.buffer);
+    pwjs_free(lfs_file);
+    return ret;
   }
-  pwjs_list_init(&vfs_lfs_root.vfs_lfs_handles);
+  *file = lfs_file;
+  return 0;
 }
 
-void vfs_lfs_handle_init(vfs_lfs_handle_t *handle) {
-  pwjs_list_init(&handle->file_handles);
+static int vfs_lfs_close(pwjs_vfs_t *vfs, void *file) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  vfs_lfs_file_handle_t *lfs_file = (vfs_lfs_file_handle_t *)file;
+  int ret = lfs_file_close(&handle->lfs, &lfs_file->lfs_file);
+  pwjs_free(lfs_file->config.buffer);
+  pwjs_free(lfs_file);
+  return ret;
 }
 
-void vfs_lfs_handle_add(vfs_lfs_handle_t *handle) {
-  pwjs_list_append(&vfs_lfs_root.vfs_lfs_handles, (pwjs_list_node_t *)handle);
+static int vfs_lfs_read(pwjs_vfs_t *vfs, void *file, uint8_t *buffer,
+                        size_t size) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  vfs_lfs_file_handle_t *lfs_file = (vfs_lfs_file_handle_t *)file;
+  return lfs_file_read(&handle->lfs, &lfs_file->lfs_file, buffer, size);
 }
 
-void vfs_lfs_handle_remove(vfs_lfs_handle_t *handle) {
-  pwjs_list_remove(&vfs_lfs_root.vfs_lfs_handles, (pwjs_list_node_t *)handle);
+static int vfs_lfs_write(pwjs_vfs_t *vfs, void *file, const uint8_t *buffer,
+                         size_t size) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  vfs_lfs_file_handle_t *lfs_file = (vfs_lfs_file_handle_t *)file;
+  return lfs_file_write(&handle->lfs, &lfs_file->lfs_file, buffer, size);
 }
 
-void vfs_lfs_file_add(vfs_lfs_handle_t *handle, vfs_lfs_file_handle_t *file) {
-  vfs_lfs_root.file_id_count++;
-  file->id = vfs_lfs_root.file_id_count;
-  pwjs_list_append(&handle->file_handles, (pwjs_list_node_t *)file);
+static int vfs_lfs_seek(pwjs_vfs_t *vfs, void *file, uint32_t position) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  vfs_lfs_file_handle_t *lfs_file = (vfs_lfs_file_handle_t *)file;
+  int ret =
+      lfs_file_seek(&handle->lfs, &lfs_file->lfs_file, position, LFS_SEEK_SET);
+  return ret < 0 ? ret : 0;
 }
 
-void vfs_lfs_file_remove(vfs_lfs_handle_t *handle,
-                         vfs_lfs_file_handle_t *file) {
-  pwjs_list_remove(&handle->file_handles, (pwjs_list_node_t *)file);
+static int vfs_lfs_stat(pwjs_vfs_t *vfs, const char *path,
+                        pwjs_vfs_stat_t *stat) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  struct lfs_info info;
+  int ret = lfs_stat(&handle->lfs, path, &info);
+  if (ret < 0) {
+    return ret;
+  }
+  if (info.type == LFS_TYPE_REG) {
+    stat->type = PWJS_VFS_TYPE_FILE;
+    stat->size = info.size;
+  } else {
+    stat->type = PWJS_VFS_TYPE_DIR;
+    stat->size = 0;
+  }
+  stat->mtime = 0;  // littlefs keeps no timestamps
+  return 0;
 }
 
-vfs_lfs_file_handle_t *vfs_lfs_file_get_by_id(vfs_lfs_handle_t *handle,
-                                              uint32_t file_id) {
-  vfs_lfs_file_handle_t *file =
-      (vfs_lfs_file_handle_t *)handle->file_handles.head;
-  while (file != NULL) {
-    if (file->id == file_id) {
-      return file;
+static int vfs_lfs_opendir(pwjs_vfs_t *vfs, const char *path, void **dir) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  lfs_dir_t *lfs_dir = pwjs_malloc(PWJS_MEM_VFS_LFS, sizeof(lfs_dir_t));
+  if (lfs_dir == NULL) {
+    return ENOMEM;
+  }
+  int ret = lfs_dir_open(&handle->lfs, lfs_dir, path);
+  if (ret < 0) {
+    pwjs_free(lfs_dir);
+    return ret;
+  }
+  *dir = lfs_dir;
+  return 0;
+}
+
+static int vfs_lfs_readdir(pwjs_vfs_t *vfs, void *dir,
+                           pwjs_vfs_dirent_t *entry) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  struct lfs_info info;
+  while (true) {
+    int ret = lfs_dir_read(&handle->lfs, (lfs_dir_t *)dir, &info);
+    if (ret <= 0) {
+      return ret;
     }
-    file = (vfs_lfs_file_handle_t *)((pwjs_list_node_t *)file)->next;
+    // skip '.', '..'
+    if (strcmp(info.name, ".") != 0 && strcmp(info.name, "..") != 0) {
+      break;
+    }
+  }
+  strncpy(entry->name, info.name, PWJS_VFS_NAME_MAX);
+  entry->name[PWJS_VFS_NAME_MAX] = '\0';
+  if (info.type == LFS_TYPE_REG) {
+    entry->type = PWJS_VFS_TYPE_FILE;
+    entry->size = info.size;
+  } else {
+    entry->type = PWJS_VFS_TYPE_DIR;
+    entry->size = 0;
   }
-  return NULL;
+  entry->mtime = 0;
+  return 1;
 }
+
+static int vfs_lfs_closedir(pwjs_vfs_t *vfs, void *dir) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  int ret = lfs_dir_close(&handle->lfs, (lfs_dir_t *)dir);
+  pwjs_free(dir);
+  return ret;
+}
+
+static int vfs_lfs_mkdir(pwjs_vfs_t *vfs, const char *path) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  return lfs_mkdir(&handle->lfs, path);
+}
+
+static int vfs_lfs_remove(pwjs_vfs_t *vfs, const char *path) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  return lfs_remove(&handle->lfs, path);
+}
+
+static int vfs_lfs_rename(pwjs_vfs_t *vfs, const char *old_path,
+                          const char *new_path) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  return lfs_rename(&handle->lfs, old_path, new_path);
+}
+
+static void vfs_lfs_free(pwjs_vfs_t *vfs) {
+  vfs_lfs_handle_t *handle = (vfs_lfs_handle_t *)vfs;
+  pwjs_free(handle->config.lookahead_buffer);
+  pwjs_free(handle->config.prog_buffer);
+  pwjs_free(handle->config.read_buffer);
+  pwjs_free(handle->read_ahead);
+  pwjs_blkcache_release(&handle->cache);
+  jerry_release_value(handle->blkdev_js);
+  pwjs_free(handle);
+}
+
+const pwjs_vfs_ops_t vfs_lfs_ops = {
+    .open = vfs_lfs_open,
+    .close = vfs_lfs_close,
+    .read = vfs_lfs_read,
+    .write = vfs_lfs_write,
+    .seek = vfs_lfs_seek,
+    .stat = vfs_lfs_stat,
+    .opendir = vfs_lfs_opendir,
+    .readdir = vfs_lfs_readdir,
+    .closedir = vfs_lfs_closedir,
+    .mkdir = vfs_lfs_mkdir,
+    .unlink = vfs_lfs_remove,
+    .rename = vfs_lfs_rename,
+    .rmdir = vfs_lfs_remove,
+    .free = vfs_lfs_free,
+};
@@ -22,56 +22,37 @@
 #ifndef __VFSLFS_H
 #define __VFSLFS_H
 
+#include "blkcache.h"
+#include "blkdev.h"
 #include "jerryscript.h"
 #include "lfs.h"
-#include "utils.h"
+#include "vfs.h"
 
-#define VFS_LFS_GET_FILE_HANDLE(vfs_handle, file, id)                    \
-  vfs_lfs_file_handle_t *file = vfs_lfs_file_get_by_id(vfs_handle, id);  \
-  if (file == NULL) {                                                    \
-    return jerry_create_error_from_value(create_system_error(-9), true); \
-  }
-
-typedef struct vfs_lfs_root_s vfs_lfs_root_t;
 typedef struct vfs_lfs_handle_s vfs_lfs_handle_t;
 typedef struct vfs_lfs_file_handle_s vfs_lfs_file_handle_t;
 
-// File open flags
-enum vfs_lfs_open_flags {
-  VFS_FLAG_READ = 1,
-  VFS_FLAG_WRITE = 2,
-  VFS_FLAG_CREATE = 4,
-  VFS_FLAG_APPEND = 8,
-  VFS_FLAG_EXCL = 16,
-  VFS_FLAG_TRUNC = 32,
-};
-
-struct vfs_lfs_root_s {
-  uint32_t file_id_count;
-  pwjs_list_t vfs_lfs_handles;
-};
-
 struct vfs_lfs_handle_s {
-  pwjs_list_node_t base;
+  pwjs_vfs_t vfs;
   lfs_t lfs;
   struct lfs_config config;
-  pwjs_list_t file_handles;
   jerry_value_t blkdev_js;
+  pwjs_blkdev_t *blkdev;  // native block device, NULL if implemented in JS
+  uint8_t *read_ahead;    // read-ahead buffer, NULL if disabled
+  uint32_t read_ahead_size;
+  uint64_t read_ahead_start;  // device address of the buffered bytes
+  uint32_t read_ahead_length;
+  uint64_t read_end;  // device address after the last read
+  pwjs_blkcache_dev_t cache;
 };
 
 struct vfs_lfs_file_handle_s {
-  pwjs_list_node_t base;
-  uint32_t id;
   lfs_file_t lfs_file;
+  struct lfs_file_config config;
 };
 
-void vfs_lfs_init();
-void vfs_lfs_cleanup();
-void vfs_lfs_handle_init(vfs_lfs_handle_t *);
-void vfs_lfs_handle_add(vfs_lfs_handle_t *);
-void vfs_lfs_handle_remove(vfs_lfs_handle_t *);
-void vfs_lfs_file_add(vfs_lfs_handle_t *, vfs_lfs_file_handle_t *);
-void vfs_lfs_file_remove(vfs_lfs_handle_t *, vfs_lfs_file_handle_t *);
-vfs_lfs_file_handle_t *vfs_lfs_file_get_by_id(vfs_lfs_handle_t *, uint32_t);
+/**
+ * File system operations of littlefs
+ */
+extern const pwjs_vfs_ops_t vfs_lfs_ops;
 
 #endif /* __VFSLFS_H */
\ No newline at end of file
@@ -26,27 +26,10 @@
 #define MSTR_VFS_LFS_MKFS "mkfs"
 #define MSTR_VFS_LFS_MOUNT "mount"
 #define MSTR_VFS_LFS_UNMOUNT "unmount"
-#define MSTR_VFS_LFS_OPEN "open"
-#define MSTR_VFS_LFS_WRITE "write"
-#define MSTR_VFS_LFS_READ "read"
-#define MSTR_VFS_LFS_CLOSE "close"
-#define MSTR_VFS_LFS_STAT "stat"
-#define MSTR_VFS_LFS_RENAME "rename"
-#define MSTR_VFS_LFS_UNLINK "unlink"
-#define MSTR_VFS_LFS_MKDIR "mkdir"
-#define MSTR_VFS_LFS_READDIR "readdir"
-#define MSTR_VFS_LFS_RMDIR "rmdir"
-#define MSTR_VFS_LFS_PATH "path"
-#define MSTR_VFS_LFS_OLD_PATH "oldPath"
-#define MSTR_VFS_LFS_NEW_PATH "newPath"
-#define MSTR_VFS_LFS_FLAGS "flags"
-#define MSTR_VFS_LFS_MODE "mode"
-#define MSTR_VFS_LFS_ID "id"
-#define MSTR_VFS_LFS_BUFFER "buffer"
-#define MSTR_VFS_LFS_OFFSET "offset"
-#define MSTR_VFS_LFS_LENGTH "length"
-#define MSTR_VFS_LFS_POSITION "position"
-#define MSTR_VFS_LFS_TYPE "type"
-#define MSTR_VFS_LFS_SIZE "size"
+#define MSTR_VFS_LFS_CACHE_SIZE "cacheSize"
+#define MSTR_VFS_LFS_LOOKAHEAD_SIZE "lookaheadSize"
+#define MSTR_VFS_LFS_BLOCK_CYCLES "blockCycles"
+#define MSTR_VFS_LFS_READ_AHEAD "readAhead"
+#define MSTR_VFS_LFS_BLOCK_CACHE "blockCache"
 
 #endif /* __VFS_LFS_MAGIC_STRINGS_H */
@@ -6,6 +6,8 @@
 
 #include "board.h"
 #include "flash.h"
+#include "flash_cache.h"
+#include "mem.h"
 
 static uint8_t *page_buffer = NULL;
 static uint32_t page_written = 0;
@@ -19,8 +21,9 @@ static int page_buffer_flush() {
   int offset = (((total_written - 1) % PICOWJS_FLASH_SECTOR_SIZE) /
                 PICOWJS_FLASH_PAGE_SIZE) *
                PICOWJS_FLASH_PAGE_SIZE;
-  int ret = pwjs_flash_program(PICOWJS_PROG_SECTOR_BASE + sector, offset,
-                             page_buffer, PICOWJS_FLASH_PAGE_SIZE);
+  int ret = pwjs_flash_cache_program(PICOWJS_PROG_SECTOR_BASE + sector,
+                                     offset, page_buffer,
+                                     PICOWJS_FLASH_PAGE_SIZE);
   if (ret < 0) return ret;
   memset(page_buffer, 0, PICOWJS_FLASH_PAGE_SIZE);
   page_written = 0;
@@ -46,12 +49,12 @@ static int page_buffer_push(uint8_t byte) {
 }
 
 void pwjs_prog_clear() {
-  pwjs_flash_erase(PICOWJS_PROG_SECTOR_BASE, PICOWJS_PROG_SECTOR_COUNT);
+  pwjs_flash_cache_erase(PICOWJS_PROG_SECTOR_BASE, PICOWJS_PROG_SECTOR_COUNT);
 }
 
 void pwjs_prog_begin() {
   pwjs_prog_clear();
-  page_buffer = malloc(PICOWJS_FLASH_PAGE_SIZE);
+  page_buffer = pwjs_malloc(PWJS_MEM_PROG, PICOWJS_FLASH_PAGE_SIZE);
   memset(page_buffer, 0, PICOWJS_FLASH_PAGE_SIZE);
   page_written = 0;
   total_written = 0;
@@ -76,9 +79,10 @@ int pwjs_prog_end() {
     int ret = page_buffer_flush();
     if (ret < 0) return -1;
   }
+  if (pwjs_flash_cache_sync() < 0) return -1;
 
   if (page_buffer != NULL) {
-    free(page_buffer);
+    pwjs_free(page_buffer);
   }
   total_written = 0;
   return 0;
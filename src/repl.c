@@ -26,6 +26,7 @@
 
 #include "io.h"
 #include "jerryscript.h"
+#include "mem.h"
 #include "picowjs_config.h"
 #include "prog.h"
 #include "runtime.h"
@@ -83,7 +84,7 @@ static void history_push(char *cmd) {
     state.history_size++;
   } else {
     // free memory of history[0]
-    free(state.history[0]);
+    pwjs_free(state.history[0]);
     // Shift history array to left (e.g. 1 to 0, 2 to 1, ...)
     for (int i = 0; i < (state.history_size - 1); i++) {
       state.history[i] = state.history[i + 1];
@@ -105,7 +106,7 @@ static void reset_commands() {
   pwjs_repl_register_command(".reset", "Soft reset", cmd_reset);
   pwjs_repl_register_command(".flash", "Commands for flash", cmd_flash);
   pwjs_repl_register_command(".load", "Load code from flash", cmd_load);
-  pwjs_repl_register_command(".mem", "Heap memory status", cmd_mem);
+  pwjs_repl_register_command(".mem", "Heap memory status (-v)", cmd_mem);
   pwjs_repl_register_command(".gc", "Perform garbage collection", cmd_gc);
 }
 
@@ -115,7 +116,7 @@ static void reset_commands() {
 static void run_command() {
   if (state.buffer_length > 0) {
     /* copy buffer to data */
-    char *data = malloc(state.buffer_length + 1);
+    char *data = pwjs_malloc(PWJS_MEM_REPL, state.buffer_length + 1);
     state.buffer[state.buffer_length] = '\0';
     strcpy(data, state.buffer);
     state.buffer_length = 0;
@@ -125,12 +126,16 @@ static void run_command() {
     history_push(data);
 
     /* tokenize command */
-    char *tokenv[5];
+    char **tokenv = state.argv;
     unsigned int tokenc = 0;
-    tokenv[0] = strtok(state.buffer, " ");
-    while (tokenv[tokenc] != NULL && tokenc < 5) {
-      tokenc++;
-      tokenv[tokenc] = strtok(NULL, " ");
+    char *token = strtok(state.buffer, " ");
+    while (token != NULL && tokenc < PWJS_REPL_ARGS_MAX) {
+      tokenv[tokenc++] = token;
+      token = strtok(NULL, " ");
+    }
+    state.argc = tokenc;
+    for (unsigned int i = tokenc; i < PWJS_REPL_ARGS_MAX; i++) {
+      tokenv[i] = NULL;
     }
 
     /* run command */
@@ -160,7 +165,7 @@ static void run_command() {
 static void run_code() {
   if (state.buffer_length > 0) {
     /* copy buffer to data */
-    char *data = malloc(state.buffer_length + 1);
+    char *data = pwjs_malloc(PWJS_MEM_REPL, state.buffer_length + 1);
     state.buffer[state.buffer_length] = '\0';
     strcpy(data, state.buffer);
     state.buffer_length = 0;
@@ -500,13 +505,9 @@ static void cmd_flash(pwjs_repl_state_t *state, char *arg) {
     pwjs_repl_println();
     /* write a file to flash via Ymodem */
   } else if (strcmp(arg, "-w") == 0) {
-    state->ymodem_state = 1;  // transfering
     pwjs_tty_printf("Transfer a file via YMODEM... (press 'a' to abort)\r\n");
-    pwjs_io_tty_read_stop(&tty);
     pwjs_ymodem_status_t result =
-        pwjs_ymodem_receive(header_cb, packet_cb, footer_cb);
-    pwjs_io_tty_read_start(&tty, tty_read_cb);
-    pwjs_delay(500);
+        pwjs_repl_ymodem_receive(header_cb, packet_cb, footer_cb, NULL);
     switch (result) {
       case PWJS_YMODEM_OK:
         pwjs_tty_printf("\r\nDone\r\n");
@@ -524,7 +525,6 @@ static void cmd_flash(pwjs_repl_state_t *state, char *arg) {
         pwjs_tty_printf("\r\nFailed to receive\r\n");
         break;
     }
-    state->ymodem_state = 0;  // stopped
     /* no option is given */
   } else {
     pwjs_repl_printf(".flash command options:\r\n");
@@ -556,6 +556,23 @@ static void cmd_mem(pwjs_repl_state_t *state, char *arg) {
   } else {
     pwjs_repl_printf("Mem stat feature is not enabled\r\n");
   }
+  if (arg != NULL && strcmp(arg, "-v") == 0) {
+    pwjs_mem_stats_t mem_stats;
+    pwjs_mem_get_total(&mem_stats);
+    pwjs_repl_printf("native: %u, peak: %u, count: %u\r\n",
+                   (unsigned)mem_stats.current, (unsigned)mem_stats.peak,
+                   (unsigned)mem_stats.count);
+    pwjs_repl_printf("%-10s %8s %8s %6s %8s\r\n", "module", "current", "peak",
+                   "count", "allocs");
+    for (int i = 0; i < PWJS_MEM_ID_COUNT; i++) {
+      pwjs_mem_get_stats(i, &mem_stats);
+      if (mem_stats.allocs > 0) {
+        pwjs_repl_printf("%-10s %8u %8u %6u %8u\r\n", pwjs_mem_name(i),
+                       (unsigned)mem_stats.current, (unsigned)mem_stats.peak,
+                       (unsigned)mem_stats.count, (unsigned)mem_stats.allocs);
+      }
+    }
+  }
 }
 
 /**
@@ -939,20 +956,35 @@ void pwjs_repl_print_prompt() {
 }
 
 void pwjs_repl_register_command(char *name, char *desc, pwjs_repl_command_cb cb) {
-  pwjs_repl_command_t *cmd = malloc(sizeof(pwjs_repl_command_t));
+  pwjs_repl_command_t *cmd =
+      pwjs_malloc(PWJS_MEM_REPL, sizeof(pwjs_repl_command_t));
   strcpy(cmd->name, name);
   strcpy(cmd->desc, desc);
   cmd->cb = cb;
   pwjs_list_append(&state.commands, (pwjs_list_node_t *)cmd);
 }
 
+pwjs_ymodem_status_t pwjs_repl_ymodem_receive(pwjs_ymodem_header_cb header_cb,
+                                              pwjs_ymodem_packet_cb packet_cb,
+                                              pwjs_ymodem_footer_cb footer_cb,
+                                              pwjs_ymodem_flush_cb flush_cb) {
+  state.ymodem_state = 1;  // transfering
+  pwjs_io_tty_read_stop(&tty);
+  pwjs_ymodem_status_t result =
+      pwjs_ymodem_receive(header_cb, packet_cb, footer_cb, flush_cb);
+  pwjs_io_tty_read_start(&tty, tty_read_cb);
+  pwjs_delay(500);
+  state.ymodem_state = 0;  // stopped
+  return result;
+}
+
 void pwjs_repl_unregister_command(char *name) {
   pwjs_repl_command_t *cmd = (pwjs_repl_command_t *)state.commands.head;
   while (strcmp(cmd->name, name) == 0) {
     pwjs_repl_command_t *next =
         (pwjs_repl_command_t *)((pwjs_list_node_t *)cmd)->next;
     pwjs_list_remove(&state.commands, (pwjs_list_node_t *)cmd);
-    free(cmd);
+    pwjs_free(cmd);
     cmd = next;
   }
 }
@@ -962,7 +994,7 @@ void pwjs_repl_clear_commands() {
   while (cmd != NULL) {
     pwjs_repl_command_t *next =
         (pwjs_repl_command_t *)((pwjs_list_node_t *)cmd)->next;
-    free(cmd);
+    pwjs_free(cmd);
     cmd = next;
   }
   pwjs_list_init(&state.commands);
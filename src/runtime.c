@@ -24,6 +24,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "blkcache.h"
+#include "flash_cache.h"
 #include "global.h"
 #include "gpio.h"
 #include "io.h"
@@ -36,6 +38,7 @@
 #include "repl.h"
 #include "system.h"
 #include "tty.h"
+#include "vfs.h"
 
 // --------------------------------------------------------------------------
 // PRIVATE VARIABLES
@@ -87,6 +90,7 @@ void pwjs_runtime_init(bool load, bool first) {
                                   16);
   jerry_register_magic_strings(magic_string_items, num_magic_string_items,
                                magic_string_lengths);
+  jerryxx_keys_init();
   pwjs_global_init();
   jerry_gc(JERRY_GC_PRESSURE_HIGH);
   if (load) {
@@ -100,9 +104,13 @@ void pwjs_runtime_init(bool load, bool first) {
 }
 
 void pwjs_runtime_cleanup() {
+  pwjs_vfs_cleanup();
+  pwjs_blkcache_cleanup();
+  jerryxx_keys_cleanup();
   jerry_cleanup();
   pwjs_system_cleanup();
   pwjs_io_cleanup();
+  pwjs_flash_cache_cleanup();
 }
 
 void pwjs_runtime_load() {
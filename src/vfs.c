@@ -0,0 +1,418 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "vfs.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+#include "mem.h"
+
+typedef struct {
+  char *path;  // NULL if the entry is free
+  size_t length;
+  pwjs_vfs_t *vfs;
+  jerry_value_t obj;
+} vfs_mount_t;
+
+typedef struct {
+  vfs_mount_t *mount;  // NULL if the descriptor is free
+  void *handle;
+  bool dir;
+} vfs_fd_t;
+
+static vfs_mount_t vfs_mounts[PWJS_VFS_MOUNT_MAX];
+static vfs_fd_t vfs_fds[PWJS_VFS_FD_MAX];
+static char vfs_cwd[PWJS_VFS_PATH_MAX] = "/";
+
+static void vfs_freecb(void *handle) {
+  pwjs_vfs_t *vfs = (pwjs_vfs_t *)handle;
+  if (vfs->ops->free != NULL) {
+    vfs->ops->free(vfs);
+  }
+}
+
+static const jerry_object_native_info_t vfs_info = {.free_cb = vfs_freecb};
+
+void pwjs_vfs_bind(jerry_value_t obj, pwjs_vfs_t *vfs) {
+  jerry_set_object_native_pointer(obj, vfs, &vfs_info);
+}
+
+pwjs_vfs_t *pwjs_vfs_get(jerry_value_t obj) {
+  void *native_pointer;
+  if (jerry_get_object_native_pointer(obj, &native_pointer, &vfs_info)) {
+    return (pwjs_vfs_t *)native_pointer;
+  }
+  return NULL;
+}
+
+void pwjs_vfs_cleanup() {
+  for (int i = 0; i < PWJS_VFS_FD_MAX; i++) {
+    vfs_fd_t *entry = &vfs_fds[i];
+    if (entry->mount != NULL) {
+      pwjs_vfs_t *vfs = entry->mount->vfs;
+      if (entry->dir) {
+        vfs->ops->closedir(vfs, entry->handle);
+      } else {
+        vfs->ops->close(vfs, entry->handle);
+      }
+      entry->mount = NULL;
+    }
+  }
+  for (int i = 0; i < PWJS_VFS_MOUNT_MAX; i++) {
+    vfs_mount_t *mount = &vfs_mounts[i];
+    if (mount->path != NULL) {
+      jerry_release_value(mount->obj);
+      pwjs_free(mount->path);
+      mount->path = NULL;
+    }
+  }
+  strcpy(vfs_cwd, "/");
+}
+
+int pwjs_vfs_resolve(const char *path, char *resolved) {
+  size_t length = 0;  // the root is kept as an empty string
+  if (path[0] != '/') {
+    length = strlen(vfs_cwd);
+    memcpy(resolved, vfs_cwd, length);
+    if (length == 1) {
+      length = 0;
+    }
+  }
+  const char *p = path;
+  while (*p != '\0') {
+    while (*p == '/') {
+      p++;
+    }
+    const char *name = p;
+    while (*p != '\0' && *p != '/') {
+      p++;
+    }
+    size_t name_length = p - name;
+    if (name_length == 0 || (name_length == 1 && name[0] == '.')) {
+      continue;
+    }
+    if (name_length == 2 && name[0] == '.' && name[1] == '.') {
+      while (length > 0 && resolved[length - 1] != '/') {
+        length--;
+      }
+      if (length > 0) {
+        length--;
+      }
+      continue;
+    }
+    if (length + 1 + name_length >= PWJS_VFS_PATH_MAX) {
+      return ENAMETOOLONG;
+    }
+    resolved[length++] = '/';
+    memcpy(resolved + length, name, name_length);
+    length += name_length;
+  }
+  if (length == 0) {
+    resolved[length++] = '/';
+  }
+  resolved[length] = '\0';
+  return 0;
+}
+
+/**
+ * Find the mount with the longest path containing the resolved path, and
+ * the path relative to it
+ */
+static vfs_mount_t *vfs_lookup(const char *resolved, const char **relative) {
+  vfs_mount_t *found = NULL;
+  for (int i = 0; i < PWJS_VFS_MOUNT_MAX; i++) {
+    vfs_mount_t *mount = &vfs_mounts[i];
+    if (mount->path == NULL ||
+        (found != NULL && mount->length <= found->length)) {
+      continue;
+    }
+    if (mount->length == 1) {  // "/"
+      found = mount;
+    } else if (strncmp(resolved, mount->path, mount->length) == 0 &&
+               (resolved[mount->length] == '/' ||
+                resolved[mount->length] == '\0')) {
+      found = mount;
+    }
+  }
+  if (found != NULL) {
+    *relative = (found->length == 1) ? resolved : resolved + found->length;
+    if (**relative == '\0') {
+      *relative = "/";
+    }
+  }
+  return found;
+}
+
+/**
+ * Resolve a path and find its mount. Declares `mount` and `relative`.
+ */
+#define VFS_LOOKUP(path, mount, relative)                       \
+  char mount##_resolved[PWJS_VFS_PATH_MAX];                     \
+  int mount##_ret = pwjs_vfs_resolve(path, mount##_resolved);   \
+  if (mount##_ret < 0) {                                        \
+    return mount##_ret;                                         \
+  }                                                             \
+  const char *relative = NULL;                                  \
+  vfs_mount_t *mount = vfs_lookup(mount##_resolved, &relative); \
+  if (mount == NULL) {                                          \
+    return ENOENT;                                              \
+  }
+
+static vfs_fd_t *vfs_get_fd(int fd, bool dir) {
+  int index = fd - PWJS_VFS_FD_BASE;
+  if (index < 0 || index >= PWJS_VFS_FD_MAX) {
+    return NULL;
+  }
+  vfs_fd_t *entry = &vfs_fds[index];
+  if (entry->mount == NULL || entry->dir != dir) {
+    return NULL;
+  }
+  return entry;
+}
+
+static int vfs_alloc_fd(vfs_mount_t *mount, void *handle, bool dir) {
+  for (int i = 0; i < PWJS_VFS_FD_MAX; i++) {
+    vfs_fd_t *entry = &vfs_fds[i];
+    if (entry->mount == NULL) {
+      entry->mount = mount;
+      entry->handle = handle;
+      entry->dir = dir;
+      return i + PWJS_VFS_FD_BASE;
+    }
+  }
+  return EMFILE;
+}
+
+const char *pwjs_vfs_getcwd() { return vfs_cwd; }
+
+int pwjs_vfs_chdir(const char *path) {
+  char resolved[PWJS_VFS_PATH_MAX];
+  int ret = pwjs_vfs_resolve(path, resolved);
+  if (ret < 0) {
+    return ret;
+  }
+  pwjs_vfs_stat_t stat;
+  ret = pwjs_vfs_stat(resolved, &stat);
+  if (ret < 0) {
+    return ret;
+  }
+  if (stat.type != PWJS_VFS_TYPE_DIR) {
+    return ENOTDIR;
+  }
+  strcpy(vfs_cwd, resolved);
+  return 0;
+}
+
+int pwjs_vfs_mount(const char *path, jerry_value_t obj) {
+  pwjs_vfs_t *vfs = pwjs_vfs_get(obj);
+  if (vfs == NULL) {
+    return EINVAL;
+  }
+  char resolved[PWJS_VFS_PATH_MAX];
+  int ret = pwjs_vfs_resolve(path, resolved);
+  if (ret < 0) {
+    return ret;
+  }
+  vfs_mount_t *free_mount = NULL;
+  for (int i = 0; i < PWJS_VFS_MOUNT_MAX; i++) {
+    vfs_mount_t *mount = &vfs_mounts[i];
+    if (mount->path == NULL) {
+      if (free_mount == NULL) {
+        free_mount = mount;
+      }
+    } else if (strcmp(mount->path, resolved) == 0 || mount->vfs == vfs) {
+      return EBUSY;
+    }
+  }
+  if (free_mount == NULL) {
+    return ENOMEM;
+  }
+  size_t length = strlen(resolved);
+  free_mount->path = pwjs_malloc(PWJS_MEM_VFS, length + 1);
+  if (free_mount->path == NULL) {
+    return ENOMEM;
+  }
+  memcpy(free_mount->path, resolved, length + 1);
+  free_mount->length = length;
+  free_mount->vfs = vfs;
+  free_mount->obj = jerry_acquire_value(obj);
+  return 0;
+}
+
+int pwjs_vfs_unmount(const char *path, jerry_value_t *obj) {
+  char resolved[PWJS_VFS_PATH_MAX];
+  int ret = pwjs_vfs_resolve(path, resolved);
+  if (ret < 0) {
+    return ret;
+  }
+  for (int i = 0; i < PWJS_VFS_MOUNT_MAX; i++) {
+    vfs_mount_t *mount = &vfs_mounts[i];
+    if (mount->path == NULL || strcmp(mount->path, resolved) != 0) {
+      continue;
+    }
+    for (int j = 0; j < PWJS_VFS_FD_MAX; j++) {
+      if (vfs_fds[j].mount == mount) {
+        return EBUSY;
+      }
+    }
+    *obj = mount->obj;
+    pwjs_free(mount->path);
+    mount->path = NULL;
+    return 0;
+  }
+  return EINVAL;
+}
+
+int pwjs_vfs_open(const char *path, int flags) {
+  VFS_LOOKUP(path, mount, relative)
+  pwjs_vfs_t *vfs = mount->vfs;
+  void *file;
+  int ret = vfs->ops->open(vfs, relative, flags, &file);
+  if (ret < 0) {
+    return ret;
+  }
+  int fd = vfs_alloc_fd(mount, file, false);
+  if (fd < 0) {
+    vfs->ops->close(vfs, file);
+  }
+  return fd;
+}
+
+int pwjs_vfs_close(int fd) {
+  vfs_fd_t *entry = vfs_get_fd(fd, false);
+  if (entry == NULL) {
+    return EBADF;
+  }
+  pwjs_vfs_t *vfs = entry->mount->vfs;
+  entry->mount = NULL;
+  return vfs->ops->close(vfs, entry->handle);
+}
+
+int pwjs_vfs_read(int fd, uint8_t *buffer, size_t size, int64_t position) {
+  vfs_fd_t *entry = vfs_get_fd(fd, false);
+  if (entry == NULL) {
+    return EBADF;
+  }
+  pwjs_vfs_t *vfs = entry->mount->vfs;
+  if (position >= 0) {
+    int ret = vfs->ops->seek(vfs, entry->handle, (uint32_t)position);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return vfs->ops->read(vfs, entry->handle, buffer, size);
+}
+
+int pwjs_vfs_write(int fd, const uint8_t *buffer, size_t size,
+                   int64_t position) {
+  vfs_fd_t *entry = vfs_get_fd(fd, false);
+  if (entry == NULL) {
+    return EBADF;
+  }
+  pwjs_vfs_t *vfs = entry->mount->vfs;
+  if (position >= 0) {
+    int ret = vfs->ops->seek(vfs, entry->handle, (uint32_t)position);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+  return vfs->ops->write(vfs, entry->handle, buffer, size);
+}
+
+int pwjs_vfs_opendir(const char *path) {
+  VFS_LOOKUP(path, mount, relative)
+  pwjs_vfs_t *vfs = mount->vfs;
+  void *dir;
+  int ret = vfs->ops->opendir(vfs, relative, &dir);
+  if (ret < 0) {
+    return ret;
+  }
+  int fd = vfs_alloc_fd(mount, dir, true);
+  if (fd < 0) {
+    vfs->ops->closedir(vfs, dir);
+  }
+  return fd;
+}
+
+int pwjs_vfs_readdir(int fd, pwjs_vfs_dirent_t *entry) {
+  vfs_fd_t *dir = vfs_get_fd(fd, true);
+  if (dir == NULL) {
+    return EBADF;
+  }
+  pwjs_vfs_t *vfs = dir->mount->vfs;
+  return vfs->ops->readdir(vfs, dir->handle, entry);
+}
+
+int pwjs_vfs_closedir(int fd) {
+  vfs_fd_t *dir = vfs_get_fd(fd, true);
+  if (dir == NULL) {
+    return EBADF;
+  }
+  pwjs_vfs_t *vfs = dir->mount->vfs;
+  dir->mount = NULL;
+  return vfs->ops->closedir(vfs, dir->handle);
+}
+
+int pwjs_vfs_stat(const char *path, pwjs_vfs_stat_t *stat) {
+  VFS_LOOKUP(path, mount, relative)
+  return mount->vfs->ops->stat(mount->vfs, relative, stat);
+}
+
+int pwjs_vfs_mkdir(const char *path) {
+  VFS_LOOKUP(path, mount, relative)
+  return mount->vfs->ops->mkdir(mount->vfs, relative);
+}
+
+int pwjs_vfs_unlink(const char *path) {
+  VFS_LOOKUP(path, mount, relative)
+  return mount->vfs->ops->unlink(mount->vfs, relative);
+}
+
+int pwjs_vfs_rename(const char *old_path, const char *new_path) {
+  VFS_LOOKUP(old_path, mount, relative)
+  VFS_LOOKUP(new_path, new_mount, new_relative)
+  if (new_mount != mount) {
+    return EXDEV;
+  }
+  return mount->vfs->ops->rename(mount->vfs, relative, new_relative);
+}
+
+int pwjs_vfs_rmdir(const char *path) {
+  VFS_LOOKUP(path, mount, relative)
+  return mount->vfs->ops->rmdir(mount->vfs, relative);
+}
+
+int pwjs_vfs_mmap(const char *path, const uint8_t **addr, uint32_t *size,
+                  jerry_value_t *obj) {
+  VFS_LOOKUP(path, mount, relative)
+  if (mount->vfs->ops->mmap == NULL) {
+    return ENODEV;
+  }
+  int ret = mount->vfs->ops->mmap(mount->vfs, relative, addr, size);
+  if (ret < 0) {
+    return ret;
+  }
+  *obj = mount->obj;
+  return 0;
+}
@@ -46,7 +46,6 @@ uint32_t session_done, session_begin;
 static pwjs_ymodem_status_t receive_packet(uint8_t *data, uint32_t *length,
                                          uint32_t timeout);
 static uint16_t update_crc16(uint16_t crc_in, uint8_t byte);
-static uint16_t calc_crc16(const uint8_t *p_data, uint32_t size);
 
 /**
  * @brief  Update CRC16 for input byte
@@ -72,7 +71,7 @@ static uint16_t update_crc16(uint16_t crc_in, uint8_t byte) {
  * @param  length
  * @return None
  */
-static uint16_t calc_crc16(const uint8_t *data, uint32_t size) {
+uint16_t pwjs_ymodem_crc16(const uint8_t *data, uint32_t size) {
   uint32_t crc = 0;
   const uint8_t *dataEnd = data + size;
   while (data < dataEnd) {
@@ -157,7 +156,7 @@ static pwjs_ymodem_status_t receive_packet(uint8_t *data, uint32_t *length,
           /* Check packet CRC */
           crc = data[packet_size + PACKET_DATA_INDEX] << 8;
           crc += data[packet_size + PACKET_DATA_INDEX + 1];
-          if (calc_crc16(&data[PACKET_DATA_INDEX], packet_size) != crc) {
+          if (pwjs_ymodem_crc16(&data[PACKET_DATA_INDEX], packet_size) != crc) {
             packet_size = 0;
             status = PWJS_YMODEM_ERROR;
           }
@@ -175,11 +174,14 @@ static pwjs_ymodem_status_t receive_packet(uint8_t *data, uint32_t *length,
  * @brief  Receive a file using the ymodem protocol with CRC16.
  * @param header_cb
  * @param packet_cb
+ * @param footer_cb
+ * @param flush_cb NULL if not used
  * @return pwjs_ymodem_status_t
  */
 pwjs_ymodem_status_t pwjs_ymodem_receive(pwjs_ymodem_header_cb header_cb,
                                      pwjs_ymodem_packet_cb packet_cb,
-                                     pwjs_ymodem_footer_cb footer_cb) {
+                                     pwjs_ymodem_footer_cb footer_cb,
+                                     pwjs_ymodem_flush_cb flush_cb) {
   uint32_t i, packet_length, file_done, errors = 0;
   uint8_t file_name_str[FILE_NAME_LENGTH];
   uint8_t file_size_str[FILE_SIZE_LENGTH];
@@ -272,6 +274,11 @@ pwjs_ymodem_status_t pwjs_ymodem_receive(pwjs_ymodem_header_cb header_cb,
                       result = PWJS_YMODEM_DATA;
                     } else {
                       pwjs_tty_putc(ACK);
+                      if (flush_cb && flush_cb() < 0) {
+                        pwjs_tty_putc(CA);
+                        pwjs_tty_putc(CA);
+                        result = PWJS_YMODEM_DATA;
+                      }
                     }
                   }
                 }
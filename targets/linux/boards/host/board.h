@@ -0,0 +1,86 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __LINUX_HOST_H
+#define __LINUX_HOST_H
+
+#include "jerryscript.h"
+
+// system
+#define PICOWJS_SYSTEM_ARCH "host"
+#define PICOWJS_SYSTEM_PLATFORM "linux"
+
+// repl
+#define PICOWJS_REPL_BUFFER_SIZE 1024
+#define PICOWJS_REPL_HISTORY_SIZE 10
+
+// Flash allocation map (same layout as the pico-w board, backed by a file)
+//
+// | B |     C     |     D     |
+// |---|-----------|-----------|
+// |16K|   512K    |   512K    |
+//
+// - B : storage (key-value database)
+// - C : user program (js)
+// - D : file system (lfs)
+// (Total : 1040KB)
+
+// flash image file (overridden by the PICOWJS_FLASH environment variable)
+#define PICOWJS_FLASH_FILE "picowjs-flash.bin"
+
+// flash (B + C + D = 1040KB (=16KB + 1024KB))
+#define PICOWJS_FLASH_OFFSET 0
+#define PICOWJS_FLASH_SECTOR_SIZE 4096
+#define PICOWJS_FLASH_SECTOR_COUNT 260
+#define PICOWJS_FLASH_PAGE_SIZE 256
+
+// user program on flash (512KB)
+#define PICOWJS_PROG_SECTOR_BASE 4
+#define PICOWJS_PROG_SECTOR_COUNT 128
+
+// storage on flash (16KB, can be enlarged for benchmarks)
+#define PICOWJS_STORAGE_SECTOR_BASE 0
+#ifndef PICOWJS_STORAGE_SECTOR_COUNT
+#define PICOWJS_STORAGE_SECTOR_COUNT 4
+#endif
+
+// file system on flash (512K)
+// - sector base : 132
+// - sector count : 128
+// - use block device : new Flash(132, 128)
+
+// -----------------------------------------------------------------
+
+#define PICOWJS_GPIO_COUNT 29
+#define ADC_NUM 5
+#define PWM_NUM 27
+#define I2C_NUM 2
+#define SPI_NUM 2
+#define UART_NUM 2
+#define PIO_NUM 2
+#define PIO_SM_NUM 4
+
+#define ADC_RESOLUTION_BIT 12
+#define I2C_MAX_CLOCK 1000000
+
+void board_init();
+
+#endif /* __LINUX_HOST_H */
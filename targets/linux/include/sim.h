@@ -0,0 +1,119 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_SIM_H
+#define __PWJS_SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Simulated peripherals of the linux target.
+ *
+ * Devices are scripted by a text file given in the PICOWJS_SIM environment
+ * variable. Each line is one of the following ('#' starts a comment):
+ *
+ *   [at <ms>] gpio <pin> <0|1>          drive an input pin
+ *   [at <ms>] adc <pin> <level>         set analog level (0.0 ~ 1.0)
+ *   [at <ms>] uart <port> <hex bytes>   feed bytes into UART RX
+ *   uart <port> loopback                echo UART TX back into RX
+ *   spi <bus> <hex bytes>               queue bytes returned on MISO
+ *   i2c <bus> <address> <hex bytes>     preload registers of an I2C device
+ *   sdcard <bus> [<blocks>]             SD card model on a SPI bus
+ *   trace                               log bus traffic to stderr
+ *
+ * Lines with `at <ms>` are applied <ms> milliseconds after boot, the others
+ * are applied immediately.
+ */
+
+/**
+ * SPI device model. Called for every transfer on the bus.
+ *
+ * @param bus SPI bus number
+ * @param tx bytes sent on MOSI
+ * @param rx bytes to return on MISO (output)
+ * @param len transfer length
+ * @return number of bytes transferred or negative error code
+ */
+typedef int (*pwjs_sim_spi_device_t)(uint8_t bus, const uint8_t *tx,
+                                     uint8_t *rx, size_t len);
+
+/**
+ * Counters of the SD card model
+ */
+typedef struct {
+  uint32_t commands;        // commands received (an ACMD counts as two)
+  uint32_t blocks_read;     // data blocks sent to the host
+  uint32_t blocks_written;  // data blocks written by the host
+  uint32_t pre_erases;      // ACMD23 (SET_WR_BLK_ERASE_COUNT) received
+} pwjs_sim_sdcard_stats_t;
+
+/**
+ * I2C device model. A write-then-read transaction (e.g. memory read) is
+ * passed as tx followed by rx. Either of them can be empty.
+ *
+ * @param bus I2C bus number
+ * @param address 7-bit device address
+ * @param tx bytes written by the master
+ * @param tx_len number of bytes written
+ * @param rx bytes read by the master (output)
+ * @param rx_len number of bytes to read
+ * @return 0 on ACK or negative error code on NACK
+ */
+typedef int (*pwjs_sim_i2c_device_t)(uint8_t bus, uint8_t address,
+                                     const uint8_t *tx, size_t tx_len,
+                                     uint8_t *rx, size_t rx_len);
+
+extern bool pwjs_sim_trace;
+
+void pwjs_sim_init();
+void pwjs_sim_cleanup();
+void pwjs_sim_poll();
+
+// gpio.c
+int pwjs_sim_gpio_drive(uint8_t pin, uint8_t value);
+
+// adc.c
+int pwjs_sim_adc_drive(uint8_t pin, double level);
+
+// uart.c
+int pwjs_sim_uart_feed(uint8_t port, const uint8_t *buf, size_t len);
+int pwjs_sim_uart_loopback(uint8_t port, bool enable);
+
+// spi.c
+void pwjs_sim_spi_attach(uint8_t bus, pwjs_sim_spi_device_t device);
+int pwjs_sim_spi_queue(uint8_t bus, const uint8_t *buf, size_t len);
+
+// sim_sdcard.c
+int pwjs_sim_sdcard_attach(uint8_t bus, uint32_t blocks);
+void pwjs_sim_sdcard_detach();
+void pwjs_sim_sdcard_get_stats(pwjs_sim_sdcard_stats_t *stats);
+
+// i2c.c
+void pwjs_sim_i2c_attach(uint8_t bus, pwjs_sim_i2c_device_t device);
+int pwjs_sim_i2c_preload(uint8_t bus, uint8_t address, const uint8_t *buf,
+                         size_t len);
+
+// wdt.c
+void pwjs_wdt_check(void);
+
+#endif /* __PWJS_SIM_H */
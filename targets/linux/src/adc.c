@@ -0,0 +1,103 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "adc.h"
+
+#include "board.h"
+#include "err.h"
+#include "sim.h"
+
+static double __adc_level[ADC_NUM];
+static int __adc_selected = 0;
+
+/**
+ * Get ADC index
+ *
+ * @param pin Pin number.
+ * @return Returns index on success or EINVPIN on failure.
+ */
+static int __get_adc_index(uint8_t pin) {
+  if ((pin >= 26) && (pin < 26 + ADC_NUM)) {
+    return pin - 26;  // GPIO 26 is channel 0
+  }
+  return EINVPIN;
+}
+
+/**
+ * Initialize all ADC channels when system started
+ */
+void pwjs_adc_init() {
+  for (int i = 0; i < ADC_NUM; i++) {
+    __adc_level[i] = 0;
+  }
+  __adc_selected = 0;
+}
+
+/**
+ * Cleanup all ADC channels when system cleanup
+ */
+void pwjs_adc_cleanup() {}
+
+/**
+ * Read value from the ADC channel selected by the last setup, quantized to
+ * the resolution of the board
+ *
+ * @param {uint8_t} adcIndex
+ * @return {double}
+ */
+double pwjs_adc_read(uint8_t adcIndex) {
+  const int max = (1 << ADC_RESOLUTION_BIT);
+  int raw = (int)(__adc_level[__adc_selected] * max);
+  if (raw >= max) {
+    raw = max - 1;
+  }
+  return (double)raw / max;
+}
+
+int pwjs_adc_setup(uint8_t pin) {
+  int ch = __get_adc_index(pin);
+  if (ch < 0) {
+    return EINVPIN;
+  }
+  __adc_selected = ch;
+  return 0;
+}
+
+int pwjs_adc_close(uint8_t pin) {
+  if (__get_adc_index(pin) < 0) {
+    return EINVPIN;
+  }
+  return 0;
+}
+
+/**
+ * Set the analog level of an ADC pin from the simulation
+ */
+int pwjs_sim_adc_drive(uint8_t pin, double level) {
+  int ch = __get_adc_index(pin);
+  if (ch < 0) {
+    return EINVPIN;
+  }
+  if (level < 0) level = 0;
+  if (level > 1) level = 1;
+  __adc_level[ch] = level;
+  return 0;
+}
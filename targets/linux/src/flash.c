@@ -0,0 +1,132 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "flash.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "board.h"
+
+#define __FLASH_SIZE (PICOWJS_FLASH_SECTOR_SIZE * PICOWJS_FLASH_SECTOR_COUNT)
+
+const uint8_t *pwjs_flash_addr = NULL;
+
+static uint8_t *__flash_map = NULL;
+
+static void __flash_unmap() {
+  if (__flash_map != NULL) {
+    msync(__flash_map, __FLASH_SIZE, MS_SYNC);
+    munmap(__flash_map, __FLASH_SIZE);
+    __flash_map = NULL;
+    pwjs_flash_addr = NULL;
+  }
+}
+
+/**
+ * Map the flash image file. A new (or shorter) file is extended with erased
+ * (0xFF) sectors.
+ */
+void pwjs_flash_init() {
+  if (__flash_map != NULL) {
+    return;
+  }
+  const char *path = getenv("PICOWJS_FLASH");
+  if (path == NULL) {
+    path = PICOWJS_FLASH_FILE;
+  }
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    perror(path);
+    exit(1);
+  }
+  struct stat st;
+  if (fstat(fd, &st) < 0 || ftruncate(fd, __FLASH_SIZE) < 0) {
+    perror(path);
+    exit(1);
+  }
+  __flash_map = (uint8_t *)mmap(NULL, __FLASH_SIZE, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+  close(fd);
+  if (__flash_map == MAP_FAILED) {
+    perror(path);
+    exit(1);
+  }
+  if (st.st_size < __FLASH_SIZE) {
+    memset(__flash_map + st.st_size, 0xFF, __FLASH_SIZE - st.st_size);
+  }
+  pwjs_flash_addr = __flash_map;
+  atexit(__flash_unmap);
+}
+
+/**
+ * Keep the mapping across soft resets (system init is not called again),
+ * only write back the dirty pages.
+ */
+void pwjs_flash_cleanup() {
+  if (__flash_map != NULL) {
+    msync(__flash_map, __FLASH_SIZE, MS_ASYNC);
+  }
+}
+
+int pwjs_flash_program(uint32_t sector, uint32_t offset, uint8_t *buffer,
+                     size_t size) {
+  const uint32_t _base =
+      PICOWJS_FLASH_OFFSET + (sector * PICOWJS_FLASH_SECTOR_SIZE) + offset;
+
+  // base should be multiple of PICOWJS_FLASH_PAGE_SIZE
+  if (_base % PICOWJS_FLASH_PAGE_SIZE > 0) {
+    return -22;  // EINVAL
+  }
+
+  // size should be multiple of PICOWJS_FLASH_PAGE_SIZE
+  if (size % PICOWJS_FLASH_PAGE_SIZE > 0) {
+    return -22;  // EINVAL
+  }
+
+  if (_base + size > __FLASH_SIZE) {
+    return -22;  // EINVAL
+  }
+
+  // NOR flash programming can only clear bits
+  uint8_t *dst = __flash_map + _base;
+  for (size_t i = 0; i < size; i++) {
+    dst[i] &= buffer[i];
+  }
+  return 0;
+}
+
+int pwjs_flash_erase(uint32_t sector, size_t count) {
+  const uint32_t _base =
+      PICOWJS_FLASH_OFFSET + (sector * PICOWJS_FLASH_SECTOR_SIZE);
+  const uint32_t _size = count * PICOWJS_FLASH_SECTOR_SIZE;
+
+  if (_base + _size > __FLASH_SIZE) {
+    return -22;  // EINVAL
+  }
+
+  memset(__flash_map + _base, 0xFF, _size);
+  return 0;
+}
@@ -0,0 +1,160 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gpio.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "board.h"
+#include "err.h"
+#include "io.h"
+#include "sim.h"
+
+static struct __gpio_status_s {
+  pwjs_gpio_io_mode_t mode;
+  uint8_t output;  // level written by the program
+  int8_t input;    // level driven by the simulation (-1: floating)
+  uint8_t events;  // attached irq events
+} __gpio_status[PICOWJS_GPIO_COUNT + 1];
+
+static pwjs_gpio_irq_callback_t __gpio_irq_cb = NULL;
+static bool __gpio_irq_enabled = true;
+
+static int __check_gpio(uint8_t pin) {
+  if (pin <= PICOWJS_GPIO_COUNT) {
+    return 0;
+  } else {
+    return EINVPIN;
+  }
+}
+
+static uint8_t __gpio_level(uint8_t pin) {
+  if (__gpio_status[pin].mode == PWJS_GPIO_IO_MODE_OUTPUT) {
+    return __gpio_status[pin].output;
+  }
+  if (__gpio_status[pin].input >= 0) {
+    return (uint8_t)__gpio_status[pin].input;
+  }
+  return (__gpio_status[pin].mode == PWJS_GPIO_IO_MODE_INPUT_PULLUP)
+             ? PWJS_GPIO_HIGH
+             : PWJS_GPIO_LOW;
+}
+
+static void __gpio_irq_dispatch(uint8_t pin, uint8_t from, uint8_t to) {
+  if (!__gpio_irq_enabled || !__gpio_irq_cb || from == to) {
+    return;
+  }
+  uint8_t events = __gpio_status[pin].events;
+  if ((to == PWJS_GPIO_HIGH) && (events & PWJS_IO_WATCH_MODE_RISING)) {
+    __gpio_irq_cb(pin, (pwjs_gpio_io_mode_t)PWJS_IO_WATCH_MODE_RISING);
+  } else if ((to == PWJS_GPIO_LOW) && (events & PWJS_IO_WATCH_MODE_FALLING)) {
+    __gpio_irq_cb(pin, (pwjs_gpio_io_mode_t)PWJS_IO_WATCH_MODE_FALLING);
+  }
+}
+
+void pwjs_gpio_init() {
+  for (int i = 0; i <= PICOWJS_GPIO_COUNT; i++) {
+    __gpio_status[i].mode = PWJS_GPIO_IO_MODE_INPUT;
+    __gpio_status[i].output = PWJS_GPIO_LOW;
+    __gpio_status[i].input = -1;
+    __gpio_status[i].events = 0;
+  }
+  __gpio_irq_enabled = true;
+}
+
+void pwjs_gpio_cleanup() {
+  pwjs_gpio_irq_disable();
+  pwjs_gpio_init();
+}
+
+int pwjs_gpio_set_io_mode(uint8_t pin, pwjs_gpio_io_mode_t mode) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  __gpio_status[pin].mode = mode;
+  return 0;
+}
+
+int pwjs_gpio_write(uint8_t pin, uint8_t value) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  __gpio_status[pin].output = value ? PWJS_GPIO_HIGH : PWJS_GPIO_LOW;
+  if (pwjs_sim_trace) {
+    fprintf(stderr, "[sim] gpio %d <- %d\n", pin, __gpio_status[pin].output);
+  }
+  return 0;
+}
+
+int pwjs_gpio_read(uint8_t pin) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  return __gpio_level(pin);
+}
+
+int pwjs_gpio_toggle(uint8_t pin) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  return pwjs_gpio_write(pin, !__gpio_level(pin));
+}
+
+void pwjs_gpio_irq_set_callback(pwjs_gpio_irq_callback_t cb) {
+  __gpio_irq_cb = cb;
+}
+
+int pwjs_gpio_irq_attach(uint8_t pin, uint8_t events) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  __gpio_status[pin].events = events;
+  __gpio_irq_enabled = true;
+  return 0;
+}
+
+int pwjs_gpio_irq_detach(uint8_t pin) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  __gpio_status[pin].events = 0;
+  return 0;
+}
+
+void pwjs_gpio_irq_enable() { __gpio_irq_enabled = true; }
+
+void pwjs_gpio_irq_disable() { __gpio_irq_enabled = false; }
+
+/**
+ * Drive an input pin from the simulation. Fires the irq callback when the
+ * level change matches the attached events.
+ */
+int pwjs_sim_gpio_drive(uint8_t pin, uint8_t value) {
+  if (__check_gpio(pin) < 0) {
+    return EINVPIN;
+  }
+  uint8_t from = __gpio_level(pin);
+  __gpio_status[pin].input = value ? PWJS_GPIO_HIGH : PWJS_GPIO_LOW;
+  __gpio_irq_dispatch(pin, from, __gpio_level(pin));
+  return 0;
+}
@@ -0,0 +1,280 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "i2c.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "err.h"
+#include "sim.h"
+
+#define SIM_I2C_ADDRESS_COUNT 128
+#define SIM_I2C_REGISTER_SIZE 256
+
+/**
+ * Default device model: every address answers as a 256-byte register file.
+ * The first byte of a write sets the register pointer, the rest are stored
+ * with auto-increment. Reads continue from the register pointer.
+ */
+typedef struct {
+  uint8_t pointer;
+  uint8_t registers[SIM_I2C_REGISTER_SIZE];
+} __i2c_regfile_t;
+
+static struct __i2c_status_s {
+  pwjs_i2c_mode_t mode;
+  uint8_t address;  // own address in slave mode
+  pwjs_sim_i2c_device_t device;
+  __i2c_regfile_t *regfiles[SIM_I2C_ADDRESS_COUNT];
+} __i2c_status[I2C_NUM];
+
+static __i2c_regfile_t *__get_regfile(uint8_t bus, uint8_t address) {
+  address &= (SIM_I2C_ADDRESS_COUNT - 1);
+  if (__i2c_status[bus].regfiles[address] == NULL) {
+    __i2c_regfile_t *regfile =
+        (__i2c_regfile_t *)calloc(1, sizeof(__i2c_regfile_t));
+    __i2c_status[bus].regfiles[address] = regfile;
+  }
+  return __i2c_status[bus].regfiles[address];
+}
+
+static int __i2c_regfile_device(uint8_t bus, uint8_t address,
+                                const uint8_t *tx, size_t tx_len, uint8_t *rx,
+                                size_t rx_len) {
+  __i2c_regfile_t *regfile = __get_regfile(bus, address);
+  if (regfile == NULL) {
+    return ENOMEM;
+  }
+  if (tx_len > 0) {
+    regfile->pointer = tx[0];
+    for (size_t i = 1; i < tx_len; i++) {
+      regfile->registers[regfile->pointer++] = tx[i];
+    }
+  }
+  for (size_t i = 0; i < rx_len; i++) {
+    rx[i] = regfile->registers[regfile->pointer++];
+  }
+  return 0;
+}
+
+static int __i2c_transfer(uint8_t bus, uint8_t address, const uint8_t *tx,
+                          size_t tx_len, uint8_t *rx, size_t rx_len) {
+  pwjs_sim_i2c_device_t device = __i2c_status[bus].device
+                                     ? __i2c_status[bus].device
+                                     : __i2c_regfile_device;
+  int ret = device(bus, address, tx, tx_len, rx, rx_len);
+  if (pwjs_sim_trace) {
+    fprintf(stderr, "[sim] i2c %d @%02x", bus, address);
+    for (size_t i = 0; i < tx_len; i++) fprintf(stderr, " w%02x", tx[i]);
+    for (size_t i = 0; i < rx_len; i++) fprintf(stderr, " r%02x", rx[i]);
+    fprintf(stderr, ret < 0 ? " nack\n" : "\n");
+  }
+  return ret;
+}
+
+/**
+ * Return default I2C pins. -1 means there is no default value on that pin.
+ */
+pwjs_i2c_pins_t pwjs_i2c_get_default_pins(uint8_t bus) {
+  pwjs_i2c_pins_t pins;
+  if (bus == 0) {
+    pins.sda = 4;
+    pins.scl = 5;
+  } else if (bus == 1) {
+    pins.sda = 2;
+    pins.scl = 3;
+  } else {
+    pins.sda = -1;
+    pins.scl = -1;
+  }
+  return pins;
+}
+
+/**
+ * Initialize all I2C when system started
+ */
+void pwjs_i2c_init() {
+  for (int i = 0; i < I2C_NUM; i++) {
+    __i2c_status[i].mode = PWJS_I2C_NONE;
+  }
+}
+
+/**
+ * Cleanup all I2C when system cleanup
+ */
+void pwjs_i2c_cleanup() { pwjs_i2c_init(); }
+
+int pwjs_i2c_setup_master(uint8_t bus, uint32_t speed, pwjs_i2c_pins_t pins) {
+  if ((bus >= I2C_NUM) || (__i2c_status[bus].mode != PWJS_I2C_NONE) ||
+      (speed > I2C_MAX_CLOCK)) {
+    return EDEVINIT;
+  }
+  __i2c_status[bus].mode = PWJS_I2C_MASTER;
+  return 0;
+}
+
+int pwjs_i2c_setup_slave(uint8_t bus, uint8_t address, pwjs_i2c_pins_t pins) {
+  if ((bus >= I2C_NUM) || (__i2c_status[bus].mode != PWJS_I2C_NONE)) {
+    return EDEVINIT;
+  }
+  __i2c_status[bus].mode = PWJS_I2C_SLAVE;
+  __i2c_status[bus].address = address;
+  return 0;
+}
+
+static bool __check_mode(uint8_t bus, pwjs_i2c_mode_t mode) {
+  return (bus < I2C_NUM) && (__i2c_status[bus].mode == mode);
+}
+
+int pwjs_i2c_mem_write_master(uint8_t bus, uint8_t address, uint16_t mem_addr,
+                            uint8_t mem_addr_size, uint8_t *buf, size_t len,
+                            uint32_t timeout) {
+  if (!__check_mode(bus, PWJS_I2C_MASTER)) {
+    return EDEVWRITE;
+  }
+  // the register file has 8-bit addresses, so send only the low byte to it
+  if (__i2c_status[bus].device == NULL) {
+    mem_addr_size = 8;
+  }
+  uint8_t *tx = (uint8_t *)malloc(len + 2);
+  if (tx == NULL) {
+    return EDEVWRITE;
+  }
+  size_t n = 0;
+  if (mem_addr_size == 16) {
+    tx[n++] = (uint8_t)(mem_addr >> 8);
+  }
+  tx[n++] = (uint8_t)(mem_addr & 0xFF);
+  memcpy(tx + n, buf, len);
+  int ret = __i2c_transfer(bus, address, tx, n + len, NULL, 0);
+  free(tx);
+  return (ret < 0) ? EDEVWRITE : (int)len;
+}
+
+int pwjs_i2c_mem_read_master(uint8_t bus, uint8_t address, uint16_t mem_addr,
+                           uint8_t mem_addr_size, uint8_t *buf, size_t len,
+                           uint32_t timeout) {
+  if (!__check_mode(bus, PWJS_I2C_MASTER)) {
+    return EDEVREAD;
+  }
+  if (__i2c_status[bus].device == NULL) {
+    mem_addr_size = 8;
+  }
+  uint8_t tx[2];
+  size_t n = 0;
+  if (mem_addr_size == 16) {
+    tx[n++] = (uint8_t)(mem_addr >> 8);
+  }
+  tx[n++] = (uint8_t)(mem_addr & 0xFF);
+  int ret = __i2c_transfer(bus, address, tx, n, buf, len);
+  return (ret < 0) ? EDEVREAD : (int)len;
+}
+
+int pwjs_i2c_write_master(uint8_t bus, uint8_t address, uint8_t *buf,
+                        size_t len, uint32_t timeout) {
+  if (!__check_mode(bus, PWJS_I2C_MASTER)) {
+    return EDEVWRITE;
+  }
+  int ret = __i2c_transfer(bus, address, buf, len, NULL, 0);
+  return (ret < 0) ? EDEVWRITE : (int)len;
+}
+
+int pwjs_i2c_write_slave(uint8_t bus, uint8_t *buf, size_t len,
+                       uint32_t timeout) {
+  if (!__check_mode(bus, PWJS_I2C_SLAVE)) {
+    return EDEVWRITE;
+  }
+  // the simulated master reads our own register file
+  __i2c_regfile_t *regfile = __get_regfile(bus, __i2c_status[bus].address);
+  if (regfile == NULL) {
+    return EDEVWRITE;
+  }
+  for (size_t i = 0; i < len; i++) {
+    regfile->registers[(uint8_t)i] = buf[i];
+  }
+  return 0;
+}
+
+int pwjs_i2c_read_master(uint8_t bus, uint8_t address, uint8_t *buf,
+                       size_t len, uint32_t timeout) {
+  if (!__check_mode(bus, PWJS_I2C_MASTER)) {
+    return EDEVREAD;
+  }
+  int ret = __i2c_transfer(bus, address, NULL, 0, buf, len);
+  return (ret < 0) ? EDEVREAD : (int)len;
+}
+
+int pwjs_i2c_read_slave(uint8_t bus, uint8_t *buf, size_t len,
+                      uint32_t timeout) {
+  if (!__check_mode(bus, PWJS_I2C_SLAVE)) {
+    return EDEVREAD;
+  }
+  // data preloaded into our own address by the simulation
+  __i2c_regfile_t *regfile = __get_regfile(bus, __i2c_status[bus].address);
+  if (regfile == NULL) {
+    return EDEVREAD;
+  }
+  for (size_t i = 0; i < len; i++) {
+    buf[i] = regfile->registers[(uint8_t)i];
+  }
+  return 0;
+}
+
+int pwjs_i2c_close(uint8_t bus) {
+  if ((bus >= I2C_NUM) || (__i2c_status[bus].mode == PWJS_I2C_NONE)) {
+    return EDEVINIT;
+  }
+  __i2c_status[bus].mode = PWJS_I2C_NONE;
+  return 0;
+}
+
+/**
+ * Attach a device model to an I2C bus (NULL to restore the register files)
+ */
+void pwjs_sim_i2c_attach(uint8_t bus, pwjs_sim_i2c_device_t device) {
+  if (bus < I2C_NUM) {
+    __i2c_status[bus].device = device;
+  }
+}
+
+/**
+ * Preload registers of the default device model from register 0
+ */
+int pwjs_sim_i2c_preload(uint8_t bus, uint8_t address, const uint8_t *buf,
+                         size_t len) {
+  if (bus >= I2C_NUM) {
+    return ENODEV;
+  }
+  __i2c_regfile_t *regfile = __get_regfile(bus, address);
+  if (regfile == NULL) {
+    return ENOMEM;
+  }
+  if (len > SIM_I2C_REGISTER_SIZE) {
+    len = SIM_I2C_REGISTER_SIZE;
+  }
+  memcpy(regfile->registers, buf, len);
+  regfile->pointer = 0;
+  return 0;
+}
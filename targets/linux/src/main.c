@@ -0,0 +1,84 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "board.h"
+#include "gpio.h"
+#include "io.h"
+#include "prog.h"
+#include "repl.h"
+#include "runtime.h"
+#include "system.h"
+#include "tty.h"
+
+/**
+ * Write a script file into the user program area of the flash
+ */
+static int write_program(const char *path) {
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    perror(path);
+    return -1;
+  }
+  uint8_t buf[PICOWJS_FLASH_PAGE_SIZE];
+  size_t n;
+  int ret = 0;
+  pwjs_prog_begin();
+  while (ret == 0 && (n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    ret = pwjs_prog_write(buf, n);
+  }
+  fclose(fp);
+  if (pwjs_prog_end() < 0 || ret < 0) {
+    fprintf(stderr, "%s: program too large\n", path);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Usage:
+ *   picowjs            start the REPL (runs the stored program first)
+ *   picowjs <file>     store <file> as the program, run it and exit when
+ *                      there are no more pending I/O handles
+ */
+int main(int argc, char *argv[]) {
+  bool load = false;
+  pwjs_system_init();
+  if (argc > 1) {
+    if (write_program(argv[1]) < 0) {
+      return 1;
+    }
+    pwjs_tty_init();
+    pwjs_io_init();
+    pwjs_runtime_init(true, true);
+    pwjs_io_run(false);
+    pwjs_runtime_cleanup();
+    fflush(stdout);
+    return 0;
+  }
+  load = pwjs_running_script_check();
+  pwjs_tty_init();
+  pwjs_io_init();
+  pwjs_repl_init(true);
+  pwjs_runtime_init(load, true);
+  pwjs_io_run(true);
+}
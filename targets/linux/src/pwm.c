@@ -0,0 +1,179 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pwm.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "board.h"
+#include "err.h"
+#include "sim.h"
+
+static struct __pwm_config_s {
+  double freq;
+  double duty;
+  bool enabled;
+  bool inverted;
+} __pwm_config[PWM_NUM];
+
+static int __get_pwm_index(uint8_t pin) {
+  if (pin <= 22) {
+    return pin;
+  } else if ((pin >= 25) && (pin <= 28)) {
+    return pin - 2;
+  }
+  return EINVPIN;
+}
+
+// same slice/channel mapping as the rp2 PWM block
+#define __PWM_SLICE(pin) (((pin) >> 1) & 7)
+#define __PWM_CHANNEL(pin) ((pin)&1)
+
+static void __pwm_trace(uint8_t pin, int pwm_index) {
+  if (pwjs_sim_trace) {
+    fprintf(stderr, "[sim] pwm %d freq=%g duty=%g %s\n", pin,
+            __pwm_config[pwm_index].freq, __pwm_config[pwm_index].duty,
+            __pwm_config[pwm_index].enabled ? "on" : "off");
+  }
+}
+
+/**
+ * Initialize all PWM when system started
+ */
+void pwjs_pwm_init() {
+  for (int i = 0; i < PWM_NUM; i++) {
+    __pwm_config[i].freq = 0;
+    __pwm_config[i].duty = 0;
+    __pwm_config[i].enabled = false;
+    __pwm_config[i].inverted = false;
+  }
+}
+
+/**
+ * Cleanup all PWM when system cleanup
+ */
+void pwjs_pwm_cleanup() { pwjs_pwm_init(); }
+
+int pwjs_pwm_set_inversion(uint8_t pin, uint8_t inv_pin) {
+  int pwm_index = __get_pwm_index(pin);
+  int pwm_inv_index = __get_pwm_index(inv_pin);
+  if ((pwm_index < 0) || (pwm_inv_index < 0)) {
+    return EINVPIN;  // Error
+  }
+  __pwm_config[pwm_inv_index] = __pwm_config[pwm_index];
+  __pwm_config[pwm_inv_index].inverted = true;
+  return 0;
+}
+
+/**
+ * return Returns 0 on success or -1 on failure.
+ */
+int pwjs_pwm_setup(uint8_t pin, double frequency, double duty) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  if (frequency < 13) {
+    frequency = 13;  // Min is 13Hz
+  }
+  __pwm_config[pwm_index].freq = frequency;
+  __pwm_config[pwm_index].duty = duty;
+  __pwm_trace(pin, pwm_index);
+  return 0;
+}
+
+int pwjs_check_pwm_inv_port(uint8_t pin, int8_t inv_pin) {
+  int pwm_index = __get_pwm_index(pin);
+  if ((pwm_index < 0) || (inv_pin < 0) || (pin == inv_pin) ||
+      (__PWM_CHANNEL(pin) == __PWM_CHANNEL(inv_pin)) ||
+      (__PWM_SLICE(pin) != __PWM_SLICE(inv_pin))) {
+    return EINVPIN;
+  }
+  return 0;
+}
+
+int pwjs_pwm_start(uint8_t pin) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  __pwm_config[pwm_index].enabled = true;
+  __pwm_trace(pin, pwm_index);
+  return 0;
+}
+
+int pwjs_pwm_stop(uint8_t pin) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  __pwm_config[pwm_index].enabled = false;
+  __pwm_trace(pin, pwm_index);
+  return 0;
+}
+
+double pwjs_pwm_get_frequency(uint8_t pin) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  return __pwm_config[pwm_index].freq;
+}
+
+double pwjs_pwm_get_duty(uint8_t pin) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  return __pwm_config[pwm_index].duty;
+}
+
+int pwjs_pwm_set_duty(uint8_t pin, double duty) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  __pwm_config[pwm_index].duty = duty;
+  __pwm_trace(pin, pwm_index);
+  return 0;
+}
+
+int pwjs_pwm_set_frequency(uint8_t pin, double frequency) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  /* The previous duty ratio must be hold up regardless of changing frequency */
+  return pwjs_pwm_setup(pin, frequency, __pwm_config[pwm_index].duty);
+}
+
+int pwjs_pwm_close(uint8_t pin) {
+  int pwm_index = __get_pwm_index(pin);
+  if (pwm_index < 0) {
+    return EINVPIN;  // Error
+  }
+  if (__pwm_config[pwm_index].enabled) {
+    pwjs_pwm_stop(pin);
+  }
+  return 0;
+}
@@ -0,0 +1,49 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rtc.h"
+
+#include <stddef.h>
+#include <sys/time.h>
+
+/**
+ * Offset from the host clock, set by pwjs_rtc_set_time(). The clock starts
+ * at unix epoch like the rp2 target.
+ */
+static int64_t __rtc_offset = 0;
+
+static int64_t __host_time() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+void pwjs_rtc_init() { __rtc_offset = -__host_time(); }
+
+void pwjs_rtc_cleanup() {}
+
+void pwjs_rtc_set_time(uint64_t time) {
+  __rtc_offset = (int64_t)time - __host_time();
+}
+
+uint64_t pwjs_rtc_get_time() {
+  return (uint64_t)(__host_time() + __rtc_offset);
+}
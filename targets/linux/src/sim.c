@@ -0,0 +1,184 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "sim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "system.h"
+#include "utils.h"
+
+#define SIM_LINE_MAX 512
+
+bool pwjs_sim_trace = false;
+
+/**
+ * A script line scheduled with `at <ms>`
+ */
+typedef struct __sim_event_s {
+  pwjs_list_node_t base;
+  uint64_t time;
+  char *line;
+} __sim_event_t;
+
+static pwjs_list_t __sim_events;
+static uint64_t __sim_start = 0;
+
+/**
+ * Parse hex bytes ("01 02 ff" or "0102ff") into buf.
+ * Return the number of bytes parsed.
+ */
+static size_t __parse_hex(const char *str, uint8_t *buf, size_t max) {
+  size_t n = 0;
+  while (*str && n < max) {
+    if (*str == ' ' || *str == '\t' || *str == ',') {
+      str++;
+      continue;
+    }
+    if (str[1] == 0) break;
+    char hex[3] = {str[0], str[1], 0};
+    char *end;
+    long value = strtol(hex, &end, 16);
+    if (*end != 0) break;
+    buf[n++] = (uint8_t)value;
+    str += 2;
+  }
+  return n;
+}
+
+static void __sim_apply(char *line) {
+  uint8_t buf[SIM_LINE_MAX / 2];
+  char name[16];
+  int bus, pin, value, address, consumed = 0;
+  double level;
+  if (sscanf(line, "%15s%n", name, &consumed) != 1) {
+    return;
+  }
+  char *args = line + consumed;
+  if (strcmp(name, "trace") == 0) {
+    pwjs_sim_trace = true;
+  } else if (strcmp(name, "gpio") == 0 &&
+             sscanf(args, "%d %d", &pin, &value) == 2) {
+    pwjs_sim_gpio_drive(pin, value);
+  } else if (strcmp(name, "adc") == 0 &&
+             sscanf(args, "%d %lf", &pin, &level) == 2) {
+    pwjs_sim_adc_drive(pin, level);
+  } else if (strcmp(name, "uart") == 0 &&
+             sscanf(args, "%d%n", &bus, &consumed) == 1) {
+    if (strstr(args + consumed, "loopback")) {
+      pwjs_sim_uart_loopback(bus, true);
+    } else {
+      size_t len = __parse_hex(args + consumed, buf, sizeof(buf));
+      pwjs_sim_uart_feed(bus, buf, len);
+    }
+  } else if (strcmp(name, "spi") == 0 &&
+             sscanf(args, "%d%n", &bus, &consumed) == 1) {
+    size_t len = __parse_hex(args + consumed, buf, sizeof(buf));
+    pwjs_sim_spi_queue(bus, buf, len);
+  } else if (strcmp(name, "sdcard") == 0 &&
+             sscanf(args, "%d%n", &bus, &consumed) == 1) {
+    unsigned int blocks = 2048;
+    sscanf(args + consumed, "%u", &blocks);
+    pwjs_sim_sdcard_attach(bus, blocks);
+  } else if (strcmp(name, "i2c") == 0 &&
+             sscanf(args, "%d %i%n", &bus, &address, &consumed) == 2) {
+    size_t len = __parse_hex(args + consumed, buf, sizeof(buf));
+    pwjs_sim_i2c_preload(bus, address, buf, len);
+  } else {
+    fprintf(stderr, "[sim] unknown: %s\n", line);
+  }
+}
+
+static void __sim_schedule(uint64_t time, const char *line) {
+  __sim_event_t *event = (__sim_event_t *)malloc(sizeof(__sim_event_t));
+  event->time = time;
+  event->line = strdup(line);
+  pwjs_list_append(&__sim_events, (pwjs_list_node_t *)event);
+}
+
+static void __sim_load(const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    perror(path);
+    return;
+  }
+  char line[SIM_LINE_MAX];
+  while (fgets(line, sizeof(line), fp)) {
+    char *comment = strchr(line, '#');
+    if (comment) *comment = 0;
+    line[strcspn(line, "\r\n")] = 0;
+    unsigned long long at;
+    int consumed = 0;
+    if (sscanf(line, " at %llu%n", &at, &consumed) == 1) {
+      __sim_schedule(at, line + consumed);
+    } else if (strspn(line, " \t") < strlen(line)) {
+      __sim_apply(line);
+    }
+  }
+  fclose(fp);
+}
+
+void pwjs_sim_init() {
+  pwjs_list_init(&__sim_events);
+  __sim_start = pwjs_gettime();
+  if (getenv("PICOWJS_SIM_TRACE")) {
+    pwjs_sim_trace = true;
+  }
+  const char *path = getenv("PICOWJS_SIM");
+  if (path) {
+    __sim_load(path);
+  }
+}
+
+void pwjs_sim_cleanup() {
+  __sim_event_t *event = (__sim_event_t *)__sim_events.head;
+  while (event != NULL) {
+    __sim_event_t *next = (__sim_event_t *)((pwjs_list_node_t *)event)->next;
+    free(event->line);
+    free(event);
+    event = next;
+  }
+  pwjs_list_init(&__sim_events);
+  pwjs_sim_sdcard_detach();
+}
+
+/**
+ * Apply scheduled script lines which are due. Called from the main loop.
+ */
+void pwjs_sim_poll() {
+  if (__sim_events.head == NULL) {
+    return;
+  }
+  uint64_t now = pwjs_gettime() - __sim_start;
+  __sim_event_t *event = (__sim_event_t *)__sim_events.head;
+  while (event != NULL) {
+    __sim_event_t *next = (__sim_event_t *)((pwjs_list_node_t *)event)->next;
+    if (event->time <= now) {
+      pwjs_list_remove(&__sim_events, (pwjs_list_node_t *)event);
+      __sim_apply(event->line);
+      free(event->line);
+      free(event);
+    }
+    event = next;
+  }
+}
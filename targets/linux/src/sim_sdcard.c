@@ -0,0 +1,329 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+#include "sim.h"
+
+/**
+ * SD card model (SDHC, SPI mode) on a simulated SPI bus. The card is kept
+ * in RAM. It answers the commands used by the sdcard module: reset and
+ * initialization, CSD, single and multiple block reads and writes,
+ * STOP_TRANSMISSION, SET_WR_BLK_ERASE_COUNT and erase.
+ */
+
+#define SD_BLOCK 512
+#define SD_R1_IDLE 0x01
+#define SD_R1_ILLEGAL_CMD 0x04
+#define SD_R1_ADDRESS_ERROR 0x20
+
+typedef enum {
+  SD_STATE_IDLE,
+  SD_STATE_COMMAND,     // receiving a command frame
+  SD_STATE_READ_MULTI,  // sending blocks until CMD12
+  SD_STATE_WRITE_TOKEN, // waiting for a start (or stop) token
+  SD_STATE_WRITE_DATA,  // receiving a data block and its CRC
+} sd_state_t;
+
+static struct {
+  uint8_t *data;
+  uint32_t blocks;
+  uint8_t bus;
+  bool ready;  // initialized by ACMD41
+  bool app;    // next command is an ACMD
+  sd_state_t state;
+  bool multi;  // CMD25 rather than CMD24
+  uint32_t address;
+  uint32_t erase_start;
+  uint32_t erase_end;
+  uint8_t command[6];
+  size_t command_length;
+  uint8_t in[SD_BLOCK + 2];  // received data block and CRC
+  size_t in_length;
+  uint8_t out[SD_BLOCK + 32];  // bytes to return on MISO
+  size_t out_length;
+  size_t out_position;
+  size_t block_end;    // end of the data block being sent, 0 if none
+  pwjs_sim_sdcard_stats_t stats;
+} __sd;
+
+static void __sd_queue(const uint8_t *buf, size_t len) {
+  if (__sd.out_position == __sd.out_length) {
+    __sd.out_position = 0;
+    __sd.out_length = 0;
+  }
+  if (__sd.out_length + len > sizeof(__sd.out)) {
+    return;
+  }
+  memcpy(__sd.out + __sd.out_length, buf, len);
+  __sd.out_length += len;
+}
+
+static void __sd_queue_byte(uint8_t byte) { __sd_queue(&byte, 1); }
+
+/**
+ * Queue a data block with its start token and a dummy CRC
+ */
+static void __sd_queue_block(uint32_t address) {
+  uint8_t header[2] = {0xFF, 0xFE};
+  uint8_t crc[2] = {0xFF, 0xFF};
+  __sd_queue(header, 2);
+  __sd_queue(__sd.data + (size_t)address * SD_BLOCK, SD_BLOCK);
+  __sd.block_end = __sd.out_length;
+  __sd_queue(crc, 2);
+}
+
+static void __sd_queue_csd() {
+  uint8_t csd[16] = {0};
+  uint32_t c_size = __sd.blocks / 1024 - 1;
+  csd[0] = 0x40;  // CSD version 2.0 (SDHC)
+  csd[5] = 0x59;  // READ_BL_LEN = 9 (512 bytes)
+  csd[7] = (c_size >> 16) & 0x3F;
+  csd[8] = (c_size >> 8) & 0xFF;
+  csd[9] = c_size & 0xFF;
+  uint8_t header[2] = {0xFF, 0xFE};
+  uint8_t crc[2] = {0xFF, 0xFF};
+  __sd_queue(header, 2);
+  __sd_queue(csd, 16);
+  __sd_queue(crc, 2);
+}
+
+static void __sd_command() {
+  uint8_t cmd = __sd.command[0] & 0x3F;
+  uint32_t arg = ((uint32_t)__sd.command[1] << 24) |
+                 ((uint32_t)__sd.command[2] << 16) |
+                 ((uint32_t)__sd.command[3] << 8) | __sd.command[4];
+  uint8_t r1 = __sd.ready ? 0x00 : SD_R1_IDLE;
+  bool app = __sd.app;
+  __sd.app = false;
+  __sd.state = SD_STATE_IDLE;
+  __sd.stats.commands++;
+  if (pwjs_sim_trace) {
+    fprintf(stderr, "[sim] sdcard %sCMD%d(%u)\n", app ? "A" : "", cmd, arg);
+  }
+  __sd_queue_byte(0xFF);  // NCR
+  if (app) {
+    switch (cmd) {
+      case 41:  // APP_SEND_OP_COND
+        __sd.ready = true;
+        __sd_queue_byte(0x00);
+        return;
+      case 23:  // SET_WR_BLK_ERASE_COUNT
+        __sd.stats.pre_erases++;
+        __sd_queue_byte(r1);
+        return;
+      default:
+        __sd_queue_byte(r1 | SD_R1_ILLEGAL_CMD);
+        return;
+    }
+  }
+  switch (cmd) {
+    case 0:  // GO_IDLE_STATE
+      __sd.ready = false;
+      __sd_queue_byte(SD_R1_IDLE);
+      break;
+    case 8: {  // SEND_IF_COND
+      uint8_t resp[5] = {r1, 0x00, 0x00, 0x01, arg & 0xFF};
+      __sd_queue(resp, 5);
+      break;
+    }
+    case 9:  // SEND_CSD
+      __sd_queue_byte(r1);
+      __sd_queue_csd();
+      break;
+    case 12:  // STOP_TRANSMISSION (R1b)
+      __sd_queue_byte(0xFF);  // stuff byte
+      __sd_queue_byte(r1);
+      break;
+    case 13: {  // SEND_STATUS (R2)
+      uint8_t resp[2] = {r1, 0x00};
+      __sd_queue(resp, 2);
+      break;
+    }
+    case 16:  // SET_BLOCKLEN
+      __sd_queue_byte(arg == SD_BLOCK ? r1 : r1 | 0x40);
+      break;
+    case 17:  // READ_SINGLE_BLOCK
+    case 18:  // READ_MULTIPLE_BLOCK
+      if (arg >= __sd.blocks) {
+        __sd_queue_byte(r1 | SD_R1_ADDRESS_ERROR);
+        break;
+      }
+      __sd_queue_byte(r1);
+      __sd_queue_block(arg);
+      if (cmd == 18) {
+        __sd.address = arg + 1;
+        __sd.state = SD_STATE_READ_MULTI;
+      }
+      break;
+    case 24:  // WRITE_BLOCK
+    case 25:  // WRITE_MULTIPLE_BLOCK
+      if (arg >= __sd.blocks) {
+        __sd_queue_byte(r1 | SD_R1_ADDRESS_ERROR);
+        break;
+      }
+      __sd_queue_byte(r1);
+      __sd.address = arg;
+      __sd.multi = (cmd == 25);
+      __sd.state = SD_STATE_WRITE_TOKEN;
+      break;
+    case 32:  // ERASE_WR_BLK_START
+      __sd.erase_start = arg;
+      __sd_queue_byte(r1);
+      break;
+    case 33:  // ERASE_WR_BLK_END
+      __sd.erase_end = arg;
+      __sd_queue_byte(r1);
+      break;
+    case 38:  // ERASE (R1b)
+      if (__sd.erase_start <= __sd.erase_end &&
+          __sd.erase_end < __sd.blocks) {
+        memset(__sd.data + (size_t)__sd.erase_start * SD_BLOCK, 0xFF,
+               (size_t)(__sd.erase_end - __sd.erase_start + 1) * SD_BLOCK);
+        __sd_queue_byte(r1);
+      } else {
+        __sd_queue_byte(r1 | SD_R1_ADDRESS_ERROR);
+      }
+      break;
+    case 55:  // APP_CMD
+      __sd.app = true;
+      __sd_queue_byte(r1);
+      break;
+    case 58: {  // READ_OCR: powered up, CCS (block addressing)
+      uint8_t resp[5] = {r1, 0xC0, 0xFF, 0x80, 0x00};
+      __sd_queue(resp, 5);
+      break;
+    }
+    default:
+      __sd_queue_byte(r1 | SD_R1_ILLEGAL_CMD);
+      break;
+  }
+}
+
+static uint8_t __sd_transfer_byte(uint8_t tx) {
+  // MISO
+  uint8_t rx = 0xFF;
+  if (__sd.out_position == __sd.out_length &&
+      __sd.state == SD_STATE_READ_MULTI && __sd.address < __sd.blocks) {
+    __sd_queue_block(__sd.address++);
+  }
+  if (__sd.out_position < __sd.out_length) {
+    rx = __sd.out[__sd.out_position++];
+  }
+  // a block is read once all its data is sent, not when it is queued
+  // ahead of a STOP_TRANSMISSION
+  if (__sd.block_end > 0 && __sd.out_position == __sd.block_end) {
+    __sd.stats.blocks_read++;
+    __sd.block_end = 0;
+  }
+
+  // MOSI
+  switch (__sd.state) {
+    case SD_STATE_COMMAND:
+      __sd.command[__sd.command_length++] = tx;
+      if (__sd.command_length == sizeof(__sd.command)) {
+        __sd_command();
+      }
+      break;
+    case SD_STATE_WRITE_TOKEN:
+      if (tx == 0xFE || (tx == 0xFC && __sd.multi)) {
+        __sd.in_length = 0;
+        __sd.state = SD_STATE_WRITE_DATA;
+      } else if (tx == 0xFD && __sd.multi) {
+        uint8_t busy[3] = {0xFF, 0x00, 0x00};  // stuff byte, busy
+        __sd_queue(busy, 3);
+        __sd.state = SD_STATE_IDLE;
+      }
+      break;
+    case SD_STATE_WRITE_DATA:
+      __sd.in[__sd.in_length++] = tx;
+      if (__sd.in_length == sizeof(__sd.in)) {
+        uint8_t resp[3] = {0x05, 0x00, 0x00};  // data accepted, busy
+        if (__sd.address < __sd.blocks) {
+          memcpy(__sd.data + (size_t)__sd.address * SD_BLOCK, __sd.in,
+                 SD_BLOCK);
+          __sd.stats.blocks_written++;
+        } else {
+          resp[0] = 0x0D;  // write error
+        }
+        __sd.address++;
+        __sd_queue(resp, 3);
+        __sd.state = __sd.multi ? SD_STATE_WRITE_TOKEN : SD_STATE_IDLE;
+      }
+      break;
+    default:
+      if ((tx & 0xC0) == 0x40) {  // start of a command frame
+        if (__sd.state == SD_STATE_READ_MULTI) {
+          __sd.out_position = __sd.out_length;
+          __sd.block_end = 0;
+        }
+        __sd.command[0] = tx;
+        __sd.command_length = 1;
+        __sd.state = SD_STATE_COMMAND;
+      }
+      break;
+  }
+  return rx;
+}
+
+static int __sd_device(uint8_t bus, const uint8_t *tx, uint8_t *rx,
+                       size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    rx[i] = __sd_transfer_byte(tx ? tx[i] : 0xFF);
+  }
+  return len;
+}
+
+/**
+ * Attach an SD card of the given number of 512-byte blocks (rounded up to
+ * a multiple of 1024) to a SPI bus. The card is blank (0xFF).
+ */
+int pwjs_sim_sdcard_attach(uint8_t bus, uint32_t blocks) {
+  pwjs_sim_sdcard_detach();
+  blocks = (blocks + 1023) / 1024 * 1024;
+  if (blocks == 0) {
+    blocks = 1024;
+  }
+  __sd.data = (uint8_t *)malloc((size_t)blocks * SD_BLOCK);
+  if (__sd.data == NULL) {
+    return ENOMEM;
+  }
+  memset(__sd.data, 0xFF, (size_t)blocks * SD_BLOCK);
+  __sd.blocks = blocks;
+  __sd.bus = bus;
+  pwjs_sim_spi_attach(bus, __sd_device);
+  return 0;
+}
+
+void pwjs_sim_sdcard_detach() {
+  if (__sd.data != NULL) {
+    pwjs_sim_spi_attach(__sd.bus, NULL);
+    free(__sd.data);
+  }
+  memset(&__sd, 0, sizeof(__sd));
+}
+
+void pwjs_sim_sdcard_get_stats(pwjs_sim_sdcard_stats_t *stats) {
+  *stats = __sd.stats;
+}
@@ -0,0 +1,215 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "spi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "err.h"
+#include "sim.h"
+
+static struct __spi_status_s {
+  bool enabled;
+  uint32_t baudrate;
+  pwjs_sim_spi_device_t device;
+  uint8_t *miso;  // queued MISO bytes
+  size_t miso_length;
+  size_t miso_position;
+} __spi_status[SPI_NUM];
+
+static bool __check_spi(uint8_t bus) {
+  return (bus < SPI_NUM) && __spi_status[bus].enabled;
+}
+
+static void __spi_trace(uint8_t bus, const uint8_t *tx, const uint8_t *rx,
+                        size_t len) {
+  fprintf(stderr, "[sim] spi %d:", bus);
+  for (size_t i = 0; i < len; i++) {
+    fprintf(stderr, " %02x/%02x", tx ? tx[i] : 0xFF, rx[i]);
+  }
+  fprintf(stderr, "\n");
+}
+
+/**
+ * Transfer bytes to the attached device model. Without a model, the MISO
+ * line returns the queued bytes and then idles high (0xFF).
+ */
+static int __spi_transfer(uint8_t bus, const uint8_t *tx, uint8_t *rx,
+                          size_t len) {
+  int ret = len;
+  if (__spi_status[bus].device) {
+    ret = __spi_status[bus].device(bus, tx, rx, len);
+  } else {
+    for (size_t i = 0; i < len; i++) {
+      if (__spi_status[bus].miso_position < __spi_status[bus].miso_length) {
+        rx[i] = __spi_status[bus].miso[__spi_status[bus].miso_position++];
+      } else {
+        rx[i] = 0xFF;
+      }
+    }
+  }
+  if (pwjs_sim_trace) {
+    __spi_trace(bus, tx, rx, len);
+  }
+  return ret;
+}
+
+/**
+ * Return default SPI pins. -1 means there is no default value on that pin.
+ */
+pwjs_spi_pins_t pwjs_spi_get_default_pins(uint8_t bus) {
+  pwjs_spi_pins_t pins;
+  if (bus == 0) {
+    pins.miso = 16;
+    pins.mosi = 19;
+    pins.sck = 18;
+  } else if (bus == 1) {
+    pins.miso = 12;
+    pins.mosi = 11;
+    pins.sck = 10;
+  } else {
+    pins.miso = -1;
+    pins.mosi = -1;
+    pins.sck = -1;
+  }
+  return pins;
+}
+
+/**
+ * Initialize all SPI when system started
+ */
+void pwjs_spi_init() {
+  for (int i = 0; i < SPI_NUM; i++) {
+    __spi_status[i].enabled = false;
+    __spi_status[i].baudrate = 0;
+  }
+}
+
+/**
+ * Cleanup all SPI when system cleanup
+ */
+void pwjs_spi_cleanup() {
+  for (int i = 0; i < SPI_NUM; i++) {
+    if (__spi_status[i].enabled) {
+      pwjs_spi_close(i);
+    }
+  }
+}
+
+int pwjs_spi_setup(uint8_t bus, pwjs_spi_mode_t mode, uint32_t baudrate,
+                 pwjs_spi_bitorder_t bitorder, pwjs_spi_pins_t pins,
+                 bool miso_pullup) {
+  if ((bus >= SPI_NUM) || (__spi_status[bus].enabled)) {
+    return EDEVINIT;
+  }
+  __spi_status[bus].enabled = true;
+  __spi_status[bus].baudrate = baudrate;
+  return 0;
+}
+
+int pwjs_spi_sendrecv(uint8_t bus, uint8_t *tx_buf, uint8_t *rx_buf, size_t len,
+                    uint32_t timeout) {
+  if (!__check_spi(bus)) {
+    return EDEVREAD;
+  }
+  return __spi_transfer(bus, tx_buf, rx_buf, len);
+}
+
+int pwjs_spi_send(uint8_t bus, uint8_t *buf, size_t len, uint32_t timeout) {
+  if (!__check_spi(bus)) {
+    return EDEVWRITE;
+  }
+  uint8_t *rx_buf = (uint8_t *)malloc(len);
+  if (rx_buf == NULL) {
+    return EDEVWRITE;
+  }
+  int ret = __spi_transfer(bus, buf, rx_buf, len);
+  free(rx_buf);
+  return ret;
+}
+
+int pwjs_spi_recv(uint8_t bus, uint8_t send_byte, uint8_t *buf, size_t len,
+                uint32_t timeout) {
+  if (!__check_spi(bus)) {
+    return EDEVREAD;
+  }
+  uint8_t *tx_buf = (uint8_t *)malloc(len);
+  if (tx_buf == NULL) {
+    return EDEVREAD;
+  }
+  memset(tx_buf, send_byte, len);
+  int ret = __spi_transfer(bus, tx_buf, buf, len);
+  free(tx_buf);
+  return ret;
+}
+
+int pwjs_set_spi_baudrate(uint8_t bus, uint32_t baudrate) {
+  if (!__check_spi(bus)) {
+    return ENODEV;
+  }
+  __spi_status[bus].baudrate = baudrate;
+  return 0;
+}
+
+int pwjs_spi_close(uint8_t bus) {
+  if (!__check_spi(bus)) {
+    return EDEVINIT;
+  }
+  __spi_status[bus].enabled = false;
+  return 0;
+}
+
+/**
+ * Attach a device model to a SPI bus (NULL to detach)
+ */
+void pwjs_sim_spi_attach(uint8_t bus, pwjs_sim_spi_device_t device) {
+  if (bus < SPI_NUM) {
+    __spi_status[bus].device = device;
+  }
+}
+
+/**
+ * Queue bytes to be returned on MISO when no device model is attached
+ */
+int pwjs_sim_spi_queue(uint8_t bus, const uint8_t *buf, size_t len) {
+  if (bus >= SPI_NUM) {
+    return ENODEV;
+  }
+  size_t pending =
+      __spi_status[bus].miso_length - __spi_status[bus].miso_position;
+  uint8_t *miso = (uint8_t *)malloc(pending + len);
+  if (miso == NULL) {
+    return ENOMEM;
+  }
+  if (pending > 0) {
+    memcpy(miso, __spi_status[bus].miso + __spi_status[bus].miso_position,
+           pending);
+  }
+  memcpy(miso + pending, buf, len);
+  free(__spi_status[bus].miso);
+  __spi_status[bus].miso = miso;
+  __spi_status[bus].miso_length = pending + len;
+  __spi_status[bus].miso_position = 0;
+  return 0;
+}
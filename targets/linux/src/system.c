@@ -0,0 +1,130 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "system.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "adc.h"
+#include "board.h"
+#include "flash.h"
+#include "gpio.h"
+#include "i2c.h"
+#include "io.h"
+#include "pwm.h"
+#include "rtc.h"
+#include "sim.h"
+#include "spi.h"
+#include "tty.h"
+#include "uart.h"
+
+static char serial[17];
+
+/**
+ * Delay in milliseconds
+ */
+void pwjs_delay(uint32_t msec) {
+  struct timespec ts = {.tv_sec = msec / 1000,
+                        .tv_nsec = (msec % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+/**
+ * Return current time (milliseconds since boot)
+ */
+uint64_t pwjs_gettime() { return pwjs_micro_gettime() / 1000; }
+
+/**
+ * Return uid of device
+ */
+char *pwjs_getuid() { return serial; }
+
+/**
+ * Return MAX of the microsecond counter
+ */
+uint64_t pwjs_micro_maxtime() {
+  return 0xFFFFFFFFFFFFFFFF;  // Max of the uint64()
+}
+
+/**
+ * Return microsecond counter
+ */
+uint64_t pwjs_micro_gettime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * microsecond delay
+ */
+void pwjs_micro_delay(uint32_t usec) {
+  struct timespec ts = {.tv_sec = usec / 1000000,
+                        .tv_nsec = (usec % 1000000) * 1000L};
+  nanosleep(&ts, NULL);
+}
+
+static void pwjs_uid_init() {
+  snprintf(serial, sizeof(serial), "%016lX", (unsigned long)gethostid());
+}
+
+/**
+ * Linux Host System Initializations
+ */
+void pwjs_system_init() {
+  pwjs_uid_init();
+  pwjs_gpio_init();
+  pwjs_adc_init();
+  pwjs_pwm_init();
+  pwjs_i2c_init();
+  pwjs_spi_init();
+  pwjs_uart_init();
+  pwjs_rtc_init();
+  pwjs_flash_init();
+  pwjs_sim_init();
+}
+
+void pwjs_system_cleanup() {
+  pwjs_adc_cleanup();
+  pwjs_pwm_cleanup();
+  pwjs_i2c_cleanup();
+  pwjs_spi_cleanup();
+  pwjs_uart_cleanup();
+  pwjs_gpio_cleanup();
+  pwjs_rtc_cleanup();
+  pwjs_flash_cleanup();
+}
+
+/**
+ * Load the user program unless PICOWJS_SKIP_LOAD is set (the rp2 target
+ * checks a GPIO for the same purpose)
+ */
+uint8_t pwjs_running_script_check() {
+  return getenv("PICOWJS_SKIP_LOAD") == NULL;
+}
+
+void pwjs_custom_infinite_loop() {
+  pwjs_sim_poll();
+  pwjs_wdt_check();
+}
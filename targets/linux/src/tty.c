@@ -0,0 +1,162 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include "tty.h"
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "repl.h"
+#include "ringbuffer.h"
+#include "runtime.h"
+#include "system.h"
+
+#define TTY_RX_RINGBUFFER_SIZE 2048
+#define ETX 0x03  // Ctrl + C, SIGINT
+static unsigned char __tty_rx_buffer[TTY_RX_RINGBUFFER_SIZE];
+static ringbuffer_t __tty_rx_ringbuffer;
+static pthread_mutex_t __tty_rx_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t __tty_rx_thread;
+static bool __tty_raw = false;
+static struct termios __tty_saved;
+
+static void __tty_restore() {
+  if (__tty_raw) {
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &__tty_saved);
+    __tty_raw = false;
+  }
+}
+
+static void __tty_signal(int sig) {
+  __tty_restore();
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+/**
+ * Put the terminal in raw mode so that keys (including Ctrl+C) reach the
+ * REPL unmodified. Ctrl+\ still quits the process.
+ */
+static void __tty_set_raw() {
+  if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &__tty_saved) < 0) {
+    return;
+  }
+  struct termios raw = __tty_saved;
+  raw.c_iflag &= ~(BRKINT | ICRNL | INPCK | ISTRIP | IXON);
+  raw.c_oflag &= ~(OPOST);
+  raw.c_cflag |= (CS8);
+  raw.c_lflag &= ~(ECHO | ICANON | IEXTEN);
+  raw.c_cc[VINTR] = _POSIX_VDISABLE;
+  raw.c_cc[VSUSP] = _POSIX_VDISABLE;
+  raw.c_cc[VMIN] = 1;
+  raw.c_cc[VTIME] = 0;
+  if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0) {
+    __tty_raw = true;
+    atexit(__tty_restore);
+    signal(SIGQUIT, __tty_signal);
+    signal(SIGTERM, __tty_signal);
+  }
+}
+
+/**
+ * Receive thread (plays the role of the USB CDC interrupt on rp2)
+ */
+static void *__tty_rx_main(void *arg) {
+  uint8_t buf[64];
+  ssize_t n;
+  while ((n = read(STDIN_FILENO, buf, sizeof(buf))) > 0) {
+    pthread_mutex_lock(&__tty_rx_mutex);
+    for (ssize_t i = 0; i < n; i++) {
+      if (buf[i] == ETX && pwjs_get_repl_state()->ymodem_state == 0) {
+        pwjs_runtime_set_vm_stop(1);
+        ringbuffer_flush(&__tty_rx_ringbuffer,
+                         ringbuffer_length(&__tty_rx_ringbuffer));
+      } else if (ringbuffer_freespace(&__tty_rx_ringbuffer) > 0) {
+        ringbuffer_write(&__tty_rx_ringbuffer, &buf[i], 1);
+      }
+    }
+    pthread_mutex_unlock(&__tty_rx_mutex);
+  }
+  return NULL;
+}
+
+void pwjs_tty_init() {
+  ringbuffer_init(&__tty_rx_ringbuffer, __tty_rx_buffer,
+                  sizeof(__tty_rx_buffer));
+  __tty_set_raw();
+  if (isatty(STDOUT_FILENO)) {
+    setvbuf(stdout, NULL, _IONBF, 0);
+  }
+  pthread_create(&__tty_rx_thread, NULL, __tty_rx_main, NULL);
+  pthread_detach(__tty_rx_thread);
+}
+
+uint32_t pwjs_tty_available() {
+  pthread_mutex_lock(&__tty_rx_mutex);
+  uint32_t len = ringbuffer_length(&__tty_rx_ringbuffer);
+  pthread_mutex_unlock(&__tty_rx_mutex);
+  return len;
+}
+
+uint32_t pwjs_tty_read(uint8_t *buf, size_t len) {
+  uint32_t ret = 0;
+  pthread_mutex_lock(&__tty_rx_mutex);
+  if (ringbuffer_length(&__tty_rx_ringbuffer) >= len) {
+    ringbuffer_read(&__tty_rx_ringbuffer, buf, len);
+    ret = len;
+  }
+  pthread_mutex_unlock(&__tty_rx_mutex);
+  return ret;
+}
+
+uint32_t pwjs_tty_read_sync(uint8_t *buf, size_t len, uint32_t timeout) {
+  uint64_t timeout_ms = pwjs_gettime() + timeout;
+  const struct timespec wait = {.tv_sec = 0, .tv_nsec = 100000};  // 100us
+  do {
+    if (pwjs_tty_read(buf, len) == len) {
+      return len;
+    }
+    nanosleep(&wait, NULL);
+  } while (pwjs_gettime() < timeout_ms);
+  return 0;
+}
+
+uint8_t pwjs_tty_getc() {
+  uint8_t c = 0;
+  pwjs_tty_read(&c, 1);
+  return c;
+}
+
+void pwjs_tty_putc(char ch) { putchar(ch); }
+
+/**
+ * Print formatted string to TTY
+ */
+void pwjs_tty_printf(const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  vprintf(fmt, ap);
+  va_end(ap);
+}
@@ -0,0 +1,178 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "uart.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "board.h"
+#include "err.h"
+#include "mem.h"
+#include "ringbuffer.h"
+#include "sim.h"
+
+static ringbuffer_t __uart_rx_ringbuffer[UART_NUM];
+static uint8_t *__read_buffer[UART_NUM];
+static struct __uart_status_s {
+  bool enabled;
+  bool loopback;
+} __uart_status[UART_NUM];
+
+static bool __check_uart(uint8_t port) {
+  return (port < UART_NUM) && __uart_status[port].enabled;
+}
+
+/**
+ * Return default UART pins. -1 means there is no default value on that pin.
+ */
+pwjs_uart_pins_t pwjs_uart_get_default_pins(uint8_t port) {
+  pwjs_uart_pins_t pins = {
+      .tx = -1,
+      .rx = -1,
+      .cts = -1,
+      .rts = -1,
+  };
+  if (port == 0) {
+    pins.tx = 0;
+    pins.rx = 1;
+  } else if (port == 1) {
+    pins.tx = 8;
+    pins.rx = 9;
+  }
+  return pins;
+}
+
+/**
+ * Initialize all UART when system started
+ */
+void pwjs_uart_init() {
+  for (int i = 0; i < UART_NUM; i++) {
+    __uart_status[i].enabled = false;
+    __uart_status[i].loopback = false;
+    __read_buffer[i] = NULL;
+  }
+}
+
+/**
+ * Cleanup all UART when system cleanup
+ */
+void pwjs_uart_cleanup() {
+  for (int i = 0; i < UART_NUM; i++) {
+    if (__uart_status[i].enabled) {
+      pwjs_uart_close(i);
+    }
+  }
+}
+
+int pwjs_uart_setup(uint8_t port, uint32_t baudrate, uint8_t bits,
+                  pwjs_uart_parity_type_t parity, uint8_t stop,
+                  pwjs_uart_flow_control_t flow, size_t buffer_size,
+                  pwjs_uart_pins_t pins) {
+  if ((port >= UART_NUM) || (__uart_status[port].enabled) || (bits < 5) ||
+      (bits > 8)) {  // Can't support 9 bit
+    return EDEVINIT;
+  }
+  __read_buffer[port] = (uint8_t *)pwjs_malloc(PWJS_MEM_UART, buffer_size);
+  if (__read_buffer[port] == NULL) {
+    return EDEVINIT;
+  }
+  ringbuffer_init(&__uart_rx_ringbuffer[port], __read_buffer[port],
+                  buffer_size);
+  __uart_status[port].enabled = true;
+  return 0;
+}
+
+int pwjs_uart_write(uint8_t port, uint8_t *buf, size_t len) {
+  if (!__check_uart(port)) {
+    return EDEVWRITE;
+  }
+  if (pwjs_sim_trace) {
+    fprintf(stderr, "[sim] uart %d tx:", port);
+    for (size_t i = 0; i < len; i++) {
+      fprintf(stderr, " %02x", buf[i]);
+    }
+    fprintf(stderr, "\n");
+  }
+  if (__uart_status[port].loopback) {
+    pwjs_sim_uart_feed(port, buf, len);
+  }
+  return len;
+}
+
+uint32_t pwjs_uart_available(uint8_t port) {
+  if (!__check_uart(port)) {
+    return ENOPHRPL;
+  }
+  return ringbuffer_length(&__uart_rx_ringbuffer[port]);
+}
+
+uint32_t pwjs_uart_read(uint8_t port, uint8_t *buf, size_t len) {
+  if (!__check_uart(port)) {
+    return EDEVREAD;
+  }
+  uint32_t n = ringbuffer_length(&__uart_rx_ringbuffer[port]);
+  if (n > len) {
+    n = len;
+  }
+  ringbuffer_read(&__uart_rx_ringbuffer[port], buf, n);
+  return n;
+}
+
+int pwjs_uart_close(uint8_t port) {
+  if (!__check_uart(port)) {
+    return EDEVINIT;
+  }
+  if (__read_buffer[port]) {
+    pwjs_free(__read_buffer[port]);
+    __read_buffer[port] = (uint8_t *)NULL;
+  }
+  __uart_status[port].enabled = false;
+  return 0;
+}
+
+/**
+ * Push bytes into the RX buffer of a UART port from the simulation.
+ * Bytes that do not fit in the buffer are dropped like an overrun.
+ */
+int pwjs_sim_uart_feed(uint8_t port, const uint8_t *buf, size_t len) {
+  if (!__check_uart(port)) {
+    return EDEVREAD;
+  }
+  size_t free_len = ringbuffer_freespace(&__uart_rx_ringbuffer[port]);
+  if (len > free_len) {
+    len = free_len;
+  }
+  ringbuffer_write(&__uart_rx_ringbuffer[port], (uint8_t *)buf, len);
+  return len;
+}
+
+/**
+ * Echo data written to a UART port back into its RX buffer
+ */
+int pwjs_sim_uart_loopback(uint8_t port, bool enable) {
+  if (port >= UART_NUM) {
+    return ENODEV;
+  }
+  __uart_status[port].loopback = enable;
+  return 0;
+}
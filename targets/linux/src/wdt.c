@@ -0,0 +1,64 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "wdt.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "board.h"
+#include "err.h"
+#include "system.h"
+
+static bool __wdt_enabled = false;
+static uint32_t __wdt_timeout = 0;
+static uint64_t __wdt_last_feed = 0;
+
+/**
+ * Enable watchdog timer. The host has no reset line, so an expired watchdog
+ * terminates the process (checked from the main loop).
+ *
+ * @param {uint32_t} timeout, milliseconds
+ * @return error code
+ */
+int pwjs_wdt_enable(bool en, uint32_t timeout_ms) {
+  __wdt_enabled = en;
+  __wdt_timeout = timeout_ms;
+  __wdt_last_feed = pwjs_gettime();
+  return 0;
+}
+
+/**
+ * Feed (Kick) watch dog reset timer
+ *
+ */
+void pwjs_wdt_feed(void) { __wdt_last_feed = pwjs_gettime(); }
+
+/**
+ * Check the watchdog timer from the main loop
+ */
+void pwjs_wdt_check(void) {
+  if (__wdt_enabled && (pwjs_gettime() - __wdt_last_feed > __wdt_timeout)) {
+    fprintf(stderr, "watchdog timeout (%u ms)\n", __wdt_timeout);
+    exit(2);
+  }
+}
@@ -0,0 +1,103 @@
+######################################
+# building variables
+######################################
+
+# debug build?
+set(DEBUG 1)
+
+# optimization
+set(OPT -O2)
+
+# default board: host
+if(NOT BOARD)
+  set(BOARD "host")
+endif()
+
+# default modules
+if(NOT MODULES)
+  set(MODULES
+    events
+    gpio
+    led
+    button
+    pwm
+    adc
+    i2c
+    spi
+    uart
+    graphics
+    at
+    storage
+    wifi
+    stream
+    net
+    http
+    url
+    rtc
+    path
+    flash
+    ramblkdev
+    fs
+    vfs_lfs
+    vfs_fat
+    vfs_assets
+    sdcard
+    wdt
+    startup)
+endif()
+
+project(picowjs-project C)
+
+set(OUTPUT_TARGET picowjs-${TARGET}-${BOARD}-${VER})
+set(TARGET_SRC_DIR ${CMAKE_CURRENT_LIST_DIR}/src)
+set(TARGET_INC_DIR ${CMAKE_CURRENT_LIST_DIR}/include)
+set(BOARD_DIR ${CMAKE_CURRENT_LIST_DIR}/boards/${BOARD})
+
+set(SOURCES
+  ${SOURCES}
+  ${TARGET_SRC_DIR}/adc.c
+  ${TARGET_SRC_DIR}/system.c
+  ${TARGET_SRC_DIR}/gpio.c
+  ${TARGET_SRC_DIR}/pwm.c
+  ${TARGET_SRC_DIR}/tty.c
+  ${TARGET_SRC_DIR}/flash.c
+  ${TARGET_SRC_DIR}/uart.c
+  ${TARGET_SRC_DIR}/i2c.c
+  ${TARGET_SRC_DIR}/spi.c
+  ${TARGET_SRC_DIR}/rtc.c
+  ${TARGET_SRC_DIR}/wdt.c
+  ${TARGET_SRC_DIR}/sim.c
+  ${TARGET_SRC_DIR}/sim_sdcard.c
+  ${TARGET_SRC_DIR}/main.c
+  ${BOARD_DIR}/board.c)
+
+include_directories(${TARGET_INC_DIR} ${BOARD_DIR})
+
+# same heap as the device so memory behaviour matches
+set(TARGET_HEAPSIZE 180)
+# native build of jerryscript (no cross toolchain)
+set(JERRY_TOOLCHAIN "")
+
+# keep frame pointers for perf and valgrind call stacks
+set(CMAKE_C_FLAGS "${OPT} -Wall -fno-omit-frame-pointer")
+if(DEBUG EQUAL 1)
+  set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -g")
+endif()
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -MMD -MP")
+
+set(TARGET_LIBS m pthread)
+
+include(${CMAKE_SOURCE_DIR}/tools/picowjs.cmake)
+add_executable(${OUTPUT_TARGET} ${SOURCES} ${JERRY_LIBS})
+target_link_libraries(${OUTPUT_TARGET} ${JERRY_LIBS} ${TARGET_LIBS})
+
+# checks run on the host executable: `ctest` in the build directory
+enable_testing()
+foreach(test require_fs require_events)
+  add_test(NAME ${test}
+    COMMAND ${OUTPUT_TARGET} ${CMAKE_CURRENT_LIST_DIR}/tests/${test}.js)
+  set_tests_properties(${test} PROPERTIES
+    ENVIRONMENT "PICOWJS_FLASH=${CMAKE_BINARY_DIR}/test-flash.bin"
+    PASS_REGULAR_EXPRESSION "${test}: ok"
+    FAIL_REGULAR_EXPRESSION "Error")
+endforeach()
@@ -0,0 +1,19 @@
+// events is self-contained, stream and http build on it
+const { EventEmitter } = require("events");
+const { Readable, Writable } = require("stream");
+let count = 0;
+const emitter = new EventEmitter();
+const listener = (value) => (count += value);
+emitter.on("data", listener);
+emitter.once("data", (value) => (count += 10 * value));
+emitter.emit("data", 1);
+emitter.emit("data", 1);
+emitter.removeListener("data", listener);
+emitter.emit("data", 1);
+if (count !== 12) {
+  throw new Error("events: wrong listener calls " + count);
+}
+if (typeof Readable !== "function" || typeof Writable !== "function") {
+  throw new Error("stream classes are missing");
+}
+console.log("require_events: ok");
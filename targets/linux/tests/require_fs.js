@@ -0,0 +1,12 @@
+// fs is loaded by the board at boot, it must load on its own
+const fs = require("fs");
+const apis = ["readFile", "writeFile", "opendir", "mmap", "createReadStream"];
+apis.forEach((name) => {
+  if (typeof fs[name] !== "function") {
+    throw new Error("fs." + name + " is missing");
+  }
+});
+if (typeof fs.promises.readFile !== "function") {
+  throw new Error("fs.promises.readFile is missing");
+}
+console.log("require_fs: ok");
@@ -26,6 +26,7 @@
 #include "err.h"
 #include "hardware/irq.h"
 #include "hardware/uart.h"
+#include "mem.h"
 #include "pico/stdlib.h"
 #include "ringbuffer.h"
 
@@ -166,7 +167,7 @@ int pwjs_uart_setup(uint8_t port, uint32_t baudrate, uint8_t bits,
     pt = UART_PARITY_ODD;
   }
   uart_set_format(uart, bits, stop, pt);
-  __read_buffer[port] = (uint8_t *)malloc(buffer_size);
+  __read_buffer[port] = (uint8_t *)pwjs_malloc(PWJS_MEM_UART, buffer_size);
   if (__read_buffer[port] == NULL) {
     return EDEVINIT;
   } else {
@@ -229,7 +230,7 @@ int pwjs_uart_close(uint8_t port) {
     return EDEVINIT;
   }
   if (__read_buffer[port]) {
-    free(__read_buffer[port]);
+    pwjs_free(__read_buffer[port]);
     __read_buffer[port] = (uint8_t *)NULL;
   }
   uart_deinit(uart);
@@ -41,9 +41,11 @@ if(NOT MODULES)
     rtc
     path
     flash
+    ramblkdev
     fs
     vfs_lfs
     vfs_fat
+    vfs_assets
     sdcard
     wdt
     startup)
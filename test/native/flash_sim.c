@@ -0,0 +1,141 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "flash_sim.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "board.h"
+#include "err.h"
+#include "flash.h"
+
+#define __FLASH_SIZE (PICOWJS_FLASH_SECTOR_SIZE * PICOWJS_FLASH_SECTOR_COUNT)
+
+const uint8_t *pwjs_flash_addr = NULL;
+
+static uint8_t __flash[__FLASH_SIZE];
+
+/**
+ * - countdown : operations left until the power cut, 0 if not armed
+ * - count : operations done since armed
+ */
+static struct {
+  uint32_t countdown;
+  uint32_t count;
+  jmp_buf *jump;
+} __cut;
+
+static uint32_t __random_state = 1;
+
+void flash_sim_seed(uint32_t seed) { __random_state = seed ? seed : 1; }
+
+uint32_t flash_sim_random() {
+  uint32_t x = __random_state;  // xorshift32
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  __random_state = x;
+  return x;
+}
+
+void flash_sim_reset() {
+  memset(__flash, 0xFF, __FLASH_SIZE);
+  pwjs_flash_addr = __flash;
+}
+
+void flash_sim_arm(uint32_t n, jmp_buf *jump) {
+  __cut.countdown = n;
+  __cut.count = 0;
+  __cut.jump = jump;
+}
+
+uint32_t flash_sim_disarm() {
+  __cut.countdown = 0;
+  return __cut.count;
+}
+
+/**
+ * Return true if the power is cut during this operation
+ */
+static bool __flash_cut() {
+  if (__cut.countdown == 0) {
+    return false;
+  }
+  __cut.count++;
+  return --__cut.countdown == 0;
+}
+
+void pwjs_flash_init() {
+  if (pwjs_flash_addr == NULL) {
+    flash_sim_reset();
+  }
+}
+
+void pwjs_flash_cleanup() {}
+
+int pwjs_flash_program(uint32_t sector, uint32_t offset, uint8_t *buffer,
+                       size_t size) {
+  const uint32_t _base =
+      PICOWJS_FLASH_OFFSET + (sector * PICOWJS_FLASH_SECTOR_SIZE) + offset;
+  if (_base % PICOWJS_FLASH_PAGE_SIZE > 0 ||
+      size % PICOWJS_FLASH_PAGE_SIZE > 0 || _base + size > __FLASH_SIZE) {
+    return EINVAL;
+  }
+  uint8_t *dst = __flash + _base;
+  if (!__flash_cut()) {
+    for (size_t i = 0; i < size; i++) {
+      dst[i] &= buffer[i];
+    }
+    return 0;
+  }
+  // torn: the bytes are programmed in order, the last one only partly
+  size_t done = flash_sim_random() % size;
+  for (size_t i = 0; i < done; i++) {
+    dst[i] &= buffer[i];
+  }
+  dst[done] &= buffer[done] | (uint8_t)flash_sim_random();
+  longjmp(*__cut.jump, 1);
+}
+
+int pwjs_flash_erase(uint32_t sector, size_t count) {
+  const uint32_t _base =
+      PICOWJS_FLASH_OFFSET + (sector * PICOWJS_FLASH_SECTOR_SIZE);
+  const uint32_t _size = count * PICOWJS_FLASH_SECTOR_SIZE;
+  if (_base + _size > __FLASH_SIZE) {
+    return EINVAL;
+  }
+  uint8_t *dst = __flash + _base;
+  if (!__flash_cut()) {
+    memset(dst, 0xFF, _size);
+    return 0;
+  }
+  // torn: either a part of the sector is erased, or bits of any byte
+  if (flash_sim_random() & 1) {
+    memset(dst, 0xFF, flash_sim_random() % _size);
+  } else {
+    for (uint32_t i = 0; i < _size; i++) {
+      dst[i] |= (uint8_t)flash_sim_random();
+    }
+  }
+  longjmp(*__cut.jump, 1);
+}
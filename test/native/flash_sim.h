@@ -0,0 +1,58 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PWJS_FLASH_SIM_H
+#define __PWJS_FLASH_SIM_H
+
+#include <setjmp.h>
+#include <stdint.h>
+
+/**
+ * RAM flash implementing the flash port, with NOR semantics (programs only
+ * clear bits, erases set a sector to 0xFF) and power cuts: once armed, the
+ * n-th program or erase is torn and the simulator jumps to the power cut
+ * handler set with flash_sim_arm().
+ */
+
+/**
+ * Set the whole flash to 0xFF
+ */
+void flash_sim_reset();
+
+/**
+ * Cut the power during the n-th program or erase from now (n >= 1). The
+ * torn operation leaves part of its bytes written, then longjmp()s to the
+ * jump buffer with the value 1.
+ */
+void flash_sim_arm(uint32_t n, jmp_buf *jump);
+
+/**
+ * Disarm the power cut, return the number of operations done since armed
+ */
+uint32_t flash_sim_disarm();
+
+/**
+ * Seed of the pseudo-random generator shared with the test
+ */
+void flash_sim_seed(uint32_t seed);
+uint32_t flash_sim_random();
+
+#endif /* __PWJS_FLASH_SIM_H */
@@ -0,0 +1,192 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Test of the SD card driver against the SD card model of the linux target
+ * on a simulated SPI bus. Checks the commands sent for single and multiple
+ * block transfers, the blocks transferred and that the data round-trips.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+#include "gpio.h"
+#include "sdcard.h"
+#include "sim.h"
+#include "spi.h"
+#include "system.h"
+
+#define BUS 1
+#define CS_PIN 13
+#define CARD_BLOCKS 4096
+#define BLOCK 512
+#define MULTI 32
+
+bool pwjs_sim_trace = false;
+
+// the driver only needs a clock that moves, for its timeouts
+static uint64_t __time = 0;
+
+uint64_t pwjs_gettime() { return __time++; }
+
+void pwjs_delay(uint32_t msec) { __time += msec; }
+
+int pwjs_gpio_write(uint8_t pin, uint8_t value) { return 0; }
+
+static int failures = 0;
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+      failures++;                                                     \
+    }                                                                 \
+  } while (0)
+
+static pwjs_sim_sdcard_stats_t stats_base;
+
+static void stats_reset() { pwjs_sim_sdcard_get_stats(&stats_base); }
+
+static pwjs_sim_sdcard_stats_t stats_get() {
+  pwjs_sim_sdcard_stats_t stats;
+  pwjs_sim_sdcard_get_stats(&stats);
+  stats.commands -= stats_base.commands;
+  stats.blocks_read -= stats_base.blocks_read;
+  stats.blocks_written -= stats_base.blocks_written;
+  stats.pre_erases -= stats_base.pre_erases;
+  return stats;
+}
+
+static void fill(uint8_t *buf, size_t len, uint32_t seed) {
+  uint32_t x = seed;
+  for (size_t i = 0; i < len; i++) {
+    x = x * 1103515245u + 12345u;
+    buf[i] = (uint8_t)(x >> 16);
+  }
+}
+
+static bool is_blank(uint32_t block) {
+  uint8_t buf[BLOCK];
+  if (sdcard_read_blocks(block, buf, 1) < 0) {
+    return false;
+  }
+  for (int i = 0; i < BLOCK; i++) {
+    if (buf[i] != 0xFF) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void test_single() {
+  static uint8_t out[BLOCK], in[BLOCK];
+  pwjs_sim_sdcard_stats_t stats;
+  fill(out, BLOCK, 1);
+
+  stats_reset();
+  CHECK(sdcard_write_blocks(10, out, 1) == 0);
+  stats = stats_get();
+  CHECK(stats.commands == 1);  // CMD24
+  CHECK(stats.blocks_written == 1);
+  CHECK(stats.pre_erases == 0);
+
+  stats_reset();
+  CHECK(sdcard_read_blocks(10, in, 1) == 0);
+  stats = stats_get();
+  CHECK(stats.commands == 1);  // CMD17
+  CHECK(stats.blocks_read == 1);
+  CHECK(memcmp(in, out, BLOCK) == 0);
+}
+
+static void test_multiple() {
+  static uint8_t out[MULTI * BLOCK], in[MULTI * BLOCK];
+  pwjs_sim_sdcard_stats_t stats;
+  fill(out, sizeof(out), 2);
+
+  stats_reset();
+  CHECK(sdcard_write_blocks(100, out, MULTI) == 0);
+  stats = stats_get();
+  CHECK(stats.commands == 3);  // ACMD23 (CMD55 + CMD23), CMD25
+  CHECK(stats.blocks_written == MULTI);
+  CHECK(stats.pre_erases == 1);
+
+  stats_reset();
+  CHECK(sdcard_read_blocks(100, in, MULTI) == 0);
+  stats = stats_get();
+  CHECK(stats.commands == 2);  // CMD18, CMD12
+  CHECK(stats.blocks_read == MULTI);
+  CHECK(memcmp(in, out, sizeof(out)) == 0);
+
+  // the blocks around are left blank
+  CHECK(is_blank(99));
+  CHECK(is_blank(100 + MULTI));
+
+  // a read in the middle of the range
+  memset(in, 0, sizeof(in));
+  CHECK(sdcard_read_blocks(110, in, 4) == 0);
+  CHECK(memcmp(in, out + 10 * BLOCK, 4 * BLOCK) == 0);
+}
+
+static void test_blkdev() {
+  static uint8_t out[8 * BLOCK], in[8 * BLOCK];
+  pwjs_sim_sdcard_stats_t stats;
+  fill(out, sizeof(out), 3);
+
+  stats_reset();
+  CHECK(sdcard_blkdev.write(&sdcard_blkdev, 1000, 0, out, sizeof(out)) == 0);
+  CHECK(sdcard_blkdev.read(&sdcard_blkdev, 1000, 0, in, sizeof(in)) == 0);
+  stats = stats_get();
+  CHECK(stats.commands == 5);
+  CHECK(stats.blocks_written == 8);
+  CHECK(stats.blocks_read == 8);
+  CHECK(memcmp(in, out, sizeof(out)) == 0);
+
+  // erase sets the block back to blank
+  CHECK(sdcard_blkdev.ioctl(&sdcard_blkdev, PWJS_BLKDEV_ERASE, 1003) == 0);
+  CHECK(is_blank(1003));
+  CHECK(!is_blank(1002));
+}
+
+int main() {
+  pwjs_spi_pins_t pins = {-1, -1, -1};
+  CHECK(pwjs_sim_sdcard_attach(BUS, CARD_BLOCKS) == 0);
+  CHECK(pwjs_spi_setup(BUS, PWJS_SPI_MODE_0, 400000, PWJS_SPI_BITORDER_MSB,
+                       pins, true) == 0);
+  sdcard_setup(BUS, CS_PIN);
+  CHECK(sdcard_init() > 0);
+  CHECK(sdcard_is_ready());
+  CHECK(sdcard_get_block_size() == BLOCK);
+  CHECK(sdcard_get_block_count() == CARD_BLOCKS);
+  if (failures == 0) {
+    test_single();
+    test_multiple();
+    test_blkdev();
+  }
+  pwjs_sim_sdcard_detach();
+  if (failures > 0) {
+    return 1;
+  }
+  printf("sdcard: ok\n");
+  return 0;
+}
@@ -0,0 +1,352 @@
+/* Copyright (c) 2024 Pico-W-JS
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * Randomized model test of the storage log. Random sets, removals and
+ * batches are applied both to the storage, on the simulated flash, and to
+ * a model in RAM. Some operations are interrupted by a power cut, which
+ * tears the flash program or erase in progress, and are followed by a
+ * recovery (itself sometimes cut). After a cut, the storage must hold
+ * either the state before or the state after the operation.
+ *
+ * Usage: picowjs-test-storage [seed] [iterations]
+ */
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "err.h"
+#include "flash.h"
+#include "flash_sim.h"
+#include "storage.h"
+
+#define KEY_COUNT 12
+#define VALUE_MAX 1500
+#define BATCH_MAX 4
+#define DEFAULT_ITERATIONS 3000
+
+typedef enum {
+  OP_SET,
+  OP_SET_BYTES,
+  OP_REMOVE,
+  OP_BATCH,
+} op_type_t;
+
+typedef struct {
+  bool set;
+  bool bytes;
+  uint16_t length;
+  uint8_t value[VALUE_MAX + 1];  // NUL terminated for setItem
+} model_item_t;
+
+typedef struct {
+  model_item_t items[KEY_COUNT];
+} model_t;
+
+typedef struct {
+  int key;
+  const uint8_t *value;  // NULL to remove
+  uint16_t length;
+  bool bytes;
+} op_item_t;
+
+typedef struct {
+  op_type_t type;
+  int count;  // > 1 for a batch
+  op_item_t items[BATCH_MAX];
+  uint8_t values[BATCH_MAX][VALUE_MAX + 1];
+} op_t;
+
+static char keys[KEY_COUNT][8];
+
+// kept out of the stack frames left by longjmp()
+static model_t model;
+static model_t post;
+static op_t op;
+static jmp_buf jump;
+static uint32_t seed;
+static uint32_t iteration;
+
+static struct {
+  uint32_t ops;
+  uint32_t cuts;
+  uint32_t recovery_cuts;
+  uint32_t full;
+  uint32_t rolled_back;
+} stats;
+
+static void fail(const char *message, int key) {
+  fprintf(stderr, "FAIL seed %u iteration %u: %s", seed, iteration, message);
+  if (key >= 0) {
+    fprintf(stderr, " (key %s)", keys[key]);
+  }
+  fprintf(stderr, "\n");
+  exit(1);
+}
+
+/**
+ * Random value length, mostly values of one slot, sometimes of several
+ */
+static uint16_t random_length() {
+  uint32_t r = flash_sim_random();
+  if (r % 4 == 0) {
+    return (r >> 8) % (VALUE_MAX + 1);
+  }
+  return (r >> 8) % 200;
+}
+
+static void random_item(op_item_t *item, uint8_t *buffer, op_type_t type) {
+  item->key = flash_sim_random() % KEY_COUNT;
+  item->bytes = type == OP_SET_BYTES;
+  if (type == OP_REMOVE) {
+    item->value = NULL;
+    item->length = 0;
+    return;
+  }
+  item->length = random_length();
+  for (int i = 0; i < item->length; i++) {
+    // string values have no NUL in them
+    buffer[i] = item->bytes ? (uint8_t)flash_sim_random()
+                            : 'a' + flash_sim_random() % 26;
+  }
+  buffer[item->length] = '\0';
+  item->value = buffer;
+}
+
+static void random_op() {
+  uint32_t r = flash_sim_random() % 10;
+  op.type = r < 4 ? OP_SET : r < 6 ? OP_SET_BYTES : r < 8 ? OP_REMOVE : OP_BATCH;
+  if (op.type != OP_BATCH) {
+    op.count = 1;
+    random_item(&op.items[0], op.values[0], op.type);
+    return;
+  }
+  op.count = 1 + flash_sim_random() % BATCH_MAX;
+  for (int i = 0; i < op.count; i++) {
+    op_type_t type = (op_type_t)(flash_sim_random() % 3);
+    random_item(&op.items[i], op.values[i], type);
+  }
+}
+
+static int run_op() {
+  op_item_t *item = &op.items[0];
+  switch (op.type) {
+    case OP_SET:
+      return storage_set_item(keys[item->key], (char *)item->value);
+    case OP_SET_BYTES:
+      return storage_set_item_bytes(keys[item->key], item->value,
+                                    item->length);
+    case OP_REMOVE:
+      return storage_remove_item(keys[item->key]);
+    default: {
+      storage_batch_op_t ops[BATCH_MAX];
+      for (int i = 0; i < op.count; i++) {
+        ops[i].key = keys[op.items[i].key];
+        ops[i].value = op.items[i].value;
+        ops[i].length = op.items[i].length;
+        ops[i].bytes = op.items[i].bytes;
+      }
+      return storage_write_batch(ops, op.count);
+    }
+  }
+}
+
+static void model_apply(model_t *m) {
+  for (int i = 0; i < op.count; i++) {
+    op_item_t *item = &op.items[i];
+    model_item_t *entry = &m->items[item->key];
+    entry->set = item->value != NULL;
+    if (entry->set) {
+      entry->bytes = item->bytes;
+      entry->length = item->length;
+      memcpy(entry->value, item->value, item->length);
+    }
+  }
+}
+
+/**
+ * Return -1 if the storage holds the model, else the first key differing
+ * (KEY_COUNT for a wrong item count or key list)
+ */
+static int model_diff(model_t *m) {
+  int count = 0;
+  for (int i = 0; i < KEY_COUNT; i++) {
+    model_item_t *entry = &m->items[i];
+    const uint8_t *value;
+    bool bytes;
+    int ret = storage_get_item_ref(keys[i], &value, &bytes);
+    if (!entry->set) {
+      if (ret != ESTGNOKEY) {
+        return i;
+      }
+      continue;
+    }
+    count++;
+    if (ret != entry->length || bytes != entry->bytes ||
+        memcmp(value, entry->value, entry->length) != 0) {
+      return i;
+    }
+  }
+  if (storage_get_item_count() != count) {
+    return KEY_COUNT;
+  }
+  // each key is listed once
+  bool listed[KEY_COUNT] = {false};
+  for (int i = 0; i < count; i++) {
+    char key[SLOT_DATA_MAX + 1];
+    int len = storage_get_key_length(i);
+    if (len < 0 || len > SLOT_DATA_MAX || storage_get_key(i, key) < 0) {
+      return KEY_COUNT;
+    }
+    key[len] = '\0';
+    int k = 0;
+    while (k < KEY_COUNT && strcmp(keys[k], key) != 0) {
+      k++;
+    }
+    if (k == KEY_COUNT || listed[k] || !m->items[k].set) {
+      return KEY_COUNT;
+    }
+    listed[k] = true;
+  }
+  return -1;
+}
+
+static void model_check(model_t *m, const char *message) {
+  int key = model_diff(m);
+  if (key >= 0) {
+    fail(message, key < KEY_COUNT ? key : -1);
+  }
+}
+
+/**
+ * Mount after a power cut. The recovery writes to the flash, so it may be
+ * cut as well, and is then done again.
+ */
+static void recover() {
+  for (;;) {
+    bool cut = flash_sim_random() % 4 == 0;
+    if (cut) {
+      flash_sim_arm(1 + flash_sim_random() % 8, &jump);
+    }
+    if (setjmp(jump) == 0) {
+      storage_mount();
+      flash_sim_disarm();
+      return;
+    }
+    stats.recovery_cuts++;
+  }
+}
+
+static void run_iteration() {
+  random_op();
+  stats.ops++;
+  bool cut = flash_sim_random() % 4 == 0;
+  if (cut) {
+    flash_sim_arm(1 + flash_sim_random() % 8, &jump);
+  }
+  if (setjmp(jump) == 0) {
+    int ret = run_op();
+    flash_sim_disarm();
+    if (ret == 0) {
+      model_apply(&model);
+    } else if (ret == ESTGFULL) {
+      stats.full++;
+    } else if (!(op.type == OP_REMOVE && ret == ESTGNOKEY &&
+                 !model.items[op.items[0].key].set)) {
+      fail("unexpected error", op.items[0].key);
+    }
+    model_check(&model, "storage differs from the model");
+    return;
+  }
+  // power cut: the operation is either done or not at all
+  stats.cuts++;
+  recover();
+  memcpy(&post, &model, sizeof(model_t));
+  model_apply(&post);
+  if (model_diff(&post) < 0) {
+    memcpy(&model, &post, sizeof(model_t));
+  } else {
+    model_check(&model, "storage is neither before nor after the operation");
+    stats.rolled_back++;
+  }
+  // the recovery is done, mounting again changes nothing
+  storage_mount();
+  model_check(&model, "storage differs after mounting again");
+}
+
+/**
+ * Churn a single key over a few cold ones, without power cuts, and check
+ * the sectors are erased evenly.
+ */
+static void check_wear() {
+  uint32_t min = UINT32_MAX;
+  uint32_t max = 0;
+  flash_sim_reset();
+  storage_mount();
+  storage_set_item("cold-0", "cold value");
+  storage_set_item("cold-1", "cold value");
+  for (int i = 0; i < 20000; i++) {
+    if (storage_set_item("hot", i % 2 ? "hot value" : "other hot value") < 0) {
+      fail("churn failed", -1);
+    }
+  }
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    const storage_sector_header_t *header =
+        (const storage_sector_header_t *)(pwjs_flash_addr +
+                                          (SECTOR_BASE + i) *
+                                              PICOWJS_FLASH_SECTOR_SIZE);
+    if (header->erase_count < min) {
+      min = header->erase_count;
+    }
+    if (header->erase_count > max) {
+      max = header->erase_count;
+    }
+  }
+  if (max - min > STORAGE_WEAR_DELTA + 1) {
+    fail("sectors are not erased evenly", -1);
+  }
+  printf("wear: erase counts %u..%u\n", min, max);
+}
+
+int main(int argc, char **argv) {
+  seed = argc > 1 ? strtoul(argv[1], NULL, 10) : 1;
+  uint32_t iterations = argc > 2 ? strtoul(argv[2], NULL, 10)
+                                 : DEFAULT_ITERATIONS;
+  for (int i = 0; i < KEY_COUNT; i++) {
+    snprintf(keys[i], sizeof(keys[i]), "key-%d", i);
+  }
+  flash_sim_seed(seed);
+  flash_sim_reset();
+  storage_mount();
+  memset(&model, 0, sizeof(model_t));
+  for (iteration = 0; iteration < iterations; iteration++) {
+    run_iteration();
+  }
+  printf("seed %u: %u ops, %u cuts (%u rolled back), %u cuts in recovery, "
+         "%u full\n",
+         seed, stats.ops, stats.cuts, stats.rolled_back, stats.recovery_cuts,
+         stats.full);
+  check_wear();
+  return 0;
+}
@@ -20,7 +20,6 @@ set(JERRY_INC
   ${JERRY_ROOT}/jerry-libm)
 
 set(JERRY_ARGS
-  --toolchain=cmake/${JERRY_TOOLCHAIN}
   #--build-type=Debug
   --compile-flag="-DJERRY_NDEBUG=1 -DJERRY_LCACHE=0 -DJERRY_PROPRETY_HASHMAP=0"
   --lto=OFF
@@ -38,6 +37,11 @@ set(JERRY_ARGS
   #--gc-limit=100000
   --cpointer-32bit=ON)
 
+# no toolchain means a native build (e.g. linux target)
+if(JERRY_TOOLCHAIN)
+  list(APPEND JERRY_ARGS --toolchain=cmake/${JERRY_TOOLCHAIN})
+endif()
+
 set(SRC_DIR ${CMAKE_SOURCE_DIR}/src)
 set(PICOWJS_GENERATED_C
   ${SRC_DIR}/gen/picowjs_modules.c
@@ -71,6 +75,11 @@ include_directories(${PICOWJS_INC} ${JERRY_INC})
 list(APPEND SOURCES
   ${SRC_DIR}/err.c
   ${SRC_DIR}/utils.c
+  ${SRC_DIR}/mem.c
+  ${SRC_DIR}/flash_cache.c
+  ${SRC_DIR}/blkdev.c
+  ${SRC_DIR}/vfs.c
+  ${SRC_DIR}/blkcache.c
   ${SRC_DIR}/base64.c
   ${SRC_DIR}/io.c
   ${SRC_DIR}/runtime.c